@@ -0,0 +1,3757 @@
+/**
+ *
+ *  Copyright (C) 2020  Raul Casanova Marques
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <getopt.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+#include "system.h"
+#include "setup.h"
+
+#include "controllers/issuer.h"
+#include "controllers/revocation-authority.h"
+#include "controllers/user.h"
+#include "controllers/verifier.h"
+
+#include "helpers/fixed_base_helper.h"
+#include "helpers/hex_helper.h"
+#include "helpers/mcl_helper.h"
+#include "keystore/keystore.h"
+#include "rkvac.h"
+
+#include "services/verifier.h"
+
+/*
+ * Number of revoked pseudonyms of the revocation list benchmark
+ */
+#define BENCHMARK_NUM_REVOKED (1u << 20u)
+
+/*
+ * Number of keys looked up by the revocation list benchmark
+ */
+#define BENCHMARK_NUM_LOOKUPS 1024
+
+/*
+ * Number of users revoked within the epoch by the revocation delta benchmark
+ */
+#define BENCHMARK_NUM_DELTA_KEYS 16
+
+/*
+ * Number of verifier processes mapping the shared revocation list
+ */
+#define BENCHMARK_NUM_PROCESSES 4
+
+/*
+ * Number of randomizers k used by the randomizers benchmark
+ */
+#define BENCHMARK_NUM_RANDOMIZERS 4096
+
+/*
+ * Number of credentials issued by the batch issuance benchmark
+ */
+#define BENCHMARK_NUM_CREDENTIALS 2048
+
+/*
+ * Number of client threads used by the verifier service benchmark
+ */
+#define BENCHMARK_NUM_CLIENTS 8
+
+/*
+ * Number of proofs verified at once by the batch verification check
+ */
+#define BENCHMARK_NUM_BATCH_PROOFS 8
+
+typedef struct
+{
+    system_par_t sys_parameters;
+
+    revocation_authority_par_t ra_parameters;
+    revocation_authority_keys_t ra_keys;
+    revocation_authority_signature_t ra_signature;
+    size_t ra_indices[REVOCATION_AUTHORITY_MAX_J]; // randomizers selected for the epoch
+
+    issuer_par_t ie_parameters;
+    issuer_keys_t ie_keys;
+    issuer_signature_t ie_signature;
+
+    user_identifier_t ue_identifier;
+    user_attributes_t ue_attributes;
+    user_credential_t ue_credential;
+    user_pi_t ue_pi;
+
+    verifier_par_t ve_parameters;
+
+    uint8_t nonce[NONCE_LENGTH];
+    uint8_t epoch[EPOCH_LENGTH];
+} benchmark_protocol_t;
+
+typedef struct
+{
+    pthread_t thread;
+    revocation_snapshot_t *snapshot; // NULL - read-write lock
+    pthread_rwlock_t *lock;
+    revocation_list_t **list;
+    const uint8_t (*keys)[REVOCATION_LIST_KEY_LENGTH];
+    size_t num_keys;
+    size_t num_lookups;
+    size_t *num_finished;
+    int error;
+} benchmark_reader_t;
+
+typedef struct
+{
+    pthread_t thread;
+    const char *socket_path;
+    const uint8_t *request;
+    size_t num_requests;
+    int error;
+} benchmark_client_t;
+
+static struct option long_options[] = {
+        {"iterations", required_argument, 0, 'i'},
+        {"help",       no_argument,       0, 'h'},
+        {0, 0, 0, 0}
+};
+
+/**
+ * Gets the current time of the monotonic clock.
+ *
+ * @return the current time in seconds
+ */
+static double benchmark_get_time(void)
+{
+    struct timespec ts = {0, 0};
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (double) ts.tv_sec + 1.0e-9 * (double) ts.tv_nsec;
+}
+
+/**
+ * Displays the average elapsed time of the reference and the optimized implementation.
+ *
+ * @param name the name of the benchmarked operation
+ * @param reference the elapsed time of the reference implementation
+ * @param optimized the elapsed time of the optimized implementation
+ * @param iterations the number of iterations
+ */
+static void benchmark_display(const char *name, double reference, double optimized, size_t iterations)
+{
+    fprintf(stdout, "[!] Elapsed time (%s) = %f / %f (x%.2f)\n", name, reference / (double) iterations, optimized / (double) iterations,
+            optimized > 0 ? reference / optimized : 0.0);
+}
+
+/**
+ * Runs the whole protocol once to obtain the data used by the benchmarks.
+ *
+ * @param protocol the protocol data
+ * @param k the number of randomizers (0 - default)
+ * @param j the number of randomizers selected by the user (0 - default)
+ * @return 0 if success else -1
+ */
+static int benchmark_setup(benchmark_protocol_t *protocol, size_t k, size_t j)
+{
+    int r;
+
+    r = sys_setup(&protocol->sys_parameters);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    r = ue_get_user_identifier(NULL, &protocol->ue_identifier);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    r = ra_setup(protocol->sys_parameters, k, j, 0, &protocol->ra_parameters, &protocol->ra_keys);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    r = ra_precompute(&protocol->ra_parameters);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    r = ra_mac(protocol->sys_parameters, protocol->ra_keys.private_key, NULL, protocol->ue_identifier, &protocol->ra_signature);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    protocol->ue_attributes.num_attributes = USER_MAX_NUM_ATTRIBUTES;
+    r = ue_get_user_attributes_identifier(NULL, &protocol->ue_attributes, &protocol->ue_identifier, &protocol->ra_signature);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    protocol->ie_parameters.num_attributes = protocol->ue_attributes.num_attributes;
+    r = ie_setup(protocol->ie_parameters, &protocol->ie_keys);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    r = ie_precompute(protocol->sys_parameters, protocol->ra_keys.public_key, &protocol->ie_parameters);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    r = ie_issue(protocol->sys_parameters, protocol->ie_parameters, protocol->ie_keys, protocol->ue_identifier, protocol->ue_attributes,
+                 protocol->ra_keys.public_key, protocol->ra_signature, &protocol->ie_signature);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    r = ve_setup(protocol->sys_parameters, protocol->ra_keys.public_key, &protocol->ve_parameters);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    r = ve_generate_nonce_epoch(protocol->nonce, sizeof(protocol->nonce), protocol->epoch, sizeof(protocol->epoch));
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    r = ue_compute_proof_of_knowledge(NULL, protocol->sys_parameters, protocol->ra_parameters, protocol->ra_signature, protocol->ie_signature, protocol->ra_indices,
+                                      protocol->nonce, sizeof(protocol->nonce), protocol->epoch, sizeof(protocol->epoch), &protocol->ue_attributes, 0,
+                                      &protocol->ue_credential, &protocol->ue_pi);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    return ve_verify_proof_of_knowledge(protocol->sys_parameters, protocol->ve_parameters, protocol->ra_parameters, protocol->ra_keys.public_key,
+                                        protocol->ie_keys, protocol->nonce, sizeof(protocol->nonce), protocol->epoch, sizeof(protocol->epoch),
+                                        protocol->ue_attributes, protocol->ue_credential, protocol->ue_pi);
+}
+
+/**
+ * Releases the resources allocated by the benchmark setup.
+ *
+ * @param protocol the protocol data
+ */
+static void benchmark_cleanup(benchmark_protocol_t *protocol)
+{
+    ve_cleanup(&protocol->ve_parameters);
+    ie_cleanup(&protocol->ie_parameters);
+    ra_cleanup(&protocol->ra_parameters);
+    sys_cleanup(&protocol->sys_parameters);
+}
+
+/**
+ * Runs the controllers that multiply by the fixed bases (G1, h1...hj)
+ * with and without the fixed-base tables.
+ *
+ * @param protocol the protocol data
+ * @param iterations the number of iterations
+ * @return 0 if success else -1
+ */
+static int benchmark_fixed_base(const benchmark_protocol_t *protocol, size_t iterations)
+{
+    system_par_t sys_parameters[2];
+    revocation_authority_par_t ra_parameters[2];
+
+    revocation_authority_par_t ra_parameters_tmp;
+    revocation_authority_keys_t ra_keys_tmp;
+    revocation_authority_signature_t ra_signature_tmp;
+    issuer_signature_t ie_signature_tmp;
+    user_attributes_t ue_attributes_tmp;
+    user_credential_t ue_credential_tmp;
+    user_pi_t ue_pi_tmp;
+
+    mclBnG1 point;
+    mclBnFr scalar;
+
+    double elapsed_time[2];
+    double start_time;
+
+    size_t it, mode;
+    int r;
+
+    fprintf(stdout, "[+] fixed-base tables (mclBnG1_mul / fixed-base)\n");
+
+    // mode 0 - without tables, mode 1 - with tables
+    memcpy(&sys_parameters[0], &protocol->sys_parameters, sizeof(system_par_t));
+    memcpy(&sys_parameters[1], &protocol->sys_parameters, sizeof(system_par_t));
+    sys_parameters[0].G1_table = NULL;
+
+    memcpy(&ra_parameters[0], &protocol->ra_parameters, sizeof(revocation_authority_par_t));
+    memcpy(&ra_parameters[1], &protocol->ra_parameters, sizeof(revocation_authority_par_t));
+    memset(ra_parameters[0].alphas_mul_tables, 0, sizeof(ra_parameters[0].alphas_mul_tables));
+
+    /// G1 multiplication
+    for (mode = 0; mode < 2; mode++)
+    {
+        start_time = benchmark_get_time();
+        for (it = 0; it < iterations; it++)
+        {
+            mclBnFr_setByCSPRNG(&scalar);
+            fixed_base_mul(&point, &sys_parameters[mode].G1, sys_parameters[mode].G1_table, &scalar);
+        }
+        elapsed_time[mode] = benchmark_get_time() - start_time;
+    }
+    benchmark_display("G1 multiplication", elapsed_time[0], elapsed_time[1], iterations);
+
+    /// revocation authority - setup
+    for (mode = 0; mode < 2; mode++)
+    {
+        start_time = benchmark_get_time();
+        for (it = 0; it < iterations; it++)
+        {
+            r = ra_setup(sys_parameters[mode], 0, 0, 0, &ra_parameters_tmp, &ra_keys_tmp);
+            if (r < 0)
+            {
+                return -1;
+            }
+            ra_cleanup(&ra_parameters_tmp);
+        }
+        elapsed_time[mode] = benchmark_get_time() - start_time;
+    }
+    benchmark_display("ra_setup", elapsed_time[0], elapsed_time[1], iterations);
+
+    /// revocation authority - mac
+    for (mode = 0; mode < 2; mode++)
+    {
+        start_time = benchmark_get_time();
+        for (it = 0; it < iterations; it++)
+        {
+            r = ra_mac(sys_parameters[mode], protocol->ra_keys.private_key, NULL, protocol->ue_identifier, &ra_signature_tmp);
+            if (r < 0)
+            {
+                return -1;
+            }
+        }
+        elapsed_time[mode] = benchmark_get_time() - start_time;
+    }
+    benchmark_display("ra_mac", elapsed_time[0], elapsed_time[1], iterations);
+
+    /// issuer - issue
+    for (mode = 0; mode < 2; mode++)
+    {
+        start_time = benchmark_get_time();
+        for (it = 0; it < iterations; it++)
+        {
+            r = ie_issue(sys_parameters[mode], protocol->ie_parameters, protocol->ie_keys, protocol->ue_identifier, protocol->ue_attributes,
+                         protocol->ra_keys.public_key, protocol->ra_signature, &ie_signature_tmp);
+            if (r < 0)
+            {
+                return -1;
+            }
+        }
+        elapsed_time[mode] = benchmark_get_time() - start_time;
+    }
+    benchmark_display("ie_issue", elapsed_time[0], elapsed_time[1], iterations);
+
+    /// user - compute proof of knowledge
+    for (mode = 0; mode < 2; mode++)
+    {
+        start_time = benchmark_get_time();
+        for (it = 0; it < iterations; it++)
+        {
+            memcpy(&ue_attributes_tmp, &protocol->ue_attributes, sizeof(user_attributes_t));
+            r = ue_compute_proof_of_knowledge(NULL, sys_parameters[mode], ra_parameters[mode], protocol->ra_signature, protocol->ie_signature, protocol->ra_indices,
+                                              protocol->nonce, sizeof(protocol->nonce), protocol->epoch, sizeof(protocol->epoch), &ue_attributes_tmp, 0,
+                                              &ue_credential_tmp, &ue_pi_tmp);
+            if (r < 0)
+            {
+                return -1;
+            }
+        }
+        elapsed_time[mode] = benchmark_get_time() - start_time;
+    }
+    benchmark_display("ue_compute_proof_of_knowledge", elapsed_time[0], elapsed_time[1], iterations);
+
+    /// verifier - verify proof of knowledge
+    for (mode = 0; mode < 2; mode++)
+    {
+        start_time = benchmark_get_time();
+        for (it = 0; it < iterations; it++)
+        {
+            r = ve_verify_proof_of_knowledge(sys_parameters[mode], protocol->ve_parameters, ra_parameters[mode], protocol->ra_keys.public_key,
+                                             protocol->ie_keys, protocol->nonce, sizeof(protocol->nonce), protocol->epoch, sizeof(protocol->epoch),
+                                             protocol->ue_attributes, protocol->ue_credential, protocol->ue_pi);
+            if (r < 0)
+            {
+                return -1;
+            }
+        }
+        elapsed_time[mode] = benchmark_get_time() - start_time;
+    }
+    benchmark_display("ve_verify_proof_of_knowledge", elapsed_time[0], elapsed_time[1], iterations);
+
+    return 0;
+}
+
+/**
+ * Converts an array of bytes into the mclBnFr type using the hexadecimal
+ * string representation (reference implementation).
+ *
+ * @param x mclBnFr data
+ * @param buffer the buffer to be converted
+ * @param buffer_length the length of the buffer
+ * @return 0 if success else -1
+ */
+static int benchmark_reference_bytes_to_Fr(mclBnFr *x, const void *buffer, size_t buffer_length)
+{
+    char data[65] = {0};
+
+    if (x == NULL || buffer == NULL || buffer_length != sizeof(mclBnFr))
+    {
+        return -1;
+    }
+
+    mem2hex(data, buffer, sizeof(mclBnFr));
+
+    return mclBnFr_setStr(x, (const char *) data, strlen(data), 16) < 0 ? -1 : 0;
+}
+
+/**
+ * Converts the mclBnFr type into an array of bytes using the hexadecimal
+ * string representation (reference implementation).
+ *
+ * @param buffer the buffer where the conversion will be stored
+ * @param buffer_length the length of the buffer
+ * @param x mclBnFr data
+ * @return 0 if success else -1
+ */
+static int benchmark_reference_Fr_to_bytes(void *buffer, size_t buffer_length, mclBnFr x)
+{
+    char fr_value[65] = {0};
+    char data[65] = {0};
+
+    size_t data_length;
+
+    if (buffer == NULL || buffer_length != sizeof(mclBnFr))
+    {
+        return -1;
+    }
+
+    if (mclBnFr_getStr(data, sizeof(data), &x, 16) == 0)
+    {
+        return -1;
+    }
+
+    // left-padded with zeros to 64 digits (copied, the digits always fit)
+    data_length = strnlen(data, 64);
+    memset(fr_value, '0', 64 - data_length);
+    memcpy(&fr_value[64 - data_length], data, data_length);
+
+    hex2mem(buffer, (const char *) fr_value, sizeof(elliptic_curve_fr_t));
+
+    return 0;
+}
+
+/**
+ * Converts an array of bytes (multos point) into the mclBnG1 type using the
+ * hexadecimal string representation (reference implementation).
+ *
+ * @param x mclBnG1 data
+ * @param buffer the buffer to be converted
+ * @param buffer_length the length of the buffer
+ * @return 0 if success else -1
+ */
+static int benchmark_reference_bytes_to_G1(mclBnG1 *x, const void *buffer, size_t buffer_length)
+{
+    char x_coordinate[65] = {0};
+    char y_coordinate[65] = {0};
+
+    char data[192] = {0};
+    size_t data_length;
+
+    if (x == NULL || buffer == NULL || buffer_length != sizeof(elliptic_curve_point_t))
+    {
+        return -1;
+    }
+
+    mem2hex(x_coordinate, (unsigned char *) &((elliptic_curve_point_t *) buffer)->x, sizeof(elliptic_curve_fp_t));
+    mem2hex(y_coordinate, (unsigned char *) &((elliptic_curve_point_t *) buffer)->y, sizeof(elliptic_curve_fp_t));
+
+    data_length = snprintf(data, 192, "1 %s %s", x_coordinate, y_coordinate);
+
+    return mclBnG1_setStr(x, (const char *) data, data_length, 16) < 0 ? -1 : 0;
+}
+
+/**
+ * Converts the mclBnG1 type into an array of bytes (multos point) using the
+ * hexadecimal string representation (reference implementation).
+ *
+ * @param buffer the buffer where the conversion will be stored
+ * @param buffer_length the length of the buffer
+ * @param x mclBnG1 data
+ * @return 0 if success else -1
+ */
+static int benchmark_reference_G1_to_bytes(void *buffer, size_t buffer_length, mclBnG1 x)
+{
+    char coordinates[2][65];
+    char data[192] = {0};
+
+    char *token;
+    size_t token_length;
+    size_t it;
+
+    if (buffer == NULL || buffer_length != sizeof(elliptic_curve_point_t))
+    {
+        return -1;
+    }
+
+    if (mclBnG1_getStr(data, sizeof(data), &x, 16) == 0)
+    {
+        return -1;
+    }
+
+    // 1 (affine coordinate)
+    token = strtok(data, " ");
+    for (it = 0; it < 2; it++)
+    {
+        token = strtok(NULL, " ");
+        if (token == NULL)
+        {
+            return -1;
+        }
+
+        // left-padded with zeros to 64 digits
+        token_length = strnlen(token, 64);
+        memset(coordinates[it], '0', 64 - token_length);
+        memcpy(&coordinates[it][64 - token_length], token, token_length);
+        coordinates[it][64] = '\0';
+    }
+
+    ((elliptic_curve_point_t *) buffer)->form = 0x04;
+    hex2mem((unsigned char *) &((elliptic_curve_point_t *) buffer)->x, (const char *) coordinates[0], sizeof(elliptic_curve_fp_t));
+    hex2mem((unsigned char *) &((elliptic_curve_point_t *) buffer)->y, (const char *) coordinates[1], sizeof(elliptic_curve_fp_t));
+
+    return 0;
+}
+
+/**
+ * Signs the randomizers of the revocation authority one by one (one division
+ * each) and by ra_setup (batch inversion, several threads), and runs the
+ * protocol with the maximum number of randomizers selected by the user.
+ *
+ * @param protocol the protocol data
+ * @param iterations the number of iterations
+ * @return 0 if success else -1
+ */
+static int benchmark_randomizers(const benchmark_protocol_t *protocol, size_t iterations)
+{
+    benchmark_protocol_t *protocols[2];
+    benchmark_protocol_t *protocol_max_j;
+
+    revocation_authority_par_t ra_parameters;
+    revocation_authority_keys_t ra_keys;
+
+    mclBnFr number_one, add_result, div_result;
+    mclBnG1 sigma;
+
+    user_attributes_t ue_attributes;
+    user_credential_t ue_credential;
+    user_pi_t ue_pi;
+
+    double elapsed_time[2];
+    double start_time;
+
+    size_t it, mode;
+    int r;
+
+    fprintf(stdout, "[+] randomizers (k = %d, one by one / batch inversion)\n", BENCHMARK_NUM_RANDOMIZERS);
+
+    /// batch
+    start_time = benchmark_get_time();
+    r = ra_setup(protocol->sys_parameters, BENCHMARK_NUM_RANDOMIZERS, 0, 0, &ra_parameters, &ra_keys);
+    if (r < 0)
+    {
+        return -1;
+    }
+    elapsed_time[1] = benchmark_get_time() - start_time;
+
+    /// one by one (same randomizers): sigma = (1 / (e + sk)) * G1
+    mclBnFr_setInt32(&number_one, 1);
+    start_time = benchmark_get_time();
+    for (it = 0; it < ra_parameters.k; it++)
+    {
+        mclBnFr_add(&add_result, &ra_parameters.randomizers[it], &ra_keys.private_key.sk);
+        mclBnFr_div(&div_result, &number_one, &add_result);
+        fixed_base_mul(&sigma, &protocol->sys_parameters.G1, protocol->sys_parameters.G1_table, &div_result);
+        mclBnG1_normalize(&sigma, &sigma);
+
+        // both signatures must be the same
+        if (mclBnG1_isEqual(&sigma, &ra_parameters.randomizers_sigma[it]) != 1)
+        {
+            fprintf(stderr, "Error: the signature of a randomizer is not valid!\n");
+            ra_cleanup(&ra_parameters);
+            return -1;
+        }
+    }
+    elapsed_time[0] = benchmark_get_time() - start_time;
+    ra_cleanup(&ra_parameters);
+
+    benchmark_display("ra_setup", elapsed_time[0], elapsed_time[1], 1);
+
+    /// protocol with j = REVOCATION_AUTHORITY_MAX_J (a different randomizer each)
+    protocol_max_j = malloc(sizeof(benchmark_protocol_t));
+    if (protocol_max_j == NULL)
+    {
+        return -1;
+    }
+    memset(protocol_max_j, 0, sizeof(benchmark_protocol_t));
+    for (it = 0; it < REVOCATION_AUTHORITY_MAX_J; it++)
+    {
+        protocol_max_j->ra_indices[it] = it;
+    }
+
+    r = benchmark_setup(protocol_max_j, BENCHMARK_NUM_RANDOMIZERS, REVOCATION_AUTHORITY_MAX_J);
+    if (r < 0)
+    {
+        fprintf(stderr, "Error: the proof of knowledge with %d randomizers is not valid!\n", REVOCATION_AUTHORITY_MAX_J);
+        goto cleanup;
+    }
+
+    protocols[0] = (benchmark_protocol_t *) protocol;
+    protocols[1] = protocol_max_j;
+
+    /// user - compute proof of knowledge
+    for (mode = 0; mode < 2; mode++)
+    {
+        start_time = benchmark_get_time();
+        for (it = 0; it < iterations; it++)
+        {
+            memcpy(&ue_attributes, &protocols[mode]->ue_attributes, sizeof(user_attributes_t));
+            r = ue_compute_proof_of_knowledge(NULL, protocols[mode]->sys_parameters, protocols[mode]->ra_parameters, protocols[mode]->ra_signature,
+                                              protocols[mode]->ie_signature, protocols[mode]->ra_indices, protocols[mode]->nonce, sizeof(protocols[mode]->nonce),
+                                              protocols[mode]->epoch, sizeof(protocols[mode]->epoch), &ue_attributes, 0, &ue_credential, &ue_pi);
+            if (r < 0)
+            {
+                goto cleanup;
+            }
+        }
+        elapsed_time[mode] = benchmark_get_time() - start_time;
+    }
+    fprintf(stdout, "[!] j = %d / j = %d\n", REVOCATION_AUTHORITY_VALUE_J, REVOCATION_AUTHORITY_MAX_J);
+    benchmark_display("ue_compute_proof_of_knowledge", elapsed_time[0], elapsed_time[1], iterations);
+
+    /// verifier - verify proof of knowledge
+    for (mode = 0; mode < 2; mode++)
+    {
+        start_time = benchmark_get_time();
+        for (it = 0; it < iterations; it++)
+        {
+            r = ve_verify_proof_of_knowledge(protocols[mode]->sys_parameters, protocols[mode]->ve_parameters, protocols[mode]->ra_parameters,
+                                             protocols[mode]->ra_keys.public_key, protocols[mode]->ie_keys, protocols[mode]->nonce, sizeof(protocols[mode]->nonce),
+                                             protocols[mode]->epoch, sizeof(protocols[mode]->epoch), protocols[mode]->ue_attributes,
+                                             protocols[mode]->ue_credential, protocols[mode]->ue_pi);
+            if (r < 0)
+            {
+                goto cleanup;
+            }
+        }
+        elapsed_time[mode] = benchmark_get_time() - start_time;
+    }
+    benchmark_display("ve_verify_proof_of_knowledge", elapsed_time[0], elapsed_time[1], iterations);
+
+    /// the credential of a protocol is not valid for the other one
+    r = ve_verify_proof_of_knowledge(protocol->sys_parameters, protocol->ve_parameters, protocol->ra_parameters, protocol->ra_keys.public_key,
+                                     protocol->ie_keys, protocol->nonce, sizeof(protocol->nonce), protocol->epoch, sizeof(protocol->epoch),
+                                     protocol_max_j->ue_attributes, protocol_max_j->ue_credential, protocol_max_j->ue_pi);
+    if (r == 0)
+    {
+        fprintf(stderr, "Error: a proof of knowledge with %d randomizers has been accepted!\n", REVOCATION_AUTHORITY_MAX_J);
+        r = -1;
+        goto cleanup;
+    }
+    r = 0;
+
+cleanup:
+    benchmark_cleanup(protocol_max_j);
+    free(protocol_max_j);
+
+    return r;
+}
+
+/**
+ * Verifies the MAC of the revocation authority as the issuer did before the
+ * cached e(G1, G2): three pairings and one exponentiation in GT.
+ *
+ * @param sys_parameters the system parameters
+ * @param parameters the issuer parameters
+ * @param ue_identifier the user identifier
+ * @param revocation_authority_public_key the revocation authority public key
+ * @param revocation_authority_signature the revocation authority signature (mr, ra_sigma)
+ * @return 0 if success else -1
+ */
+static int benchmark_reference_ie_verify_mac(system_par_t sys_parameters, issuer_par_t parameters, user_identifier_t ue_identifier,
+                                             revocation_authority_public_key_t revocation_authority_public_key, revocation_authority_signature_t revocation_authority_signature)
+{
+    mclBnGT el, er;
+    mclBnGT e1, e2, e3;
+
+    unsigned char fr_data[EC_SIZE];
+    mclBnFr fr_hash;
+
+    unsigned char hash[SHA_DIGEST_PADDING + SHA_DIGEST_LENGTH] = {0};
+    SHA_CTX ctx;
+
+    // H(mr || id)
+    mcl_Fr_to_bytes(fr_data, EC_SIZE, revocation_authority_signature.mr);
+    SHA1_Init(&ctx);
+    SHA1_Update(&ctx, fr_data, EC_SIZE);
+    SHA1_Update(&ctx, ue_identifier.buffer, ue_identifier.buffer_length);
+    SHA1_Final(&hash[SHA_DIGEST_PADDING], &ctx);
+    mcl_bytes_to_Fr(&fr_hash, hash, EC_SIZE);
+
+    // e(ra_sigma, ra_pk) * e(ra_sigma, G2)^hash
+    mcl_pairing(&e1, &revocation_authority_signature.sigma, &revocation_authority_public_key.pk, parameters.pk_precomputed);
+    mcl_pairing(&e2, &revocation_authority_signature.sigma, &sys_parameters.G2, parameters.G2_precomputed);
+    mclBnGT_pow(&e3, &e2, &fr_hash);
+    mclBnGT_mul(&el, &e1, &e3);
+
+    // e(G1, G2)
+    mcl_pairing(&er, &sys_parameters.G1, &sys_parameters.G2, parameters.G2_precomputed);
+
+    return mclBnGT_isEqual(&el, &er) == 1 ? 0 : -1;
+}
+
+/**
+ * Verifies the MAC of the revocation authority with the reference check (three
+ * pairings), with the cached e(G1, G2) and one precomputed Miller loop, and with
+ * the G2 aggregation (issuer not precomputed). All of them must accept the MAC
+ * of the protocol and reject a forged one.
+ *
+ * @param protocol the protocol data
+ * @param iterations the number of iterations
+ * @return 0 if success else -1
+ */
+static int benchmark_issuer_mac(const benchmark_protocol_t *protocol, size_t iterations)
+{
+    issuer_par_t ie_parameters[2]; // precomputed, not precomputed
+    revocation_authority_signature_t ra_signature;
+
+    double elapsed_time[2];
+    double start_time;
+
+    size_t it, mode;
+    int r;
+
+    fprintf(stdout, "[+] issuer MAC check (three pairings / cached e(G1, G2))\n");
+
+    memcpy(&ie_parameters[0], &protocol->ie_parameters, sizeof(issuer_par_t));
+    memcpy(&ie_parameters[1], &protocol->ie_parameters, sizeof(issuer_par_t));
+    ie_parameters[1].G2_precomputed = NULL;
+    ie_parameters[1].pk_precomputed = NULL;
+
+    /// valid and forged MACs
+    memcpy(&ra_signature, &protocol->ra_signature, sizeof(revocation_authority_signature_t));
+    mclBnG1_add(&ra_signature.sigma, &ra_signature.sigma, &protocol->sys_parameters.G1);
+
+    for (mode = 0; mode < 2; mode++)
+    {
+        r = benchmark_reference_ie_verify_mac(protocol->sys_parameters, ie_parameters[mode], protocol->ue_identifier, protocol->ra_keys.public_key, protocol->ra_signature);
+        r |= ie_verify_mac(protocol->sys_parameters, ie_parameters[mode], protocol->ue_identifier, protocol->ra_keys.public_key, protocol->ra_signature);
+        if (r != 0)
+        {
+            fprintf(stderr, "Error: a valid MAC has been rejected!\n");
+            return -1;
+        }
+
+        r = benchmark_reference_ie_verify_mac(protocol->sys_parameters, ie_parameters[mode], protocol->ue_identifier, protocol->ra_keys.public_key, ra_signature);
+        if (r == 0 || ie_verify_mac(protocol->sys_parameters, ie_parameters[mode], protocol->ue_identifier, protocol->ra_keys.public_key, ra_signature) == 0)
+        {
+            fprintf(stderr, "Error: a forged MAC has been accepted!\n");
+            return -1;
+        }
+    }
+
+    /// reference (precomputed line coefficients, e(G1, G2) computed every time)
+    start_time = benchmark_get_time();
+    for (it = 0; it < iterations; it++)
+    {
+        r = benchmark_reference_ie_verify_mac(protocol->sys_parameters, ie_parameters[0], protocol->ue_identifier, protocol->ra_keys.public_key, protocol->ra_signature);
+        if (r < 0)
+        {
+            return -1;
+        }
+    }
+    elapsed_time[0] = benchmark_get_time() - start_time;
+
+    for (mode = 0; mode < 2; mode++)
+    {
+        start_time = benchmark_get_time();
+        for (it = 0; it < iterations; it++)
+        {
+            r = ie_verify_mac(protocol->sys_parameters, ie_parameters[mode], protocol->ue_identifier, protocol->ra_keys.public_key, protocol->ra_signature);
+            if (r < 0)
+            {
+                return -1;
+            }
+        }
+        elapsed_time[1] = benchmark_get_time() - start_time;
+
+        benchmark_display(mode == 0 ? "ie_verify_mac" : "ie_verify_mac (G2 aggregation)", elapsed_time[0], elapsed_time[1], iterations);
+    }
+
+    return 0;
+}
+
+/**
+ * Issues a batch of credentials one by one (ie_issue) and at once
+ * (ie_issue_batch, streamed to a temporary file), checks that the streamed
+ * signatures are the same and that a forged MAC is the only one rejected.
+ *
+ * @param protocol the protocol data
+ * @return 0 if success else -1
+ */
+static int benchmark_issuance(const benchmark_protocol_t *protocol)
+{
+    user_identifier_t *ue_identifiers = NULL;
+    user_attributes_t *ue_attributes = NULL;
+    revocation_authority_signature_t *ra_signatures = NULL;
+    issuer_signature_t *ie_signatures = NULL;
+    issuer_signature_t ie_signature;
+    int *results = NULL;
+
+    FILE *output = NULL;
+
+    double elapsed_time[2];
+    double start_time;
+
+    size_t num_signatures, index;
+    size_t it, jt;
+    int r;
+
+    fprintf(stdout, "[+] issuance (%d credentials, one by one / batch)\n", BENCHMARK_NUM_CREDENTIALS);
+
+    ue_identifiers = malloc(BENCHMARK_NUM_CREDENTIALS * sizeof(user_identifier_t));
+    ue_attributes = malloc(BENCHMARK_NUM_CREDENTIALS * sizeof(user_attributes_t));
+    ra_signatures = malloc(BENCHMARK_NUM_CREDENTIALS * sizeof(revocation_authority_signature_t));
+    ie_signatures = malloc(BENCHMARK_NUM_CREDENTIALS * sizeof(issuer_signature_t));
+    results = malloc(BENCHMARK_NUM_CREDENTIALS * sizeof(int));
+    output = tmpfile();
+    if (ue_identifiers == NULL || ue_attributes == NULL || ra_signatures == NULL || ie_signatures == NULL || results == NULL || output == NULL)
+    {
+        r = -1;
+        goto cleanup;
+    }
+
+    /// users (random identifiers, the attributes of the protocol)
+    for (it = 0; it < BENCHMARK_NUM_CREDENTIALS; it++)
+    {
+        ue_identifiers[it].buffer_length = USER_MAX_ID_LENGTH;
+        r = RAND_bytes(ue_identifiers[it].buffer, USER_MAX_ID_LENGTH);
+        if (r != 1)
+        {
+            r = -1;
+            goto cleanup;
+        }
+
+        r = ra_mac(protocol->sys_parameters, protocol->ra_keys.private_key, NULL, ue_identifiers[it], &ra_signatures[it]);
+        if (r < 0)
+        {
+            goto cleanup;
+        }
+
+        memcpy(&ue_attributes[it], &protocol->ue_attributes, sizeof(user_attributes_t));
+    }
+
+    /// one by one
+    start_time = benchmark_get_time();
+    for (it = 0; it < BENCHMARK_NUM_CREDENTIALS; it++)
+    {
+        r = ie_issue(protocol->sys_parameters, protocol->ie_parameters, protocol->ie_keys, ue_identifiers[it], ue_attributes[it], protocol->ra_keys.public_key,
+                     ra_signatures[it], &ie_signatures[it]);
+        if (r < 0)
+        {
+            goto cleanup;
+        }
+    }
+    elapsed_time[0] = benchmark_get_time() - start_time;
+
+    /// batch
+    start_time = benchmark_get_time();
+    r = ie_issue_batch(protocol->sys_parameters, protocol->ie_parameters, protocol->ie_keys, ue_identifiers, ue_attributes, protocol->ra_keys.public_key,
+                       ra_signatures, BENCHMARK_NUM_CREDENTIALS, 0, output, NULL, results);
+    if (r < 0)
+    {
+        fprintf(stderr, "Error: the batch issuance has rejected a valid credential!\n");
+        goto cleanup;
+    }
+    elapsed_time[1] = benchmark_get_time() - start_time;
+
+    benchmark_display("ie_issue", elapsed_time[0], elapsed_time[1], BENCHMARK_NUM_CREDENTIALS);
+
+    /// the streamed signatures must be the same
+    rewind(output);
+    num_signatures = 0;
+    while (ie_read_signature(output, protocol->ie_parameters.num_attributes, &index, &ie_signature) == 0)
+    {
+        r = index < BENCHMARK_NUM_CREDENTIALS && mclBnG1_isEqual(&ie_signature.sigma, &ie_signatures[index].sigma) == 1
+            && mclBnG1_isEqual(&ie_signature.revocation_sigma, &ie_signatures[index].revocation_sigma) == 1 ? 0 : -1;
+        for (jt = 0; jt < protocol->ie_parameters.num_attributes && r == 0; jt++)
+        {
+            r = mclBnG1_isEqual(&ie_signature.attribute_sigmas[jt], &ie_signatures[index].attribute_sigmas[jt]) == 1 ? 0 : -1;
+        }
+        if (r < 0)
+        {
+            fprintf(stderr, "Error: the batch issuance has computed a different signature!\n");
+            goto cleanup;
+        }
+
+        num_signatures++;
+    }
+    if (num_signatures != BENCHMARK_NUM_CREDENTIALS)
+    {
+        fprintf(stderr, "Error: the batch issuance has written %lu of %d signatures!\n", (unsigned long) num_signatures, BENCHMARK_NUM_CREDENTIALS);
+        r = -1;
+        goto cleanup;
+    }
+
+    /// a forged MAC must be the only one rejected
+    index = BENCHMARK_NUM_CREDENTIALS / 3;
+    mclBnG1_add(&ra_signatures[index].sigma, &ra_signatures[index].sigma, &protocol->sys_parameters.G1);
+
+    r = ie_issue_batch(protocol->sys_parameters, protocol->ie_parameters, protocol->ie_keys, ue_identifiers, ue_attributes, protocol->ra_keys.public_key,
+                       ra_signatures, BENCHMARK_NUM_CREDENTIALS, 0, NULL, ie_signatures, results);
+    for (it = 0; it < BENCHMARK_NUM_CREDENTIALS && r < 0; it++)
+    {
+        if (results[it] != (it == index ? -1 : 0))
+        {
+            break;
+        }
+    }
+    if (r == 0 || it != BENCHMARK_NUM_CREDENTIALS)
+    {
+        fprintf(stderr, "Error: the batch issuance has not rejected the forged MAC only!\n");
+        r = -1;
+        goto cleanup;
+    }
+    r = 0;
+
+cleanup:
+    free(ue_identifiers);
+    free(ue_attributes);
+    free(ra_signatures);
+    free(ie_signatures);
+    free(results);
+    if (output != NULL)
+    {
+        fclose(output);
+    }
+
+    return r;
+}
+
+/**
+ * Compares the cold start (sys_setup, ra_setup with BENCHMARK_NUM_RANDOMIZERS
+ * randomizers, ra_precompute and ie_setup) with the load of the same parameters
+ * from the keystore. The loaded parameters must be the stored ones and a
+ * corrupted keystore must be rejected.
+ *
+ * @param protocol the protocol data
+ * @param iterations the number of iterations
+ * @return 0 if success else -1
+ */
+static int benchmark_keystore(const benchmark_protocol_t *protocol, size_t iterations)
+{
+    system_par_t sys_parameters[2]; // setup, keystore
+    revocation_authority_par_t ra_parameters[2];
+    revocation_authority_keys_t ra_keys[2];
+    issuer_par_t ie_parameters[2];
+    issuer_keys_t ie_keys[2];
+
+    keystore_t keystore;
+    int keystore_loaded = 0;
+
+    char directory[] = "/tmp/rkvac-XXXXXX";
+    char path[FILENAME_MAX];
+    FILE *file;
+    int byte;
+
+    mclBnFr scalar;
+    mclBnG1 points[2];
+
+    double elapsed_time[2];
+    double start_time;
+
+    size_t it;
+    int r;
+
+    fprintf(stdout, "[+] keystore (k = %d, setup / load)\n", BENCHMARK_NUM_RANDOMIZERS);
+
+    memset(sys_parameters, 0, sizeof(sys_parameters));
+    memset(ra_parameters, 0, sizeof(ra_parameters));
+    memset(ie_parameters, 0, sizeof(ie_parameters));
+
+    if (mkdtemp(directory) == NULL)
+    {
+        return -1;
+    }
+    snprintf(path, sizeof(path), "%s/keystore", directory);
+
+    /// cold start
+    start_time = benchmark_get_time();
+    r = sys_setup(&sys_parameters[0]);
+    if (r == 0)
+    {
+        r = ra_setup(sys_parameters[0], BENCHMARK_NUM_RANDOMIZERS, 0, 0, &ra_parameters[0], &ra_keys[0]);
+    }
+    if (r == 0)
+    {
+        r = ra_precompute(&ra_parameters[0]);
+    }
+    if (r == 0)
+    {
+        ie_parameters[0].num_attributes = protocol->ie_parameters.num_attributes;
+        r = ie_setup(ie_parameters[0], &ie_keys[0]);
+    }
+    elapsed_time[0] = benchmark_get_time() - start_time;
+    if (r == 0)
+    {
+        r = ks_save(path, sys_parameters[0], ra_parameters[0], ra_keys[0], ie_parameters[0], ie_keys[0]);
+    }
+    if (r < 0)
+    {
+        goto cleanup;
+    }
+
+    /// keystore
+    start_time = benchmark_get_time();
+    for (it = 0; it < iterations; it++)
+    {
+        if (keystore_loaded)
+        {
+            ks_release(&sys_parameters[1], &ra_parameters[1]);
+            ks_close(&keystore);
+            keystore_loaded = 0;
+        }
+
+        r = ks_open(&keystore, path);
+        if (r < 0)
+        {
+            goto cleanup;
+        }
+        keystore_loaded = 1;
+
+        r = ks_load(&keystore, &sys_parameters[1], &ra_parameters[1], &ra_keys[1], &ie_parameters[1], &ie_keys[1]);
+        if (r < 0)
+        {
+            goto cleanup;
+        }
+    }
+    elapsed_time[1] = (benchmark_get_time() - start_time) / (double) iterations;
+
+    benchmark_display("setup / ks_open + ks_load", elapsed_time[0], elapsed_time[1], 1);
+
+    /// the loaded parameters must be the stored ones
+    r = ra_parameters[1].k == ra_parameters[0].k && ra_parameters[1].j == ra_parameters[0].j
+        && ie_parameters[1].num_attributes == ie_parameters[0].num_attributes
+        && memcmp(ra_parameters[1].randomizers, ra_parameters[0].randomizers, ra_parameters[0].k * sizeof(mclBnFr)) == 0
+        && memcmp(ra_parameters[1].randomizers_sigma, ra_parameters[0].randomizers_sigma, ra_parameters[0].k * sizeof(mclBnG1)) == 0
+        && memcmp(ra_parameters[1].alphas_mul, ra_parameters[0].alphas_mul, sizeof(ra_parameters[0].alphas_mul)) == 0
+        && memcmp(&ra_keys[1], &ra_keys[0], sizeof(revocation_authority_keys_t)) == 0
+        && memcmp(&ie_keys[1], &ie_keys[0], sizeof(issuer_keys_t)) == 0 ? 0 : -1;
+
+    // the mapped tables and signatures are used in place: sigma_e·(e + sk) == G1
+    for (it = 0; it < ra_parameters[1].k && r == 0; it += ra_parameters[1].k / 16 + 1)
+    {
+        mclBnFr_add(&scalar, &ra_parameters[1].randomizers[it], &ra_keys[1].private_key.sk);
+        mclBnG1_mul(&points[0], &ra_parameters[1].randomizers_sigma[it], &scalar);
+        r = mclBnG1_isEqual(&points[0], &sys_parameters[1].G1) == 1 ? 0 : -1;
+
+        fixed_base_mul(&points[0], &sys_parameters[1].G1, sys_parameters[1].G1_table, &scalar);
+        mclBnG1_mul(&points[1], &sys_parameters[1].G1, &scalar);
+        r |= mclBnG1_isEqual(&points[0], &points[1]) == 1 ? 0 : -1;
+
+        fixed_base_mul(&points[0], &ra_parameters[1].alphas_mul[0], ra_parameters[1].alphas_mul_tables[0], &scalar);
+        mclBnG1_mul(&points[1], &ra_parameters[1].alphas_mul[0], &scalar);
+        r |= mclBnG1_isEqual(&points[0], &points[1]) == 1 ? 0 : -1;
+    }
+    if (r < 0)
+    {
+        fprintf(stderr, "Error: the keystore has loaded different parameters!\n");
+        goto cleanup;
+    }
+
+    ks_release(&sys_parameters[1], &ra_parameters[1]);
+    ks_close(&keystore);
+    keystore_loaded = 0;
+
+    /// a corrupted keystore must be rejected
+    file = fopen(path, "r+b");
+    if (file == NULL)
+    {
+        r = -1;
+        goto cleanup;
+    }
+    fseek(file, -1 - (long) sizeof(fixed_base_table_t), SEEK_END);
+    byte = fgetc(file);
+    fseek(file, -1 - (long) sizeof(fixed_base_table_t), SEEK_END);
+    fputc(byte ^ 0x01, file);
+    fclose(file);
+
+    r = ks_open(&keystore, path);
+    if (r == 0)
+    {
+        fprintf(stderr, "Error: a corrupted keystore has been accepted!\n");
+        ks_close(&keystore);
+        r = -1;
+        goto cleanup;
+    }
+    r = 0;
+
+cleanup:
+    if (keystore_loaded)
+    {
+        ks_release(&sys_parameters[1], &ra_parameters[1]);
+        ks_close(&keystore);
+    }
+    ra_cleanup(&ra_parameters[0]);
+    sys_cleanup(&sys_parameters[0]);
+
+    unlink(path);
+    rmdir(directory);
+
+    return r;
+}
+
+/**
+ * Compares the cold start of a verifier (sys_compute, ve_setup and the first
+ * verification) with the same start from the system parameters blob. The
+ * loaded tables must be the computed ones and a corrupted blob must be rejected.
+ *
+ * @param protocol the protocol data
+ * @param iterations the number of iterations
+ * @return 0 if success else -1
+ */
+static int benchmark_cold_start(const benchmark_protocol_t *protocol, size_t iterations)
+{
+    system_par_t sys_parameters[2]; // computed, blob
+    verifier_par_t ve_parameters;
+
+    char directory[] = "/tmp/rkvac-XXXXXX";
+    char path[FILENAME_MAX];
+    FILE *file;
+    int byte;
+
+    double elapsed_time[2];
+    double start_time;
+
+    size_t it, mode;
+    int r;
+
+    fprintf(stdout, "[+] cold start (sys_compute / blob)\n");
+
+    memset(sys_parameters, 0, sizeof(sys_parameters));
+    memset(&ve_parameters, 0, sizeof(verifier_par_t));
+
+    if (mkdtemp(directory) == NULL)
+    {
+        return -1;
+    }
+    snprintf(path, sizeof(path), "%s/parameters", directory);
+
+    r = sys_compute(&sys_parameters[0]);
+    if (r == 0)
+    {
+        r = sys_save(sys_parameters[0], path);
+    }
+    sys_cleanup(&sys_parameters[0]);
+    if (r < 0)
+    {
+        goto cleanup;
+    }
+
+    /// setup and first verification
+    for (mode = 0; mode < 2; mode++)
+    {
+        start_time = benchmark_get_time();
+        for (it = 0; it < iterations; it++)
+        {
+            sys_cleanup(&sys_parameters[mode]);
+
+            r = mode == 0 ? sys_compute(&sys_parameters[mode]) : sys_setup_from_file(&sys_parameters[mode], path);
+            if (r < 0)
+            {
+                goto cleanup;
+            }
+
+            r = ve_setup(sys_parameters[mode], protocol->ra_keys.public_key, &ve_parameters);
+            if (r < 0)
+            {
+                goto cleanup;
+            }
+
+            r = ve_verify_proof_of_knowledge(sys_parameters[mode], ve_parameters, protocol->ra_parameters, protocol->ra_keys.public_key,
+                                             protocol->ie_keys, protocol->nonce, sizeof(protocol->nonce), protocol->epoch, sizeof(protocol->epoch),
+                                             protocol->ue_attributes, protocol->ue_credential, protocol->ue_pi);
+            ve_cleanup(&ve_parameters);
+            if (r < 0)
+            {
+                goto cleanup;
+            }
+        }
+        elapsed_time[mode] = (benchmark_get_time() - start_time) / (double) iterations;
+    }
+
+    benchmark_display("sys_compute / sys_setup_from_file (+ ve_setup + verification)", elapsed_time[0], elapsed_time[1], 1);
+
+#if defined (RKVAC_PROTOCOL_EMBEDDED_PARAMETERS)
+    /// system parameters only (embedded into the executable)
+    for (mode = 0; mode < 2; mode++)
+    {
+        start_time = benchmark_get_time();
+        for (it = 0; it < iterations; it++)
+        {
+            sys_cleanup(&sys_parameters[mode]);
+
+            r = mode == 0 ? sys_compute(&sys_parameters[mode]) : sys_setup_from_blob(&sys_parameters[mode], sys_embedded_parameters, sys_embedded_parameters_length);
+            if (r < 0)
+            {
+                fprintf(stderr, "Error: the embedded system parameters have been rejected!\n");
+                goto cleanup;
+            }
+        }
+        elapsed_time[mode] = (benchmark_get_time() - start_time) / (double) iterations;
+    }
+
+    benchmark_display("sys_compute / embedded sys_setup_from_blob", elapsed_time[0], elapsed_time[1], 1);
+#endif
+
+    /// the loaded parameters must be the computed ones
+    r = mclBnG1_isEqual(&sys_parameters[1].G1, &sys_parameters[0].G1) == 1 && mclBnG2_isEqual(&sys_parameters[1].G2, &sys_parameters[0].G2) == 1
+        && memcmp(sys_parameters[1].G1_table, sys_parameters[0].G1_table, sizeof(fixed_base_table_t)) == 0
+        && memcmp(sys_parameters[1].G2_precomputed, sys_parameters[0].G2_precomputed, mclBn_getUint64NumToPrecompute() * sizeof(uint64_t)) == 0 ? 0 : -1;
+    if (r < 0)
+    {
+        fprintf(stderr, "Error: the blob has loaded different system parameters!\n");
+        goto cleanup;
+    }
+
+    /// a corrupted blob must be rejected
+    file = fopen(path, "r+b");
+    if (file == NULL)
+    {
+        r = -1;
+        goto cleanup;
+    }
+    fseek(file, -1, SEEK_END);
+    byte = fgetc(file);
+    fseek(file, -1, SEEK_END);
+    fputc(byte ^ 0x01, file);
+    fclose(file);
+
+    sys_cleanup(&sys_parameters[1]);
+    r = sys_setup_from_file(&sys_parameters[1], path);
+    if (r == 0)
+    {
+        fprintf(stderr, "Error: a corrupted blob has been accepted!\n");
+        r = -1;
+        goto cleanup;
+    }
+    r = 0;
+
+cleanup:
+    sys_cleanup(&sys_parameters[0]);
+    sys_cleanup(&sys_parameters[1]);
+
+    unlink(path);
+    rmdir(directory);
+
+    return r;
+}
+
+/**
+ * Runs the whole protocol through librkvac (rkvac.h) and compares the verification
+ * of an encoded proof through the library with the direct call of the verifier
+ * controller. The proof of a revoked user and the proof sent with another nonce
+ * must be rejected, and the library must refuse the calls once it has been released.
+ *
+ * @param protocol the protocol data
+ * @param iterations the number of iterations
+ * @return 0 if success else -1
+ */
+static int benchmark_library(const benchmark_protocol_t *protocol, size_t iterations)
+{
+    rkvac_revocation_authority_t *ra = NULL;
+    rkvac_issuer_t *ie = NULL;
+    rkvac_user_t *user = NULL;
+    rkvac_verifier_t *ve = NULL;
+
+    uint8_t *proof = NULL;
+    size_t proof_length;
+
+    uint8_t nonce[RKVAC_NONCE_LENGTH];
+    uint8_t epoch[RKVAC_EPOCH_LENGTH];
+
+    double elapsed_time[2];
+    double start_time;
+
+    size_t it;
+    int r;
+
+    fprintf(stdout, "[+] library (controllers / rkvac.h)\n");
+
+    r = rkvac_init(NULL);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    proof_length = rkvac_proof_length();
+    proof = (uint8_t *) malloc(proof_length);
+    if (proof == NULL)
+    {
+        r = -1;
+        goto cleanup;
+    }
+
+    /// protocol through the library
+    ra = rkvac_ra_create(0, 0);
+    user = rkvac_ue_create(NULL, 0, USER_MAX_NUM_ATTRIBUTES);
+    r = ra != NULL && user != NULL ? 0 : -1;
+    if (r == 0)
+    {
+        r = rkvac_ra_mac(ra, user);
+    }
+    if (r == 0)
+    {
+        ie = rkvac_ie_create(ra, USER_MAX_NUM_ATTRIBUTES);
+        r = ie != NULL ? rkvac_ie_issue(ie, user) : -1;
+    }
+    if (r == 0)
+    {
+        ve = rkvac_ve_create(ra, ie);
+        r = ve != NULL ? rkvac_ve_generate_nonce_epoch(nonce, sizeof(nonce), epoch, sizeof(epoch)) : -1;
+    }
+    if (r == 0)
+    {
+        r = rkvac_ve_set_epoch(ve, epoch, sizeof(epoch));
+    }
+    if (r == 0)
+    {
+        r = rkvac_ue_compute_proof(user, ra, nonce, sizeof(nonce), epoch, sizeof(epoch), 0, proof, proof_length);
+    }
+    if (r == 0)
+    {
+        r = rkvac_ve_verify(ve, nonce, sizeof(nonce), proof, proof_length);
+    }
+    if (r < 0)
+    {
+        fprintf(stderr, "Error: the protocol through the library has failed!\n");
+        goto cleanup;
+    }
+
+    /// verification (controller / library)
+    start_time = benchmark_get_time();
+    for (it = 0; it < iterations; it++)
+    {
+        r = ve_verify_proof_of_knowledge(protocol->sys_parameters, protocol->ve_parameters, protocol->ra_parameters, protocol->ra_keys.public_key,
+                                         protocol->ie_keys, protocol->nonce, sizeof(protocol->nonce), protocol->epoch, sizeof(protocol->epoch),
+                                         protocol->ue_attributes, protocol->ue_credential, protocol->ue_pi);
+        if (r < 0)
+        {
+            goto cleanup;
+        }
+    }
+    elapsed_time[0] = benchmark_get_time() - start_time;
+
+    start_time = benchmark_get_time();
+    for (it = 0; it < iterations; it++)
+    {
+        r = rkvac_ve_verify(ve, nonce, sizeof(nonce), proof, proof_length);
+        if (r < 0)
+        {
+            goto cleanup;
+        }
+    }
+    elapsed_time[1] = benchmark_get_time() - start_time;
+
+    benchmark_display("ve_verify_proof_of_knowledge / rkvac_ve_verify", elapsed_time[0], elapsed_time[1], iterations);
+
+    /// the proof is bound to its nonce
+    nonce[0] ^= 0x01;
+    r = rkvac_ve_verify(ve, nonce, sizeof(nonce), proof, proof_length) == 0 ? -1 : 0;
+    nonce[0] ^= 0x01;
+    if (r < 0)
+    {
+        fprintf(stderr, "Error: the library has accepted a proof of another nonce!\n");
+        goto cleanup;
+    }
+
+    /// the revoked user is rejected from the next epoch
+    r = rkvac_ra_revoke(ra, user);
+    if (r == 0)
+    {
+        r = rkvac_ve_generate_nonce_epoch(nonce, sizeof(nonce), epoch, sizeof(epoch));
+    }
+    if (r == 0)
+    {
+        r = rkvac_ve_set_epoch(ve, epoch, sizeof(epoch));
+    }
+    if (r == 0)
+    {
+        r = rkvac_ue_compute_proof(user, ra, nonce, sizeof(nonce), epoch, sizeof(epoch), 0, proof, proof_length);
+    }
+    if (r == 0 && rkvac_ve_verify(ve, nonce, sizeof(nonce), proof, proof_length) == 0)
+    {
+        fprintf(stderr, "Error: the library has accepted the proof of a revoked user!\n");
+        r = -1;
+    }
+
+cleanup:
+    rkvac_ve_destroy(ve);
+    rkvac_ie_destroy(ie);
+    rkvac_ue_destroy(user);
+    rkvac_ra_destroy(ra);
+    rkvac_teardown();
+    free(proof);
+
+    /// the released library must refuse the calls
+    if (r == 0)
+    {
+        ra = rkvac_ra_create(0, 0);
+        if (ra != NULL)
+        {
+            fprintf(stderr, "Error: the library has been used after its release!\n");
+            rkvac_ra_destroy(ra);
+            r = -1;
+        }
+    }
+
+    return r;
+}
+
+/**
+ * Checks that the binary Fr/G1 conversions give the same bytes and values as the
+ * hexadecimal string conversions (round trip) and compares their times.
+ *
+ * @param protocol the protocol data
+ * @param iterations the number of iterations
+ * @return 0 if success else -1
+ */
+static int benchmark_conversions(const benchmark_protocol_t *protocol, size_t iterations)
+{
+    mclBnFr fr_value, fr_result[2];
+    mclBnG1 g1_value, g1_result[2];
+
+    elliptic_curve_fr_t fr_bytes[2];
+    elliptic_curve_point_t g1_bytes[2];
+
+    double elapsed_time[2];
+    double start_time;
+
+    size_t it;
+    int r;
+
+    fprintf(stdout, "[+] conversions (hexadecimal string / binary)\n");
+
+    /// round trip
+    for (it = 0; it < iterations; it++)
+    {
+        mclBnFr_setByCSPRNG(&fr_value);
+        mclBnG1_mul(&g1_value, &protocol->sys_parameters.G1, &fr_value);
+
+        // Fr
+        r = benchmark_reference_Fr_to_bytes(&fr_bytes[0], sizeof(elliptic_curve_fr_t), fr_value);
+        r |= mcl_Fr_to_bytes(&fr_bytes[1], sizeof(elliptic_curve_fr_t), fr_value);
+        r |= benchmark_reference_bytes_to_Fr(&fr_result[0], &fr_bytes[1], sizeof(elliptic_curve_fr_t));
+        r |= mcl_bytes_to_Fr(&fr_result[1], &fr_bytes[0], sizeof(elliptic_curve_fr_t));
+        if (r != 0 || memcmp(&fr_bytes[0], &fr_bytes[1], sizeof(elliptic_curve_fr_t)) != 0 ||
+            mclBnFr_isEqual(&fr_result[0], &fr_value) != 1 || mclBnFr_isEqual(&fr_result[1], &fr_value) != 1)
+        {
+            fprintf(stderr, "Error: the Fr conversions differ!\n");
+            return -1;
+        }
+
+        // G1
+        r = benchmark_reference_G1_to_bytes(&g1_bytes[0], sizeof(elliptic_curve_point_t), g1_value);
+        r |= mcl_G1_to_bytes(&g1_bytes[1], sizeof(elliptic_curve_point_t), g1_value);
+        r |= benchmark_reference_bytes_to_G1(&g1_result[0], &g1_bytes[1], sizeof(elliptic_curve_point_t));
+        r |= mcl_bytes_to_G1(&g1_result[1], &g1_bytes[0], sizeof(elliptic_curve_point_t));
+        if (r != 0 || memcmp(&g1_bytes[0], &g1_bytes[1], sizeof(elliptic_curve_point_t)) != 0 ||
+            mclBnG1_isEqual(&g1_result[0], &g1_value) != 1 || mclBnG1_isEqual(&g1_result[1], &g1_value) != 1)
+        {
+            fprintf(stderr, "Error: the G1 conversions differ!\n");
+            return -1;
+        }
+    }
+
+    /// Fr to bytes
+    start_time = benchmark_get_time();
+    for (it = 0; it < iterations; it++)
+    {
+        benchmark_reference_Fr_to_bytes(&fr_bytes[0], sizeof(elliptic_curve_fr_t), fr_value);
+    }
+    elapsed_time[0] = benchmark_get_time() - start_time;
+    start_time = benchmark_get_time();
+    for (it = 0; it < iterations; it++)
+    {
+        mcl_Fr_to_bytes(&fr_bytes[1], sizeof(elliptic_curve_fr_t), fr_value);
+    }
+    elapsed_time[1] = benchmark_get_time() - start_time;
+    benchmark_display("mcl_Fr_to_bytes", elapsed_time[0], elapsed_time[1], iterations);
+
+    /// bytes to Fr
+    start_time = benchmark_get_time();
+    for (it = 0; it < iterations; it++)
+    {
+        benchmark_reference_bytes_to_Fr(&fr_result[0], &fr_bytes[0], sizeof(elliptic_curve_fr_t));
+    }
+    elapsed_time[0] = benchmark_get_time() - start_time;
+    start_time = benchmark_get_time();
+    for (it = 0; it < iterations; it++)
+    {
+        mcl_bytes_to_Fr(&fr_result[1], &fr_bytes[1], sizeof(elliptic_curve_fr_t));
+    }
+    elapsed_time[1] = benchmark_get_time() - start_time;
+    benchmark_display("mcl_bytes_to_Fr", elapsed_time[0], elapsed_time[1], iterations);
+
+    /// G1 to bytes
+    start_time = benchmark_get_time();
+    for (it = 0; it < iterations; it++)
+    {
+        benchmark_reference_G1_to_bytes(&g1_bytes[0], sizeof(elliptic_curve_point_t), g1_value);
+    }
+    elapsed_time[0] = benchmark_get_time() - start_time;
+    start_time = benchmark_get_time();
+    for (it = 0; it < iterations; it++)
+    {
+        mcl_G1_to_bytes(&g1_bytes[1], sizeof(elliptic_curve_point_t), g1_value);
+    }
+    elapsed_time[1] = benchmark_get_time() - start_time;
+    benchmark_display("mcl_G1_to_bytes", elapsed_time[0], elapsed_time[1], iterations);
+
+    /// bytes to G1
+    start_time = benchmark_get_time();
+    for (it = 0; it < iterations; it++)
+    {
+        benchmark_reference_bytes_to_G1(&g1_result[0], &g1_bytes[0], sizeof(elliptic_curve_point_t));
+    }
+    elapsed_time[0] = benchmark_get_time() - start_time;
+    start_time = benchmark_get_time();
+    for (it = 0; it < iterations; it++)
+    {
+        mcl_bytes_to_G1(&g1_result[1], &g1_bytes[1], sizeof(elliptic_curve_point_t));
+    }
+    elapsed_time[1] = benchmark_get_time() - start_time;
+    benchmark_display("mcl_bytes_to_G1", elapsed_time[0], elapsed_time[1], iterations);
+
+    return 0;
+}
+
+/**
+ * Compares the t values computed by two verification kernels.
+ *
+ * @param a the t values computed by the first kernel
+ * @param b the t values computed by the second kernel
+ * @param num_randomizers the number of t_sig values of the randomizers (j)
+ * @return 0 if the t values are equal else -1
+ */
+static int benchmark_compare_t_values(const verifier_t_values_t *a, const verifier_t_values_t *b, size_t num_randomizers)
+{
+    size_t it;
+
+    if (mclBnG1_isEqual(&a->t_verify, &b->t_verify) != 1 || mclBnG1_isEqual(&a->t_revoke, &b->t_revoke) != 1 || mclBnG1_isEqual(&a->t_sig, &b->t_sig) != 1)
+    {
+        return -1;
+    }
+
+    for (it = 0; it < num_randomizers; it++)
+    {
+        if (mclBnG1_isEqual(&a->t_sig_e[it], &b->t_sig_e[it]) != 1)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Checks that the folded and the reference verification kernels compute the same
+ * t values and the same result for all the (attributes, disclosed attributes)
+ * combinations, for valid and tampered proofs, and compares their times.
+ *
+ * @param protocol the protocol data
+ * @param iterations the number of iterations
+ * @return 0 if success else -1
+ */
+static int benchmark_verifier_kernels(const benchmark_protocol_t *protocol, size_t iterations)
+{
+    verifier_par_t ve_parameters[2];
+    verifier_t_values_t t_values[2];
+
+    issuer_par_t ie_parameters;
+    issuer_keys_t ie_keys;
+    issuer_signature_t ie_signature;
+
+    user_attributes_t ue_attributes;
+    user_credential_t ue_credential;
+    user_pi_t ue_pi;
+
+    mclBnFr one;
+
+    char name[64];
+
+    double elapsed_time[2];
+    double start_time;
+
+    size_t num_attributes, num_disclosed_attributes;
+    size_t it, kernel;
+    int results[2];
+    int r;
+
+    fprintf(stdout, "[+] verification kernels (reference / folded)\n");
+
+    // kernel 0 - reference, kernel 1 - folded
+    memcpy(&ve_parameters[0], &protocol->ve_parameters, sizeof(verifier_par_t));
+    memcpy(&ve_parameters[1], &protocol->ve_parameters, sizeof(verifier_par_t));
+    ve_parameters[0].kernel = VERIFIER_KERNEL_REFERENCE;
+    ve_parameters[1].kernel = VERIFIER_KERNEL_FOLDED;
+
+    mclBnFr_setInt32(&one, 1);
+
+    memcpy(&ie_parameters, &protocol->ie_parameters, sizeof(issuer_par_t));
+    for (num_attributes = 1; num_attributes <= USER_MAX_NUM_ATTRIBUTES; num_attributes++)
+    {
+        // issuer keys and signature for the current number of attributes
+        ie_parameters.num_attributes = num_attributes;
+        r = ie_setup(ie_parameters, &ie_keys);
+        if (r < 0)
+        {
+            return -1;
+        }
+
+        memcpy(&ue_attributes, &protocol->ue_attributes, sizeof(user_attributes_t));
+        ue_attributes.num_attributes = num_attributes;
+
+        r = ie_issue(protocol->sys_parameters, ie_parameters, ie_keys, protocol->ue_identifier, ue_attributes,
+                     protocol->ra_keys.public_key, protocol->ra_signature, &ie_signature);
+        if (r < 0)
+        {
+            return -1;
+        }
+
+        for (num_disclosed_attributes = 0; num_disclosed_attributes <= num_attributes; num_disclosed_attributes++)
+        {
+            // the user marks the disclosed attributes, start from the undisclosed ones
+            memcpy(&ue_attributes, &protocol->ue_attributes, sizeof(user_attributes_t));
+            ue_attributes.num_attributes = num_attributes;
+
+            r = ue_compute_proof_of_knowledge(NULL, protocol->sys_parameters, protocol->ra_parameters, protocol->ra_signature, ie_signature, protocol->ra_indices,
+                                              protocol->nonce, sizeof(protocol->nonce), protocol->epoch, sizeof(protocol->epoch), &ue_attributes, num_disclosed_attributes,
+                                              &ue_credential, &ue_pi);
+            if (r < 0)
+            {
+                return -1;
+            }
+
+            /// differential check (valid proof)
+            for (kernel = 0; kernel < 2; kernel++)
+            {
+                r = ve_compute_t_values(protocol->sys_parameters, ve_parameters[kernel], protocol->ra_parameters, ie_keys, protocol->epoch, sizeof(protocol->epoch),
+                                        ue_attributes, ue_credential, ue_pi, &t_values[kernel]);
+                if (r < 0)
+                {
+                    return -1;
+                }
+
+                results[kernel] = ve_verify_proof_of_knowledge(protocol->sys_parameters, ve_parameters[kernel], protocol->ra_parameters, protocol->ra_keys.public_key,
+                                                               ie_keys, protocol->nonce, sizeof(protocol->nonce), protocol->epoch, sizeof(protocol->epoch),
+                                                               ue_attributes, ue_credential, ue_pi);
+            }
+            if (benchmark_compare_t_values(&t_values[0], &t_values[1], protocol->ra_parameters.j) < 0 || results[0] != 0 || results[1] != 0)
+            {
+                fprintf(stderr, "Error: the kernels differ for a valid proof (%lu/%lu)!\n", num_attributes, num_disclosed_attributes);
+                return -1;
+            }
+
+            /// verification time
+            for (kernel = 0; kernel < 2; kernel++)
+            {
+                start_time = benchmark_get_time();
+                for (it = 0; it < iterations; it++)
+                {
+                    r = ve_verify_proof_of_knowledge(protocol->sys_parameters, ve_parameters[kernel], protocol->ra_parameters, protocol->ra_keys.public_key,
+                                                     ie_keys, protocol->nonce, sizeof(protocol->nonce), protocol->epoch, sizeof(protocol->epoch),
+                                                     ue_attributes, ue_credential, ue_pi);
+                    if (r < 0)
+                    {
+                        return -1;
+                    }
+                }
+                elapsed_time[kernel] = benchmark_get_time() - start_time;
+            }
+            sprintf(name, "ve_verify_proof_of_knowledge %lu/%lu", num_attributes, num_disclosed_attributes);
+            benchmark_display(name, elapsed_time[0], elapsed_time[1], iterations);
+
+            /// differential check (tampered proof, s_mr is used by t_verify and t_revoke)
+            mclBnFr_add(&ue_pi.s_mr, &ue_pi.s_mr, &one);
+            for (kernel = 0; kernel < 2; kernel++)
+            {
+                r = ve_compute_t_values(protocol->sys_parameters, ve_parameters[kernel], protocol->ra_parameters, ie_keys, protocol->epoch, sizeof(protocol->epoch),
+                                        ue_attributes, ue_credential, ue_pi, &t_values[kernel]);
+                if (r < 0)
+                {
+                    return -1;
+                }
+
+                results[kernel] = ve_verify_proof_of_knowledge(protocol->sys_parameters, ve_parameters[kernel], protocol->ra_parameters, protocol->ra_keys.public_key,
+                                                               ie_keys, protocol->nonce, sizeof(protocol->nonce), protocol->epoch, sizeof(protocol->epoch),
+                                                               ue_attributes, ue_credential, ue_pi);
+            }
+            if (benchmark_compare_t_values(&t_values[0], &t_values[1], protocol->ra_parameters.j) < 0 || results[0] != -1 || results[1] != -1)
+            {
+                fprintf(stderr, "Error: the kernels differ for a tampered proof (%lu/%lu)!\n", num_attributes, num_disclosed_attributes);
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Computes a proof of knowledge of the user whose randomizer carries a forged
+ * signature of the revocation authority: the challenge of the proof is valid,
+ * only the pairing equation of sigma_minus_e(randomizer) does not hold.
+ *
+ * @param protocol the protocol data
+ * @param randomizer the forged randomizer (0...j-1)
+ * @param attributes the user attributes
+ * @param credential the credential struct computed by the user
+ * @param pi the pi struct computed by the user
+ * @return 0 if success else -1
+ */
+static int benchmark_forge_randomizer(const benchmark_protocol_t *protocol, size_t randomizer, user_attributes_t *attributes,
+                                      user_credential_t *credential, user_pi_t *pi)
+{
+    revocation_authority_par_t ra_parameters;
+    size_t indices[REVOCATION_AUTHORITY_MAX_J];
+    size_t forged, it;
+    int r;
+
+    memcpy(&ra_parameters, &protocol->ra_parameters, sizeof(revocation_authority_par_t));
+    memcpy(indices, protocol->ra_indices, sizeof(indices));
+
+    // a randomizer of the authority not selected by the other slots
+    for (forged = 0; forged < ra_parameters.k; forged++)
+    {
+        for (it = 0; it < ra_parameters.j && (it == randomizer || indices[it] != forged); it++)
+        {
+        }
+        if (it == ra_parameters.j)
+        {
+            break;
+        }
+    }
+    if (forged == ra_parameters.k)
+    {
+        return -1;
+    }
+    indices[randomizer] = forged;
+
+    ra_parameters.randomizers_sigma = malloc(ra_parameters.k * sizeof(mclBnG1));
+    if (ra_parameters.randomizers_sigma == NULL)
+    {
+        return -1;
+    }
+    memcpy(ra_parameters.randomizers_sigma, protocol->ra_parameters.randomizers_sigma, ra_parameters.k * sizeof(mclBnG1));
+    mclBnG1_add(&ra_parameters.randomizers_sigma[forged], &ra_parameters.randomizers_sigma[forged], &protocol->sys_parameters.G1);
+
+    memcpy(attributes, &protocol->ue_attributes, sizeof(user_attributes_t));
+    r = ue_compute_proof_of_knowledge(NULL, protocol->sys_parameters, ra_parameters, protocol->ra_signature, protocol->ie_signature, indices,
+                                      protocol->nonce, sizeof(protocol->nonce), protocol->epoch, sizeof(protocol->epoch), attributes, 0, credential, pi);
+
+    free(ra_parameters.randomizers_sigma);
+
+    return r;
+}
+
+/**
+ * Compares the verification time of the pairing modes with the default mode, and
+ * checks that every mode rejects the credentials whose first or last randomizer
+ * is forged, and that the designated verifier rejects the proofs when the key
+ * is wrong.
+ *
+ * @param protocol the protocol data
+ * @param iterations the number of iterations
+ * @return 0 if success else -1
+ */
+static int benchmark_pairing_modes(const benchmark_protocol_t *protocol, size_t iterations)
+{
+    static const char *names[] = {"ve_verify_proof_of_knowledge (multi-pairing)", "ve_verify_proof_of_knowledge (designated)"};
+
+    verifier_par_t ve_parameters[3];
+    revocation_authority_private_key_t ra_private_key;
+
+    user_attributes_t ue_attributes;
+    user_credential_t ue_credential;
+    user_pi_t ue_pi;
+
+    double elapsed_time[3];
+    double start_time;
+
+    size_t it, mode;
+    int r;
+
+    fprintf(stdout, "[+] pairing modes (default / mode)\n");
+
+    memcpy(&ve_parameters[0], &protocol->ve_parameters, sizeof(verifier_par_t));
+    memcpy(&ve_parameters[1], &protocol->ve_parameters, sizeof(verifier_par_t));
+    memcpy(&ve_parameters[2], &protocol->ve_parameters, sizeof(verifier_par_t));
+    ve_parameters[0].pairing_mode = VERIFIER_PAIRING_MODE_DEFAULT;
+    ve_parameters[1].pairing_mode = VERIFIER_PAIRING_MODE_MULTI_PAIRING;
+    r = ve_set_designated_key(&ve_parameters[2], protocol->ra_keys.private_key);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    for (mode = 0; mode < 3; mode++)
+    {
+        start_time = benchmark_get_time();
+        for (it = 0; it < iterations; it++)
+        {
+            r = ve_verify_proof_of_knowledge(protocol->sys_parameters, ve_parameters[mode], protocol->ra_parameters, protocol->ra_keys.public_key,
+                                             protocol->ie_keys, protocol->nonce, sizeof(protocol->nonce), protocol->epoch, sizeof(protocol->epoch),
+                                             protocol->ue_attributes, protocol->ue_credential, protocol->ue_pi);
+            if (r < 0)
+            {
+                return -1;
+            }
+        }
+        elapsed_time[mode] = benchmark_get_time() - start_time;
+    }
+
+    // a forged signature of the first or the last randomizer must not verify
+    for (it = 0; it < 2; it++)
+    {
+        r = benchmark_forge_randomizer(protocol, it == 0 ? 0 : protocol->ra_parameters.j - 1, &ue_attributes, &ue_credential, &ue_pi);
+        if (r < 0)
+        {
+            return -1;
+        }
+
+        for (mode = 0; mode < 3; mode++)
+        {
+            r = ve_verify_proof_of_knowledge(protocol->sys_parameters, ve_parameters[mode], protocol->ra_parameters, protocol->ra_keys.public_key,
+                                             protocol->ie_keys, protocol->nonce, sizeof(protocol->nonce), protocol->epoch, sizeof(protocol->epoch),
+                                             ue_attributes, ue_credential, ue_pi);
+            if (r == 0)
+            {
+                fprintf(stderr, "Error: the pairing mode %lu accepts a forged randomizer %lu!\n", (unsigned long) mode,
+                        (unsigned long) (it == 0 ? 0 : protocol->ra_parameters.j - 1));
+                return -1;
+            }
+        }
+    }
+
+    // a key different from the revocation authority key must not verify
+    mclBnFr_setByCSPRNG(&ra_private_key.sk);
+    r = ve_set_designated_key(&ve_parameters[2], ra_private_key);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    r = ve_verify_proof_of_knowledge(protocol->sys_parameters, ve_parameters[2], protocol->ra_parameters, protocol->ra_keys.public_key,
+                                     protocol->ie_keys, protocol->nonce, sizeof(protocol->nonce), protocol->epoch, sizeof(protocol->epoch),
+                                     protocol->ue_attributes, protocol->ue_credential, protocol->ue_pi);
+    if (r == 0)
+    {
+        fprintf(stderr, "Error: the designated verifier accepts a wrong key!\n");
+        return -1;
+    }
+
+    for (mode = 1; mode < 3; mode++)
+    {
+        benchmark_display(names[mode - 1], elapsed_time[0], elapsed_time[mode], iterations);
+    }
+
+    return 0;
+}
+
+/**
+ * Verifies a batch of proofs where a few of them are invalid: two with a forged
+ * randomizer (only their pairing equations fail, the batch must be bisected)
+ * and one with a tampered s_mr (its challenge fails). Exactly those proofs
+ * must be reported as invalid.
+ *
+ * @param protocol the protocol data
+ * @return 0 if success else -1
+ */
+static int benchmark_batch_verification(const benchmark_protocol_t *protocol)
+{
+    static const size_t forged[] = {2, 5}; // forged randomizer: first, last
+    static const size_t tampered = 6; // tampered s_mr
+
+    verifier_proof_t *proofs;
+    int results[BENCHMARK_NUM_BATCH_PROOFS];
+    mclBnFr one;
+
+    size_t it;
+    int r;
+
+    fprintf(stdout, "[+] batch verification (%d proofs, 3 invalid)\n", BENCHMARK_NUM_BATCH_PROOFS);
+
+    proofs = malloc(BENCHMARK_NUM_BATCH_PROOFS * sizeof(verifier_proof_t));
+    if (proofs == NULL)
+    {
+        return -1;
+    }
+
+    for (it = 0, r = 0; it < BENCHMARK_NUM_BATCH_PROOFS && r == 0; it++)
+    {
+        proofs[it].nonce = protocol->nonce;
+        proofs[it].nonce_length = sizeof(protocol->nonce);
+
+        if (it == forged[0] || it == forged[1])
+        {
+            r = benchmark_forge_randomizer(protocol, it == forged[0] ? 0 : protocol->ra_parameters.j - 1, &proofs[it].attributes,
+                                           &proofs[it].ue_credential, &proofs[it].ue_pi);
+            continue;
+        }
+
+        memcpy(&proofs[it].attributes, &protocol->ue_attributes, sizeof(user_attributes_t));
+        r = ue_compute_proof_of_knowledge(NULL, protocol->sys_parameters, protocol->ra_parameters, protocol->ra_signature, protocol->ie_signature,
+                                          protocol->ra_indices, protocol->nonce, sizeof(protocol->nonce), protocol->epoch, sizeof(protocol->epoch),
+                                          &proofs[it].attributes, 0, &proofs[it].ue_credential, &proofs[it].ue_pi);
+    }
+    if (r < 0)
+    {
+        free(proofs);
+        return -1;
+    }
+
+    mclBnFr_setInt32(&one, 1);
+    mclBnFr_add(&proofs[tampered].ue_pi.s_mr, &proofs[tampered].ue_pi.s_mr, &one);
+
+    r = ve_verify_proof_of_knowledge_batch(protocol->sys_parameters, protocol->ve_parameters, protocol->ra_parameters, protocol->ra_keys.public_key,
+                                           protocol->ie_keys, protocol->epoch, sizeof(protocol->epoch), proofs, BENCHMARK_NUM_BATCH_PROOFS, results);
+    if (r == 0)
+    {
+        fprintf(stderr, "Error: the batch verification accepts invalid proofs!\n");
+        free(proofs);
+        return -1;
+    }
+
+    for (it = 0, r = 0; it < BENCHMARK_NUM_BATCH_PROOFS; it++)
+    {
+        if (results[it] != ((it == forged[0] || it == forged[1] || it == tampered) ? -1 : 0))
+        {
+            fprintf(stderr, "Error: the batch verification reports a wrong result for the proof %lu!\n", (unsigned long) it);
+            r = -1;
+        }
+    }
+
+    free(proofs);
+
+    return r;
+}
+
+/**
+ * Compares the latency of a single proof verification computed sequentially
+ * and with the thread pool (t values and pairings forked across the threads),
+ * and reports the wall-clock time and the critical path of each stage.
+ *
+ * @param protocol the protocol data
+ * @param iterations the number of iterations
+ * @return 0 if success else -1
+ */
+static int benchmark_parallel_verification(const benchmark_protocol_t *protocol, size_t iterations)
+{
+    static const char *names[] = {"ve_verify_proof_of_knowledge (default)", "ve_verify_proof_of_knowledge (designated)"};
+
+    verifier_par_t ve_parameters[2];
+    verifier_profile_t profiles[2];
+
+    double elapsed_time[2];
+    double start_time;
+
+    size_t it, mode, pairing_mode;
+    int r;
+
+    fprintf(stdout, "[+] parallel verification (sequential / %d threads)\n", VERIFIER_NUM_THREADS + 1);
+
+    memcpy(&ve_parameters[0], &protocol->ve_parameters, sizeof(verifier_par_t));
+    memcpy(&ve_parameters[1], &protocol->ve_parameters, sizeof(verifier_par_t));
+    ve_parameters[0].profile = &profiles[0];
+    ve_parameters[1].profile = &profiles[1];
+
+    r = ve_set_parallel(&ve_parameters[1], VERIFIER_NUM_THREADS);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    for (pairing_mode = 0; pairing_mode < 2; pairing_mode++)
+    {
+        if (pairing_mode == 1)
+        {
+            r = ve_set_designated_key(&ve_parameters[0], protocol->ra_keys.private_key);
+            r |= ve_set_designated_key(&ve_parameters[1], protocol->ra_keys.private_key);
+            if (r < 0)
+            {
+                goto cleanup;
+            }
+        }
+
+        for (mode = 0; mode < 2; mode++)
+        {
+            start_time = benchmark_get_time();
+            for (it = 0; it < iterations; it++)
+            {
+                r = ve_verify_proof_of_knowledge(protocol->sys_parameters, ve_parameters[mode], protocol->ra_parameters, protocol->ra_keys.public_key,
+                                                 protocol->ie_keys, protocol->nonce, sizeof(protocol->nonce), protocol->epoch, sizeof(protocol->epoch),
+                                                 protocol->ue_attributes, protocol->ue_credential, protocol->ue_pi);
+                if (r < 0)
+                {
+                    fprintf(stderr, "Error: the parallel verification rejects a valid proof of knowledge!\n");
+                    goto cleanup;
+                }
+            }
+            elapsed_time[mode] = benchmark_get_time() - start_time;
+        }
+        benchmark_display(names[pairing_mode], elapsed_time[0], elapsed_time[1], iterations);
+
+        // stages of the last verification (wall-clock time / critical path)
+        for (mode = 0; mode < 2; mode++)
+        {
+            fprintf(stdout, "[!] Stages (%s) = t values %f / %f, challenge %f, pairings %f / %f\n", mode == 0 ? "sequential" : "parallel",
+                    profiles[mode].t_values, profiles[mode].t_values_critical_path, profiles[mode].challenge,
+                    profiles[mode].pairings, profiles[mode].pairings_critical_path);
+        }
+    }
+
+cleanup:
+    thread_pool_destroy(ve_parameters[1].thread_pool);
+    free(ve_parameters[1].thread_pool);
+
+    return r;
+}
+
+/**
+ * Fills a revocation list with BENCHMARK_NUM_REVOKED pseudonyms and measures
+ * the lookup of revoked and non-revoked pseudonyms, and the verification
+ * with and without the revocation list.
+ *
+ * @param protocol the protocol data
+ * @param iterations the number of iterations
+ * @return 0 if success else -1
+ */
+static int benchmark_revocation_list(const benchmark_protocol_t *protocol, size_t iterations)
+{
+    revocation_list_t revocation_list;
+    verifier_par_t ve_parameters;
+
+    uint8_t (*keys)[REVOCATION_LIST_KEY_LENGTH];
+    mclBnG1 pseudonym;
+    mclBnFr scalar;
+
+    double elapsed_time[2];
+    double start_time;
+
+    size_t it, mode;
+    int r;
+
+    fprintf(stdout, "[+] revocation list (%u revoked pseudonyms)\n", BENCHMARK_NUM_REVOKED);
+
+    // keys of revoked pseudonyms [0, BENCHMARK_NUM_LOOKUPS) and of non-revoked pseudonyms
+    keys = malloc(2 * BENCHMARK_NUM_LOOKUPS * REVOCATION_LIST_KEY_LENGTH);
+    if (keys == NULL)
+    {
+        return -1;
+    }
+
+    r = rl_create(&revocation_list, BENCHMARK_NUM_REVOKED + 1, protocol->epoch, sizeof(protocol->epoch));
+    if (r < 0)
+    {
+        free(keys);
+        return -1;
+    }
+
+    /// revoked pseudonyms (consecutive multiples of G1 from a random one)
+    mclBnFr_setByCSPRNG(&scalar);
+    mclBnG1_mul(&pseudonym, &protocol->sys_parameters.G1, &scalar);
+
+    start_time = benchmark_get_time();
+    for (it = 0; it < BENCHMARK_NUM_REVOKED + BENCHMARK_NUM_LOOKUPS; it++)
+    {
+        if (it < BENCHMARK_NUM_REVOKED)
+        {
+            r = rl_add(&revocation_list, pseudonym);
+            if (r < 0)
+            {
+                goto cleanup;
+            }
+        }
+
+        if (it < BENCHMARK_NUM_LOOKUPS || it >= BENCHMARK_NUM_REVOKED)
+        {
+            r = rl_compute_key(keys[it < BENCHMARK_NUM_LOOKUPS ? it : it - BENCHMARK_NUM_REVOKED + BENCHMARK_NUM_LOOKUPS], pseudonym);
+            if (r < 0)
+            {
+                goto cleanup;
+            }
+        }
+
+        mclBnG1_add(&pseudonym, &pseudonym, &protocol->sys_parameters.G1);
+    }
+    fprintf(stdout, "[!] Elapsed time (rl_add) = %f\n", (benchmark_get_time() - start_time) / BENCHMARK_NUM_REVOKED);
+
+    /// lookups (non-revoked / revoked)
+    for (mode = 0; mode < 2; mode++)
+    {
+        start_time = benchmark_get_time();
+        for (it = 0; it < iterations * BENCHMARK_NUM_LOOKUPS; it++)
+        {
+            r = rl_contains_key(&revocation_list, keys[(it % BENCHMARK_NUM_LOOKUPS) + (mode == 0 ? BENCHMARK_NUM_LOOKUPS : 0)]);
+            if (r != (int) mode)
+            {
+                fprintf(stderr, "Error: the revocation list gives a wrong result!\n");
+                r = -1;
+                goto cleanup;
+            }
+        }
+        elapsed_time[mode] = benchmark_get_time() - start_time;
+    }
+    fprintf(stdout, "[!] Elapsed time (rl_contains_key) = %f (not revoked) / %f (revoked)\n",
+            elapsed_time[0] / (double) (iterations * BENCHMARK_NUM_LOOKUPS), elapsed_time[1] / (double) (iterations * BENCHMARK_NUM_LOOKUPS));
+
+    /// verification without / with the revocation list
+    memcpy(&ve_parameters, &protocol->ve_parameters, sizeof(verifier_par_t));
+    for (mode = 0; mode < 2; mode++)
+    {
+        ve_set_revocation_list(&ve_parameters, mode == 0 ? NULL : &revocation_list);
+
+        start_time = benchmark_get_time();
+        for (it = 0; it < iterations; it++)
+        {
+            r = ve_verify_proof_of_knowledge(protocol->sys_parameters, ve_parameters, protocol->ra_parameters, protocol->ra_keys.public_key,
+                                             protocol->ie_keys, protocol->nonce, sizeof(protocol->nonce), protocol->epoch, sizeof(protocol->epoch),
+                                             protocol->ue_attributes, protocol->ue_credential, protocol->ue_pi);
+            if (r < 0)
+            {
+                goto cleanup;
+            }
+        }
+        elapsed_time[mode] = benchmark_get_time() - start_time;
+    }
+    benchmark_display("ve_verify_proof_of_knowledge (revocation list)", elapsed_time[0], elapsed_time[1], iterations);
+
+    /// a revoked pseudonym must not verify
+    r = rl_add(&revocation_list, protocol->ue_credential.pseudonym);
+    if (r < 0)
+    {
+        goto cleanup;
+    }
+
+    r = ve_verify_proof_of_knowledge(protocol->sys_parameters, ve_parameters, protocol->ra_parameters, protocol->ra_keys.public_key,
+                                     protocol->ie_keys, protocol->nonce, sizeof(protocol->nonce), protocol->epoch, sizeof(protocol->epoch),
+                                     protocol->ue_attributes, protocol->ue_credential, protocol->ue_pi);
+    if (r == 0)
+    {
+        fprintf(stderr, "Error: the verifier accepts a revoked pseudonym!\n");
+        r = -1;
+        goto cleanup;
+    }
+    r = 0;
+
+cleanup:
+    rl_destroy(&revocation_list);
+    free(keys);
+
+    return r;
+}
+
+/**
+ * Compares the computation of the revoked pseudonyms of an epoch one by one
+ * (as the user computes its pseudonym) with the revocation authority routine
+ * (batch inversion and several threads), and checks that both give the same set.
+ *
+ * @param protocol the protocol data
+ * @param iterations the number of iterations (thousands of revoked users)
+ * @return 0 if success else -1
+ */
+static int benchmark_revoked_pseudonyms(const benchmark_protocol_t *protocol, size_t iterations)
+{
+    revocation_list_t revocation_list;
+    revocation_list_t revocation_lists[2]; // one thread, VERIFIER_NUM_THREADS threads
+    verifier_par_t ve_parameters;
+
+    mclBnFr *revoked_mr;
+    mclBnFr number_one;
+    mclBnFr i, mul_result, fr_hash, denominator, div_result;
+    mclBnG1 pseudonym;
+
+    unsigned char hash[SHA_DIGEST_PADDING + SHA_DIGEST_LENGTH] = {0};
+    uint8_t (*keys)[REVOCATION_LIST_KEY_LENGTH];
+
+    double elapsed_time[2];
+    double start_time;
+
+    size_t num_revoked = iterations * 1000;
+    size_t it;
+    int r = -1;
+
+    fprintf(stdout, "[+] revoked pseudonyms (%lu revoked users, one by one / batch)\n", num_revoked);
+
+    revoked_mr = malloc(num_revoked * sizeof(mclBnFr));
+    keys = malloc(num_revoked * REVOCATION_LIST_KEY_LENGTH);
+    if (revoked_mr == NULL || keys == NULL)
+    {
+        free(revoked_mr);
+        free(keys);
+        return -1;
+    }
+
+    // the user of the protocol is revoked too
+    memcpy(&revoked_mr[0], &protocol->ra_signature.mr, sizeof(mclBnFr));
+    for (it = 1; it < num_revoked; it++)
+    {
+        mclBnFr_setByCSPRNG(&revoked_mr[it]);
+    }
+
+    /// one by one: C = (1 / i - mr + H(epoch)) * G1 with the randomizers of the protocol
+    start_time = benchmark_get_time();
+    SHA1(protocol->epoch, sizeof(protocol->epoch), &hash[SHA_DIGEST_PADDING]);
+    mcl_bytes_to_Fr(&fr_hash, hash, EC_SIZE);
+    mclBnFr_clear(&i);
+    for (it = 0; it < protocol->ra_parameters.j; it++)
+    {
+        mclBnFr_mul(&mul_result, &protocol->ra_parameters.alphas[it], &protocol->ra_parameters.randomizers[protocol->ra_indices[it]]);
+        mclBnFr_add(&i, &i, &mul_result);
+    }
+    mclBnFr_setInt32(&number_one, 1);
+    for (it = 0; it < num_revoked; it++)
+    {
+        mclBnFr_sub(&denominator, &i, &revoked_mr[it]);
+        mclBnFr_add(&denominator, &denominator, &fr_hash);
+        mclBnFr_div(&div_result, &number_one, &denominator);
+        fixed_base_mul(&pseudonym, &protocol->sys_parameters.G1, protocol->sys_parameters.G1_table, &div_result);
+        if (rl_compute_key(keys[it], pseudonym) < 0)
+        {
+            goto cleanup;
+        }
+    }
+    elapsed_time[0] = benchmark_get_time() - start_time;
+
+    /// batch
+    start_time = benchmark_get_time();
+    r = ra_revoked_pseudonyms(protocol->sys_parameters, protocol->ra_parameters, protocol->ra_indices, revoked_mr, num_revoked, protocol->epoch, sizeof(protocol->epoch),
+                              0, &revocation_list);
+    if (r < 0)
+    {
+        goto cleanup;
+    }
+    elapsed_time[1] = benchmark_get_time() - start_time;
+
+    benchmark_display("ra_revoked_pseudonyms", elapsed_time[0], elapsed_time[1], 1);
+
+    /// both sets must be the same
+    for (it = 0; it < num_revoked; it++)
+    {
+        if (rl_contains_key(&revocation_list, keys[it]) != 1)
+        {
+            fprintf(stderr, "Error: the revocation list does not contain a revoked pseudonym!\n");
+            r = -1;
+            goto cleanup_list;
+        }
+    }
+
+    /// the threads must give the same list as a single thread
+    r = ra_revoked_pseudonyms(protocol->sys_parameters, protocol->ra_parameters, protocol->ra_indices, revoked_mr, num_revoked, protocol->epoch, sizeof(protocol->epoch),
+                              1, &revocation_lists[0]);
+    if (r < 0)
+    {
+        goto cleanup_list;
+    }
+    r = ra_revoked_pseudonyms(protocol->sys_parameters, protocol->ra_parameters, protocol->ra_indices, revoked_mr, num_revoked, protocol->epoch, sizeof(protocol->epoch),
+                              VERIFIER_NUM_THREADS, &revocation_lists[1]);
+    if (r < 0)
+    {
+        rl_destroy(&revocation_lists[0]);
+        goto cleanup_list;
+    }
+
+    r = revocation_lists[0].image_length == revocation_lists[1].image_length
+        && revocation_lists[0].header->num_entries == revocation_lists[1].header->num_entries ? 0 : -1;
+    for (it = 0; it < num_revoked && r == 0; it++)
+    {
+        r = rl_contains_key(&revocation_lists[0], keys[it]) == 1 && rl_contains_key(&revocation_lists[1], keys[it]) == 1 ? 0 : -1;
+    }
+    rl_destroy(&revocation_lists[0]);
+    rl_destroy(&revocation_lists[1]);
+    if (r < 0)
+    {
+        fprintf(stderr, "Error: the threads give a different revocation list!\n");
+        goto cleanup_list;
+    }
+
+    /// the revoked user of the protocol must not verify
+    memcpy(&ve_parameters, &protocol->ve_parameters, sizeof(verifier_par_t));
+    ve_set_revocation_list(&ve_parameters, &revocation_list);
+
+    r = ve_verify_proof_of_knowledge(protocol->sys_parameters, ve_parameters, protocol->ra_parameters, protocol->ra_keys.public_key,
+                                     protocol->ie_keys, protocol->nonce, sizeof(protocol->nonce), protocol->epoch, sizeof(protocol->epoch),
+                                     protocol->ue_attributes, protocol->ue_credential, protocol->ue_pi);
+    if (r == 0)
+    {
+        fprintf(stderr, "Error: the verifier accepts a revoked user!\n");
+        r = -1;
+        goto cleanup_list;
+    }
+    r = 0;
+
+cleanup_list:
+    rl_destroy(&revocation_list);
+
+cleanup:
+    free(revoked_mr);
+    free(keys);
+
+    return r;
+}
+
+/**
+ * Looks up a user scanning the whole log of the revocation database (reference
+ * implementation without the index).
+ *
+ * @param database the revocation database
+ * @param identifier the user identifier
+ * @param record the last record of the user
+ * @return 0 if success else -1
+ */
+static int benchmark_reference_rd_lookup(const revocation_database_t *database, user_identifier_t identifier, revocation_database_record_t *record)
+{
+    revocation_database_record_t records[1024];
+    ssize_t length;
+
+    uint64_t offset = 0;
+    size_t num_records;
+    size_t it;
+    int found = 0;
+
+    for (;;)
+    {
+        length = pread(database->log_fd, records, sizeof(records), (off_t) offset);
+        if (length <= 0)
+        {
+            break;
+        }
+
+        num_records = (size_t) length / sizeof(revocation_database_record_t);
+        for (it = 0; it < num_records; it++)
+        {
+            if (records[it].identifier_length == identifier.buffer_length && memcmp(records[it].identifier, identifier.buffer, identifier.buffer_length) == 0)
+            {
+                memcpy(record, &records[it], sizeof(revocation_database_record_t));
+                found = 1;
+            }
+        }
+        offset += num_records * sizeof(revocation_database_record_t);
+    }
+
+    return found ? 0 : -1;
+}
+
+/**
+ * Computes the identifier of the n-th user of the revocation database benchmark.
+ *
+ * @param identifier the user identifier
+ * @param n the number of the user
+ */
+static void benchmark_rd_identifier(user_identifier_t *identifier, size_t n)
+{
+    identifier->buffer_length = (size_t) snprintf((char *) identifier->buffer, USER_MAX_ID_LENGTH, "user-%015lu", n);
+}
+
+/**
+ * Fills the revocation database with users, compares the lookup scanning the log
+ * with the indexed lookup and the recovery replaying the whole log with the one
+ * replaying the tail only. A torn record is appended to the log to simulate a crash.
+ *
+ * @param protocol the protocol data
+ * @param iterations the number of iterations (thousands of users)
+ * @return 0 if success else -1
+ */
+static int benchmark_revocation_database(const benchmark_protocol_t *protocol, size_t iterations)
+{
+    revocation_database_t database;
+    revocation_database_entry_t entry;
+    revocation_database_record_t record;
+
+    char directory[] = "/tmp/rkvac-XXXXXX";
+    char path[FILENAME_MAX];
+
+    user_identifier_t identifier;
+    mclBnFr mr, *revoked_mr;
+    size_t num_revoked;
+
+    double elapsed_time[2];
+    double start_time;
+
+    size_t num_users = iterations * 1000;
+    size_t it;
+    int r = -1;
+
+    fprintf(stdout, "[+] revocation database (%lu users)\n", num_users);
+
+    if (mkdtemp(directory) == NULL)
+    {
+        return -1;
+    }
+    snprintf(path, sizeof(path), "%s/rd", directory);
+
+    r = rd_open(&database, path);
+    if (r < 0)
+    {
+        rmdir(directory);
+        return -1;
+    }
+
+    /// insert (the user of the protocol is the first one)
+    start_time = benchmark_get_time();
+    r = rd_insert(&database, protocol->ue_identifier, protocol->ra_signature.mr);
+    for (it = 1; it < num_users && r == 0; it++)
+    {
+        benchmark_rd_identifier(&identifier, it);
+        mclBnFr_setByCSPRNG(&mr);
+        r = rd_insert(&database, identifier, mr);
+    }
+    elapsed_time[0] = benchmark_get_time() - start_time;
+    if (r < 0)
+    {
+        goto cleanup;
+    }
+
+    fprintf(stdout, "[!] Elapsed time (rd_insert) = %f\n", elapsed_time[0] / (double) num_users);
+
+    r = rd_revoke(&database, protocol->ue_identifier, &mr);
+    if (r < 0 || mclBnFr_isEqual(&mr, &protocol->ra_signature.mr) != 1)
+    {
+        r = -1;
+        goto cleanup;
+    }
+
+    /// lookup: log scan / index
+    start_time = benchmark_get_time();
+    for (it = 0; it < iterations; it++)
+    {
+        benchmark_rd_identifier(&identifier, (it * 7919) % num_users);
+        r = benchmark_reference_rd_lookup(&database, identifier, &record);
+        if (r < 0 && it * 7919 % num_users != 0)
+        {
+            goto cleanup;
+        }
+    }
+    elapsed_time[0] = benchmark_get_time() - start_time;
+
+    start_time = benchmark_get_time();
+    for (it = 0; it < iterations; it++)
+    {
+        benchmark_rd_identifier(&identifier, (it * 7919) % num_users);
+        r = rd_lookup(&database, identifier, &entry);
+        if (r < 0 && it * 7919 % num_users != 0)
+        {
+            goto cleanup;
+        }
+    }
+    elapsed_time[1] = benchmark_get_time() - start_time;
+
+    benchmark_display("rd_lookup", elapsed_time[0], elapsed_time[1], iterations);
+
+    /// crash: torn record at the end of the log
+    memset(&record, 0xFF, sizeof(record));
+    if (pwrite(database.log_fd, &record, sizeof(record) / 2, (off_t) database.log_length) != sizeof(record) / 2)
+    {
+        r = -1;
+        goto cleanup;
+    }
+    rd_close(&database);
+
+    /// recovery: whole log (no index) / tail only
+    start_time = benchmark_get_time();
+    unlink(database.index_path);
+    r = rd_open(&database, path);
+    elapsed_time[0] = benchmark_get_time() - start_time;
+    if (r < 0)
+    {
+        goto cleanup;
+    }
+    rd_close(&database);
+
+    start_time = benchmark_get_time();
+    r = rd_open(&database, path);
+    elapsed_time[1] = benchmark_get_time() - start_time;
+    if (r < 0)
+    {
+        goto cleanup;
+    }
+
+    benchmark_display("rd_open", elapsed_time[0], elapsed_time[1], 1);
+
+    /// the revoked user survives the recovery
+    r = rd_lookup(&database, protocol->ue_identifier, &entry);
+    if (r < 0 || entry.revoked != 1 || mclBnFr_isEqual(&entry.mr, &protocol->ra_signature.mr) != 1 ||
+        database.header->num_entries != num_users || database.log_length != (num_users + 1) * sizeof(revocation_database_record_t))
+    {
+        fprintf(stderr, "Error: the revocation database has not been recovered!\n");
+        r = -1;
+        goto cleanup;
+    }
+
+    r = rd_get_revoked(&database, &revoked_mr, &num_revoked);
+    if (r < 0)
+    {
+        goto cleanup;
+    }
+    if (num_revoked != 1 || mclBnFr_isEqual(&revoked_mr[0], &protocol->ra_signature.mr) != 1)
+    {
+        fprintf(stderr, "Error: the revocation database returns wrong revoked users!\n");
+        r = -1;
+    }
+    free(revoked_mr);
+
+cleanup:
+    rd_close(&database);
+    unlink(database.log_path);
+    unlink(database.index_path);
+    rmdir(directory);
+
+    return r;
+}
+
+/**
+ * Creates a revocation list of the epoch with the given keys.
+ *
+ * @param list the revocation list
+ * @param epoch the epoch
+ * @param keys the keys
+ * @param num_keys the number of keys
+ * @return 0 if success else -1
+ */
+static int benchmark_create_keys_list(revocation_list_t *list, const uint8_t *epoch, const uint8_t (*keys)[REVOCATION_LIST_KEY_LENGTH], size_t num_keys)
+{
+    size_t it;
+    int r;
+
+    r = rl_create(list, num_keys, epoch, EPOCH_LENGTH);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    for (it = 0; it < num_keys; it++)
+    {
+        r = rl_add_key(list, keys[it]);
+        if (r < 0)
+        {
+            rl_destroy(list);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Creates a revocation list with the given keys.
+ *
+ * @param epoch the epoch of the list
+ * @param keys the keys
+ * @param num_keys the number of keys
+ * @return the list (allocated with malloc) or NULL
+ */
+static revocation_list_t *benchmark_create_list(const uint8_t *epoch, const uint8_t (*keys)[REVOCATION_LIST_KEY_LENGTH], size_t num_keys)
+{
+    revocation_list_t *list;
+
+    list = malloc(sizeof(revocation_list_t));
+    if (list == NULL)
+    {
+        return NULL;
+    }
+
+    if (benchmark_create_keys_list(list, epoch, keys, num_keys) < 0)
+    {
+        free(list);
+        return NULL;
+    }
+
+    return list;
+}
+
+/**
+ * Looks up revoked keys in the current revocation list, through the snapshot
+ * or under the read-write lock (reference implementation).
+ *
+ * @param argument the reader
+ * @return NULL
+ */
+static void *benchmark_reader(void *argument)
+{
+    benchmark_reader_t *reader = (benchmark_reader_t *) argument;
+    const revocation_list_t *list;
+
+    size_t slot = 0;
+    size_t it;
+
+    if (reader->snapshot != NULL && rs_register_reader(reader->snapshot, &slot) < 0)
+    {
+        reader->error = 1;
+        __atomic_add_fetch(reader->num_finished, 1, __ATOMIC_RELEASE);
+        return NULL;
+    }
+
+    for (it = 0; it < reader->num_lookups; it++)
+    {
+        if (reader->snapshot != NULL)
+        {
+            list = rs_read_lock(reader->snapshot, slot);
+            reader->error |= rl_contains_key(list, reader->keys[it % reader->num_keys]) != 1;
+            rs_read_unlock(reader->snapshot, slot);
+        }
+        else
+        {
+            pthread_rwlock_rdlock(reader->lock);
+            reader->error |= rl_contains_key(*reader->list, reader->keys[it % reader->num_keys]) != 1;
+            pthread_rwlock_unlock(reader->lock);
+        }
+    }
+
+    if (reader->snapshot != NULL)
+    {
+        rs_unregister_reader(reader->snapshot, slot);
+    }
+    __atomic_add_fetch(reader->num_finished, 1, __ATOMIC_RELEASE);
+
+    return NULL;
+}
+
+/**
+ * Compares the readers of the revocation list under a read-write lock with the
+ * readers of the snapshot (epoch-based reclamation) while a writer keeps
+ * publishing new lists. Every published list contains the looked up keys.
+ *
+ * @param protocol the protocol data
+ * @param iterations the number of iterations
+ * @return 0 if success else -1
+ */
+static int benchmark_revocation_snapshot(const benchmark_protocol_t *protocol, size_t iterations)
+{
+    benchmark_reader_t readers[VERIFIER_NUM_THREADS];
+    revocation_snapshot_t snapshot;
+    pthread_rwlock_t lock;
+    revocation_list_t *list, *next, *previous;
+
+    uint8_t (*keys)[REVOCATION_LIST_KEY_LENGTH];
+    mclBnG1 pseudonym;
+    mclBnFr scalar;
+
+    double elapsed_time[2];
+    double start_time;
+
+    size_t num_published[2];
+    size_t num_finished;
+    size_t it, mode;
+    int r = 0;
+
+    fprintf(stdout, "[+] revocation snapshot (%d readers, lists published while reading)\n", VERIFIER_NUM_THREADS);
+
+    keys = malloc(BENCHMARK_NUM_LOOKUPS * REVOCATION_LIST_KEY_LENGTH);
+    if (keys == NULL)
+    {
+        return -1;
+    }
+
+    mclBnFr_setByCSPRNG(&scalar);
+    mclBnG1_mul(&pseudonym, &protocol->sys_parameters.G1, &scalar);
+    for (it = 0; it < BENCHMARK_NUM_LOOKUPS; it++)
+    {
+        mclBnG1_add(&pseudonym, &pseudonym, &protocol->sys_parameters.G1);
+        if (rl_compute_key(keys[it], pseudonym) < 0)
+        {
+            free(keys);
+            return -1;
+        }
+    }
+
+    /// mode 0: read-write lock, mode 1: snapshot
+    for (mode = 0; mode < 2 && r == 0; mode++)
+    {
+        list = benchmark_create_list(protocol->epoch, (const uint8_t (*)[REVOCATION_LIST_KEY_LENGTH]) keys, BENCHMARK_NUM_LOOKUPS);
+        if (list == NULL)
+        {
+            r = -1;
+            break;
+        }
+
+        if (mode == 0)
+        {
+            pthread_rwlock_init(&lock, NULL);
+        }
+        else
+        {
+            rs_init(&snapshot, list);
+        }
+
+        num_finished = 0;
+        num_published[mode] = 0;
+
+        start_time = benchmark_get_time();
+        for (it = 0; it < VERIFIER_NUM_THREADS; it++)
+        {
+            memset(&readers[it], 0, sizeof(benchmark_reader_t));
+            readers[it].snapshot = mode == 0 ? NULL : &snapshot;
+            readers[it].lock = &lock;
+            readers[it].list = &list;
+            readers[it].keys = (const uint8_t (*)[REVOCATION_LIST_KEY_LENGTH]) keys;
+            readers[it].num_keys = BENCHMARK_NUM_LOOKUPS;
+            readers[it].num_lookups = iterations * BENCHMARK_NUM_LOOKUPS;
+            readers[it].num_finished = &num_finished;
+            pthread_create(&readers[it].thread, NULL, benchmark_reader, &readers[it]);
+        }
+
+        // the writer builds the next list off to the side and swaps it in
+        while (__atomic_load_n(&num_finished, __ATOMIC_ACQUIRE) < VERIFIER_NUM_THREADS)
+        {
+            next = benchmark_create_list(protocol->epoch, (const uint8_t (*)[REVOCATION_LIST_KEY_LENGTH]) keys, BENCHMARK_NUM_LOOKUPS);
+            if (next == NULL)
+            {
+                r = -1;
+                break;
+            }
+
+            if (mode == 0)
+            {
+                pthread_rwlock_wrlock(&lock);
+                previous = list;
+                list = next;
+                pthread_rwlock_unlock(&lock);
+
+                rl_destroy(previous);
+                free(previous);
+            }
+            else
+            {
+                rs_publish(&snapshot, next);
+            }
+            num_published[mode]++;
+        }
+
+        for (it = 0; it < VERIFIER_NUM_THREADS; it++)
+        {
+            pthread_join(readers[it].thread, NULL);
+            if (readers[it].error)
+            {
+                fprintf(stderr, "Error: a reader did not find a revoked key!\n");
+                r = -1;
+            }
+        }
+        elapsed_time[mode] = benchmark_get_time() - start_time;
+
+        if (mode == 0)
+        {
+            pthread_rwlock_destroy(&lock);
+            rl_destroy(list);
+            free(list);
+        }
+        else
+        {
+            rs_destroy(&snapshot);
+        }
+    }
+
+    if (r == 0)
+    {
+        benchmark_display("revocation snapshot", elapsed_time[0], elapsed_time[1], iterations * BENCHMARK_NUM_LOOKUPS);
+        fprintf(stdout, "[!] Published lists = %lu / %lu\n", num_published[0], num_published[1]);
+    }
+
+    free(keys);
+
+    return r;
+}
+
+/**
+ * Compares the propagation of a few revocations within the epoch as a full
+ * republish of the revocation list (rebuild record with all the keys) with the
+ * propagation as a delta (only the new keys), both through the delta log.
+ * Checks that the rebuilds compact the log and that a malformed rebuild is rejected.
+ *
+ * @param protocol the protocol data
+ * @param iterations the number of iterations (thousands of revoked users)
+ * @return 0 if success else -1
+ */
+static int benchmark_revocation_delta(const benchmark_protocol_t *protocol, size_t iterations)
+{
+    revocation_delta_t writer, reader, late_reader;
+    revocation_snapshot_t snapshot, late_snapshot;
+    revocation_list_t list, full, added;
+    const revocation_list_t *current;
+
+    char directory[] = "/tmp/rkvac-XXXXXX";
+    char path[FILENAME_MAX];
+
+    uint8_t (*keys)[REVOCATION_LIST_KEY_LENGTH];
+
+    double elapsed_time[2];
+    double start_time;
+
+    size_t num_revoked = iterations * 1000;
+    size_t num_applied[2];
+    size_t it;
+    int r;
+
+    fprintf(stdout, "[+] revocation delta (%lu revoked users, %d new revocations)\n", num_revoked, BENCHMARK_NUM_DELTA_KEYS);
+
+    keys = malloc((num_revoked + BENCHMARK_NUM_DELTA_KEYS) * REVOCATION_LIST_KEY_LENGTH);
+    if (keys == NULL)
+    {
+        return -1;
+    }
+
+    r = RAND_bytes((unsigned char *) keys, (int) ((num_revoked + BENCHMARK_NUM_DELTA_KEYS) * REVOCATION_LIST_KEY_LENGTH));
+    if (r != 1)
+    {
+        free(keys);
+        return -1;
+    }
+    for (it = 0; it < num_revoked + BENCHMARK_NUM_DELTA_KEYS; it++)
+    {
+        keys[it][0] = (keys[it][0] & 0x3Fu) | REVOCATION_LIST_KEY_USED;
+    }
+
+    if (mkdtemp(directory) == NULL)
+    {
+        free(keys);
+        return -1;
+    }
+    snprintf(path, sizeof(path), "%s/delta", directory);
+
+    r = rl_delta_create(&writer, path);
+    if (r < 0)
+    {
+        rmdir(directory);
+        free(keys);
+        return -1;
+    }
+
+    r = rl_delta_open(&reader, path);
+    if (r < 0)
+    {
+        rl_delta_close(&writer);
+        unlink(path);
+        rmdir(directory);
+        free(keys);
+        return -1;
+    }
+    rs_init(&snapshot, NULL);
+
+    /// list of the epoch
+    r = benchmark_create_keys_list(&list, protocol->epoch, keys, num_revoked);
+    if (r < 0)
+    {
+        goto cleanup;
+    }
+    if (rl_delta_append(&writer, &list, 1) < 0 || rl_delta_apply(&reader, &snapshot, NULL) < 0)
+    {
+        r = -1;
+        goto cleanup_list;
+    }
+
+    /// full republish: the list of the epoch with the new keys
+    start_time = benchmark_get_time();
+    r = benchmark_create_keys_list(&full, protocol->epoch, keys, num_revoked + BENCHMARK_NUM_DELTA_KEYS);
+    if (r < 0)
+    {
+        goto cleanup_list;
+    }
+    r = rl_delta_append(&writer, &full, 1);
+    rl_destroy(&full);
+    if (r < 0 || rl_delta_apply(&reader, &snapshot, &num_applied[0]) < 0)
+    {
+        r = -1;
+        goto cleanup_list;
+    }
+    elapsed_time[0] = benchmark_get_time() - start_time;
+
+    // back to the list without the new keys
+    if (rl_delta_append(&writer, &list, 1) < 0 || rl_delta_apply(&reader, &snapshot, NULL) < 0)
+    {
+        r = -1;
+        goto cleanup_list;
+    }
+
+    /// delta: the new keys only
+    current = snapshot.current;
+    start_time = benchmark_get_time();
+    r = benchmark_create_keys_list(&added, protocol->epoch, &keys[num_revoked], BENCHMARK_NUM_DELTA_KEYS);
+    if (r < 0)
+    {
+        goto cleanup_list;
+    }
+    r = rl_delta_append(&writer, &added, 0);
+    rl_destroy(&added);
+    if (r < 0 || rl_delta_apply(&reader, &snapshot, &num_applied[1]) < 0)
+    {
+        r = -1;
+        goto cleanup_list;
+    }
+    elapsed_time[1] = benchmark_get_time() - start_time;
+
+    benchmark_display("revocation delta", elapsed_time[0], elapsed_time[1], 1);
+    fprintf(stdout, "[!] Applied records = %lu / %lu\n", num_applied[0], num_applied[1]);
+
+    // the published lists are immutable, the new keys are added to a copy
+    if (snapshot.current == current)
+    {
+        fprintf(stderr, "Error: the revocation delta has modified a published list!\n");
+        r = -1;
+        goto cleanup_list;
+    }
+
+    /// the verifiers see all the revoked keys
+    current = snapshot.current;
+    for (it = 0; it < num_revoked + BENCHMARK_NUM_DELTA_KEYS; it++)
+    {
+        if (rl_contains_key(current, keys[it]) != 1)
+        {
+            fprintf(stderr, "Error: the revocation delta has not been applied!\n");
+            r = -1;
+            goto cleanup_list;
+        }
+    }
+
+    /// the log has been compacted by the rebuilds, a new verifier starts at the latest one
+    r = rl_delta_open(&late_reader, path);
+    if (r < 0)
+    {
+        goto cleanup_list;
+    }
+    rs_init(&late_snapshot, NULL);
+
+    r = rl_delta_apply(&late_reader, &late_snapshot, &num_applied[0]);
+    if (r < 0 || num_applied[0] != num_revoked + 1 + BENCHMARK_NUM_DELTA_KEYS ||
+        rl_contains_key(late_snapshot.current, keys[num_revoked + BENCHMARK_NUM_DELTA_KEYS - 1]) != 1)
+    {
+        fprintf(stderr, "Error: the revocation delta log has not been compacted!\n");
+        r = -1;
+    }
+    rs_destroy(&late_snapshot);
+    rl_delta_close(&late_reader);
+    if (r < 0)
+    {
+        goto cleanup_list;
+    }
+
+    /// a rebuild followed by a record other than a key of its epoch is rejected
+    writer.records[1].type = REVOCATION_DELTA_EPOCH;
+
+    r = rl_delta_open(&late_reader, path);
+    if (r < 0)
+    {
+        goto cleanup_list;
+    }
+    rs_init(&late_snapshot, NULL);
+
+    if (rl_delta_apply(&late_reader, &late_snapshot, NULL) == 0)
+    {
+        fprintf(stderr, "Error: the revocation delta log accepts a malformed rebuild!\n");
+        r = -1;
+    }
+    rs_destroy(&late_snapshot);
+    rl_delta_close(&late_reader);
+
+    writer.records[1].type = REVOCATION_DELTA_ADD;
+
+cleanup_list:
+    rl_destroy(&list);
+
+cleanup:
+    rs_destroy(&snapshot);
+    rl_delta_close(&reader);
+    rl_delta_close(&writer);
+    unlink(path);
+    rmdir(directory);
+    free(keys);
+
+    return r;
+}
+
+/**
+ * Compares the lookups in a private revocation list with the lookups in the
+ * shared revocation list (seqlock), checks that several verifier processes see
+ * consistent lists while new lists are published and that the verifier rejects
+ * the revoked user of the protocol through the shared list.
+ *
+ * @param protocol the protocol data
+ * @param iterations the number of iterations (thousands of revoked users)
+ * @return 0 if success else -1
+ */
+static int benchmark_revocation_shared(const benchmark_protocol_t *protocol, size_t iterations)
+{
+    revocation_shared_t writer, reader;
+    revocation_list_t list;
+    verifier_par_t ve_parameters;
+
+    char directory[] = "/tmp/rkvac-XXXXXX";
+    char path[FILENAME_MAX];
+
+    uint8_t (*keys)[REVOCATION_LIST_KEY_LENGTH];
+    pid_t processes[BENCHMARK_NUM_PROCESSES];
+
+    double elapsed_time[2];
+    double start_time;
+
+    size_t num_revoked = iterations * 1000;
+    size_t num_published = 0;
+    size_t num_lookups = iterations * BENCHMARK_NUM_LOOKUPS;
+    size_t it, process;
+    int status, found = 0;
+    int r;
+
+    fprintf(stdout, "[+] shared revocation list (%lu revoked users, %d processes)\n", num_revoked, BENCHMARK_NUM_PROCESSES);
+
+    // keys [0, num_revoked) are revoked
+    keys = malloc(2 * num_revoked * REVOCATION_LIST_KEY_LENGTH);
+    if (keys == NULL)
+    {
+        return -1;
+    }
+
+    r = RAND_bytes((unsigned char *) keys, (int) (2 * num_revoked * REVOCATION_LIST_KEY_LENGTH));
+    if (r != 1)
+    {
+        free(keys);
+        return -1;
+    }
+    for (it = 0; it < 2 * num_revoked; it++)
+    {
+        keys[it][0] = (keys[it][0] & 0x3Fu) | REVOCATION_LIST_KEY_USED;
+    }
+
+    if (mkdtemp(directory) == NULL)
+    {
+        free(keys);
+        return -1;
+    }
+    snprintf(path, sizeof(path), "%s/revocation-list", directory);
+
+    r = rl_shared_create(&writer, path);
+    if (r < 0)
+    {
+        rmdir(directory);
+        free(keys);
+        return -1;
+    }
+
+    r = benchmark_create_keys_list(&list, protocol->epoch, (const uint8_t (*)[REVOCATION_LIST_KEY_LENGTH]) keys, num_revoked);
+    if (r < 0 || rl_shared_publish(&writer, &list) < 0 || rl_shared_open(&reader, path) < 0)
+    {
+        r = -1;
+        goto cleanup;
+    }
+
+    /// lookups: private list / shared list
+    start_time = benchmark_get_time();
+    for (it = 0; it < num_lookups; it++)
+    {
+        found += rl_contains_key(&list, keys[(it * 7919) % (2 * num_revoked)]);
+    }
+    elapsed_time[0] = benchmark_get_time() - start_time;
+
+    start_time = benchmark_get_time();
+    for (it = 0; it < num_lookups; it++)
+    {
+        found -= rl_shared_contains_key(&reader, protocol->epoch, keys[(it * 7919) % (2 * num_revoked)]);
+    }
+    elapsed_time[1] = benchmark_get_time() - start_time;
+
+    benchmark_display("shared revocation list", elapsed_time[0], elapsed_time[1], num_lookups);
+    fprintf(stdout, "[!] Memory of the lists = %lu / %lu bytes\n", (unsigned long) (BENCHMARK_NUM_PROCESSES * list.image_length),
+            (unsigned long) list.image_length);
+
+    if (found != 0)
+    {
+        fprintf(stderr, "Error: the shared revocation list differs from the private one!\n");
+        r = -1;
+        goto cleanup_reader;
+    }
+
+    /// verifier processes looking up the keys while the lists are republished
+    for (process = 0; process < BENCHMARK_NUM_PROCESSES; process++)
+    {
+        processes[process] = fork();
+        if (processes[process] == 0)
+        {
+            status = 0;
+            for (it = 0; it < num_lookups && status == 0; it++)
+            {
+                status = rl_shared_contains_key(&reader, protocol->epoch, keys[it % (2 * num_revoked)]) != (it % (2 * num_revoked) < num_revoked);
+            }
+            _exit(status);
+        }
+        else if (processes[process] < 0)
+        {
+            break;
+        }
+    }
+
+    for (it = 0; it < process; it++)
+    {
+        while (waitpid(processes[it], &status, WNOHANG) == 0)
+        {
+            // same keys, new seed (other layout of the hash set)
+            rl_destroy(&list);
+            r = benchmark_create_keys_list(&list, protocol->epoch, (const uint8_t (*)[REVOCATION_LIST_KEY_LENGTH]) keys, num_revoked);
+            if (r < 0 || rl_shared_publish(&writer, &list) < 0)
+            {
+                r = -1;
+                break;
+            }
+            num_published++;
+        }
+        if (r < 0)
+        {
+            waitpid(processes[it], &status, 0);
+        }
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        {
+            fprintf(stderr, "Error: a verifier process has read an inconsistent revocation list!\n");
+            r = -1;
+        }
+    }
+    if (process < BENCHMARK_NUM_PROCESSES)
+    {
+        r = -1;
+    }
+    if (r < 0)
+    {
+        goto cleanup_reader;
+    }
+
+    fprintf(stdout, "[!] Published lists = %lu\n", num_published);
+
+    /// a publisher crashed while writing the next slot, the next one takes over
+    writer.header->slots[(writer.header->generation + 1) & 1u].sequence |= 1u;
+    rl_shared_close(&writer);
+    r = rl_shared_create(&writer, path);
+    if (r < 0)
+    {
+        goto cleanup_reader;
+    }
+
+    /// the revoked user of the protocol must not verify
+    rl_destroy(&list);
+    r = ra_revoked_pseudonyms(protocol->sys_parameters, protocol->ra_parameters, protocol->ra_indices, &protocol->ra_signature.mr, 1, protocol->epoch,
+                              sizeof(protocol->epoch), 1, &list);
+    if (r < 0 || rl_shared_publish(&writer, &list) < 0)
+    {
+        r = -1;
+        goto cleanup_reader;
+    }
+
+    memcpy(&ve_parameters, &protocol->ve_parameters, sizeof(verifier_par_t));
+    ve_set_revocation_shared(&ve_parameters, &reader);
+
+    r = ve_verify_proof_of_knowledge(protocol->sys_parameters, ve_parameters, protocol->ra_parameters, protocol->ra_keys.public_key,
+                                     protocol->ie_keys, protocol->nonce, sizeof(protocol->nonce), protocol->epoch, sizeof(protocol->epoch),
+                                     protocol->ue_attributes, protocol->ue_credential, protocol->ue_pi);
+    if (r == 0)
+    {
+        fprintf(stderr, "Error: the verifier accepts a revoked user!\n");
+        r = -1;
+        goto cleanup_reader;
+    }
+    r = 0;
+
+cleanup_reader:
+    rl_shared_close(&reader);
+
+cleanup:
+    rl_destroy(&list);
+    rl_shared_close(&writer);
+    unlink(path);
+    rmdir(directory);
+    free(keys);
+
+    return r;
+}
+
+/**
+ * Compares the proof of knowledge with and without the pseudonym cache
+ * (the cache is flushed before each proof in the reference case).
+ *
+ * @param protocol the protocol data
+ * @param iterations the number of iterations
+ * @return 0 if success else -1
+ */
+static int benchmark_pseudonym_cache(const benchmark_protocol_t *protocol, size_t iterations)
+{
+    user_attributes_t ue_attributes;
+    user_credential_t ue_credential;
+    user_pi_t ue_pi;
+
+    double elapsed_time[2];
+    double start_time;
+
+    size_t it, mode;
+    int r;
+
+    fprintf(stdout, "[+] pseudonym cache (flushed / cached)\n");
+
+    for (mode = 0; mode < 2; mode++)
+    {
+        start_time = benchmark_get_time();
+        for (it = 0; it < iterations; it++)
+        {
+            if (mode == 0)
+            {
+                ue_flush_pseudonym_cache();
+            }
+
+            memcpy(&ue_attributes, &protocol->ue_attributes, sizeof(user_attributes_t));
+            r = ue_compute_proof_of_knowledge(NULL, protocol->sys_parameters, protocol->ra_parameters, protocol->ra_signature, protocol->ie_signature, protocol->ra_indices,
+                                              protocol->nonce, sizeof(protocol->nonce), protocol->epoch, sizeof(protocol->epoch), &ue_attributes, 0,
+                                              &ue_credential, &ue_pi);
+            if (r < 0)
+            {
+                return -1;
+            }
+        }
+        elapsed_time[mode] = benchmark_get_time() - start_time;
+    }
+    benchmark_display("ue_compute_proof_of_knowledge", elapsed_time[0], elapsed_time[1], iterations);
+
+    // the cached pseudonym must give a valid proof
+    return ve_verify_proof_of_knowledge(protocol->sys_parameters, protocol->ve_parameters, protocol->ra_parameters, protocol->ra_keys.public_key,
+                                        protocol->ie_keys, protocol->nonce, sizeof(protocol->nonce), protocol->epoch, sizeof(protocol->epoch),
+                                        ue_attributes, ue_credential, ue_pi);
+}
+
+/**
+ * Compares the latency of the proof of knowledge computed from scratch with the
+ * latency of the online step of the token pool, and checks that the proofs
+ * computed from the tokens are valid.
+ *
+ * @param protocol the protocol data
+ * @param iterations the number of iterations
+ * @return 0 if success else -1
+ */
+static int benchmark_token_pool(const benchmark_protocol_t *protocol, size_t iterations)
+{
+    user_token_pool_t *pool;
+
+    user_attributes_t ue_attributes;
+    user_credential_t ue_credential[USER_TOKEN_POOL_SIZE];
+    user_pi_t ue_pi[USER_TOKEN_POOL_SIZE];
+
+    struct timespec delay = {0, 1000000}; // 1 ms
+
+    double elapsed_time[2];
+    double start_time;
+
+    size_t num_tokens;
+    size_t it;
+    int r;
+
+    fprintf(stdout, "[+] token pool (offline + online / online)\n");
+
+    // the pool is too big for the stack
+    pool = malloc(sizeof(user_token_pool_t));
+    if (pool == NULL)
+    {
+        return -1;
+    }
+
+    r = ue_token_pool_start(pool, protocol->sys_parameters, protocol->ra_parameters, protocol->ra_signature, protocol->ie_signature, protocol->ra_indices,
+                            protocol->epoch, sizeof(protocol->epoch), &protocol->ue_attributes, 0);
+    if (r < 0)
+    {
+        free(pool);
+        return -1;
+    }
+
+    // the online latency is measured with a full pool
+    num_tokens = iterations < USER_TOKEN_POOL_SIZE ? iterations : USER_TOKEN_POOL_SIZE;
+
+    /// proof of knowledge from scratch
+    start_time = benchmark_get_time();
+    for (it = 0; it < num_tokens; it++)
+    {
+        memcpy(&ue_attributes, &protocol->ue_attributes, sizeof(user_attributes_t));
+        r = ue_compute_proof_of_knowledge(NULL, protocol->sys_parameters, protocol->ra_parameters, protocol->ra_signature, protocol->ie_signature, protocol->ra_indices,
+                                          protocol->nonce, sizeof(protocol->nonce), protocol->epoch, sizeof(protocol->epoch), &ue_attributes, 0,
+                                          &ue_credential[it], &ue_pi[it]);
+        if (r < 0)
+        {
+            goto cleanup;
+        }
+    }
+    elapsed_time[0] = benchmark_get_time() - start_time;
+
+    while (ue_token_pool_available(pool) < num_tokens)
+    {
+        nanosleep(&delay, NULL);
+    }
+
+    /// proof of knowledge from the tokens
+    start_time = benchmark_get_time();
+    for (it = 0; it < num_tokens; it++)
+    {
+        r = ue_token_pool_compute_proof_of_knowledge(pool, protocol->nonce, sizeof(protocol->nonce), protocol->epoch, sizeof(protocol->epoch),
+                                                     &ue_attributes, &ue_credential[it], &ue_pi[it]);
+        if (r < 0)
+        {
+            goto cleanup;
+        }
+    }
+    elapsed_time[1] = benchmark_get_time() - start_time;
+
+    benchmark_display("ue_token_pool_compute_proof_of_knowledge", elapsed_time[0], elapsed_time[1], num_tokens);
+
+    /// the proofs computed from the tokens must be valid
+    for (it = 0; it < num_tokens; it++)
+    {
+        r = ve_verify_proof_of_knowledge(protocol->sys_parameters, protocol->ve_parameters, protocol->ra_parameters, protocol->ra_keys.public_key,
+                                         protocol->ie_keys, protocol->nonce, sizeof(protocol->nonce), protocol->epoch, sizeof(protocol->epoch),
+                                         ue_attributes, ue_credential[it], ue_pi[it]);
+        if (r < 0)
+        {
+            fprintf(stderr, "Error: invalid proof of knowledge computed from a token!\n");
+            goto cleanup;
+        }
+    }
+
+cleanup:
+    ue_token_pool_stop(pool);
+    free(pool);
+
+    return r;
+}
+
+/**
+ * Client thread of the verifier service benchmark, sends the same request
+ * several times and checks that all of them are valid.
+ *
+ * @param argument the client
+ * @return NULL
+ */
+static void *benchmark_client(void *argument)
+{
+    benchmark_client_t *client = (benchmark_client_t *) argument;
+
+    struct sockaddr_un address;
+    uint8_t response;
+
+    size_t it;
+    int fd;
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, client->socket_path);
+
+    for (it = 0; it < client->num_requests; it++)
+    {
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0)
+        {
+            client->error = -1;
+            return NULL;
+        }
+
+        if (connect(fd, (struct sockaddr *) &address, sizeof(address)) < 0 ||
+            send(fd, client->request, VERIFIER_SERVICE_REQUEST_LENGTH, 0) != VERIFIER_SERVICE_REQUEST_LENGTH ||
+            recv(fd, &response, sizeof(response), MSG_WAITALL) != sizeof(response) || response != VERIFIER_SERVICE_RESPONSE_VALID)
+        {
+            close(fd);
+            client->error = -1;
+            return NULL;
+        }
+
+        close(fd);
+    }
+
+    return NULL;
+}
+
+/**
+ * Runs the loop of the verifier service.
+ *
+ * @param argument the verifier service
+ * @return NULL
+ */
+static void *benchmark_service(void *argument)
+{
+    ve_service_run((verifier_service_t *) argument);
+
+    return NULL;
+}
+
+/**
+ * Compares the throughput of the verifier service with a single worker and
+ * with one worker per core, with BENCHMARK_NUM_CLIENTS concurrent clients.
+ *
+ * @param protocol the protocol data
+ * @param iterations the number of iterations (requests per client)
+ * @return 0 if success else -1
+ */
+static int benchmark_verifier_service(const benchmark_protocol_t *protocol, size_t iterations)
+{
+    verifier_service_t *service;
+    benchmark_client_t clients[BENCHMARK_NUM_CLIENTS];
+    pthread_t service_thread;
+
+    uint8_t request[VERIFIER_SERVICE_REQUEST_LENGTH];
+    char socket_path[64];
+
+    struct sockaddr_un address;
+    uint8_t response;
+    int stalled_fd;
+
+    double elapsed_time[2];
+    double start_time;
+
+    size_t it, mode;
+    int r;
+
+    fprintf(stdout, "[+] verifier service (1 worker / 1 worker per core)\n");
+
+    r = ve_service_encode_request(request, sizeof(request), protocol->nonce, sizeof(protocol->nonce), protocol->ue_attributes,
+                                  protocol->ue_credential, protocol->ue_pi);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    // the service is too big for the stack
+    service = malloc(sizeof(verifier_service_t));
+    if (service == NULL)
+    {
+        return -1;
+    }
+
+    snprintf(socket_path, sizeof(socket_path), "/tmp/rkvac-protocol-benchmark-%ld.sock", (long) getpid());
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, socket_path);
+
+    for (mode = 0; mode < 2; mode++)
+    {
+        r = ve_service_start(service, protocol->sys_parameters, protocol->ve_parameters, protocol->ra_parameters, protocol->ra_keys.public_key,
+                             protocol->ie_keys, protocol->epoch, sizeof(protocol->epoch), socket_path, mode == 0 ? 1 : 0);
+        if (r < 0)
+        {
+            free(service);
+            return -1;
+        }
+
+        r = pthread_create(&service_thread, NULL, benchmark_service, service);
+        if (r != 0)
+        {
+            ve_service_stop(service);
+            free(service);
+            return -1;
+        }
+
+        // a stalled client (one byte of its request) must not delay the other clients
+        stalled_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (stalled_fd < 0 || connect(stalled_fd, (struct sockaddr *) &address, sizeof(address)) < 0 || send(stalled_fd, request, 1, 0) != 1)
+        {
+            r = -1;
+        }
+
+        start_time = benchmark_get_time();
+        for (it = 0; it < BENCHMARK_NUM_CLIENTS && r == 0; it++)
+        {
+            clients[it].socket_path = socket_path;
+            clients[it].request = request;
+            clients[it].num_requests = iterations;
+            clients[it].error = 0;
+            if (pthread_create(&clients[it].thread, NULL, benchmark_client, &clients[it]) != 0)
+            {
+                clients[it].error = -1;
+                break;
+            }
+        }
+        while (it-- > 0)
+        {
+            pthread_join(clients[it].thread, NULL);
+            if (clients[it].error < 0)
+            {
+                r = -1;
+            }
+        }
+        elapsed_time[mode] = benchmark_get_time() - start_time;
+
+        // the stalled client is dropped once its time is over
+        if (r == 0 && (recv(stalled_fd, &response, sizeof(response), MSG_WAITALL) != sizeof(response) || response != VERIFIER_SERVICE_RESPONSE_MALFORMED))
+        {
+            fprintf(stderr, "Error: the verifier service has not dropped a stalled client!\n");
+            r = -1;
+        }
+        if (stalled_fd >= 0)
+        {
+            close(stalled_fd);
+        }
+
+        ve_service_request_stop(service);
+        pthread_join(service_thread, NULL);
+        ve_service_stop(service);
+
+        if (r < 0)
+        {
+            fprintf(stderr, "Error: the verifier service rejects a valid proof of knowledge!\n");
+            free(service);
+            return -1;
+        }
+    }
+
+    free(service);
+
+    benchmark_display("ve_service_run", elapsed_time[0], elapsed_time[1], BENCHMARK_NUM_CLIENTS * iterations);
+
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    benchmark_protocol_t protocol;
+
+    size_t iterations;
+
+    int opt;
+    int r;
+
+    memset(&protocol, 0, sizeof(benchmark_protocol_t));
+
+    // default number of iterations
+    iterations = 100;
+
+    while ((opt = getopt_long(argc, argv, "i:h", long_options, NULL)) != -1)
+    {
+        switch (opt)
+        {
+            case 'i':
+            {
+                iterations = strtol(optarg, NULL, 10);
+
+                break;
+            }
+            case 'h':
+            {
+                fprintf(stderr, "Usage: %s --iterations=<XX>\n", argv[0]);
+
+                exit(0);
+            }
+            default:
+            {
+                break;
+            }
+        }
+    }
+
+    // check iterations
+    if (iterations == 0)
+    {
+        fprintf(stderr, "Error: invalid number of iterations!\n");
+        return 1;
+    }
+
+    printf("[!] Iterations: %lu\n", iterations);
+
+    r = benchmark_setup(&protocol, 0, 0);
+    if (r < 0)
+    {
+        fprintf(stderr, "Error: cannot run the protocol!\n");
+        return 1;
+    }
+
+    r = benchmark_fixed_base(&protocol, iterations);
+    if (r < 0)
+    {
+        fprintf(stderr, "Error: cannot run the fixed-base benchmark!\n");
+        return 1;
+    }
+
+    r = benchmark_randomizers(&protocol, iterations);
+    if (r < 0)
+    {
+        fprintf(stderr, "Error: cannot run the randomizers benchmark!\n");
+        return 1;
+    }
+
+    r = benchmark_issuer_mac(&protocol, iterations);
+    if (r < 0)
+    {
+        fprintf(stderr, "Error: cannot run the issuer MAC benchmark!\n");
+        return 1;
+    }
+
+    r = benchmark_issuance(&protocol);
+    if (r < 0)
+    {
+        fprintf(stderr, "Error: cannot run the issuance benchmark!\n");
+        return 1;
+    }
+
+    r = benchmark_keystore(&protocol, iterations);
+    if (r < 0)
+    {
+        fprintf(stderr, "Error: cannot run the keystore benchmark!\n");
+        return 1;
+    }
+
+    r = benchmark_cold_start(&protocol, iterations);
+    if (r < 0)
+    {
+        fprintf(stderr, "Error: cannot run the cold start benchmark!\n");
+        return 1;
+    }
+
+    r = benchmark_library(&protocol, iterations);
+    if (r < 0)
+    {
+        fprintf(stderr, "Error: cannot run the library benchmark!\n");
+        return 1;
+    }
+
+    r = benchmark_conversions(&protocol, iterations);
+    if (r < 0)
+    {
+        fprintf(stderr, "Error: cannot run the conversions benchmark!\n");
+        return 1;
+    }
+
+    r = benchmark_verifier_kernels(&protocol, iterations);
+    if (r < 0)
+    {
+        fprintf(stderr, "Error: cannot run the verification kernels benchmark!\n");
+        return 1;
+    }
+
+    r = benchmark_pairing_modes(&protocol, iterations);
+    if (r < 0)
+    {
+        fprintf(stderr, "Error: cannot run the pairing modes benchmark!\n");
+        return 1;
+    }
+
+    r = benchmark_batch_verification(&protocol);
+    if (r < 0)
+    {
+        fprintf(stderr, "Error: cannot run the batch verification benchmark!\n");
+        return 1;
+    }
+
+    r = benchmark_parallel_verification(&protocol, iterations);
+    if (r < 0)
+    {
+        fprintf(stderr, "Error: cannot run the parallel verification benchmark!\n");
+        return 1;
+    }
+
+    r = benchmark_revocation_list(&protocol, iterations);
+    if (r < 0)
+    {
+        fprintf(stderr, "Error: cannot run the revocation list benchmark!\n");
+        return 1;
+    }
+
+    r = benchmark_revoked_pseudonyms(&protocol, iterations);
+    if (r < 0)
+    {
+        fprintf(stderr, "Error: cannot run the revoked pseudonyms benchmark!\n");
+        return 1;
+    }
+
+    r = benchmark_revocation_database(&protocol, iterations);
+    if (r < 0)
+    {
+        fprintf(stderr, "Error: cannot run the revocation database benchmark!\n");
+        return 1;
+    }
+
+    r = benchmark_revocation_snapshot(&protocol, iterations);
+    if (r < 0)
+    {
+        fprintf(stderr, "Error: cannot run the revocation snapshot benchmark!\n");
+        return 1;
+    }
+
+    r = benchmark_revocation_delta(&protocol, iterations);
+    if (r < 0)
+    {
+        fprintf(stderr, "Error: cannot run the revocation delta benchmark!\n");
+        return 1;
+    }
+
+    r = benchmark_revocation_shared(&protocol, iterations);
+    if (r < 0)
+    {
+        fprintf(stderr, "Error: cannot run the shared revocation list benchmark!\n");
+        return 1;
+    }
+
+    r = benchmark_pseudonym_cache(&protocol, iterations);
+    if (r < 0)
+    {
+        fprintf(stderr, "Error: cannot run the pseudonym cache benchmark!\n");
+        return 1;
+    }
+
+    r = benchmark_token_pool(&protocol, iterations);
+    if (r < 0)
+    {
+        fprintf(stderr, "Error: cannot run the token pool benchmark!\n");
+        return 1;
+    }
+
+    r = benchmark_verifier_service(&protocol, iterations);
+    if (r < 0)
+    {
+        fprintf(stderr, "Error: cannot run the verifier service benchmark!\n");
+        return 1;
+    }
+
+    benchmark_cleanup(&protocol);
+
+    return 0;
+}
@@ -58,15 +58,84 @@ extern "C"
 #define USER_MAX_NUM_ATTRIBUTES 9
 
 /*
- * Value k of the revocation authority, used by randomizers
+ * Number of presentation tokens precomputed by the user token pool
+ */
+#define USER_TOKEN_POOL_SIZE 16
+
+/*
+ * Number of (credential, randomizer combination) pseudonyms cached by the user for the current epoch
+ */
+#define USER_PSEUDONYM_CACHE_SIZE 8
+
+/*
+ * Default value k of the revocation authority, used by randomizers
+ * (the value is chosen at runtime by ra_setup, the MULTOS card only supports the default)
  */
 #define REVOCATION_AUTHORITY_VALUE_K 10
 
 /*
- * Value j of the revocation authority, used by alphas
+ * Default value j of the revocation authority, used by alphas
+ * (the value is chosen at runtime by ra_setup, the MULTOS card only supports the default)
  */
 #define REVOCATION_AUTHORITY_VALUE_J 2
 
+/*
+ * Maximum value j of the revocation authority (randomizers selected by the user)
+ */
+#define REVOCATION_AUTHORITY_MAX_J 8
+
+/*
+ * Number of credentials checked and signed together by the batch issuance
+ * (written to the output once the whole chunk is signed)
+ */
+#define ISSUER_BATCH_CHUNK_SIZE 1024
+
+/*
+ * Length in bytes of the random weights used by the batch issuance
+ */
+#define ISSUER_BATCH_WEIGHT_LENGTH 8
+
+/*
+ * Length in bytes of the random weights used by the batch verification
+ */
+#define VERIFIER_BATCH_WEIGHT_LENGTH 8
+
+/*
+ * Number of threads used by the parallel verification of a single proof
+ * (plus the calling thread, one per t value)
+ */
+#define VERIFIER_NUM_THREADS 4
+
+/*
+ * Maximum number of requests verified together by a worker of the verifier service
+ */
+#define VERIFIER_SERVICE_BATCH_SIZE 16
+
+/*
+ * Capacity of the request queue of the verifier service (must be a power of two)
+ */
+#define VERIFIER_SERVICE_QUEUE_SIZE 1024
+
+/*
+ * Maximum number of connections whose requests are being received by the verifier service
+ */
+#define VERIFIER_SERVICE_MAX_CONNECTIONS 256
+
+/*
+ * Time given to a client of the verifier service to send its whole request (milliseconds)
+ */
+#define VERIFIER_SERVICE_RECEIVE_TIMEOUT 1000
+
+/*
+ * Bits of the Bloom filter of the revocation list per revoked pseudonym
+ */
+#define REVOCATION_LIST_BITS_PER_ENTRY 16
+
+/*
+ * Maximum number of threads reading the revocation list snapshot at the same time
+ */
+#define REVOCATION_SNAPSHOT_MAX_READERS 64
+
 #ifdef __cplusplus
 }
 #endif
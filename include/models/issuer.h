@@ -27,14 +27,21 @@ extern "C"
 #endif
 
 #include <stddef.h>
+#include <stdint.h>
 
 #include <mcl/bn_c256.h>
 
 #include "config/config.h"
+#include "system.h"
+#include "types.h"
 
 typedef struct
 {
     size_t num_attributes;
+
+    uint64_t *G2_precomputed; // line coefficients of G2
+    uint64_t *pk_precomputed; // line coefficients of the revocation authority public key
+    mclBnGT G1_G2_pairing; // e(G1, G2), valid if the line coefficients are precomputed
 } issuer_par_t;
 
 typedef struct
@@ -56,6 +63,28 @@ typedef struct
     mclBnG1 revocation_sigma; // sigma x(r)
 } issuer_signature_t;
 
+typedef struct
+{
+    uint64_t index; // index of the credential in the batch
+    elliptic_curve_point_t sigma;
+    elliptic_curve_point_t attribute_sigmas[USER_MAX_NUM_ATTRIBUTES]; // unused slots are zeros
+    elliptic_curve_point_t revocation_sigma;
+} issuer_signature_record_t;
+
+typedef struct
+{
+    const system_par_t *sys_parameters;
+    const issuer_keys_t *keys;
+    size_t num_attributes;
+
+    const mclBnFr *denominators; // x(0) + m(1)·x(1) + ... + m(r)·x(r), 1 if not signed
+    int *results; // only the credentials whose result is 0 are signed
+    issuer_signature_t *signatures;
+
+    size_t first, last; // range [first, last) of credentials
+    mclBnFr *products; // prefix products of the batch inversion
+} issuer_signatures_task_t;
+
 #ifdef __cplusplus
 }
 #endif
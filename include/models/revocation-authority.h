@@ -31,16 +31,20 @@ extern "C"
 #include <mcl/bn_c256.h>
 
 #include "config/config.h"
+#include "system.h"
+#include "types.h"
 
 typedef struct
 {
     size_t k, j;
 
-    mclBnFr alphas[REVOCATION_AUTHORITY_VALUE_J]; // alpha_j
-    mclBnG1 alphas_mul[REVOCATION_AUTHORITY_VALUE_J]; // h_j = G1 * alpha_j
+    mclBnFr alphas[REVOCATION_AUTHORITY_MAX_J]; // alpha_j (first j used)
+    mclBnG1 alphas_mul[REVOCATION_AUTHORITY_MAX_J]; // h_j = G1 * alpha_j
+    fixed_base_table_t *alphas_mul_tables[REVOCATION_AUTHORITY_MAX_J]; // fixed-base tables of h_j
 
-    mclBnFr randomizers[REVOCATION_AUTHORITY_VALUE_K];  // e_k
-    mclBnG1 randomizers_sigma[REVOCATION_AUTHORITY_VALUE_K]; // sigma_e_k
+    // structure of arrays, k values each (allocated by ra_setup, released by ra_cleanup)
+    mclBnFr *randomizers;  // e_k
+    mclBnG1 *randomizers_sigma; // sigma_e_k
 } revocation_authority_par_t;
 
 typedef struct
@@ -65,6 +69,32 @@ typedef struct
     mclBnG1 sigma;
 } revocation_authority_signature_t;
 
+typedef struct
+{
+    const system_par_t *sys_parameters;
+    const mclBnFr *revoked_mr; // mr of the revoked users
+    mclBnFr i_hash; // i + H(epoch)
+
+    size_t first, last; // range [first, last) of revoked users
+    mclBnFr *products; // prefix products of the batch inversion
+    uint8_t *keys; // keys of the revoked pseudonyms (REVOCATION_LIST_KEY_LENGTH bytes each)
+
+    int result;
+} revocation_authority_pseudonyms_task_t;
+
+typedef struct
+{
+    const system_par_t *sys_parameters;
+    const mclBnFr *sk; // revocation authority private key
+    const mclBnFr *randomizers; // e_k
+    mclBnG1 *randomizers_sigma; // sigma_e_k
+
+    size_t first, last; // range [first, last) of randomizers
+    mclBnFr *products; // prefix products of the batch inversion
+
+    int result;
+} revocation_authority_randomizers_task_t;
+
 #ifdef __cplusplus
 }
 #endif
@@ -30,10 +30,16 @@ extern "C"
 #include <stddef.h>
 #include <stdint.h>
 
+#include <pthread.h>
+
 #include <mcl/bn_c256.h>
 
 #include "config/config.h"
 
+#include "models/issuer.h"
+#include "models/revocation-authority.h"
+#include "system.h"
+
 typedef struct
 {
     uint8_t buffer[USER_MAX_ID_LENGTH];
@@ -54,10 +60,9 @@ typedef struct
 {
     mclBnG1 pseudonym; // C
     mclBnG1 sigma_hat;
-    mclBnG1 sigma_hat_e1;
-    mclBnG1 sigma_hat_e2;
-    mclBnG1 sigma_minus_e1;
-    mclBnG1 sigma_minus_e2;
+    mclBnG1 sigma_hat_e[REVOCATION_AUTHORITY_MAX_J]; // sigma_hat_e1...sigma_hat_ej
+    mclBnG1 sigma_minus_e[REVOCATION_AUTHORITY_MAX_J]; // sigma_minus_e1...sigma_minus_ej
+    size_t num_randomizers; // j
 } user_credential_t;
 
 typedef struct
@@ -67,10 +72,75 @@ typedef struct
     mclBnFr s_v;
     mclBnFr s_mr;
     mclBnFr s_i;
-    mclBnFr s_e1;
-    mclBnFr s_e2;
+    mclBnFr s_e[REVOCATION_AUTHORITY_MAX_J]; // s_e1...s_ej
 } user_pi_t;
 
+typedef struct
+{
+    user_credential_t credential;
+
+    // t values
+    mclBnG1 t_verify;
+    mclBnG1 t_revoke;
+    mclBnG1 t_sig;
+    mclBnG1 t_sig_e[REVOCATION_AUTHORITY_MAX_J]; // t_sig1...t_sigj
+
+    // rho random numbers
+    mclBnFr rho;
+    mclBnFr rho_v;
+    mclBnFr rho_i;
+    mclBnFr rho_mr;
+    mclBnFr rho_e[REVOCATION_AUTHORITY_MAX_J]; // rho_e1...rho_ej
+    mclBnFr rho_mz[USER_MAX_NUM_ATTRIBUTES]; // rho non-disclosed attributes
+
+    // secrets used by the s values
+    mclBnFr i;
+    mclBnFr mr;
+    mclBnFr randomizers[REVOCATION_AUTHORITY_MAX_J]; // e1...ej
+
+    uint8_t epoch[EPOCH_LENGTH]; // epoch the pseudonym was computed for
+} user_token_t;
+
+typedef struct
+{
+    uint8_t epoch[EPOCH_LENGTH]; // epoch of the cached pseudonyms
+    mclBnFr epoch_hash; // H(epoch)
+    bool valid;
+
+    struct pseudonym_cache_entry_t
+    {
+        mclBnFr mr; // revocation attribute (credential)
+        mclBnFr i; // sum(alpha_j·e_j) (randomizer combination)
+        mclBnG1 pseudonym; // C
+    } entries[USER_PSEUDONYM_CACHE_SIZE];
+    size_t num_entries;
+    size_t next_entry; // entry to be replaced when the cache is full
+} user_pseudonym_cache_t;
+
+typedef struct
+{
+    // parameters used to compute the tokens
+    system_par_t sys_parameters;
+    revocation_authority_par_t ra_parameters;
+    revocation_authority_signature_t ra_signature;
+    issuer_signature_t ie_signature;
+    size_t indices[REVOCATION_AUTHORITY_MAX_J]; // selected randomizers
+    uint8_t epoch[EPOCH_LENGTH];
+    user_attributes_t attributes; // disclosed attributes already marked
+
+    user_token_t tokens[USER_TOKEN_POOL_SIZE]; // circular buffer
+    size_t head; // next token to be consumed
+    size_t num_tokens;
+
+    bool running;
+    int error;
+
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+} user_token_pool_t;
+
 #ifdef __cplusplus
 }
 #endif
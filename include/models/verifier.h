@@ -26,7 +26,115 @@ extern "C"
 {
 #endif
 
-// nothing here
+#include <stddef.h>
+#include <stdint.h>
+
+#include <mcl/bn_c256.h>
+
+#include "models/issuer.h"
+#include "models/revocation-authority.h"
+#include "models/user.h"
+#include "revocation/list.h"
+#include "revocation/shared.h"
+#include "revocation/snapshot.h"
+#include "system.h"
+#include "thread/pool.h"
+
+typedef enum
+{
+    VERIFIER_PAIRING_MODE_DEFAULT = 0, // e(sigma_minus, G2) ?= e(sigma_hat, pk), two pairings per randomizer
+    VERIFIER_PAIRING_MODE_MULTI_PAIRING, // e(sigma_minus, G2) · e(-sigma_hat, pk) ?= 1, one multi-Miller loop
+    VERIFIER_PAIRING_MODE_DESIGNATED // sigma_minus ?= sigma_hat·sk, no pairings (requires the revocation authority private key)
+} verifier_pairing_mode_t;
+
+typedef enum
+{
+    VERIFIER_KERNEL_FOLDED = 0, // scalars accumulated in Fr, two multiplications for t_verify and t_revoke
+    VERIFIER_KERNEL_REFERENCE // one multiplication per term, as defined by the protocol
+} verifier_kernel_t;
+
+typedef struct
+{
+    double t_values; // wall-clock time of the t values stage
+    double t_values_critical_path; // longest t value
+    double challenge; // hash of the t values
+    double pairings; // wall-clock time of the pairings stage
+    double pairings_critical_path; // longest pairing (or multiplication)
+} verifier_profile_t;
+
+typedef struct
+{
+    verifier_pairing_mode_t pairing_mode;
+    verifier_kernel_t kernel;
+
+    uint64_t *G2_precomputed; // line coefficients of G2
+    uint64_t *pk_precomputed; // line coefficients of the revocation authority public key
+
+    revocation_authority_private_key_t ra_private_key; // designated verifier only
+
+    const revocation_list_t *revocation_list; // revoked pseudonyms of the epoch or NULL
+    revocation_snapshot_t *revocation_snapshot; // published revocation lists or NULL (replaces revocation_list)
+    size_t revocation_reader; // reader slot of the snapshot
+    const revocation_shared_t *revocation_shared; // revocation list shared by the processes of the host or NULL
+
+    thread_pool_t *thread_pool; // fork-join pool of the single proof verification or NULL
+    verifier_profile_t *profile; // stage times of the last verification or NULL
+} verifier_par_t;
+
+typedef struct
+{
+    mclBnG1 t_verify;
+    mclBnG1 t_revoke;
+    mclBnG1 t_sig;
+    mclBnG1 t_sig_e[REVOCATION_AUTHORITY_MAX_J]; // t_sig1...t_sigj
+} verifier_t_values_t;
+
+typedef struct
+{
+    const system_par_t *sys_parameters;
+    const revocation_authority_par_t *ra_parameters;
+    const issuer_keys_t *ie_keys;
+    const user_attributes_t *attributes;
+    const user_credential_t *ue_credential;
+    const user_pi_t *ue_pi;
+
+    mclBnFr fr_hash; // H(epoch)
+    mclBnFr neg_e; // -e
+    mclBnG1 g1_s_v; // G1·s_v, shared by t_verify and t_sig1...t_sigj
+
+    verifier_t_values_t *t_values;
+} verifier_kernel_context_t;
+
+typedef struct
+{
+    const verifier_kernel_context_t *context;
+    size_t index; // randomizer of the t_sig value
+} verifier_kernel_randomizer_t;
+
+typedef struct
+{
+    mclBnGT result;
+    const mclBnG1 *x;
+    const mclBnG2 *y;
+    const uint64_t *y_precomputed; // line coefficients of y or NULL
+} verifier_pairing_t;
+
+typedef struct
+{
+    mclBnG1 result;
+    const mclBnG1 *x;
+    const mclBnFr *y;
+} verifier_multiplication_t;
+
+typedef struct
+{
+    const void *nonce; // nonce generated by the verifier for this proof
+    size_t nonce_length;
+
+    user_attributes_t attributes;
+    user_credential_t ue_credential;
+    user_pi_t ue_pi;
+} verifier_proof_t;
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,272 @@
+/**
+ *
+ *  Copyright (C) 2020  Raul Casanova Marques
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __RKVAC_PROTOCOL_RKVAC_H_
+#define __RKVAC_PROTOCOL_RKVAC_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stddef.h>
+
+/*
+ * Version of the librkvac interface (the major version changes with the ABI)
+ */
+#define RKVAC_VERSION_MAJOR 2
+#define RKVAC_VERSION_MINOR 0
+
+/*
+ * Lengths of the values exchanged with the library
+ */
+#define RKVAC_NONCE_LENGTH 32
+#define RKVAC_EPOCH_LENGTH 4
+#define RKVAC_IDENTIFIER_LENGTH 21
+#define RKVAC_ATTRIBUTE_LENGTH 32
+
+/*
+ * Entities of the protocol (opaque)
+ */
+typedef struct rkvac_revocation_authority rkvac_revocation_authority_t;
+typedef struct rkvac_issuer rkvac_issuer_t;
+typedef struct rkvac_user rkvac_user_t;
+typedef struct rkvac_verifier rkvac_verifier_t;
+
+/*
+ * IMPORTANT!
+ *
+ * librkvac exports the revocation authority, the issuer, the user (PC) and the
+ * verifier as opaque entities, the proofs of knowledge are exchanged encoded
+ * (the request format of the verifier service, rkvac_proof_length bytes). mcl
+ * keeps the curve in a global state and all the entities share the system
+ * parameters, so the library must be initialized (rkvac_init) before any other
+ * call and released (rkvac_teardown) once the entities have been destroyed.
+ * Both are reference counted: each rkvac_init must be paired with a rkvac_teardown.
+ *
+ * The calls taking a const entity (e.g. rkvac_ve_verify) only read it and can
+ * run at the same time on the same entity. The calls modifying an entity
+ * (rkvac_ra_revoke, rkvac_ue_set_attribute, rkvac_ra_mac and rkvac_ie_issue on
+ * the user, rkvac_ve_set_epoch) must not overlap with any other call on it, so
+ * a verifier whose epoch changes while verifying must not be shared: use one
+ * verifier per thread. An entity must outlive the entities created from it
+ * (the issuer and the verifier keep their revocation authority and issuer).
+ */
+
+/**
+ * Initializes mcl and the system parameters shared by all the entities.
+ * The parameters are loaded from the blob if it is valid, otherwise they are
+ * computed (and stored in the blob for the next processes if it can be written).
+ *
+ * @param parameters_path the path of the system parameters blob or NULL
+ * @return 0 if success else -1
+ */
+extern int rkvac_init(const char *parameters_path);
+
+/**
+ * Releases the system parameters and the user pseudonym cache when the
+ * last initialization is released.
+ */
+extern void rkvac_teardown(void);
+
+/**
+ * Gets the length of an encoded proof of knowledge.
+ *
+ * @return the length of the proof
+ */
+extern size_t rkvac_proof_length(void);
+
+/**
+ * Creates a revocation authority: generates its keys and k randomizers
+ * and precomputes its fixed-base tables.
+ *
+ * @param k the number of randomizers (0 - default)
+ * @param j the number of randomizers selected by the user (0 - default)
+ * @return the revocation authority or NULL if error
+ */
+extern rkvac_revocation_authority_t *rkvac_ra_create(size_t k, size_t j);
+
+/**
+ * Destroys a revocation authority.
+ *
+ * @param ra the revocation authority
+ */
+extern void rkvac_ra_destroy(rkvac_revocation_authority_t *ra);
+
+/**
+ * Computes the MAC of the identifier of the user, which gets its revocation attribute.
+ *
+ * @param ra the revocation authority
+ * @param user the user
+ * @return 0 if success else -1
+ */
+extern int rkvac_ra_mac(const rkvac_revocation_authority_t *ra, rkvac_user_t *user);
+
+/**
+ * Revokes a user, its pseudonyms are in the revocation lists of the next
+ * epochs (see rkvac_ve_set_epoch).
+ *
+ * @param ra the revocation authority
+ * @param user the user (with the MAC of the revocation authority)
+ * @return 0 if success else -1
+ */
+extern int rkvac_ra_revoke(rkvac_revocation_authority_t *ra, const rkvac_user_t *user);
+
+/**
+ * Creates an issuer of credentials with num_attributes attributes
+ * accepting the users of the revocation authority.
+ *
+ * @param ra the revocation authority
+ * @param num_attributes the number of user attributes
+ * @return the issuer or NULL if error
+ */
+extern rkvac_issuer_t *rkvac_ie_create(const rkvac_revocation_authority_t *ra, size_t num_attributes);
+
+/**
+ * Destroys an issuer.
+ *
+ * @param ie the issuer
+ */
+extern void rkvac_ie_destroy(rkvac_issuer_t *ie);
+
+/**
+ * Verifies the MAC of the revocation authority on the user identifier and
+ * signs the attributes of the user.
+ *
+ * @param ie the issuer
+ * @param user the user
+ * @return 0 if success else -1
+ */
+extern int rkvac_ie_issue(const rkvac_issuer_t *ie, rkvac_user_t *user);
+
+/**
+ * Creates a user.
+ *
+ * @param identifier the identifier of the user (RKVAC_IDENTIFIER_LENGTH) or NULL (identifier of the device)
+ * @param identifier_length the length of the identifier
+ * @param num_attributes the number of attributes (the values of the device by default)
+ * @return the user or NULL if error
+ */
+extern rkvac_user_t *rkvac_ue_create(const void *identifier, size_t identifier_length, size_t num_attributes);
+
+/**
+ * Destroys a user.
+ *
+ * @param user the user
+ */
+extern void rkvac_ue_destroy(rkvac_user_t *user);
+
+/**
+ * Sets the value of an attribute of the user (before the credential is issued).
+ *
+ * @param user the user
+ * @param index the index of the attribute
+ * @param value the value of the attribute (big-endian, lower than the order of the group)
+ * @param value_length the length of the value (RKVAC_ATTRIBUTE_LENGTH)
+ * @return 0 if success else -1
+ */
+extern int rkvac_ue_set_attribute(rkvac_user_t *user, size_t index, const void *value, size_t value_length);
+
+/**
+ * Computes the proof of knowledge of the credential of the user disclosing
+ * its last num_disclosed_attributes attributes.
+ *
+ * @param user the user (with its credential)
+ * @param ra the revocation authority
+ * @param nonce the nonce generated by the verifier
+ * @param nonce_length the length of the nonce (RKVAC_NONCE_LENGTH)
+ * @param epoch the epoch generated by the verifier
+ * @param epoch_length the length of the epoch (RKVAC_EPOCH_LENGTH)
+ * @param num_disclosed_attributes the number of disclosed attributes
+ * @param proof the buffer where the encoded proof will be stored
+ * @param proof_length the length of the buffer (rkvac_proof_length)
+ * @return 0 if success else -1
+ */
+extern int rkvac_ue_compute_proof(const rkvac_user_t *user, const rkvac_revocation_authority_t *ra, const void *nonce, size_t nonce_length,
+                                  const void *epoch, size_t epoch_length, size_t num_disclosed_attributes, void *proof, size_t proof_length);
+
+/**
+ * Creates a verifier of the credentials of the issuer.
+ *
+ * @param ra the revocation authority
+ * @param ie the issuer
+ * @return the verifier or NULL if error
+ */
+extern rkvac_verifier_t *rkvac_ve_create(const rkvac_revocation_authority_t *ra, const rkvac_issuer_t *ie);
+
+/**
+ * Destroys a verifier.
+ *
+ * @param ve the verifier
+ */
+extern void rkvac_ve_destroy(rkvac_verifier_t *ve);
+
+/**
+ * Generates a nonce and an epoch to be used in the proof of knowledge.
+ *
+ * @param nonce the nonce
+ * @param nonce_length the length of the nonce (RKVAC_NONCE_LENGTH)
+ * @param epoch the epoch
+ * @param epoch_length the length of the epoch (RKVAC_EPOCH_LENGTH)
+ * @return 0 if success else -1
+ */
+extern int rkvac_ve_generate_nonce_epoch(void *nonce, size_t nonce_length, void *epoch, size_t epoch_length);
+
+/**
+ * Sets the epoch of the verifier and computes its revocation list from the
+ * users revoked by the revocation authority.
+ *
+ * @param ve the verifier
+ * @param epoch the epoch
+ * @param epoch_length the length of the epoch (RKVAC_EPOCH_LENGTH)
+ * @return 0 if success else -1
+ */
+extern int rkvac_ve_set_epoch(rkvac_verifier_t *ve, const void *epoch, size_t epoch_length);
+
+/**
+ * Verifies an encoded proof of knowledge computed for the nonce and the
+ * epoch of the verifier.
+ *
+ * @param ve the verifier
+ * @param nonce the nonce
+ * @param nonce_length the length of the nonce (RKVAC_NONCE_LENGTH)
+ * @param proof the encoded proof
+ * @param proof_length the length of the proof (rkvac_proof_length)
+ * @return 0 if valid else -1
+ */
+extern int rkvac_ve_verify(const rkvac_verifier_t *ve, const void *nonce, size_t nonce_length, const void *proof, size_t proof_length);
+
+/**
+ * Verifies several encoded proofs of knowledge of the epoch of the verifier at
+ * once (each proof carries its own nonce, it must be checked by the caller).
+ *
+ * @param ve the verifier
+ * @param proofs the encoded proofs, one after the other
+ * @param num_proofs the number of proofs
+ * @param results the result of each proof (0 if valid else -1)
+ * @return 0 if all the proofs are valid else -1
+ */
+extern int rkvac_ve_verify_batch(const rkvac_verifier_t *ve, const void *proofs, size_t num_proofs, int *results);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RKVAC_PROTOCOL_RKVAC_H_ */
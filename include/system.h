@@ -26,14 +26,21 @@ extern "C"
 {
 #endif
 
+#include <stdint.h>
+
 #include <mcl/bn_c256.h>
 
+#include "types.h"
+
 typedef struct
 {
     int curve;
 
     mclBnG1 G1;
     mclBnG2 G2;
+
+    fixed_base_table_t *G1_table; // fixed-base table of G1
+    uint64_t *G2_precomputed; // line coefficients of G2 (copied by the issuer and the verifier)
 } system_par_t;
 
 #ifdef __cplusplus
@@ -65,6 +65,11 @@ typedef struct
     elliptic_curve_fr_t ecm; // 32B
 } elliptic_curve_multiplier_t;
 
+/*
+ * Fixed-base precomputation table of a G1 point (see helpers/fixed_base_helper.h)
+ */
+typedef struct fixed_base_table fixed_base_table_t;
+
 #ifdef __cplusplus
 }
 #endif
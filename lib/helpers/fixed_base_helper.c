@@ -0,0 +1,210 @@
+/**
+ *
+ *  Copyright (C) 2020  Raul Casanova Marques
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "fixed_base_helper.h"
+
+/**
+ * Precomputes the fixed-base table of a G1 point. The table must be
+ * released using fixed_base_free().
+ *
+ * @param table the table to be computed
+ * @param base the base point
+ * @return 0 if success else -1
+ */
+int fixed_base_precompute(fixed_base_table_t **table, const mclBnG1 *base)
+{
+    mclBnG1 window_base; // 2^(8·w)·base
+    mclBnG1 *points;
+
+    size_t window, digit;
+
+    if (table == NULL || base == NULL)
+    {
+        return -1;
+    }
+
+    *table = malloc(sizeof(fixed_base_table_t));
+    if (*table == NULL)
+    {
+        return -1;
+    }
+
+    mclBnG1_normalize(&(*table)->base, base);
+
+    memcpy(&window_base, &(*table)->base, sizeof(mclBnG1));
+    for (window = 0; window < FIXED_BASE_NUM_WINDOWS; window++)
+    {
+        points = &(*table)->points[window * FIXED_BASE_WINDOW_VALUES];
+
+        // points[d - 1] = d·window_base
+        memcpy(&points[0], &window_base, sizeof(mclBnG1));
+        for (digit = 1; digit < FIXED_BASE_WINDOW_VALUES; digit++)
+        {
+            mclBnG1_add(&points[digit], &points[digit - 1], &window_base);
+            mclBnG1_normalize(&points[digit], &points[digit]);
+        }
+
+        // window_base = 2^8·window_base
+        mclBnG1_add(&window_base, &points[FIXED_BASE_WINDOW_VALUES - 1], &window_base);
+        mclBnG1_normalize(&window_base, &window_base);
+    }
+
+    return 0;
+}
+
+/**
+ * Adds base·y to the accumulator using the fixed-base table of the base point.
+ *
+ * @param result the accumulator
+ * @param table the fixed-base table of the base point
+ * @param y the scalar
+ * @return 0 if success else -1
+ */
+static int fixed_base_accumulate(mclBnG1 *result, const fixed_base_table_t *table, const mclBnFr *y)
+{
+    uint8_t digits[FIXED_BASE_NUM_WINDOWS] = {0}; // little-endian scalar
+    mclSize digits_length;
+
+    size_t window;
+
+    digits_length = mclBnFr_serialize(digits, sizeof(digits), y);
+    if (digits_length == 0)
+    {
+        return -1;
+    }
+
+    for (window = 0; window < digits_length; window++)
+    {
+        if (digits[window] != 0)
+        {
+            mclBnG1_add(result, result, &table->points[window * FIXED_BASE_WINDOW_VALUES + digits[window] - 1]);
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Computes z = base·y using the fixed-base table of the base point. If the
+ * table is not available, the multiplication is done by mclBnG1_mul.
+ *
+ * @param z the result of the multiplication
+ * @param base the base point
+ * @param table the fixed-base table of the base point or NULL
+ * @param y the scalar
+ */
+void fixed_base_mul(mclBnG1 *z, const mclBnG1 *base, const fixed_base_table_t *table, const mclBnFr *y)
+{
+    mclBnG1 result;
+
+    int r;
+
+    if (table == NULL)
+    {
+        mclBnG1_mul(z, base, y);
+        return;
+    }
+
+    mclBnG1_clear(&result);
+    r = fixed_base_accumulate(&result, table, y);
+    if (r < 0)
+    {
+        mclBnG1_mul(z, base, y);
+        return;
+    }
+
+    memcpy(z, &result, sizeof(mclBnG1));
+}
+
+/**
+ * Computes the multi-scalar multiplication z = sum(bases(i)·y(i)). The terms
+ * whose fixed-base table is available share a single accumulator (no
+ * doublings), the rest of them are computed at once by mclBnG1_mulVec.
+ *
+ * @param z the result of the multiplication
+ * @param bases the base points
+ * @param tables the fixed-base tables of the base points (each of them or all can be NULL)
+ * @param y the scalars
+ * @param n the number of terms
+ * @return 0 if success else -1
+ */
+int fixed_base_mul_vec(mclBnG1 *z, const mclBnG1 *bases, fixed_base_table_t *const *tables, const mclBnFr *y, size_t n)
+{
+    mclBnG1 *points = NULL; // terms without table
+    mclBnFr *scalars = NULL;
+    size_t num_points;
+
+    mclBnG1 result, mul_result;
+
+    size_t it;
+    int r;
+
+    if (z == NULL || bases == NULL || y == NULL || n == 0)
+    {
+        return -1;
+    }
+
+    points = malloc(n * sizeof(mclBnG1));
+    scalars = malloc(n * sizeof(mclBnFr));
+    if (points == NULL || scalars == NULL)
+    {
+        r = -1;
+        goto cleanup;
+    }
+
+    mclBnG1_clear(&result);
+    num_points = 0;
+    for (it = 0; it < n; it++)
+    {
+        if (tables != NULL && tables[it] != NULL && fixed_base_accumulate(&result, tables[it], &y[it]) == 0)
+        {
+            continue;
+        }
+
+        memcpy(&points[num_points], &bases[it], sizeof(mclBnG1));
+        memcpy(&scalars[num_points], &y[it], sizeof(mclBnFr));
+        num_points++;
+    }
+
+    if (num_points > 0)
+    {
+        mclBnG1_mulVec(&mul_result, points, scalars, num_points);
+        mclBnG1_add(&result, &result, &mul_result);
+    }
+
+    memcpy(z, &result, sizeof(mclBnG1));
+    r = 0;
+
+cleanup:
+    free(points);
+    free(scalars);
+
+    return r;
+}
+
+/**
+ * Releases a fixed-base table.
+ *
+ * @param table the table to be released
+ */
+void fixed_base_free(fixed_base_table_t *table)
+{
+    free(table);
+}
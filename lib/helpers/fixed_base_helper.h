@@ -0,0 +1,106 @@
+/**
+ *
+ *  Copyright (C) 2020  Raul Casanova Marques
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __RKVAC_PROTOCOL_FIXED_BASE_HELPER_H_
+#define __RKVAC_PROTOCOL_FIXED_BASE_HELPER_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <mcl/bn_c256.h>
+
+#include "config/config.h"
+#include "types.h"
+
+/*
+ * IMPORTANT!
+ *
+ * The scalar is split into EC_SIZE windows of 8 bits. For each window w the
+ * table stores the points d·2^(8·w)·base (d = 1...255) in affine coordinates,
+ * so a multiplication costs at most EC_SIZE mixed additions and no doublings.
+ * Each table takes EC_SIZE·255 points of sizeof(mclBnG1) = 96 B (~783 KB).
+ *
+ * The table lookups depend on the value of the scalar, i.e., the
+ * multiplication is not constant-time (neither is mclBnG1_mul).
+ */
+#define FIXED_BASE_WINDOW_BITS 8
+#define FIXED_BASE_WINDOW_VALUES ((1u << FIXED_BASE_WINDOW_BITS) - 1)
+#define FIXED_BASE_NUM_WINDOWS EC_SIZE
+
+struct fixed_base_table
+{
+    mclBnG1 base;
+    mclBnG1 points[FIXED_BASE_NUM_WINDOWS * FIXED_BASE_WINDOW_VALUES];
+};
+
+/**
+ * Precomputes the fixed-base table of a G1 point. The table must be
+ * released using fixed_base_free().
+ *
+ * @param table the table to be computed
+ * @param base the base point
+ * @return 0 if success else -1
+ */
+extern int fixed_base_precompute(fixed_base_table_t **table, const mclBnG1 *base);
+
+/**
+ * Computes z = base·y using the fixed-base table of the base point. If the
+ * table is not available, the multiplication is done by mclBnG1_mul.
+ *
+ * @param z the result of the multiplication
+ * @param base the base point
+ * @param table the fixed-base table of the base point or NULL
+ * @param y the scalar
+ */
+extern void fixed_base_mul(mclBnG1 *z, const mclBnG1 *base, const fixed_base_table_t *table, const mclBnFr *y);
+
+/**
+ * Computes the multi-scalar multiplication z = sum(bases(i)·y(i)). The terms
+ * whose fixed-base table is available share a single accumulator (no
+ * doublings), the rest of them are computed at once by mclBnG1_mulVec.
+ *
+ * @param z the result of the multiplication
+ * @param bases the base points
+ * @param tables the fixed-base tables of the base points (each of them or all can be NULL)
+ * @param y the scalars
+ * @param n the number of terms
+ * @return 0 if success else -1
+ */
+extern int fixed_base_mul_vec(mclBnG1 *z, const mclBnG1 *bases, fixed_base_table_t *const *tables, const mclBnFr *y, size_t n);
+
+/**
+ * Releases a fixed-base table.
+ *
+ * @param table the table to be released
+ */
+extern void fixed_base_free(fixed_base_table_t *table);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RKVAC_PROTOCOL_FIXED_BASE_HELPER_H_ */
@@ -21,49 +21,68 @@
 #include "hash_helper.h"
 
 /**
- * Gets the size of a elliptic curve point depending on the
- * platform for which the software has been compiled.
+ * Updates the hash with the canonical encoding of a elliptic curve point,
+ * the affine point 0x04 || x || y (big-endian), which is also the format
+ * used by the smart card (elliptic_curve_point_t). The same encoding must
+ * be used by the user and the verifier on every platform.
  *
- * @return the size of the point
+ * @param ctx the hash context
+ * @param x mclBnG1 data
+ * @return 0 if success else -1
  */
-size_t digest_get_platform_point_size(void)
+int digest_update_point(SHA_CTX *ctx, mclBnG1 x)
 {
-#if defined (RKVAC_PROTOCOL_MULTOS)
-    return sizeof(elliptic_curve_point_t);
-#else
-    return sizeof(mclBnG1);
-#endif
+    elliptic_curve_point_t point;
+
+    int r;
+
+    if (ctx == NULL)
+    {
+        return -1;
+    }
+
+    r = mcl_G1_to_bytes(&point, sizeof(elliptic_curve_point_t), x);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    r = SHA1_Update(ctx, &point, sizeof(elliptic_curve_point_t));
+    if (r != 1)
+    {
+        return -1;
+    }
+
+    return 0;
 }
 
 /**
- * Gets the data of a elliptic curve point depending on the
- * platform for which the software has been compiled.
+ * Computes the checksum of a buffer, FNV-1a over 64-bit words (the tail
+ * byte by byte), fast enough to check megabytes of precomputed data at
+ * startup. It detects corruption, it is not a cryptographic hash.
  *
- * @param buffer the buffer where the point conversion will be stored
- * @param x mclBnG1 data
- * @return pointer to the buffer or NULL if error
+ * @param buffer the buffer
+ * @param buffer_length the length of the buffer
+ * @return the checksum
  */
-void *digest_get_platform_point_data(void *buffer, mclBnG1 x)
+uint64_t checksum_fnv1a(const void *buffer, size_t buffer_length)
 {
-    int r;
+    const uint8_t *data = (const uint8_t *) buffer;
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    uint64_t word;
+    size_t it;
 
-    if (buffer == NULL)
+    for (it = 0; it + sizeof(uint64_t) <= buffer_length; it += sizeof(uint64_t))
     {
-        return NULL;
+        memcpy(&word, &data[it], sizeof(uint64_t));
+        hash ^= word;
+        hash *= 0x100000001B3ULL;
     }
-
-#if defined (RKVAC_PROTOCOL_MULTOS)
-    r = mcl_G1_to_multos_G1(buffer, sizeof(elliptic_curve_point_t), x);
-#else
-    memcpy(buffer, &x, sizeof(mclBnG1));
-    r = 0;
-#endif
-
-    // avoid future errors
-    if (r < 0)
+    for (; it < buffer_length; it++)
     {
-        buffer = NULL;
+        hash ^= data[it];
+        hash *= 0x100000001B3ULL;
     }
 
-    return buffer;
+    return hash;
 }
@@ -27,30 +27,37 @@ extern "C"
 #endif
 
 #include <stddef.h>
+#include <stdint.h>
 #include <string.h>
 
 #include <mcl/bn_c256.h>
+#include <openssl/sha.h>
 
 #include "helpers/mcl_helper.h"
 #include "types.h"
 
 /**
- * Gets the size of a elliptic curve point depending on the
- * platform for which the software has been compiled.
+ * Updates the hash with the canonical encoding of a elliptic curve point,
+ * the affine point 0x04 || x || y (big-endian), which is also the format
+ * used by the smart card (elliptic_curve_point_t). The same encoding must
+ * be used by the user and the verifier on every platform.
  *
- * @return the size of the point
+ * @param ctx the hash context
+ * @param x mclBnG1 data
+ * @return 0 if success else -1
  */
-extern size_t digest_get_platform_point_size(void);
+extern int digest_update_point(SHA_CTX *ctx, mclBnG1 x);
 
 /**
- * Gets the data of a elliptic curve point depending on the
- * platform for which the software has been compiled.
+ * Computes the checksum of a buffer, FNV-1a over 64-bit words (the tail
+ * byte by byte), fast enough to check megabytes of precomputed data at
+ * startup. It detects corruption, it is not a cryptographic hash.
  *
- * @param buffer the buffer where the point conversion will be stored
- * @param x mclBnG1 data
- * @return pointer to the buffer or NULL if error
+ * @param buffer the buffer
+ * @param buffer_length the length of the buffer
+ * @return the checksum
  */
-extern void *digest_get_platform_point_data(void *buffer, mclBnG1 x);
+extern uint64_t checksum_fnv1a(const void *buffer, size_t buffer_length);
 
 #ifdef __cplusplus
 }
@@ -85,7 +85,24 @@ void mcl_display_G1(const char *name, mclBnG1 x)
 }
 
 /**
- * Converts an array of bytes into the mclBnFr type.
+ * Copies the buffer reversing the order of the bytes (big-endian <-> little-endian).
+ *
+ * @param destination the buffer where the bytes will be stored
+ * @param source the buffer to be reversed
+ * @param length the length of the buffers
+ */
+static void mcl_reverse_bytes(uint8_t *destination, const uint8_t *source, size_t length)
+{
+    size_t it;
+
+    for (it = 0; it < length; it++)
+    {
+        destination[it] = source[length - 1 - it];
+    }
+}
+
+/**
+ * Converts an array of bytes (big-endian) into the mclBnFr type.
  *
  * @param x mclBnFr data
  * @param buffer the buffer to be converted
@@ -94,27 +111,24 @@ void mcl_display_G1(const char *name, mclBnG1 x)
  */
 int mcl_bytes_to_Fr(mclBnFr *x, const void *buffer, size_t buffer_length)
 {
-    char fr_value[65] = {0};
-
-    char data[65] = {0};
+    uint8_t data[EC_SIZE];
     mclSize data_length;
 
-    int r;
-
     if (x == NULL || buffer == NULL || buffer_length != sizeof(mclBnFr))
     {
         return -1;
     }
 
-    // fr to hex
-    mem2hex(fr_value, buffer, sizeof(mclBnFr));
-
-    // mcl fr format
-    data_length = snprintf(data, 65, "%s", fr_value);
+    /*
+     * IMPORTANT!
+     *
+     * The mcl serialization of Fr is little-endian, the buffer is big-endian
+     * (elliptic_curve_fr_t). Values greater or equal than r are rejected.
+     */
+    mcl_reverse_bytes(data, buffer, EC_SIZE);
 
-    // mcl fr conversion
-    r = mclBnFr_setStr(x, (const char *) data, data_length, 16);
-    if (r < 0)
+    data_length = mclBnFr_deserialize(x, data, EC_SIZE);
+    if (data_length != EC_SIZE)
     {
         return -1;
     }
@@ -123,7 +137,7 @@ int mcl_bytes_to_Fr(mclBnFr *x, const void *buffer, size_t buffer_length)
 }
 
 /**
- * Converts the mclBnFr type into an array of bytes.
+ * Converts the mclBnFr type into an array of bytes (big-endian).
  *
  * @param buffer the buffer where the conversion will be stored
  * @param buffer_length the length of the buffer
@@ -132,33 +146,122 @@ int mcl_bytes_to_Fr(mclBnFr *x, const void *buffer, size_t buffer_length)
  */
 int mcl_Fr_to_bytes(void *buffer, size_t buffer_length, mclBnFr x)
 {
-    char fr_value[65] = {0};
+    uint8_t data[EC_SIZE];
+    mclSize data_length;
+
+    if (buffer == NULL || buffer_length != sizeof(mclBnFr))
+    {
+        return -1;
+    }
+
+    // little-endian to big-endian (elliptic_curve_fr_t)
+    data_length = mclBnFr_serialize(data, EC_SIZE, &x);
+    if (data_length != EC_SIZE)
+    {
+        return -1;
+    }
+
+    mcl_reverse_bytes(buffer, data, EC_SIZE);
+
+    return 0;
+}
 
-    char data[65] = {0};
+/**
+ * Converts an array of bytes (affine point, 0x04 || x || y, big-endian) into the mclBnG1 type.
+ *
+ * @param x mclBnG1 data
+ * @param buffer the buffer to be converted
+ * @param buffer_length the length of the buffer
+ * @return 0 if success else -1
+ */
+int mcl_bytes_to_G1(mclBnG1 *x, const void *buffer, size_t buffer_length)
+{
+    const elliptic_curve_point_t *point = (const elliptic_curve_point_t *) buffer;
+
+    uint8_t data[EC_SIZE];
     mclSize data_length;
 
     int r;
 
-    if (buffer == NULL || buffer_length != sizeof(mclBnFr))
+    if (x == NULL || buffer == NULL || buffer_length != sizeof(elliptic_curve_point_t) || point->form != 0x04)
     {
         return -1;
     }
 
-    // mcl fr conversion
-    r = mclBnFr_getStr(data, sizeof(data), &x, 16);
-    if (r < 0)
+    // x coordinate
+    mcl_reverse_bytes(data, (const uint8_t *) &point->x, EC_SIZE);
+    data_length = mclBnFp_deserialize(&x->x, data, EC_SIZE);
+    if (data_length != EC_SIZE)
     {
         return -1;
     }
 
-    // fr value
-    data_length = strnlen(data, 64);
-    if (data_length < 64)
-        snprintf(fr_value, 65, "%0*d%s", (int) (64 - data_length), 0, data);
-    else
-        snprintf(fr_value, 65, "%s", data);
+    // y coordinate
+    mcl_reverse_bytes(data, (const uint8_t *) &point->y, EC_SIZE);
+    data_length = mclBnFp_deserialize(&x->y, data, EC_SIZE);
+    if (data_length != EC_SIZE)
+    {
+        return -1;
+    }
 
-    hex2mem(buffer, (const char *) fr_value, sizeof(elliptic_curve_fr_t)); // hex fr value
+    // z coordinate (affine space)
+    mclBnFp_setInt32(&x->z, 1);
+
+    // the point must be on the curve
+    r = mclBnG1_isValid(x);
+    if (r != 1)
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * Converts the mclBnG1 type into an array of bytes (affine point, 0x04 || x || y, big-endian).
+ *
+ * @param buffer the buffer where the conversion will be stored
+ * @param buffer_length the length of the buffer
+ * @param x mclBnG1 data
+ * @return 0 if success else -1
+ */
+int mcl_G1_to_bytes(void *buffer, size_t buffer_length, mclBnG1 x)
+{
+    elliptic_curve_point_t *point = (elliptic_curve_point_t *) buffer;
+
+    uint8_t data[EC_SIZE];
+    mclSize data_length;
+
+    if (buffer == NULL || buffer_length != sizeof(elliptic_curve_point_t))
+    {
+        return -1;
+    }
+
+    // the point at infinity has no affine coordinates
+    if (mclBnG1_isZero(&x) == 1)
+    {
+        return -1;
+    }
+
+    mclBnG1_normalize(&x, &x);
+
+    point->form = 0x04; // affine space
+
+    // x coordinate
+    data_length = mclBnFp_serialize(data, EC_SIZE, &x.x);
+    if (data_length != EC_SIZE)
+    {
+        return -1;
+    }
+    mcl_reverse_bytes((uint8_t *) &point->x, data, EC_SIZE);
+
+    // y coordinate
+    data_length = mclBnFp_serialize(data, EC_SIZE, &x.y);
+    if (data_length != EC_SIZE)
+    {
+        return -1;
+    }
+    mcl_reverse_bytes((uint8_t *) &point->y, data, EC_SIZE);
 
     return 0;
 }
@@ -210,51 +313,129 @@ int mcl_Fr_to_multos_Multiplier(void *buffer, size_t buffer_length, mclBnFr x)
  */
 int mcl_G1_to_multos_G1(void *buffer, size_t buffer_length, mclBnG1 x)
 {
-    char x_coordinate[65] = {0};
-    char y_coordinate[65] = {0};
+    if (buffer == NULL || buffer_length != sizeof(elliptic_curve_point_t))
+    {
+        return -1;
+    }
 
-    char data[192] = {0};
+    return mcl_G1_to_bytes(buffer, sizeof(elliptic_curve_point_t), x);
+}
 
-    char *token;
-    size_t token_length;
+/**
+ * Precomputes the line coefficients of a G2 point, to be used by the
+ * precomputed Miller loops. The buffer must be released using free().
+ *
+ * @param buffer the buffer where the coefficients will be stored
+ * @param x mclBnG2 data
+ * @return 0 if success else -1
+ */
+int mcl_G2_precompute(uint64_t **buffer, const mclBnG2 *x)
+{
+    if (buffer == NULL || x == NULL)
+    {
+        return -1;
+    }
 
-    int r;
+    *buffer = malloc(mclBn_getUint64NumToPrecompute() * sizeof(uint64_t));
+    if (*buffer == NULL)
+    {
+        return -1;
+    }
 
-    if (buffer == NULL || buffer_length != sizeof(elliptic_curve_point_t))
+    mclBn_precomputeG2(*buffer, x);
+
+    return 0;
+}
+
+/**
+ * Copies the line coefficients of a G2 point already precomputed (e.g. by
+ * the system setup), or precomputes them if they are not available. The
+ * buffer must be released using free().
+ *
+ * @param buffer the buffer where the coefficients will be stored
+ * @param x mclBnG2 data
+ * @param x_precomputed the line coefficients of x or NULL
+ * @return 0 if success else -1
+ */
+int mcl_G2_precompute_copy(uint64_t **buffer, const mclBnG2 *x, const uint64_t *x_precomputed)
+{
+    if (x_precomputed == NULL)
+    {
+        return mcl_G2_precompute(buffer, x);
+    }
+
+    if (buffer == NULL)
     {
         return -1;
     }
 
-    // mcl point conversion
-    r = mclBnG1_getStr(data, sizeof(data), &x, 16);
-    if (r < 0)
+    *buffer = malloc(mclBn_getUint64NumToPrecompute() * sizeof(uint64_t));
+    if (*buffer == NULL)
     {
         return -1;
     }
 
-    // 1 (affine coordinate)
-    token = strtok(data, " ");
-    assert(token != NULL);
+    memcpy(*buffer, x_precomputed, mclBn_getUint64NumToPrecompute() * sizeof(uint64_t));
 
-    // x coordinate
-    token = strtok(NULL, " ");
-    token_length = strnlen(token, 64);
-    if (token_length < 64)
-        snprintf(x_coordinate, 65, "%0*d%s", (int) (64 - token_length), 0, token);
-    else
-        snprintf(x_coordinate, 65, "%s", token);
+    return 0;
+}
 
-    // y coordinate
-    token = strtok(NULL, " ");
-    token_length = strnlen(token, 64);
-    if (token_length < 64)
-        snprintf(y_coordinate, 65, "%0*d%s", (int) (64 - token_length), 0, token);
-    else
-        snprintf(y_coordinate, 65, "%s", token);
-
-    ((elliptic_curve_point_t *) buffer)->form = 0x04; // affine space
-    hex2mem((unsigned char *) &((elliptic_curve_point_t *) buffer)->x, (const char *) x_coordinate, sizeof(elliptic_curve_fp_t)); // hex x coordinate
-    hex2mem((unsigned char *) &((elliptic_curve_point_t *) buffer)->y, (const char *) y_coordinate, sizeof(elliptic_curve_fp_t)); // hex y coordinate
+/**
+ * Computes the pairing e(x, y) using the precomputed line coefficients
+ * of y if available.
+ *
+ * @param z the result of the pairing
+ * @param x mclBnG1 data
+ * @param y mclBnG2 data
+ * @param y_precomputed the line coefficients of y or NULL
+ */
+void mcl_pairing(mclBnGT *z, const mclBnG1 *x, const mclBnG2 *y, const uint64_t *y_precomputed)
+{
+    if (y_precomputed == NULL)
+    {
+        mclBn_pairing(z, x, y);
+        return;
+    }
+
+    mclBn_precomputedMillerLoop(z, x, y_precomputed);
+    mclBn_finalExp(z, z);
+}
+
+/**
+ * Generates the random small-exponent weights used to combine pairing equations.
+ *
+ * @param weights the weights to be generated
+ * @param num_weights the number of weights
+ * @param weight_length the length in bytes of each weight (1-EC_SIZE)
+ * @return 0 if success else -1
+ */
+int mcl_generate_weights(mclBnFr *weights, size_t num_weights, size_t weight_length)
+{
+    uint8_t data[EC_SIZE];
+
+    size_t it;
+    int r;
+
+    if (weights == NULL || weight_length == 0 || weight_length > EC_SIZE)
+    {
+        return -1;
+    }
+
+    for (it = 0; it < num_weights; it++)
+    {
+        r = RAND_bytes(data, (int) weight_length);
+        if (r != 1)
+        {
+            return -1;
+        }
+
+        mclBnFr_setLittleEndian(&weights[it], data, weight_length);
+        // a zero weight would remove the equation from the batch
+        if (mclBnFr_isZero(&weights[it]) == 1)
+        {
+            mclBnFr_setInt32(&weights[it], 1);
+        }
+    }
 
     return 0;
 }
@@ -30,10 +30,13 @@ extern "C"
 #include <ctype.h>
 
 #include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 #include <assert.h>
 
 #include <mcl/bn_c256.h>
+#include <openssl/rand.h>
 
 #include "helpers/hex_helper.h"
 #include "types.h"
@@ -64,7 +67,7 @@ extern void mcl_display_Fr(const char *name, mclBnFr x);
 extern void mcl_display_G1(const char *name, mclBnG1 x);
 
 /**
- * Converts an array of bytes into the mclBnFr type.
+ * Converts an array of bytes (big-endian) into the mclBnFr type.
  *
  * @param x mclBnFr data
  * @param buffer the buffer to be converted
@@ -74,7 +77,7 @@ extern void mcl_display_G1(const char *name, mclBnG1 x);
 extern int mcl_bytes_to_Fr(mclBnFr *x, const void *buffer, size_t buffer_length);
 
 /**
- * Converts the mclBnFr type into an array of bytes.
+ * Converts the mclBnFr type into an array of bytes (big-endian).
  *
  * @param buffer the buffer where the conversion will be stored
  * @param buffer_length the length of the buffer
@@ -83,6 +86,26 @@ extern int mcl_bytes_to_Fr(mclBnFr *x, const void *buffer, size_t buffer_length)
  */
 extern int mcl_Fr_to_bytes(void *buffer, size_t buffer_length, mclBnFr x);
 
+/**
+ * Converts an array of bytes (affine point, 0x04 || x || y, big-endian) into the mclBnG1 type.
+ *
+ * @param x mclBnG1 data
+ * @param buffer the buffer to be converted
+ * @param buffer_length the length of the buffer
+ * @return 0 if success else -1
+ */
+extern int mcl_bytes_to_G1(mclBnG1 *x, const void *buffer, size_t buffer_length);
+
+/**
+ * Converts the mclBnG1 type into an array of bytes (affine point, 0x04 || x || y, big-endian).
+ *
+ * @param buffer the buffer where the conversion will be stored
+ * @param buffer_length the length of the buffer
+ * @param x mclBnG1 data
+ * @return 0 if success else -1
+ */
+extern int mcl_G1_to_bytes(void *buffer, size_t buffer_length, mclBnG1 x);
+
 /**
  * Converts the mclBnFr type into an array of bytes (multos fr).
  *
@@ -113,6 +136,49 @@ extern int mcl_Fr_to_multos_Multiplier(void *buffer, size_t buffer_length, mclBn
  */
 extern int mcl_G1_to_multos_G1(void *buffer, size_t buffer_length, mclBnG1 x);
 
+/**
+ * Precomputes the line coefficients of a G2 point, to be used by the
+ * precomputed Miller loops. The buffer must be released using free().
+ *
+ * @param buffer the buffer where the coefficients will be stored
+ * @param x mclBnG2 data
+ * @return 0 if success else -1
+ */
+extern int mcl_G2_precompute(uint64_t **buffer, const mclBnG2 *x);
+
+/**
+ * Copies the line coefficients of a G2 point already precomputed (e.g. by
+ * the system setup), or precomputes them if they are not available. The
+ * buffer must be released using free().
+ *
+ * @param buffer the buffer where the coefficients will be stored
+ * @param x mclBnG2 data
+ * @param x_precomputed the line coefficients of x or NULL
+ * @return 0 if success else -1
+ */
+extern int mcl_G2_precompute_copy(uint64_t **buffer, const mclBnG2 *x, const uint64_t *x_precomputed);
+
+/**
+ * Computes the pairing e(x, y) using the precomputed line coefficients
+ * of y if available.
+ *
+ * @param z the result of the pairing
+ * @param x mclBnG1 data
+ * @param y mclBnG2 data
+ * @param y_precomputed the line coefficients of y or NULL
+ */
+extern void mcl_pairing(mclBnGT *z, const mclBnG1 *x, const mclBnG2 *y, const uint64_t *y_precomputed);
+
+/**
+ * Generates the random small-exponent weights used to combine pairing equations.
+ *
+ * @param weights the weights to be generated
+ * @param num_weights the number of weights
+ * @param weight_length the length in bytes of each weight (1-EC_SIZE)
+ * @return 0 if success else -1
+ */
+extern int mcl_generate_weights(mclBnFr *weights, size_t num_weights, size_t weight_length);
+
 #ifdef __cplusplus
 }
 #endif
@@ -67,32 +67,10 @@ int multos_Multiplier_to_mcl_Fr(mclBnFr *x, const void *buffer, size_t buffer_le
  */
 int multos_G1_to_mcl_G1(mclBnG1 *x, const void *buffer, size_t buffer_length)
 {
-    char x_coordinate[65] = {0};
-    char y_coordinate[65] = {0};
-
-    char data[192] = {0};
-    mclSize data_length;
-
-    int r;
-
     if (x == NULL || buffer == NULL || buffer_length != sizeof(elliptic_curve_point_t))
     {
         return -1;
     }
 
-    // convert x and y coordinates to raw - affine space
-    mem2hex(x_coordinate, (unsigned char *) &((elliptic_curve_point_t *) buffer)->x, sizeof(elliptic_curve_fp_t)); // hex x coordinate
-    mem2hex(y_coordinate, (unsigned char *) &((elliptic_curve_point_t *) buffer)->y, sizeof(elliptic_curve_fp_t)); // hex y coordinate
-
-    // mcl point format
-    data_length = snprintf(data, 192, "1 %s %s", x_coordinate, y_coordinate);
-
-    // mcl point conversion
-    r = mclBnG1_setStr(x, (const char *) data, data_length, 16);
-    if (r < 0)
-    {
-        return -1;
-    }
-
-    return 0;
+    return mcl_bytes_to_G1(x, buffer, sizeof(elliptic_curve_point_t));
 }
@@ -0,0 +1,427 @@
+/**
+ *
+ *  Copyright (C) 2020  Raul Casanova Marques
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "keystore.h"
+
+/**
+ * Rounds a length up to the alignment of the sections.
+ *
+ * @param length the length
+ * @return the aligned length
+ */
+static size_t ks_align(size_t length)
+{
+    return (length + KEYSTORE_ALIGNMENT - 1) & ~((size_t) KEYSTORE_ALIGNMENT - 1);
+}
+
+/**
+ * Fills the header fields that describe the representation of the values.
+ *
+ * @param header the header
+ * @param curve the curve
+ */
+static void ks_set_representation(keystore_header_t *header, int curve)
+{
+    header->curve = (uint32_t) curve;
+    header->mcl_version = (uint32_t) mclBn_getVersion();
+    header->fr_size = sizeof(mclBnFr);
+    header->g1_size = sizeof(mclBnG1);
+    header->g2_size = sizeof(mclBnG2);
+    header->keys_size = sizeof(keystore_keys_t);
+    header->table_size = sizeof(fixed_base_table_t);
+}
+
+/**
+ * Computes the offsets of the sections and the length of the file.
+ *
+ * @param header the header (num_attributes, k and j already set)
+ */
+static void ks_set_layout(keystore_header_t *header)
+{
+    size_t offset;
+
+    offset = ks_align(sizeof(keystore_header_t));
+
+    header->keys_offset = offset;
+    offset = ks_align(offset + sizeof(keystore_keys_t));
+
+    header->randomizers_offset = offset;
+    offset = ks_align(offset + header->k * sizeof(mclBnFr));
+
+    header->randomizers_sigma_offset = offset;
+    offset = ks_align(offset + header->k * sizeof(mclBnG1));
+
+    header->G1_table_offset = offset;
+    offset = ks_align(offset + sizeof(fixed_base_table_t));
+
+    header->alphas_mul_tables_offset = offset;
+    offset = ks_align(offset + header->j * sizeof(fixed_base_table_t));
+
+    header->file_length = offset;
+}
+
+/**
+ * Writes the keystore (the file is replaced atomically). The fixed-base
+ * tables must have been precomputed (sys_setup and ra_precompute).
+ *
+ * @param path the path of the keystore
+ * @param sys_parameters the system parameters
+ * @param ra_parameters the revocation authority parameters
+ * @param ra_keys the revocation authority keys
+ * @param ie_parameters the issuer parameters
+ * @param ie_keys the issuer keys
+ * @return 0 if success else -1
+ */
+int ks_save(const char *path, system_par_t sys_parameters, revocation_authority_par_t ra_parameters, revocation_authority_keys_t ra_keys,
+            issuer_par_t ie_parameters, issuer_keys_t ie_keys)
+{
+    char tmp_path[FILENAME_MAX];
+
+    keystore_header_t layout;
+    keystore_header_t *header;
+    keystore_keys_t *keys;
+    uint8_t *image = NULL;
+
+    size_t it, length;
+    ssize_t written;
+    int fd = -1;
+    int r;
+
+    if (path == NULL || sys_parameters.G1_table == NULL || ra_parameters.randomizers == NULL || ra_parameters.randomizers_sigma == NULL
+        || ra_parameters.k == 0 || ra_parameters.j == 0 || ra_parameters.j > REVOCATION_AUTHORITY_MAX_J
+        || ie_parameters.num_attributes == 0 || ie_parameters.num_attributes > USER_MAX_NUM_ATTRIBUTES)
+    {
+        return -1;
+    }
+    for (it = 0; it < ra_parameters.j; it++)
+    {
+        if (ra_parameters.alphas_mul_tables[it] == NULL)
+        {
+            return -1;
+        }
+    }
+
+    r = snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    if (r < 0 || (size_t) r >= sizeof(tmp_path))
+    {
+        return -1;
+    }
+
+    /// image of the keystore
+    memset(&layout, 0, sizeof(keystore_header_t));
+    layout.num_attributes = ie_parameters.num_attributes;
+    layout.k = ra_parameters.k;
+    layout.j = ra_parameters.j;
+    ks_set_layout(&layout);
+    ks_set_representation(&layout, sys_parameters.curve);
+
+    length = (size_t) layout.file_length;
+    image = calloc(1, length);
+    if (image == NULL)
+    {
+        return -1;
+    }
+
+    header = (keystore_header_t *) image;
+    memcpy(header, &layout, sizeof(keystore_header_t));
+
+    keys = (keystore_keys_t *) &image[header->keys_offset];
+    memcpy(&keys->G1, &sys_parameters.G1, sizeof(mclBnG1));
+    memcpy(&keys->G2, &sys_parameters.G2, sizeof(mclBnG2));
+    memcpy(&keys->ra_keys, &ra_keys, sizeof(revocation_authority_keys_t));
+    memcpy(keys->alphas, ra_parameters.alphas, sizeof(keys->alphas));
+    memcpy(keys->alphas_mul, ra_parameters.alphas_mul, sizeof(keys->alphas_mul));
+    memcpy(&keys->ie_keys, &ie_keys, sizeof(issuer_keys_t));
+
+    memcpy(&image[header->randomizers_offset], ra_parameters.randomizers, ra_parameters.k * sizeof(mclBnFr));
+    memcpy(&image[header->randomizers_sigma_offset], ra_parameters.randomizers_sigma, ra_parameters.k * sizeof(mclBnG1));
+    memcpy(&image[header->G1_table_offset], sys_parameters.G1_table, sizeof(fixed_base_table_t));
+    for (it = 0; it < ra_parameters.j; it++)
+    {
+        memcpy(&image[header->alphas_mul_tables_offset + it * sizeof(fixed_base_table_t)], ra_parameters.alphas_mul_tables[it], sizeof(fixed_base_table_t));
+    }
+
+    header->checksum = checksum_fnv1a(&image[sizeof(keystore_header_t)], length - sizeof(keystore_header_t));
+    header->version = KEYSTORE_VERSION;
+    header->magic = KEYSTORE_MAGIC;
+
+    /// temporary file, renamed once it is durable
+    fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0)
+    {
+        r = -1;
+        goto cleanup;
+    }
+
+    for (it = 0; it < length; it += (size_t) written)
+    {
+        written = write(fd, &image[it], length - it);
+        if (written <= 0)
+        {
+            r = -1;
+            goto cleanup;
+        }
+    }
+
+    r = fsync(fd);
+    if (r < 0)
+    {
+        goto cleanup;
+    }
+
+    r = close(fd);
+    fd = -1;
+    if (r < 0)
+    {
+        goto cleanup;
+    }
+
+    r = rename(tmp_path, path);
+
+cleanup:
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+    if (r < 0)
+    {
+        unlink(tmp_path);
+    }
+    free(image);
+
+    return r < 0 ? -1 : 0;
+}
+
+/**
+ * Maps the keystore read-only and checks its header and checksum.
+ *
+ * @param keystore the keystore
+ * @param path the path of the keystore
+ * @return 0 if success else -1
+ */
+int ks_open(keystore_t *keystore, const char *path)
+{
+    keystore_header_t expected;
+    const keystore_header_t *header;
+
+    struct stat keystore_stat;
+    int r;
+
+    if (keystore == NULL || path == NULL)
+    {
+        return -1;
+    }
+
+    memset(keystore, 0, sizeof(keystore_t));
+
+    keystore->fd = open(path, O_RDONLY);
+    if (keystore->fd < 0)
+    {
+        return -1;
+    }
+
+    r = fstat(keystore->fd, &keystore_stat);
+    if (r < 0 || (size_t) keystore_stat.st_size < sizeof(keystore_header_t))
+    {
+        ks_close(keystore);
+        return -1;
+    }
+    keystore->image_length = (size_t) keystore_stat.st_size;
+
+    keystore->image = mmap(NULL, keystore->image_length, PROT_READ, MAP_SHARED, keystore->fd, 0);
+    if (keystore->image == MAP_FAILED)
+    {
+        keystore->image = NULL;
+        ks_close(keystore);
+        return -1;
+    }
+    header = (const keystore_header_t *) keystore->image;
+
+    /// header (layout computed by this build)
+    memset(&expected, 0, sizeof(keystore_header_t));
+    expected.num_attributes = header->num_attributes;
+    expected.k = header->k;
+    expected.j = header->j;
+    ks_set_layout(&expected);
+    ks_set_representation(&expected, MCL_BN254);
+
+    if (header->magic != KEYSTORE_MAGIC || header->version != KEYSTORE_VERSION
+        || header->num_attributes == 0 || header->num_attributes > USER_MAX_NUM_ATTRIBUTES
+        || header->k == 0 || header->k > (uint64_t) SIZE_MAX / sizeof(mclBnG1) || header->j == 0 || header->j > REVOCATION_AUTHORITY_MAX_J
+        || header->curve != expected.curve || header->mcl_version != expected.mcl_version
+        || header->fr_size != expected.fr_size || header->g1_size != expected.g1_size || header->g2_size != expected.g2_size
+        || header->keys_size != expected.keys_size || header->table_size != expected.table_size
+        || header->keys_offset != expected.keys_offset || header->randomizers_offset != expected.randomizers_offset
+        || header->randomizers_sigma_offset != expected.randomizers_sigma_offset || header->G1_table_offset != expected.G1_table_offset
+        || header->alphas_mul_tables_offset != expected.alphas_mul_tables_offset
+        || header->file_length != expected.file_length || header->file_length != keystore->image_length)
+    {
+        ks_close(keystore);
+        return -1;
+    }
+
+    /// checksum of the whole keystore
+    if (header->checksum != checksum_fnv1a((const uint8_t *) keystore->image + sizeof(keystore_header_t), keystore->image_length - sizeof(keystore_header_t)))
+    {
+        ks_close(keystore);
+        return -1;
+    }
+
+    keystore->header = header;
+
+    return 0;
+}
+
+/**
+ * Loads the parameters and keys of the keystore, initializing mcl. The
+ * randomizers and the fixed-base tables point into the mapping. The issuer
+ * parameters must still be precomputed (ie_precompute).
+ *
+ * @param keystore the keystore
+ * @param sys_parameters the system parameters
+ * @param ra_parameters the revocation authority parameters
+ * @param ra_keys the revocation authority keys
+ * @param ie_parameters the issuer parameters
+ * @param ie_keys the issuer keys
+ * @return 0 if success else -1
+ */
+int ks_load(const keystore_t *keystore, system_par_t *sys_parameters, revocation_authority_par_t *ra_parameters, revocation_authority_keys_t *ra_keys,
+            issuer_par_t *ie_parameters, issuer_keys_t *ie_keys)
+{
+    const keystore_header_t *header;
+    const keystore_keys_t *keys;
+    uint8_t *image;
+
+    size_t it;
+    int r;
+
+    if (keystore == NULL || keystore->header == NULL || sys_parameters == NULL || ra_parameters == NULL || ra_keys == NULL || ie_parameters == NULL || ie_keys == NULL)
+    {
+        return -1;
+    }
+
+    header = keystore->header;
+    image = (uint8_t *) keystore->image;
+    keys = (const keystore_keys_t *) &image[header->keys_offset];
+
+    r = mclBn_init((int) header->curve, MCLBN_COMPILED_TIME_VAR);
+    if (r != 0)
+    {
+        return -1;
+    }
+
+    /// system parameters
+    memset(sys_parameters, 0, sizeof(system_par_t));
+    sys_parameters->curve = (int) header->curve;
+    memcpy(&sys_parameters->G1, &keys->G1, sizeof(mclBnG1));
+    memcpy(&sys_parameters->G2, &keys->G2, sizeof(mclBnG2));
+    sys_parameters->G1_table = (fixed_base_table_t *) &image[header->G1_table_offset];
+
+    /// revocation authority
+    memset(ra_parameters, 0, sizeof(revocation_authority_par_t));
+    ra_parameters->k = (size_t) header->k;
+    ra_parameters->j = (size_t) header->j;
+    memcpy(ra_parameters->alphas, keys->alphas, sizeof(ra_parameters->alphas));
+    memcpy(ra_parameters->alphas_mul, keys->alphas_mul, sizeof(ra_parameters->alphas_mul));
+    for (it = 0; it < ra_parameters->j; it++)
+    {
+        ra_parameters->alphas_mul_tables[it] = (fixed_base_table_t *) &image[header->alphas_mul_tables_offset + it * sizeof(fixed_base_table_t)];
+    }
+    ra_parameters->randomizers = (mclBnFr *) &image[header->randomizers_offset];
+    ra_parameters->randomizers_sigma = (mclBnG1 *) &image[header->randomizers_sigma_offset];
+
+    memcpy(ra_keys, &keys->ra_keys, sizeof(revocation_authority_keys_t));
+
+    /// issuer
+    memset(ie_parameters, 0, sizeof(issuer_par_t));
+    ie_parameters->num_attributes = (size_t) header->num_attributes;
+
+    memcpy(ie_keys, &keys->ie_keys, sizeof(issuer_keys_t));
+
+    /// the points used by every proof (the rest is covered by the checksum)
+    if (mclBnG1_isValid(&sys_parameters->G1) != 1 || mclBnG2_isValid(&sys_parameters->G2) != 1 || mclBnG2_isValid(&ra_keys->public_key.pk) != 1)
+    {
+        ks_release(sys_parameters, ra_parameters);
+        return -1;
+    }
+    for (it = 0; it < ra_parameters->j; it++)
+    {
+        if (mclBnG1_isValid(&ra_parameters->alphas_mul[it]) != 1)
+        {
+            ks_release(sys_parameters, ra_parameters);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Detaches the parameters loaded from the keystore from its mapping, so
+ * that sys_cleanup and ra_cleanup do not release it.
+ *
+ * @param sys_parameters the system parameters
+ * @param ra_parameters the revocation authority parameters
+ */
+void ks_release(system_par_t *sys_parameters, revocation_authority_par_t *ra_parameters)
+{
+    size_t it;
+
+    if (sys_parameters != NULL)
+    {
+        sys_parameters->G1_table = NULL;
+    }
+
+    if (ra_parameters != NULL)
+    {
+        for (it = 0; it < REVOCATION_AUTHORITY_MAX_J; it++)
+        {
+            ra_parameters->alphas_mul_tables[it] = NULL;
+        }
+        ra_parameters->randomizers = NULL;
+        ra_parameters->randomizers_sigma = NULL;
+    }
+}
+
+/**
+ * Unmaps and closes the keystore.
+ *
+ * @param keystore the keystore
+ */
+void ks_close(keystore_t *keystore)
+{
+    if (keystore == NULL)
+    {
+        return;
+    }
+
+    if (keystore->image != NULL)
+    {
+        munmap(keystore->image, keystore->image_length);
+        keystore->image = NULL;
+    }
+    keystore->header = NULL;
+
+    if (keystore->fd >= 0)
+    {
+        close(keystore->fd);
+        keystore->fd = -1;
+    }
+}
@@ -0,0 +1,192 @@
+/**
+ *
+ *  Copyright (C) 2020  Raul Casanova Marques
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __RKVAC_PROTOCOL_KEYSTORE_H_
+#define __RKVAC_PROTOCOL_KEYSTORE_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <mcl/bn_c256.h>
+
+#include "config/config.h"
+
+#include "models/issuer.h"
+#include "models/revocation-authority.h"
+#include "system.h"
+
+#include "helpers/fixed_base_helper.h"
+#include "helpers/hash_helper.h"
+
+/*
+ * Magic number of the keystore ("RKVACKEY")
+ */
+#define KEYSTORE_MAGIC 0x59454B4341564B52ULL
+
+/*
+ * Version of the layout of the keystore
+ */
+#define KEYSTORE_VERSION 1
+
+/*
+ * Alignment of the sections of the keystore (one cache line)
+ */
+#define KEYSTORE_ALIGNMENT 64
+
+typedef struct
+{
+    uint64_t magic;
+    uint64_t version; // version of the layout
+    uint64_t file_length;
+    uint64_t checksum; // FNV-1a (64-bit words) of the file after the header
+
+    // representation of the stored values (native mcl types)
+    uint32_t curve;
+    uint32_t mcl_version;
+    uint32_t fr_size;
+    uint32_t g1_size;
+    uint32_t g2_size;
+    uint32_t keys_size;
+    uint32_t table_size;
+    uint32_t reserved0;
+
+    uint64_t num_attributes; // issuer
+    uint64_t k, j; // revocation authority
+
+    // offsets of the sections
+    uint64_t keys_offset;
+    uint64_t randomizers_offset; // k randomizers
+    uint64_t randomizers_sigma_offset; // k signatures of the randomizers
+    uint64_t G1_table_offset; // fixed-base table of G1
+    uint64_t alphas_mul_tables_offset; // j fixed-base tables of h1...hj
+} keystore_header_t;
+
+typedef struct
+{
+    mclBnG1 G1;
+    mclBnG2 G2;
+
+    revocation_authority_keys_t ra_keys;
+    mclBnFr alphas[REVOCATION_AUTHORITY_MAX_J];
+    mclBnG1 alphas_mul[REVOCATION_AUTHORITY_MAX_J];
+
+    issuer_keys_t ie_keys;
+} keystore_keys_t;
+
+/*
+ * IMPORTANT!
+ *
+ * The keystore stores the system parameters, the revocation authority
+ * parameters and keys and the issuer keys in the native representation of
+ * mcl (Montgomery form), together with the fixed-base tables, so a process
+ * maps the file read-only and uses the randomizers, their signatures and
+ * the tables in place without parsing or recomputing them. The header
+ * records the curve, the version of mcl and the size of the types, a file
+ * written by an incompatible build is rejected. The file holds the private
+ * keys, it is created with the permissions 0600.
+ *
+ * The parameters loaded by ks_load point into the mapping: they must not be
+ * modified, and ks_release must be called before sys_cleanup and ra_cleanup.
+ */
+typedef struct
+{
+    int fd;
+
+    void *image;
+    size_t image_length;
+
+    const keystore_header_t *header;
+} keystore_t;
+
+/**
+ * Writes the keystore (the file is replaced atomically). The fixed-base
+ * tables must have been precomputed (sys_setup and ra_precompute).
+ *
+ * @param path the path of the keystore
+ * @param sys_parameters the system parameters
+ * @param ra_parameters the revocation authority parameters
+ * @param ra_keys the revocation authority keys
+ * @param ie_parameters the issuer parameters
+ * @param ie_keys the issuer keys
+ * @return 0 if success else -1
+ */
+extern int ks_save(const char *path, system_par_t sys_parameters, revocation_authority_par_t ra_parameters, revocation_authority_keys_t ra_keys,
+                   issuer_par_t ie_parameters, issuer_keys_t ie_keys);
+
+/**
+ * Maps the keystore read-only and checks its header and checksum.
+ *
+ * @param keystore the keystore
+ * @param path the path of the keystore
+ * @return 0 if success else -1
+ */
+extern int ks_open(keystore_t *keystore, const char *path);
+
+/**
+ * Loads the parameters and keys of the keystore, initializing mcl. The
+ * randomizers and the fixed-base tables point into the mapping. The issuer
+ * parameters must still be precomputed (ie_precompute).
+ *
+ * @param keystore the keystore
+ * @param sys_parameters the system parameters
+ * @param ra_parameters the revocation authority parameters
+ * @param ra_keys the revocation authority keys
+ * @param ie_parameters the issuer parameters
+ * @param ie_keys the issuer keys
+ * @return 0 if success else -1
+ */
+extern int ks_load(const keystore_t *keystore, system_par_t *sys_parameters, revocation_authority_par_t *ra_parameters, revocation_authority_keys_t *ra_keys,
+                   issuer_par_t *ie_parameters, issuer_keys_t *ie_keys);
+
+/**
+ * Detaches the parameters loaded from the keystore from its mapping, so
+ * that sys_cleanup and ra_cleanup do not release it.
+ *
+ * @param sys_parameters the system parameters
+ * @param ra_parameters the revocation authority parameters
+ */
+extern void ks_release(system_par_t *sys_parameters, revocation_authority_par_t *ra_parameters);
+
+/**
+ * Unmaps and closes the keystore.
+ *
+ * @param keystore the keystore
+ */
+extern void ks_close(keystore_t *keystore);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RKVAC_PROTOCOL_KEYSTORE_H_ */
@@ -0,0 +1,166 @@
+/**
+ *
+ *  Copyright (C) 2020  Raul Casanova Marques
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "mpmc_queue.h"
+
+/**
+ * Initializes the queue.
+ *
+ * @param queue the queue
+ * @param capacity the capacity of the queue (power of two)
+ * @return 0 if success else -1
+ */
+int mpmc_queue_init(mpmc_queue_t *queue, size_t capacity)
+{
+    size_t it;
+
+    if (queue == NULL || capacity < 2 || (capacity & (capacity - 1)) != 0)
+    {
+        return -1;
+    }
+
+    queue->cells = malloc(capacity * sizeof(mpmc_queue_cell_t));
+    if (queue->cells == NULL)
+    {
+        return -1;
+    }
+
+    for (it = 0; it < capacity; it++)
+    {
+        __atomic_store_n(&queue->cells[it].sequence, it, __ATOMIC_RELAXED);
+        queue->cells[it].data = NULL;
+    }
+
+    queue->mask = capacity - 1;
+    __atomic_store_n(&queue->enqueue_position, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&queue->dequeue_position, 0, __ATOMIC_RELAXED);
+
+    return 0;
+}
+
+/**
+ * Pushes an element into the queue.
+ *
+ * @param queue the queue
+ * @param data the element
+ * @return 0 if success else -1 (the queue is full)
+ */
+int mpmc_queue_push(mpmc_queue_t *queue, void *data)
+{
+    mpmc_queue_cell_t *cell;
+
+    size_t position, sequence;
+    intptr_t difference;
+
+    position = __atomic_load_n(&queue->enqueue_position, __ATOMIC_RELAXED);
+    for (;;)
+    {
+        cell = &queue->cells[position & queue->mask];
+        sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+        difference = (intptr_t) sequence - (intptr_t) position;
+
+        if (difference == 0)
+        {
+            // the cell is free, try to reserve it
+            if (__atomic_compare_exchange_n(&queue->enqueue_position, &position, position + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                break;
+            }
+        }
+        else if (difference < 0)
+        {
+            // the cell has not been consumed yet, the queue is full
+            return -1;
+        }
+        else
+        {
+            // another producer has reserved the cell
+            position = __atomic_load_n(&queue->enqueue_position, __ATOMIC_RELAXED);
+        }
+    }
+
+    cell->data = data;
+    __atomic_store_n(&cell->sequence, position + 1, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+/**
+ * Pops an element from the queue.
+ *
+ * @param queue the queue
+ * @param data the element
+ * @return 0 if success else -1 (the queue is empty)
+ */
+int mpmc_queue_pop(mpmc_queue_t *queue, void **data)
+{
+    mpmc_queue_cell_t *cell;
+
+    size_t position, sequence;
+    intptr_t difference;
+
+    position = __atomic_load_n(&queue->dequeue_position, __ATOMIC_RELAXED);
+    for (;;)
+    {
+        cell = &queue->cells[position & queue->mask];
+        sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+        difference = (intptr_t) sequence - (intptr_t) (position + 1);
+
+        if (difference == 0)
+        {
+            // the cell is full, try to reserve it
+            if (__atomic_compare_exchange_n(&queue->dequeue_position, &position, position + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                break;
+            }
+        }
+        else if (difference < 0)
+        {
+            // the cell has not been produced yet, the queue is empty
+            return -1;
+        }
+        else
+        {
+            // another consumer has reserved the cell
+            position = __atomic_load_n(&queue->dequeue_position, __ATOMIC_RELAXED);
+        }
+    }
+
+    *data = cell->data;
+    __atomic_store_n(&cell->sequence, position + queue->mask + 1, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+/**
+ * Releases the resources allocated by the queue.
+ *
+ * @param queue the queue
+ */
+void mpmc_queue_destroy(mpmc_queue_t *queue)
+{
+    if (queue == NULL)
+    {
+        return;
+    }
+
+    free(queue->cells);
+    queue->cells = NULL;
+}
@@ -0,0 +1,99 @@
+/**
+ *
+ *  Copyright (C) 2020  Raul Casanova Marques
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __RKVAC_PROTOCOL_MPMC_QUEUE_H_
+#define __RKVAC_PROTOCOL_MPMC_QUEUE_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/*
+ * IMPORTANT!
+ *
+ * Bounded multi-producer/multi-consumer queue (D. Vyukov). Each cell has a
+ * sequence number that tells producers and consumers whether the cell is
+ * free or full, so push and pop only need one compare-and-swap on the
+ * enqueue or dequeue position and never take a lock. The capacity must be
+ * a power of two. The queue does not block, the callers decide how to wait.
+ */
+typedef struct
+{
+    size_t sequence;
+    void *data;
+} mpmc_queue_cell_t;
+
+typedef struct
+{
+    mpmc_queue_cell_t *cells;
+    size_t mask; // capacity - 1
+
+    // enqueue and dequeue positions in different cache lines (avoid false sharing)
+    char padding0[64];
+    size_t enqueue_position;
+    char padding1[64];
+    size_t dequeue_position;
+    char padding2[64];
+} mpmc_queue_t;
+
+/**
+ * Initializes the queue.
+ *
+ * @param queue the queue
+ * @param capacity the capacity of the queue (power of two)
+ * @return 0 if success else -1
+ */
+extern int mpmc_queue_init(mpmc_queue_t *queue, size_t capacity);
+
+/**
+ * Pushes an element into the queue.
+ *
+ * @param queue the queue
+ * @param data the element
+ * @return 0 if success else -1 (the queue is full)
+ */
+extern int mpmc_queue_push(mpmc_queue_t *queue, void *data);
+
+/**
+ * Pops an element from the queue.
+ *
+ * @param queue the queue
+ * @param data the element
+ * @return 0 if success else -1 (the queue is empty)
+ */
+extern int mpmc_queue_pop(mpmc_queue_t *queue, void **data);
+
+/**
+ * Releases the resources allocated by the queue.
+ *
+ * @param queue the queue
+ */
+extern void mpmc_queue_destroy(mpmc_queue_t *queue);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RKVAC_PROTOCOL_MPMC_QUEUE_H_ */
@@ -0,0 +1,803 @@
+/**
+ *
+ *  Copyright (C) 2020  Raul Casanova Marques
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "database.h"
+
+/*
+ * Number of records read at once during the recovery
+ */
+#define REVOCATION_DATABASE_REPLAY_RECORDS 1024
+
+/**
+ * Computes the checksum of a record.
+ *
+ * @param record the record
+ * @return the checksum
+ */
+static uint32_t rd_checksum(const revocation_database_record_t *record)
+{
+    revocation_database_record_t copy;
+    uint64_t hash;
+
+    memcpy(&copy, record, sizeof(revocation_database_record_t));
+    copy.checksum = 0;
+
+    hash = checksum_fnv1a(&copy, sizeof(copy));
+
+    return (uint32_t) (hash ^ (hash >> 32u));
+}
+
+/**
+ * Reads a record of the log.
+ *
+ * @param database the revocation database
+ * @param offset the offset of the record
+ * @param record the record
+ * @return 0 if success else -1
+ */
+static int rd_read_record(const revocation_database_t *database, uint64_t offset, revocation_database_record_t *record)
+{
+    ssize_t length;
+
+    length = pread(database->log_fd, record, sizeof(revocation_database_record_t), (off_t) offset);
+    if (length != sizeof(revocation_database_record_t))
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * Finds the index slot of an identifier: the slot of the user if it exists,
+ * otherwise the empty slot where it would be inserted.
+ *
+ * @param database the revocation database
+ * @param identifier the identifier
+ * @param identifier_length the length of the identifier
+ * @param hash the hash of the identifier
+ * @return the slot
+ */
+static revocation_database_index_slot_t *rd_find_slot(const revocation_database_t *database, const uint8_t *identifier, size_t identifier_length, uint64_t hash)
+{
+    revocation_database_index_slot_t *slot;
+    revocation_database_record_t record;
+
+    uint64_t mask = database->header->num_slots - 1;
+    uint64_t position = hash & mask;
+
+    for (;;)
+    {
+        slot = &database->slots[position];
+        if (slot->offset == 0)
+        {
+            return slot;
+        }
+
+        // the hashes are equal, so the identifiers are almost certainly equal too
+        if (slot->hash == hash && rd_read_record(database, slot->offset - 1, &record) == 0 &&
+            record.identifier_length == identifier_length && memcmp(record.identifier, identifier, identifier_length) == 0)
+        {
+            return slot;
+        }
+
+        position = (position + 1) & mask;
+    }
+}
+
+/**
+ * Maps the index file with the given number of slots.
+ *
+ * @param database the revocation database
+ * @param num_slots the number of slots
+ * @return 0 if success else -1
+ */
+static int rd_map_index(revocation_database_t *database, uint64_t num_slots)
+{
+    int r;
+
+    if (database->index != NULL)
+    {
+        munmap(database->index, database->index_length);
+        database->index = NULL;
+    }
+
+    database->index_length = sizeof(revocation_database_index_header_t) + num_slots * sizeof(revocation_database_index_slot_t);
+
+    r = ftruncate(database->index_fd, (off_t) database->index_length);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    database->index = mmap(NULL, database->index_length, PROT_READ | PROT_WRITE, MAP_SHARED, database->index_fd, 0);
+    if (database->index == MAP_FAILED)
+    {
+        database->index = NULL;
+        return -1;
+    }
+
+    database->header = (revocation_database_index_header_t *) database->index;
+    database->slots = (revocation_database_index_slot_t *) (database->header + 1);
+
+    return 0;
+}
+
+/**
+ * Creates an empty index (the whole log must be replayed).
+ *
+ * @param database the revocation database
+ * @param num_slots the number of slots
+ * @return 0 if success else -1
+ */
+static int rd_create_index(revocation_database_t *database, uint64_t num_slots)
+{
+    int r;
+
+    // discard the old content
+    r = ftruncate(database->index_fd, 0);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    r = rd_map_index(database, num_slots);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    database->header->magic = REVOCATION_DATABASE_INDEX_MAGIC;
+    database->header->num_slots = num_slots;
+    database->header->num_entries = 0;
+    database->header->log_length = 0;
+
+    return 0;
+}
+
+/**
+ * Doubles the number of slots of the index.
+ *
+ * @param database the revocation database
+ * @return 0 if success else -1
+ */
+static int rd_grow_index(revocation_database_t *database)
+{
+    revocation_database_index_slot_t *slots;
+    revocation_database_index_header_t header;
+
+    uint64_t num_slots, mask, position;
+    uint64_t it;
+    int r;
+
+    memcpy(&header, database->header, sizeof(header));
+
+    slots = malloc(header.num_slots * sizeof(revocation_database_index_slot_t));
+    if (slots == NULL)
+    {
+        return -1;
+    }
+    memcpy(slots, database->slots, header.num_slots * sizeof(revocation_database_index_slot_t));
+
+    num_slots = header.num_slots * 2;
+    r = rd_create_index(database, num_slots);
+    if (r < 0)
+    {
+        free(slots);
+        return -1;
+    }
+
+    // the identifiers are unique, only an empty slot has to be found
+    mask = num_slots - 1;
+    for (it = 0; it < header.num_slots; it++)
+    {
+        if (slots[it].offset == 0)
+        {
+            continue;
+        }
+
+        position = slots[it].hash & mask;
+        while (database->slots[position].offset != 0)
+        {
+            position = (position + 1) & mask;
+        }
+        memcpy(&database->slots[position], &slots[it], sizeof(revocation_database_index_slot_t));
+    }
+    database->header->num_entries = header.num_entries;
+    database->header->log_length = header.log_length;
+
+    free(slots);
+
+    return 0;
+}
+
+/**
+ * Points the index slot of the user of a record to the record.
+ *
+ * @param database the revocation database
+ * @param record the record
+ * @param offset the offset of the record in the log
+ * @return 0 if success else -1
+ */
+static int rd_index_record(revocation_database_t *database, const revocation_database_record_t *record, uint64_t offset)
+{
+    revocation_database_index_slot_t *slot;
+    uint64_t hash;
+    int r;
+
+    // keep the load factor <= 3/4
+    if ((database->header->num_entries + 1) * 4 > database->header->num_slots * 3)
+    {
+        r = rd_grow_index(database);
+        if (r < 0)
+        {
+            return -1;
+        }
+    }
+
+    hash = checksum_fnv1a(record->identifier, record->identifier_length);
+
+    slot = rd_find_slot(database, record->identifier, record->identifier_length, hash);
+    if (slot->offset == 0)
+    {
+        slot->hash = hash;
+        database->header->num_entries++;
+    }
+    slot->offset = offset + 1;
+
+    return 0;
+}
+
+/**
+ * Replays the records of the log from the given offset. A torn or corrupted
+ * record ends the log, it is truncated there.
+ *
+ * @param database the revocation database
+ * @param offset the offset of the first record
+ * @return 0 if success else -1
+ */
+static int rd_replay(revocation_database_t *database, uint64_t offset)
+{
+    revocation_database_record_t *records;
+    ssize_t length;
+
+    size_t num_records;
+    size_t it;
+    int r;
+
+    records = malloc(REVOCATION_DATABASE_REPLAY_RECORDS * sizeof(revocation_database_record_t));
+    if (records == NULL)
+    {
+        return -1;
+    }
+
+    for (;;)
+    {
+        length = pread(database->log_fd, records, REVOCATION_DATABASE_REPLAY_RECORDS * sizeof(revocation_database_record_t), (off_t) offset);
+        if (length < 0)
+        {
+            free(records);
+            return -1;
+        }
+
+        num_records = (size_t) length / sizeof(revocation_database_record_t);
+        for (it = 0; it < num_records; it++)
+        {
+            if (records[it].checksum != rd_checksum(&records[it]) || records[it].identifier_length > USER_MAX_ID_LENGTH)
+            {
+                break;
+            }
+
+            r = rd_index_record(database, &records[it], offset);
+            if (r < 0)
+            {
+                free(records);
+                return -1;
+            }
+            offset += sizeof(revocation_database_record_t);
+        }
+
+        // end of the log (or torn record)
+        if (it < REVOCATION_DATABASE_REPLAY_RECORDS)
+        {
+            break;
+        }
+    }
+
+    free(records);
+
+    r = ftruncate(database->log_fd, (off_t) offset);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    database->log_length = offset;
+    database->header->log_length = offset;
+
+    return 0;
+}
+
+/**
+ * Checks that the slots of the index only point to records of the log. The
+ * kernel may write the pages of the index back before rd_sync, so a slot may
+ * point to a record that never reached the disk.
+ *
+ * @param database the revocation database
+ * @return 0 if the index is consistent else -1
+ */
+static int rd_validate_index(const revocation_database_t *database)
+{
+    uint64_t num_entries = 0;
+    uint64_t it;
+
+    for (it = 0; it < database->header->num_slots; it++)
+    {
+        if (database->slots[it].offset == 0)
+        {
+            continue;
+        }
+
+        if (database->slots[it].offset - 1 >= database->log_length || (database->slots[it].offset - 1) % sizeof(revocation_database_record_t) != 0)
+        {
+            return -1;
+        }
+        num_entries++;
+    }
+
+    return num_entries == database->header->num_entries ? 0 : -1;
+}
+
+/**
+ * Opens the revocation database (path.log and path.idx), creating it if it does
+ * not exist, and replays the records of the log not covered by the index.
+ *
+ * @param database the revocation database
+ * @param path the path of the database files (without extension)
+ * @return 0 if success else -1
+ */
+int rd_open(revocation_database_t *database, const char *path)
+{
+    struct stat log_stat, index_stat;
+    int r;
+
+    if (database == NULL || path == NULL)
+    {
+        return -1;
+    }
+
+    memset(database, 0, sizeof(revocation_database_t));
+    database->log_fd = -1;
+    database->index_fd = -1;
+
+    r = snprintf(database->log_path, sizeof(database->log_path), "%s.log", path);
+    if (r < 0 || (size_t) r >= sizeof(database->log_path))
+    {
+        return -1;
+    }
+    r = snprintf(database->index_path, sizeof(database->index_path), "%s.idx", path);
+    if (r < 0 || (size_t) r >= sizeof(database->index_path))
+    {
+        return -1;
+    }
+
+    database->log_fd = open(database->log_path, O_RDWR | O_CREAT, 0600);
+    database->index_fd = open(database->index_path, O_RDWR | O_CREAT, 0600);
+    if (database->log_fd < 0 || database->index_fd < 0)
+    {
+        rd_close(database);
+        return -1;
+    }
+
+    if (fstat(database->log_fd, &log_stat) < 0 || fstat(database->index_fd, &index_stat) < 0)
+    {
+        rd_close(database);
+        return -1;
+    }
+
+    /// index
+    if ((size_t) index_stat.st_size >= sizeof(revocation_database_index_header_t))
+    {
+        database->index_length = (size_t) index_stat.st_size;
+        database->index = mmap(NULL, database->index_length, PROT_READ | PROT_WRITE, MAP_SHARED, database->index_fd, 0);
+        if (database->index == MAP_FAILED)
+        {
+            database->index = NULL;
+        }
+        else
+        {
+            database->header = (revocation_database_index_header_t *) database->index;
+            database->slots = (revocation_database_index_slot_t *) (database->header + 1);
+        }
+    }
+
+    // missing or inconsistent index (e.g. the index reached the disk but the log did not)
+    if (database->index == NULL || database->header->magic != REVOCATION_DATABASE_INDEX_MAGIC ||
+        database->header->num_slots == 0 || (database->header->num_slots & (database->header->num_slots - 1)) != 0 ||
+        database->index_length != sizeof(revocation_database_index_header_t) + database->header->num_slots * sizeof(revocation_database_index_slot_t) ||
+        database->header->log_length > (uint64_t) log_stat.st_size || database->header->log_length % sizeof(revocation_database_record_t) != 0)
+    {
+        r = rd_create_index(database, REVOCATION_DATABASE_INDEX_SLOTS);
+        if (r < 0)
+        {
+            rd_close(database);
+            return -1;
+        }
+    }
+
+    /// recovery (only the tail of the log not covered by the index)
+    r = rd_replay(database, database->header->log_length);
+    if (r == 0 && rd_validate_index(database) < 0)
+    {
+        // the whole log is replayed into a new index
+        r = rd_create_index(database, REVOCATION_DATABASE_INDEX_SLOTS);
+        if (r == 0)
+        {
+            r = rd_replay(database, 0);
+        }
+    }
+    if (r < 0)
+    {
+        rd_close(database);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * Appends a record to the log and updates the index.
+ *
+ * @param database the revocation database
+ * @param record the record
+ * @return 0 if success else -1
+ */
+static int rd_append(revocation_database_t *database, revocation_database_record_t *record)
+{
+    ssize_t length;
+    int r;
+
+    record->checksum = rd_checksum(record);
+
+    length = pwrite(database->log_fd, record, sizeof(revocation_database_record_t), (off_t) database->log_length);
+    if (length != sizeof(revocation_database_record_t))
+    {
+        return -1;
+    }
+
+    r = rd_index_record(database, record, database->log_length);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    // the index header covers the record from the next rd_sync, once the record is on the disk
+    database->log_length += sizeof(revocation_database_record_t);
+
+    return 0;
+}
+
+/**
+ * Reads the last record of a user.
+ *
+ * @param database the revocation database
+ * @param identifier the user identifier
+ * @param record the record
+ * @return 0 if success else -1 (the user does not exist)
+ */
+static int rd_find_record(const revocation_database_t *database, user_identifier_t identifier, revocation_database_record_t *record)
+{
+    revocation_database_index_slot_t *slot;
+
+    if (identifier.buffer_length > USER_MAX_ID_LENGTH)
+    {
+        return -1;
+    }
+
+    slot = rd_find_slot(database, identifier.buffer, identifier.buffer_length, checksum_fnv1a(identifier.buffer, identifier.buffer_length));
+    if (slot->offset == 0)
+    {
+        return -1;
+    }
+
+    return rd_read_record(database, slot->offset - 1, record);
+}
+
+/**
+ * Inserts a user (or replaces its mr if it already exists).
+ *
+ * @param database the revocation database
+ * @param identifier the user identifier
+ * @param mr the revocation attribute of the user
+ * @return 0 if success else -1
+ */
+int rd_insert(revocation_database_t *database, user_identifier_t identifier, mclBnFr mr)
+{
+    revocation_database_record_t record;
+    int r;
+
+    if (database == NULL || database->index == NULL || identifier.buffer_length > USER_MAX_ID_LENGTH)
+    {
+        return -1;
+    }
+
+    memset(&record, 0, sizeof(record));
+    record.identifier_length = identifier.buffer_length;
+    memcpy(record.identifier, identifier.buffer, identifier.buffer_length);
+
+    r = mcl_Fr_to_bytes(record.mr, EC_SIZE, mr);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    return rd_append(database, &record);
+}
+
+/**
+ * Sets the revocation handler i of a user.
+ *
+ * @param database the revocation database
+ * @param identifier the user identifier
+ * @param i the revocation handler
+ * @return 0 if success else -1
+ */
+int rd_set_handler(revocation_database_t *database, user_identifier_t identifier, mclBnFr i)
+{
+    revocation_database_record_t record;
+    int r;
+
+    if (database == NULL || database->index == NULL)
+    {
+        return -1;
+    }
+
+    r = rd_find_record(database, identifier, &record);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    r = mcl_Fr_to_bytes(record.i, EC_SIZE, i);
+    if (r < 0)
+    {
+        return -1;
+    }
+    record.has_handler = 1;
+
+    return rd_append(database, &record);
+}
+
+/**
+ * Looks up a user.
+ *
+ * @param database the revocation database
+ * @param identifier the user identifier
+ * @param entry the entry of the user
+ * @return 0 if success else -1 (the user does not exist)
+ */
+int rd_lookup(const revocation_database_t *database, user_identifier_t identifier, revocation_database_entry_t *entry)
+{
+    revocation_database_record_t record;
+    int r;
+
+    if (database == NULL || database->index == NULL || entry == NULL)
+    {
+        return -1;
+    }
+
+    r = rd_find_record(database, identifier, &record);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    r = mcl_bytes_to_Fr(&entry->mr, record.mr, EC_SIZE);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    if (record.has_handler)
+    {
+        r = mcl_bytes_to_Fr(&entry->i, record.i, EC_SIZE);
+        if (r < 0)
+        {
+            return -1;
+        }
+    }
+    else
+    {
+        mclBnFr_clear(&entry->i);
+    }
+
+    entry->has_handler = record.has_handler;
+    entry->revoked = record.revoked;
+
+    return 0;
+}
+
+/**
+ * Revokes a user.
+ *
+ * @param database the revocation database
+ * @param identifier the user identifier
+ * @param mr the revocation attribute of the revoked user (can be NULL)
+ * @return 0 if success else -1 (the user does not exist)
+ */
+int rd_revoke(revocation_database_t *database, user_identifier_t identifier, mclBnFr *mr)
+{
+    revocation_database_record_t record;
+    int r;
+
+    if (database == NULL || database->index == NULL)
+    {
+        return -1;
+    }
+
+    r = rd_find_record(database, identifier, &record);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    if (mr != NULL)
+    {
+        r = mcl_bytes_to_Fr(mr, record.mr, EC_SIZE);
+        if (r < 0)
+        {
+            return -1;
+        }
+    }
+
+    // already revoked
+    if (record.revoked)
+    {
+        return 0;
+    }
+
+    record.revoked = 1;
+
+    return rd_append(database, &record);
+}
+
+/**
+ * Gets the revocation attributes of all the revoked users, used to compute
+ * the revocation list of an epoch.
+ *
+ * @param database the revocation database
+ * @param revoked_mr the revocation attributes (allocated, must be freed by the caller)
+ * @param num_revoked the number of revoked users
+ * @return 0 if success else -1
+ */
+int rd_get_revoked(const revocation_database_t *database, mclBnFr **revoked_mr, size_t *num_revoked)
+{
+    revocation_database_record_t record;
+
+    uint64_t it;
+    int r;
+
+    if (database == NULL || database->index == NULL || revoked_mr == NULL || num_revoked == NULL)
+    {
+        return -1;
+    }
+
+    *num_revoked = 0;
+    *revoked_mr = malloc((database->header->num_entries + 1) * sizeof(mclBnFr));
+    if (*revoked_mr == NULL)
+    {
+        return -1;
+    }
+
+    for (it = 0; it < database->header->num_slots; it++)
+    {
+        if (database->slots[it].offset == 0)
+        {
+            continue;
+        }
+
+        r = rd_read_record(database, database->slots[it].offset - 1, &record);
+        if (r < 0)
+        {
+            free(*revoked_mr);
+            *revoked_mr = NULL;
+            return -1;
+        }
+
+        if (record.revoked)
+        {
+            r = mcl_bytes_to_Fr(&(*revoked_mr)[*num_revoked], record.mr, EC_SIZE);
+            if (r < 0)
+            {
+                free(*revoked_mr);
+                *revoked_mr = NULL;
+                return -1;
+            }
+            (*num_revoked)++;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Flushes the log and the index to the disk.
+ *
+ * @param database the revocation database
+ * @return 0 if success else -1
+ */
+int rd_sync(revocation_database_t *database)
+{
+    int r;
+
+    if (database == NULL || database->index == NULL)
+    {
+        return -1;
+    }
+
+    // the log first, the index must never cover records that are not on the disk
+    r = fdatasync(database->log_fd);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    database->header->log_length = database->log_length;
+
+    r = msync(database->index, database->index_length, MS_SYNC);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * Flushes and closes the revocation database.
+ *
+ * @param database the revocation database
+ */
+void rd_close(revocation_database_t *database)
+{
+    if (database == NULL)
+    {
+        return;
+    }
+
+    if (database->index != NULL)
+    {
+        rd_sync(database);
+        munmap(database->index, database->index_length);
+        database->index = NULL;
+    }
+
+    if (database->log_fd >= 0)
+    {
+        close(database->log_fd);
+        database->log_fd = -1;
+    }
+
+    if (database->index_fd >= 0)
+    {
+        close(database->index_fd);
+        database->index_fd = -1;
+    }
+}
@@ -0,0 +1,205 @@
+/**
+ *
+ *  Copyright (C) 2020  Raul Casanova Marques
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __RKVAC_PROTOCOL_REVOCATION_DATABASE_H_
+#define __RKVAC_PROTOCOL_REVOCATION_DATABASE_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <mcl/bn_c256.h>
+
+#include "config/config.h"
+
+#include "models/user.h"
+
+#include "helpers/hash_helper.h"
+#include "helpers/mcl_helper.h"
+
+/*
+ * Magic number of the index file ("RKVACIDX")
+ */
+#define REVOCATION_DATABASE_INDEX_MAGIC 0x5844494341564B52ULL
+
+/*
+ * Number of slots of a new index (power of two)
+ */
+#define REVOCATION_DATABASE_INDEX_SLOTS 1024
+
+typedef struct
+{
+    uint8_t revoked; // 1 if the user has been revoked
+    uint8_t has_handler; // 1 if the revocation handler i is set
+    uint8_t identifier_length;
+    uint8_t reserved0;
+    uint32_t checksum; // FNV-1a of the record (computed with checksum = 0)
+    uint8_t identifier[USER_MAX_ID_LENGTH];
+    uint8_t reserved1[3];
+    uint8_t mr[EC_SIZE]; // big-endian
+    uint8_t i[EC_SIZE]; // big-endian
+} revocation_database_record_t;
+
+typedef struct
+{
+    uint64_t magic;
+    uint64_t num_slots; // power of two
+    uint64_t num_entries;
+    uint64_t log_length; // length of the log indexed by the slots (on the disk at the last rd_sync)
+    uint8_t reserved[32]; // one cache line
+} revocation_database_index_header_t;
+
+typedef struct
+{
+    uint64_t hash; // hash of the identifier
+    uint64_t offset; // offset of the last record of the user in the log + 1 (0 - empty)
+} revocation_database_index_slot_t;
+
+/*
+ * IMPORTANT!
+ *
+ * The revocation database RD is an append-only log of fixed-size records
+ * (every record holds the whole state of a user: identifier, mr, revocation
+ * handler i and revoked flag) and a memory-mapped open-addressing index from
+ * the identifier to the offset of its last record. The index header tells
+ * how much of the log the index covers (updated by rd_sync once the log is on
+ * the disk), so a recovery after a crash only replays the tail of the log.
+ * A torn record at the end of the log is discarded, and an index whose slots
+ * point beyond the recovered log is rebuilt from the whole log. The records
+ * are durable after rd_sync or rd_close.
+ */
+typedef struct
+{
+    char log_path[FILENAME_MAX];
+    char index_path[FILENAME_MAX];
+
+    int log_fd;
+    int index_fd;
+
+    uint64_t log_length;
+
+    void *index;
+    size_t index_length;
+    revocation_database_index_header_t *header;
+    revocation_database_index_slot_t *slots;
+} revocation_database_t;
+
+typedef struct
+{
+    mclBnFr mr;
+    mclBnFr i; // revocation handler
+    int has_handler;
+    int revoked;
+} revocation_database_entry_t;
+
+/**
+ * Opens the revocation database (path.log and path.idx), creating it if it does
+ * not exist, and replays the records of the log not covered by the index.
+ *
+ * @param database the revocation database
+ * @param path the path of the database files (without extension)
+ * @return 0 if success else -1
+ */
+extern int rd_open(revocation_database_t *database, const char *path);
+
+/**
+ * Inserts a user (or replaces its mr if it already exists).
+ *
+ * @param database the revocation database
+ * @param identifier the user identifier
+ * @param mr the revocation attribute of the user
+ * @return 0 if success else -1
+ */
+extern int rd_insert(revocation_database_t *database, user_identifier_t identifier, mclBnFr mr);
+
+/**
+ * Sets the revocation handler i of a user.
+ *
+ * @param database the revocation database
+ * @param identifier the user identifier
+ * @param i the revocation handler
+ * @return 0 if success else -1
+ */
+extern int rd_set_handler(revocation_database_t *database, user_identifier_t identifier, mclBnFr i);
+
+/**
+ * Looks up a user.
+ *
+ * @param database the revocation database
+ * @param identifier the user identifier
+ * @param entry the entry of the user
+ * @return 0 if success else -1 (the user does not exist)
+ */
+extern int rd_lookup(const revocation_database_t *database, user_identifier_t identifier, revocation_database_entry_t *entry);
+
+/**
+ * Revokes a user.
+ *
+ * @param database the revocation database
+ * @param identifier the user identifier
+ * @param mr the revocation attribute of the revoked user (can be NULL)
+ * @return 0 if success else -1 (the user does not exist)
+ */
+extern int rd_revoke(revocation_database_t *database, user_identifier_t identifier, mclBnFr *mr);
+
+/**
+ * Gets the revocation attributes of all the revoked users, used to compute
+ * the revocation list of an epoch.
+ *
+ * @param database the revocation database
+ * @param revoked_mr the revocation attributes (allocated, must be freed by the caller)
+ * @param num_revoked the number of revoked users
+ * @return 0 if success else -1
+ */
+extern int rd_get_revoked(const revocation_database_t *database, mclBnFr **revoked_mr, size_t *num_revoked);
+
+/**
+ * Flushes the log and the index to the disk.
+ *
+ * @param database the revocation database
+ * @return 0 if success else -1
+ */
+extern int rd_sync(revocation_database_t *database);
+
+/**
+ * Flushes and closes the revocation database.
+ *
+ * @param database the revocation database
+ */
+extern void rd_close(revocation_database_t *database);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RKVAC_PROTOCOL_REVOCATION_DATABASE_H_ */
@@ -0,0 +1,680 @@
+/**
+ *
+ *  Copyright (C) 2020  Raul Casanova Marques
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "delta.h"
+
+/**
+ * Maps the delta log file.
+ *
+ * @param delta the delta log
+ * @param length the length of the file
+ * @return 0 if success else -1
+ */
+static int rl_delta_map(revocation_delta_t *delta, size_t length)
+{
+    if (delta->image != NULL)
+    {
+        munmap(delta->image, delta->image_length);
+        delta->image = NULL;
+    }
+
+    delta->image = mmap(NULL, length, delta->writer ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, delta->fd, 0);
+    if (delta->image == MAP_FAILED)
+    {
+        delta->image = NULL;
+        return -1;
+    }
+    delta->image_length = length;
+
+    delta->header = (revocation_delta_header_t *) delta->image;
+    delta->records = (revocation_delta_record_t *) (delta->header + 1);
+
+    return 0;
+}
+
+/**
+ * Creates the delta log, or opens it to append more deltas (revocation authority).
+ *
+ * @param delta the delta log
+ * @param path the path of the delta log
+ * @return 0 if success else -1
+ */
+int rl_delta_create(revocation_delta_t *delta, const char *path)
+{
+    struct stat delta_stat;
+    size_t length;
+    int r;
+
+    if (delta == NULL || path == NULL)
+    {
+        return -1;
+    }
+
+    if (strlen(path) >= sizeof(delta->path))
+    {
+        return -1;
+    }
+
+    memset(delta, 0, sizeof(revocation_delta_t));
+    delta->writer = 1;
+    strcpy(delta->path, path);
+
+    delta->fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (delta->fd < 0)
+    {
+        return -1;
+    }
+
+    r = fstat(delta->fd, &delta_stat);
+    if (r < 0)
+    {
+        rl_delta_close(delta);
+        return -1;
+    }
+
+    // existing delta log
+    if ((size_t) delta_stat.st_size >= sizeof(revocation_delta_header_t))
+    {
+        r = rl_delta_map(delta, (size_t) delta_stat.st_size);
+        if (r == 0 && delta->header->magic == REVOCATION_DELTA_MAGIC && delta->header->length <= delta->header->capacity && !delta->header->rotated &&
+            sizeof(revocation_delta_header_t) + delta->header->capacity * sizeof(revocation_delta_record_t) == (size_t) delta_stat.st_size)
+        {
+            return 0;
+        }
+    }
+
+    // new delta log
+    length = sizeof(revocation_delta_header_t) + REVOCATION_DELTA_INITIAL_RECORDS * sizeof(revocation_delta_record_t);
+    r = ftruncate(delta->fd, 0);
+    if (r == 0)
+    {
+        r = ftruncate(delta->fd, (off_t) length);
+    }
+    if (r < 0 || rl_delta_map(delta, length) < 0)
+    {
+        rl_delta_close(delta);
+        return -1;
+    }
+
+    delta->header->capacity = REVOCATION_DELTA_INITIAL_RECORDS;
+    delta->header->length = 0;
+    delta->header->rotated = 0;
+    __atomic_store_n(&delta->header->magic, REVOCATION_DELTA_MAGIC, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+/**
+ * Opens the delta log to tail it (verifier).
+ *
+ * @param delta the delta log
+ * @param path the path of the delta log
+ * @return 0 if success else -1
+ */
+int rl_delta_open(revocation_delta_t *delta, const char *path)
+{
+    struct stat delta_stat;
+    int r;
+
+    if (delta == NULL || path == NULL)
+    {
+        return -1;
+    }
+
+    if (strlen(path) >= sizeof(delta->path))
+    {
+        return -1;
+    }
+
+    memset(delta, 0, sizeof(revocation_delta_t));
+    strcpy(delta->path, path);
+
+    // the log starts with the latest rebuild, the reader starts there
+    delta->fd = open(path, O_RDONLY);
+    if (delta->fd < 0)
+    {
+        return -1;
+    }
+
+    r = fstat(delta->fd, &delta_stat);
+    if (r < 0 || (size_t) delta_stat.st_size < sizeof(revocation_delta_header_t))
+    {
+        rl_delta_close(delta);
+        return -1;
+    }
+
+    r = rl_delta_map(delta, (size_t) delta_stat.st_size);
+    if (r < 0 || __atomic_load_n(&delta->header->magic, __ATOMIC_ACQUIRE) != REVOCATION_DELTA_MAGIC)
+    {
+        rl_delta_close(delta);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * Makes room for new records at the end of the delta log (writer).
+ *
+ * @param delta the delta log
+ * @param num_records the number of new records
+ * @return 0 if success else -1
+ */
+static int rl_delta_reserve(revocation_delta_t *delta, uint64_t num_records)
+{
+    uint64_t capacity = delta->header->capacity;
+    size_t length;
+    int r;
+
+    if (delta->header->length + num_records <= capacity)
+    {
+        return 0;
+    }
+
+    while (delta->header->length + num_records > capacity)
+    {
+        capacity *= 2;
+    }
+
+    // the committed records do not move, the readers remap the file when they reach the end of their mapping
+    length = sizeof(revocation_delta_header_t) + capacity * sizeof(revocation_delta_record_t);
+    r = ftruncate(delta->fd, (off_t) length);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    r = rl_delta_map(delta, length);
+    if (r < 0)
+    {
+        return -1;
+    }
+    delta->header->capacity = capacity;
+
+    return 0;
+}
+
+/**
+ * Writes the keys of a revocation list after the committed records and commits
+ * them (the room for the records must have been reserved).
+ *
+ * @param delta the delta log
+ * @param list the revocation list
+ * @param next_epoch 1 if the list is the list of the next epoch else 0
+ */
+static void rl_delta_write(revocation_delta_t *delta, const revocation_list_t *list, int next_epoch)
+{
+    revocation_delta_record_t *record;
+    uint64_t length;
+    size_t it;
+
+    length = delta->header->length;
+
+    if (next_epoch)
+    {
+        record = &delta->records[length++];
+        memset(record, 0, sizeof(revocation_delta_record_t));
+        record->type = REVOCATION_DELTA_EPOCH;
+        memcpy(record->epoch, list->header->epoch, EPOCH_LENGTH);
+        record->num_keys = list->header->num_entries;
+    }
+
+    for (it = 0; it < list->header->num_slots; it++)
+    {
+        if ((list->slots[it].key[0] & REVOCATION_LIST_KEY_USED) == 0)
+        {
+            continue;
+        }
+
+        record = &delta->records[length++];
+        memset(record, 0, sizeof(revocation_delta_record_t));
+        record->type = REVOCATION_DELTA_ADD;
+        memcpy(record->epoch, list->header->epoch, EPOCH_LENGTH);
+        memcpy(record->key, list->slots[it].key, REVOCATION_LIST_KEY_LENGTH);
+    }
+
+    // commit
+    __atomic_store_n(&delta->header->length, length, __ATOMIC_RELEASE);
+}
+
+/**
+ * Replaces the delta log by a new one starting with the rebuild of the list
+ * of the next epoch (writer). The old file is marked as rotated once the new
+ * one has been renamed over it, its readers then reopen the log.
+ *
+ * @param delta the delta log
+ * @param list the revocation list of the next epoch
+ * @return 0 if success else -1
+ */
+static int rl_delta_rotate(revocation_delta_t *delta, const revocation_list_t *list)
+{
+    revocation_delta_t rotated;
+    char path[sizeof(delta->path)];
+
+    uint64_t capacity = REVOCATION_DELTA_INITIAL_RECORDS;
+    size_t length;
+    int r;
+
+    r = snprintf(path, sizeof(path), "%s.tmp", delta->path);
+    if (r < 0 || (size_t) r >= sizeof(path))
+    {
+        return -1;
+    }
+
+    // room for the rebuild and as many keys revoked within the epoch
+    while (capacity < 2 * (list->header->num_entries + 1))
+    {
+        capacity *= 2;
+    }
+
+    memset(&rotated, 0, sizeof(revocation_delta_t));
+    rotated.writer = 1;
+    strcpy(rotated.path, delta->path);
+
+    rotated.fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (rotated.fd < 0)
+    {
+        return -1;
+    }
+
+    length = sizeof(revocation_delta_header_t) + capacity * sizeof(revocation_delta_record_t);
+    r = ftruncate(rotated.fd, (off_t) length);
+    if (r < 0 || rl_delta_map(&rotated, length) < 0)
+    {
+        rl_delta_close(&rotated);
+        unlink(path);
+        return -1;
+    }
+
+    rotated.header->capacity = capacity;
+    rotated.header->length = 0;
+    rotated.header->rotated = 0;
+    rotated.header->magic = REVOCATION_DELTA_MAGIC;
+
+    rl_delta_write(&rotated, list, 1);
+
+    r = rename(path, delta->path);
+    if (r < 0)
+    {
+        rl_delta_close(&rotated);
+        unlink(path);
+        return -1;
+    }
+
+    // no more records in the old file (its committed records are still applied by its readers)
+    __atomic_store_n(&delta->header->rotated, 1, __ATOMIC_RELEASE);
+
+    rl_delta_close(delta);
+    memcpy(delta, &rotated, sizeof(revocation_delta_t));
+
+    return 0;
+}
+
+/**
+ * Appends the keys of a revocation list: as keys revoked within the epoch of
+ * the list, or as the rebuild of the list of the next epoch (the log is then
+ * replaced by a new one starting with the rebuild).
+ *
+ * @param delta the delta log
+ * @param list the revocation list
+ * @param next_epoch 1 if the list is the list of the next epoch else 0
+ * @return 0 if success else -1
+ */
+int rl_delta_append(revocation_delta_t *delta, const revocation_list_t *list, int next_epoch)
+{
+    int r;
+
+    if (delta == NULL || delta->image == NULL || !delta->writer || list == NULL || list->image == NULL)
+    {
+        return -1;
+    }
+
+    if (next_epoch)
+    {
+        return rl_delta_rotate(delta, list);
+    }
+
+    r = rl_delta_reserve(delta, list->header->num_entries);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    rl_delta_write(delta, list, 0);
+
+    return 0;
+}
+
+/**
+ * Creates a list with room for new keys and copies the keys of another list.
+ *
+ * @param list the new list (allocated with malloc)
+ * @param source the copied list or NULL
+ * @param max_entries the maximum number of keys of the new list
+ * @param epoch the epoch of the new list
+ * @return 0 if success else -1
+ */
+static int rl_delta_create_list(revocation_list_t **list, const revocation_list_t *source, size_t max_entries, const uint8_t *epoch)
+{
+    size_t it;
+    int r;
+
+    *list = malloc(sizeof(revocation_list_t));
+    if (*list == NULL)
+    {
+        return -1;
+    }
+
+    r = rl_create(*list, max_entries, epoch, EPOCH_LENGTH);
+    if (r < 0)
+    {
+        free(*list);
+        *list = NULL;
+        return -1;
+    }
+
+    for (it = 0; source != NULL && it < source->header->num_slots; it++)
+    {
+        if ((source->slots[it].key[0] & REVOCATION_LIST_KEY_USED) == 0)
+        {
+            continue;
+        }
+
+        r = rl_add_key(*list, source->slots[it].key);
+        if (r < 0)
+        {
+            rl_destroy(*list);
+            free(*list);
+            *list = NULL;
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Adds the keys revoked within the epoch to a copy of the current list, and
+ * publishes the copy once (the published lists are immutable).
+ *
+ * @param snapshot the revocation list snapshot
+ * @param records the ADD records
+ * @param num_records the number of records
+ * @return 0 if success else -1
+ */
+static int rl_delta_apply_adds(revocation_snapshot_t *snapshot, const revocation_delta_record_t *records, uint64_t num_records)
+{
+    revocation_list_t *current, *list;
+    uint64_t it, num_keys;
+    int r;
+
+    current = __atomic_load_n(&snapshot->current, __ATOMIC_ACQUIRE);
+    if (current == NULL)
+    {
+        return 0;
+    }
+
+    // keys of another epoch (the list of their epoch is not the current one)
+    for (it = 0, num_keys = 0; it < num_records; it++)
+    {
+        num_keys += memcmp(current->header->epoch, records[it].epoch, EPOCH_LENGTH) == 0;
+    }
+    if (num_keys == 0)
+    {
+        return 0;
+    }
+
+    r = rl_delta_create_list(&list, current, current->header->num_entries + num_keys, current->header->epoch);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    for (it = 0; it < num_records; it++)
+    {
+        if (memcmp(current->header->epoch, records[it].epoch, EPOCH_LENGTH) != 0)
+        {
+            continue;
+        }
+
+        r = rl_add_key(list, records[it].key);
+        if (r < 0)
+        {
+            rl_destroy(list);
+            free(list);
+            return -1;
+        }
+    }
+
+    return rs_publish(snapshot, list);
+}
+
+/**
+ * Publishes the rebuild of the list of the next epoch. The num_keys records
+ * following the rebuild must be the keys (ADD records) of its epoch.
+ *
+ * @param snapshot the revocation list snapshot
+ * @param record the record of the rebuild
+ * @return 0 if success else -1
+ */
+static int rl_delta_apply_epoch(revocation_snapshot_t *snapshot, const revocation_delta_record_t *record)
+{
+    revocation_list_t *list;
+    uint64_t it;
+    int r;
+
+    r = rl_delta_create_list(&list, NULL, record->num_keys, record->epoch);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    for (it = 1; it <= record->num_keys; it++)
+    {
+        r = -1;
+        if (record[it].type == REVOCATION_DELTA_ADD && memcmp(record[it].epoch, record->epoch, EPOCH_LENGTH) == 0)
+        {
+            r = rl_add_key(list, record[it].key);
+        }
+        if (r < 0)
+        {
+            rl_destroy(list);
+            free(list);
+            return -1;
+        }
+    }
+
+    return rs_publish(snapshot, list);
+}
+
+/**
+ * Applies the committed records of the mapped file up to length.
+ *
+ * @param delta the delta log
+ * @param snapshot the revocation list snapshot
+ * @param length the number of committed records
+ * @return 0 if success else -1
+ */
+static int rl_delta_apply_records(revocation_delta_t *delta, revocation_snapshot_t *snapshot, uint64_t length)
+{
+    const revocation_delta_record_t *record;
+    struct stat delta_stat;
+
+    uint64_t capacity, num_records;
+    int r;
+
+    if (length == delta->position)
+    {
+        return 0;
+    }
+
+    // the writer has grown the file
+    capacity = (delta->image_length - sizeof(revocation_delta_header_t)) / sizeof(revocation_delta_record_t);
+    if (length > capacity)
+    {
+        r = fstat(delta->fd, &delta_stat);
+        if (r < 0 || rl_delta_map(delta, (size_t) delta_stat.st_size) < 0)
+        {
+            return -1;
+        }
+        capacity = (delta->image_length - sizeof(revocation_delta_header_t)) / sizeof(revocation_delta_record_t);
+        if (length > capacity)
+        {
+            return -1;
+        }
+    }
+
+    while (delta->position < length)
+    {
+        record = &delta->records[delta->position];
+
+        switch (record->type)
+        {
+            case REVOCATION_DELTA_ADD:
+            {
+                // the following ADD records are applied at once
+                for (num_records = 1; delta->position + num_records < length && record[num_records].type == REVOCATION_DELTA_ADD; num_records++)
+                {
+                }
+
+                r = rl_delta_apply_adds(snapshot, record, num_records);
+                if (r < 0)
+                {
+                    return -1;
+                }
+                delta->position += num_records;
+
+                break;
+            }
+            case REVOCATION_DELTA_EPOCH:
+            {
+                // the keys are committed with the rebuild
+                if (record->num_keys > length - delta->position - 1)
+                {
+                    return -1;
+                }
+
+                r = rl_delta_apply_epoch(snapshot, record);
+                if (r < 0)
+                {
+                    return -1;
+                }
+                delta->position += record->num_keys + 1;
+
+                break;
+            }
+            default:
+            {
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Applies the committed deltas not applied yet to the revocation list of the
+ * snapshot, and follows the rotations of the log. The caller is the only
+ * writer of the snapshot.
+ *
+ * @param delta the delta log
+ * @param snapshot the revocation list snapshot
+ * @param num_applied the number of applied records (can be NULL)
+ * @return 0 if success else -1
+ */
+int rl_delta_apply(revocation_delta_t *delta, revocation_snapshot_t *snapshot, size_t *num_applied)
+{
+    revocation_delta_t reopened;
+
+    uint64_t length, rotated, start;
+    int r;
+
+    if (delta == NULL || delta->image == NULL || snapshot == NULL)
+    {
+        return -1;
+    }
+
+    if (num_applied != NULL)
+    {
+        *num_applied = 0;
+    }
+
+    for (;;)
+    {
+        // the writer commits the last records of a file before marking it as rotated
+        rotated = __atomic_load_n(&delta->header->rotated, __ATOMIC_ACQUIRE);
+        length = __atomic_load_n(&delta->header->length, __ATOMIC_ACQUIRE);
+
+        start = delta->position;
+        r = rl_delta_apply_records(delta, snapshot, length);
+        if (num_applied != NULL)
+        {
+            *num_applied += (size_t) (delta->position - start);
+        }
+        if (r < 0)
+        {
+            return -1;
+        }
+
+        if (!rotated)
+        {
+            return 0;
+        }
+
+        // the new file starts with the rebuild of the latest epoch
+        r = rl_delta_open(&reopened, delta->path);
+        if (r < 0)
+        {
+            return -1;
+        }
+        rl_delta_close(delta);
+        memcpy(delta, &reopened, sizeof(revocation_delta_t));
+    }
+}
+
+/**
+ * Closes the delta log.
+ *
+ * @param delta the delta log
+ */
+void rl_delta_close(revocation_delta_t *delta)
+{
+    if (delta == NULL)
+    {
+        return;
+    }
+
+    if (delta->image != NULL)
+    {
+        if (delta->writer)
+        {
+            msync(delta->image, delta->image_length, MS_SYNC);
+        }
+        munmap(delta->image, delta->image_length);
+        delta->image = NULL;
+    }
+
+    if (delta->fd >= 0)
+    {
+        close(delta->fd);
+        delta->fd = -1;
+    }
+}
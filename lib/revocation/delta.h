@@ -0,0 +1,167 @@
+/**
+ *
+ *  Copyright (C) 2020  Raul Casanova Marques
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __RKVAC_PROTOCOL_REVOCATION_DELTA_H_
+#define __RKVAC_PROTOCOL_REVOCATION_DELTA_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "config/config.h"
+
+#include "revocation/list.h"
+#include "revocation/snapshot.h"
+
+/*
+ * Magic number of the delta log ("RKVACDLT")
+ */
+#define REVOCATION_DELTA_MAGIC 0x544C444341564B52ULL
+
+/*
+ * Number of records of a new delta log
+ */
+#define REVOCATION_DELTA_INITIAL_RECORDS 1024
+
+typedef enum
+{
+    REVOCATION_DELTA_ADD = 1, // key revoked within the epoch
+    REVOCATION_DELTA_EPOCH = 2 // rebuild of the list of the next epoch, followed by its num_keys keys (ADD records of the epoch)
+} revocation_delta_type_t;
+
+typedef struct
+{
+    uint64_t magic;
+    uint64_t length; // number of committed records
+    uint64_t capacity; // number of records of the file
+    uint64_t rotated; // 1 once the log has been replaced by a compacted one (no more records)
+    uint8_t reserved[32]; // one cache line
+} revocation_delta_header_t;
+
+typedef struct
+{
+    uint8_t type;
+    uint8_t reserved0[3];
+    uint8_t epoch[EPOCH_LENGTH];
+    uint64_t num_keys; // REVOCATION_DELTA_EPOCH only
+    uint8_t reserved1[16];
+    uint8_t key[REVOCATION_LIST_KEY_LENGTH];
+} revocation_delta_record_t;
+
+/*
+ * IMPORTANT!
+ *
+ * The delta log is a memory-mapped append log of the changes of the revocation
+ * list, written by the revocation authority and tailed by the verifiers. The
+ * writer fills the records and then commits them by storing the new length in
+ * the header, so a reader only sees whole deltas (a rebuild of the next epoch
+ * is committed with all its keys). A reader applies the deltas without
+ * rebuilding the list: the keys revoked within the epoch are added to a copy of
+ * the current list published once per pass (the published lists are
+ * immutable), a rebuild creates and publishes the list of the next epoch.
+ *
+ * A rebuild replaces all the previous deltas, so it is not appended: the writer
+ * writes it into a new file, renames it over the log and marks the old file as
+ * rotated. The log always starts with the latest rebuild, so it does not grow
+ * beyond one list and the deltas of its epoch, and a new reader starts at the
+ * latest rebuild. A reader of a rotated file applies its last records and then
+ * reopens the log.
+ */
+typedef struct
+{
+    int fd;
+    int writer;
+
+    void *image;
+    size_t image_length;
+    revocation_delta_header_t *header;
+    revocation_delta_record_t *records;
+
+    char path[FILENAME_MAX]; // path of the log (reopened after a rotation)
+    uint64_t position; // next record to be applied (reader)
+} revocation_delta_t;
+
+/**
+ * Creates the delta log, or opens it to append more deltas (revocation authority).
+ *
+ * @param delta the delta log
+ * @param path the path of the delta log
+ * @return 0 if success else -1
+ */
+extern int rl_delta_create(revocation_delta_t *delta, const char *path);
+
+/**
+ * Opens the delta log to tail it (verifier).
+ *
+ * @param delta the delta log
+ * @param path the path of the delta log
+ * @return 0 if success else -1
+ */
+extern int rl_delta_open(revocation_delta_t *delta, const char *path);
+
+/**
+ * Appends the keys of a revocation list: as keys revoked within the epoch of
+ * the list, or as the rebuild of the list of the next epoch (the log is then
+ * replaced by a new one starting with the rebuild).
+ *
+ * @param delta the delta log
+ * @param list the revocation list
+ * @param next_epoch 1 if the list is the list of the next epoch else 0
+ * @return 0 if success else -1
+ */
+extern int rl_delta_append(revocation_delta_t *delta, const revocation_list_t *list, int next_epoch);
+
+/**
+ * Applies the committed deltas not applied yet to the revocation list of the
+ * snapshot, and follows the rotations of the log. The caller is the only
+ * writer of the snapshot.
+ *
+ * @param delta the delta log
+ * @param snapshot the revocation list snapshot
+ * @param num_applied the number of applied records (can be NULL)
+ * @return 0 if success else -1
+ */
+extern int rl_delta_apply(revocation_delta_t *delta, revocation_snapshot_t *snapshot, size_t *num_applied);
+
+/**
+ * Closes the delta log.
+ *
+ * @param delta the delta log
+ */
+extern void rl_delta_close(revocation_delta_t *delta);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RKVAC_PROTOCOL_REVOCATION_DELTA_H_ */
@@ -0,0 +1,337 @@
+/**
+ *
+ *  Copyright (C) 2020  Raul Casanova Marques
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "list.h"
+
+/*
+ * Bits of the Bloom filter set by each key (9 bits per position, one 64-bit hash)
+ */
+#define REVOCATION_LIST_NUM_HASHES 7
+
+/**
+ * Rounds a value up to the next power of two.
+ *
+ * @param value the value
+ * @return the power of two
+ */
+static uint64_t rl_next_power_of_two(uint64_t value)
+{
+    uint64_t power = 1;
+
+    while (power < value)
+    {
+        power <<= 1u;
+    }
+
+    return power;
+}
+
+/**
+ * Mixes the bits of a 64-bit value (splitmix64 finalizer).
+ *
+ * @param value the value
+ * @return the mixed value
+ */
+static uint64_t rl_mix(uint64_t value)
+{
+    value ^= value >> 30u;
+    value *= 0xBF58476D1CE4E5B9ULL;
+    value ^= value >> 27u;
+    value *= 0x94D049BB133111EBULL;
+    value ^= value >> 31u;
+
+    return value;
+}
+
+/**
+ * Computes the two hashes of a key: the first one selects the Bloom filter block
+ * and the first slot, the second one the bits of the block.
+ *
+ * @param list the revocation list
+ * @param key the key
+ * @param h1 the first hash
+ * @param h2 the second hash
+ */
+static void rl_hash(const revocation_list_t *list, const uint8_t key[REVOCATION_LIST_KEY_LENGTH], uint64_t *h1, uint64_t *h2)
+{
+    uint64_t words[4];
+
+    // the key is a coordinate of a point, its bytes are already uniformly distributed
+    memcpy(words, key, sizeof(words));
+
+    *h1 = rl_mix(words[3] ^ list->header->seed);
+    *h2 = rl_mix(words[2] ^ rl_mix(words[1] ^ list->header->seed));
+}
+
+/**
+ * Creates an empty revocation list.
+ *
+ * @param list the revocation list
+ * @param max_entries the maximum number of revoked pseudonyms
+ * @param epoch the epoch of the pseudonyms
+ * @param epoch_length the length of the epoch
+ * @return 0 if success else -1
+ */
+int rl_create(revocation_list_t *list, size_t max_entries, const void *epoch, size_t epoch_length)
+{
+    uint64_t num_blocks, num_slots;
+    int r;
+
+    if (list == NULL || epoch == NULL || epoch_length != EPOCH_LENGTH)
+    {
+        return -1;
+    }
+
+    memset(list, 0, sizeof(revocation_list_t));
+
+    if (max_entries == 0)
+    {
+        max_entries = 1;
+    }
+
+    // load factor of the hash set <= 3/4
+    num_slots = rl_next_power_of_two(((uint64_t) max_entries * 4 + 2) / 3);
+    num_blocks = rl_next_power_of_two(((uint64_t) max_entries * REVOCATION_LIST_BITS_PER_ENTRY + 511) / 512);
+
+    list->image_length = sizeof(revocation_list_header_t) + num_blocks * sizeof(revocation_list_block_t) + num_slots * sizeof(revocation_list_slot_t);
+
+    r = posix_memalign(&list->image, 64, list->image_length);
+    if (r != 0)
+    {
+        list->image = NULL;
+        return -1;
+    }
+    memset(list->image, 0, list->image_length);
+
+    list->header = (revocation_list_header_t *) list->image;
+    list->blocks = (revocation_list_block_t *) (list->header + 1);
+    list->slots = (revocation_list_slot_t *) (list->blocks + num_blocks);
+
+    memcpy(list->header->epoch, epoch, EPOCH_LENGTH);
+    list->header->num_blocks = num_blocks;
+    list->header->num_slots = num_slots;
+
+    r = RAND_bytes((unsigned char *) &list->header->seed, sizeof(list->header->seed));
+    if (r != 1)
+    {
+        rl_destroy(list);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * Computes the key of a pseudonym (canonical affine encoding).
+ *
+ * @param key the key of the pseudonym
+ * @param pseudonym the pseudonym
+ * @return 0 if success else -1
+ */
+int rl_compute_key(uint8_t key[REVOCATION_LIST_KEY_LENGTH], mclBnG1 pseudonym)
+{
+    uint8_t buffer[ECP_SIZE];
+    int r;
+
+    r = mcl_G1_to_bytes(buffer, sizeof(buffer), pseudonym);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    // 0x04 || x || y
+    memcpy(key, &buffer[1], REVOCATION_LIST_KEY_LENGTH);
+    key[0] |= REVOCATION_LIST_KEY_USED;
+    if (buffer[ECP_SIZE - 1] & 0x01u)
+    {
+        key[0] |= REVOCATION_LIST_KEY_Y_ODD;
+    }
+
+    return 0;
+}
+
+/**
+ * Adds the key of a pseudonym to the revocation list.
+ *
+ * @param list the revocation list
+ * @param key the key of the pseudonym
+ * @return 0 if success else -1 (the list is full)
+ */
+int rl_add_key(revocation_list_t *list, const uint8_t key[REVOCATION_LIST_KEY_LENGTH])
+{
+    revocation_list_block_t *block;
+    uint64_t h1, h2, position, mask;
+
+    size_t it;
+
+    if (list == NULL || list->image == NULL || key == NULL || (key[0] & REVOCATION_LIST_KEY_USED) == 0)
+    {
+        return -1;
+    }
+
+    rl_hash(list, key, &h1, &h2);
+
+    mask = list->header->num_slots - 1;
+    position = (h1 >> 32u) & mask;
+    while (list->slots[position].key[0] & REVOCATION_LIST_KEY_USED)
+    {
+        if (memcmp(list->slots[position].key, key, REVOCATION_LIST_KEY_LENGTH) == 0)
+        {
+            return 0; // already revoked
+        }
+        position = (position + 1) & mask;
+    }
+
+    // keep the load factor <= 3/4, so the probe sequences stay short
+    if ((list->header->num_entries + 1) * 4 > list->header->num_slots * 3)
+    {
+        return -1;
+    }
+
+    /*
+     * IMPORTANT!
+     *
+     * A single writer can add keys while the readers look them up (see
+     * rl_delta_apply): the first byte of the key (used flag) is published
+     * after the rest of the key, and the Bloom filter bits are set atomically.
+     */
+    memcpy(&list->slots[position].key[1], &key[1], REVOCATION_LIST_KEY_LENGTH - 1);
+    __atomic_store_n(&list->slots[position].key[0], key[0], __ATOMIC_RELEASE);
+    list->header->num_entries++;
+
+    block = &list->blocks[h1 & (list->header->num_blocks - 1)];
+    for (it = 0; it < REVOCATION_LIST_NUM_HASHES; it++)
+    {
+        __atomic_fetch_or(&block->bits[(h2 >> 6u) & 0x07u], 1ULL << (h2 & 0x3Fu), __ATOMIC_RELEASE);
+        h2 >>= 9u;
+    }
+
+    return 0;
+}
+
+/**
+ * Checks whether the key of a pseudonym is in the revocation list.
+ *
+ * @param list the revocation list
+ * @param key the key of the pseudonym
+ * @return 1 if the key is in the list else 0
+ */
+int rl_contains_key(const revocation_list_t *list, const uint8_t key[REVOCATION_LIST_KEY_LENGTH])
+{
+    const revocation_list_block_t *block;
+    uint64_t h1, h2, position, mask;
+
+    size_t it;
+
+    if (list == NULL || list->image == NULL || key == NULL)
+    {
+        return 0;
+    }
+
+    rl_hash(list, key, &h1, &h2);
+
+    // Bloom filter (one cache line)
+    block = &list->blocks[h1 & (list->header->num_blocks - 1)];
+    for (it = 0; it < REVOCATION_LIST_NUM_HASHES; it++)
+    {
+        if ((__atomic_load_n(&block->bits[(h2 >> 6u) & 0x07u], __ATOMIC_ACQUIRE) & (1ULL << (h2 & 0x3Fu))) == 0)
+        {
+            return 0;
+        }
+        h2 >>= 9u;
+    }
+
+    // hash set (a torn copy of a shared list may have no empty slot, see rl_shared_contains_key)
+    mask = list->header->num_slots - 1;
+    position = (h1 >> 32u) & mask;
+    for (it = 0; it <= mask && (__atomic_load_n(&list->slots[position].key[0], __ATOMIC_ACQUIRE) & REVOCATION_LIST_KEY_USED); it++)
+    {
+        if (memcmp(list->slots[position].key, key, REVOCATION_LIST_KEY_LENGTH) == 0)
+        {
+            return 1;
+        }
+        position = (position + 1) & mask;
+    }
+
+    return 0;
+}
+
+/**
+ * Adds a pseudonym to the revocation list.
+ *
+ * @param list the revocation list
+ * @param pseudonym the revoked pseudonym
+ * @return 0 if success else -1
+ */
+int rl_add(revocation_list_t *list, mclBnG1 pseudonym)
+{
+    uint8_t key[REVOCATION_LIST_KEY_LENGTH];
+    int r;
+
+    r = rl_compute_key(key, pseudonym);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    return rl_add_key(list, key);
+}
+
+/**
+ * Checks whether a pseudonym is in the revocation list.
+ *
+ * @param list the revocation list
+ * @param pseudonym the pseudonym
+ * @return 1 if the pseudonym is revoked, 0 if not, -1 if error
+ */
+int rl_is_revoked(const revocation_list_t *list, mclBnG1 pseudonym)
+{
+    uint8_t key[REVOCATION_LIST_KEY_LENGTH];
+    int r;
+
+    if (list == NULL || list->image == NULL)
+    {
+        return -1;
+    }
+
+    r = rl_compute_key(key, pseudonym);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    return rl_contains_key(list, key);
+}
+
+/**
+ * Releases the resources allocated by the revocation list.
+ *
+ * @param list the revocation list
+ */
+void rl_destroy(revocation_list_t *list)
+{
+    if (list == NULL)
+    {
+        return;
+    }
+
+    free(list->image);
+    memset(list, 0, sizeof(revocation_list_t));
+}
@@ -0,0 +1,161 @@
+/**
+ *
+ *  Copyright (C) 2020  Raul Casanova Marques
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __RKVAC_PROTOCOL_REVOCATION_LIST_H_
+#define __RKVAC_PROTOCOL_REVOCATION_LIST_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <mcl/bn_c256.h>
+#include <openssl/rand.h>
+
+#include "config/config.h"
+
+#include "helpers/mcl_helper.h"
+
+/*
+ * Length in bytes of the key of a pseudonym (x coordinate, big-endian)
+ */
+#define REVOCATION_LIST_KEY_LENGTH EC_SIZE
+
+/*
+ * The x coordinate is smaller than 2^254, so the two most significant bits
+ * of the key store whether the slot is used and the parity of y
+ */
+#define REVOCATION_LIST_KEY_USED    0x80u
+#define REVOCATION_LIST_KEY_Y_ODD   0x40u
+
+typedef struct
+{
+    uint8_t epoch[EPOCH_LENGTH]; // epoch of the pseudonyms
+    uint8_t padding[4];
+    uint64_t seed; // random seed of the hash function
+    uint64_t num_blocks; // number of Bloom filter blocks (power of two)
+    uint64_t num_slots; // number of hash set slots (power of two)
+    uint64_t num_entries;
+    uint8_t reserved[24]; // one cache line
+} revocation_list_header_t;
+
+typedef struct
+{
+    uint64_t bits[8]; // 512 bits, one cache line
+} revocation_list_block_t;
+
+typedef struct
+{
+    uint8_t key[REVOCATION_LIST_KEY_LENGTH];
+} revocation_list_slot_t;
+
+/*
+ * IMPORTANT!
+ *
+ * The revocation list is a single contiguous image: header, blocked Bloom
+ * filter and open-addressing hash set (linear probing, two slots per cache
+ * line). All the bits of a key in the Bloom filter are in the same block,
+ * so the lookup of a non-revoked pseudonym usually costs one cache miss and
+ * the lookup of a revoked pseudonym two. The pseudonyms depend on the epoch,
+ * so a list is only valid for the epoch it was created for.
+ */
+typedef struct
+{
+    void *image;
+    size_t image_length;
+
+    revocation_list_header_t *header;
+    revocation_list_block_t *blocks;
+    revocation_list_slot_t *slots;
+} revocation_list_t;
+
+/**
+ * Creates an empty revocation list.
+ *
+ * @param list the revocation list
+ * @param max_entries the maximum number of revoked pseudonyms
+ * @param epoch the epoch of the pseudonyms
+ * @param epoch_length the length of the epoch
+ * @return 0 if success else -1
+ */
+extern int rl_create(revocation_list_t *list, size_t max_entries, const void *epoch, size_t epoch_length);
+
+/**
+ * Computes the key of a pseudonym (canonical affine encoding).
+ *
+ * @param key the key of the pseudonym
+ * @param pseudonym the pseudonym
+ * @return 0 if success else -1
+ */
+extern int rl_compute_key(uint8_t key[REVOCATION_LIST_KEY_LENGTH], mclBnG1 pseudonym);
+
+/**
+ * Adds the key of a pseudonym to the revocation list.
+ *
+ * @param list the revocation list
+ * @param key the key of the pseudonym
+ * @return 0 if success else -1 (the list is full)
+ */
+extern int rl_add_key(revocation_list_t *list, const uint8_t key[REVOCATION_LIST_KEY_LENGTH]);
+
+/**
+ * Checks whether the key of a pseudonym is in the revocation list.
+ *
+ * @param list the revocation list
+ * @param key the key of the pseudonym
+ * @return 1 if the key is in the list else 0
+ */
+extern int rl_contains_key(const revocation_list_t *list, const uint8_t key[REVOCATION_LIST_KEY_LENGTH]);
+
+/**
+ * Adds a pseudonym to the revocation list.
+ *
+ * @param list the revocation list
+ * @param pseudonym the revoked pseudonym
+ * @return 0 if success else -1
+ */
+extern int rl_add(revocation_list_t *list, mclBnG1 pseudonym);
+
+/**
+ * Checks whether a pseudonym is in the revocation list.
+ *
+ * @param list the revocation list
+ * @param pseudonym the pseudonym
+ * @return 1 if the pseudonym is revoked, 0 if not, -1 if error
+ */
+extern int rl_is_revoked(const revocation_list_t *list, mclBnG1 pseudonym);
+
+/**
+ * Releases the resources allocated by the revocation list.
+ *
+ * @param list the revocation list
+ */
+extern void rl_destroy(revocation_list_t *list);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RKVAC_PROTOCOL_REVOCATION_LIST_H_ */
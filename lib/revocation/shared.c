@@ -0,0 +1,334 @@
+/**
+ *
+ *  Copyright (C) 2020  Raul Casanova Marques
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "shared.h"
+
+/**
+ * Opens and maps the file of the shared revocation list.
+ *
+ * @param shared the shared revocation list
+ * @param path the path of the file
+ * @param writer 1 if the list is opened to publish lists else 0
+ * @return 0 if success else -1
+ */
+static int rl_shared_map(revocation_shared_t *shared, const char *path, int writer)
+{
+    struct stat shared_stat;
+    int r;
+
+    memset(shared, 0, sizeof(revocation_shared_t));
+    shared->writer = writer;
+
+    shared->fd = open(path, writer ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+    if (shared->fd < 0)
+    {
+        return -1;
+    }
+
+    r = fstat(shared->fd, &shared_stat);
+    if (r < 0)
+    {
+        rl_shared_close(shared);
+        return -1;
+    }
+    shared->file_length = (size_t) shared_stat.st_size;
+
+    if (writer && shared->file_length < sizeof(revocation_shared_header_t))
+    {
+        r = ftruncate(shared->fd, sizeof(revocation_shared_header_t));
+        if (r < 0)
+        {
+            rl_shared_close(shared);
+            return -1;
+        }
+        shared->file_length = sizeof(revocation_shared_header_t);
+    }
+    else if (shared->file_length < sizeof(revocation_shared_header_t))
+    {
+        rl_shared_close(shared);
+        return -1;
+    }
+
+    // the pages beyond the end of the file become valid when the writer extends it
+    shared->image = mmap(NULL, REVOCATION_SHARED_MAX_LENGTH, writer ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED | MAP_NORESERVE, shared->fd, 0);
+    if (shared->image == MAP_FAILED)
+    {
+        shared->image = NULL;
+        rl_shared_close(shared);
+        return -1;
+    }
+
+    shared->header = (revocation_shared_header_t *) shared->image;
+    shared->list_images[0] = (uint8_t *) (shared->header + 1);
+    shared->list_images[1] = shared->list_images[0] + REVOCATION_SHARED_SLOT_LENGTH;
+
+    return 0;
+}
+
+/**
+ * Creates (or opens) the shared revocation list to publish lists (revocation authority).
+ *
+ * @param shared the shared revocation list
+ * @param path the path of the file (e.g. /dev/shm/rkvac-revocation-list)
+ * @return 0 if success else -1
+ */
+int rl_shared_create(revocation_shared_t *shared, const char *path)
+{
+    int r;
+
+    if (shared == NULL || path == NULL)
+    {
+        return -1;
+    }
+
+    r = rl_shared_map(shared, path, 1);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    // new (or incompatible) file, empty until the first publication
+    if (shared->header->magic != REVOCATION_SHARED_MAGIC || shared->header->version != REVOCATION_SHARED_VERSION)
+    {
+        shared->header->generation = 0;
+        memset(shared->header->slots, 0, sizeof(shared->header->slots));
+        shared->header->version = REVOCATION_SHARED_VERSION;
+        __atomic_store_n(&shared->header->magic, REVOCATION_SHARED_MAGIC, __ATOMIC_RELEASE);
+    }
+
+    return 0;
+}
+
+/**
+ * Opens the shared revocation list read-only (verifier).
+ *
+ * @param shared the shared revocation list
+ * @param path the path of the file
+ * @return 0 if success else -1
+ */
+int rl_shared_open(revocation_shared_t *shared, const char *path)
+{
+    int r;
+
+    if (shared == NULL || path == NULL)
+    {
+        return -1;
+    }
+
+    r = rl_shared_map(shared, path, 0);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    if (__atomic_load_n(&shared->header->magic, __ATOMIC_ACQUIRE) != REVOCATION_SHARED_MAGIC || shared->header->version != REVOCATION_SHARED_VERSION)
+    {
+        rl_shared_close(shared);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * Publishes a revocation list, replacing the previous one (the list is
+ * written into the image that is not current, then it becomes current).
+ *
+ * @param shared the shared revocation list
+ * @param list the revocation list
+ * @return 0 if success else -1
+ */
+int rl_shared_publish(revocation_shared_t *shared, const revocation_list_t *list)
+{
+    struct revocation_shared_slot_t *slot;
+    size_t length;
+    uint64_t generation, sequence;
+    size_t index;
+    int r;
+
+    if (shared == NULL || shared->image == NULL || !shared->writer || list == NULL || list->image == NULL)
+    {
+        return -1;
+    }
+
+    if (list->image_length > REVOCATION_SHARED_SLOT_LENGTH - sizeof(revocation_shared_header_t))
+    {
+        return -1;
+    }
+
+    // the current image is not touched, the list goes into the other one
+    generation = shared->header->generation;
+    index = (size_t) ((generation + 1) & 1u);
+    slot = &shared->header->slots[index];
+
+    length = (size_t) (shared->list_images[index] - (uint8_t *) shared->image) + list->image_length;
+
+    // the file only grows, the readers may still read the previous image
+    if (length > shared->file_length)
+    {
+        r = ftruncate(shared->fd, (off_t) length);
+        if (r < 0)
+        {
+            return -1;
+        }
+        shared->file_length = length;
+    }
+
+    /// write of the image (only a reader late by two publications reads this slot)
+    // odd if a previous publisher crashed while writing this slot
+    sequence = slot->sequence | 1u;
+    __atomic_store_n(&slot->sequence, sequence, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    memcpy(shared->list_images[index], list->image, list->image_length);
+    slot->image_length = list->image_length;
+
+    __atomic_store_n(&slot->sequence, sequence + 1, __ATOMIC_RELEASE);
+
+    /// publication
+    __atomic_store_n(&shared->header->generation, generation + 1, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+/**
+ * Checks whether the key of a pseudonym is in the shared revocation list.
+ *
+ * @param shared the shared revocation list
+ * @param epoch the epoch of the pseudonym
+ * @param key the key of the pseudonym
+ * @return 1 if the key is in the list, 0 if not, -1 if there is no list of the epoch
+ */
+int rl_shared_contains_key(const revocation_shared_t *shared, const uint8_t epoch[EPOCH_LENGTH], const uint8_t key[REVOCATION_LIST_KEY_LENGTH])
+{
+    revocation_list_header_t header;
+    revocation_list_t list;
+
+    const struct revocation_shared_slot_t *slot;
+    uint8_t *list_image;
+
+    uint64_t generation, sequence;
+    uint64_t image_length;
+    int r;
+
+    if (shared == NULL || shared->image == NULL || epoch == NULL || key == NULL)
+    {
+        return -1;
+    }
+
+    for (;;)
+    {
+        // nothing published yet
+        generation = __atomic_load_n(&shared->header->generation, __ATOMIC_ACQUIRE);
+        if (generation == 0)
+        {
+            return -1;
+        }
+
+        slot = &shared->header->slots[generation & 1u];
+        list_image = shared->list_images[generation & 1u];
+
+        // the writer only rewrites this image once the next list has been published
+        sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        if (sequence & 1u)
+        {
+            continue;
+        }
+
+        // private copy of the header, its sizes are checked against the image
+        image_length = slot->image_length;
+        memcpy(&header, list_image, sizeof(revocation_list_header_t));
+
+        if (header.num_blocks == 0 || (header.num_blocks & (header.num_blocks - 1)) != 0 ||
+            header.num_slots == 0 || (header.num_slots & (header.num_slots - 1)) != 0 ||
+            image_length > REVOCATION_SHARED_SLOT_LENGTH - sizeof(revocation_shared_header_t) ||
+            image_length != sizeof(revocation_list_header_t) + header.num_blocks * sizeof(revocation_list_block_t) + header.num_slots * sizeof(revocation_list_slot_t))
+        {
+            r = -2; // torn (or corrupted) image
+        }
+        else if (memcmp(header.epoch, epoch, EPOCH_LENGTH) != 0)
+        {
+            r = -1;
+        }
+        else
+        {
+            list.image = list_image;
+            list.image_length = (size_t) image_length;
+            list.header = &header;
+            list.blocks = (revocation_list_block_t *) (list_image + sizeof(revocation_list_header_t));
+            list.slots = (revocation_list_slot_t *) (list.blocks + header.num_blocks);
+
+            r = rl_contains_key(&list, key);
+        }
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&slot->sequence, __ATOMIC_RELAXED) == sequence)
+        {
+            return r == -2 ? -1 : r;
+        }
+    }
+}
+
+/**
+ * Checks whether a pseudonym is in the shared revocation list.
+ *
+ * @param shared the shared revocation list
+ * @param epoch the epoch of the pseudonym
+ * @param pseudonym the pseudonym
+ * @return 1 if the pseudonym is revoked, 0 if not, -1 if there is no list of the epoch
+ */
+int rl_shared_is_revoked(const revocation_shared_t *shared, const uint8_t epoch[EPOCH_LENGTH], mclBnG1 pseudonym)
+{
+    uint8_t key[REVOCATION_LIST_KEY_LENGTH];
+    int r;
+
+    r = rl_compute_key(key, pseudonym);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    return rl_shared_contains_key(shared, epoch, key);
+}
+
+/**
+ * Unmaps and closes the shared revocation list (the file is kept).
+ *
+ * @param shared the shared revocation list
+ */
+void rl_shared_close(revocation_shared_t *shared)
+{
+    if (shared == NULL)
+    {
+        return;
+    }
+
+    if (shared->image != NULL)
+    {
+        munmap(shared->image, REVOCATION_SHARED_MAX_LENGTH);
+        shared->image = NULL;
+    }
+
+    if (shared->fd >= 0)
+    {
+        close(shared->fd);
+        shared->fd = -1;
+    }
+}
@@ -0,0 +1,166 @@
+/**
+ *
+ *  Copyright (C) 2020  Raul Casanova Marques
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __RKVAC_PROTOCOL_REVOCATION_SHARED_H_
+#define __RKVAC_PROTOCOL_REVOCATION_SHARED_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <mcl/bn_c256.h>
+
+#include "config/config.h"
+
+#include "revocation/list.h"
+
+/*
+ * Magic number of the shared revocation list ("RKVACSHM")
+ */
+#define REVOCATION_SHARED_MAGIC 0x4D48534341564B52ULL
+
+/*
+ * Version of the layout of the shared revocation list
+ */
+#define REVOCATION_SHARED_VERSION 2
+
+/*
+ * Address space reserved for the shared revocation list (the file grows
+ * inside the reservation, so it is mapped only once)
+ */
+#define REVOCATION_SHARED_MAX_LENGTH (1ULL << 34u)
+
+/*
+ * Address space of each of the two images of the list (the first one
+ * follows the header, so an image has at most this length minus the header)
+ */
+#define REVOCATION_SHARED_SLOT_LENGTH (REVOCATION_SHARED_MAX_LENGTH / 2)
+
+typedef struct
+{
+    uint64_t magic;
+    uint64_t version; // version of the layout
+    uint64_t generation; // number of publications, the current list is the image of the slot generation % 2
+    struct revocation_shared_slot_t
+    {
+        uint64_t sequence; // odd while the image of the slot is being written
+        uint64_t image_length; // length of the image of the list
+    } slots[2];
+    uint8_t reserved[8]; // one cache line
+} revocation_shared_header_t;
+
+/*
+ * IMPORTANT!
+ *
+ * The shared revocation list is the image of a revocation list stored in a
+ * file (a file in /dev/shm is a POSIX shared-memory segment) behind a versioned
+ * header. The revocation authority publishes the lists and all the verifier
+ * processes of the host map the file read-only, so there is a single copy of
+ * the revoked pseudonyms. The file holds two images: a new list is written
+ * into the image that is not current and published by incrementing the
+ * generation, so the readers never wait for a publication. Each image has its
+ * own sequence number, a reader only retries the lookup if its image has been
+ * rewritten meanwhile (i.e. two lists were published during the lookup), and
+ * it only trusts a private copy of the header of the list.
+ */
+typedef struct
+{
+    int fd;
+    int writer;
+
+    void *image; // reservation of REVOCATION_SHARED_MAX_LENGTH bytes
+    size_t file_length;
+
+    revocation_shared_header_t *header;
+    uint8_t *list_images[2]; // images of the slots
+} revocation_shared_t;
+
+/**
+ * Creates (or opens) the shared revocation list to publish lists (revocation authority).
+ *
+ * @param shared the shared revocation list
+ * @param path the path of the file (e.g. /dev/shm/rkvac-revocation-list)
+ * @return 0 if success else -1
+ */
+extern int rl_shared_create(revocation_shared_t *shared, const char *path);
+
+/**
+ * Opens the shared revocation list read-only (verifier).
+ *
+ * @param shared the shared revocation list
+ * @param path the path of the file
+ * @return 0 if success else -1
+ */
+extern int rl_shared_open(revocation_shared_t *shared, const char *path);
+
+/**
+ * Publishes a revocation list, replacing the previous one (the list is
+ * written into the image that is not current, then it becomes current).
+ *
+ * @param shared the shared revocation list
+ * @param list the revocation list
+ * @return 0 if success else -1
+ */
+extern int rl_shared_publish(revocation_shared_t *shared, const revocation_list_t *list);
+
+/**
+ * Checks whether the key of a pseudonym is in the shared revocation list.
+ *
+ * @param shared the shared revocation list
+ * @param epoch the epoch of the pseudonym
+ * @param key the key of the pseudonym
+ * @return 1 if the key is in the list, 0 if not, -1 if there is no list of the epoch
+ */
+extern int rl_shared_contains_key(const revocation_shared_t *shared, const uint8_t epoch[EPOCH_LENGTH], const uint8_t key[REVOCATION_LIST_KEY_LENGTH]);
+
+/**
+ * Checks whether a pseudonym is in the shared revocation list.
+ *
+ * @param shared the shared revocation list
+ * @param epoch the epoch of the pseudonym
+ * @param pseudonym the pseudonym
+ * @return 1 if the pseudonym is revoked, 0 if not, -1 if there is no list of the epoch
+ */
+extern int rl_shared_is_revoked(const revocation_shared_t *shared, const uint8_t epoch[EPOCH_LENGTH], mclBnG1 pseudonym);
+
+/**
+ * Unmaps and closes the shared revocation list (the file is kept).
+ *
+ * @param shared the shared revocation list
+ */
+extern void rl_shared_close(revocation_shared_t *shared);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RKVAC_PROTOCOL_REVOCATION_SHARED_H_ */
@@ -0,0 +1,212 @@
+/**
+ *
+ *  Copyright (C) 2020  Raul Casanova Marques
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "snapshot.h"
+
+/**
+ * Frees a list owned by the snapshot.
+ *
+ * @param list the list or NULL
+ */
+static void rs_free_list(revocation_list_t *list)
+{
+    if (list == NULL)
+    {
+        return;
+    }
+
+    rl_destroy(list);
+    free(list);
+}
+
+/**
+ * Initializes the revocation list snapshot.
+ *
+ * @param snapshot the revocation list snapshot
+ * @param list the first list (allocated with malloc, owned by the snapshot) or NULL
+ * @return 0 if success else -1
+ */
+int rs_init(revocation_snapshot_t *snapshot, revocation_list_t *list)
+{
+    int r;
+
+    if (snapshot == NULL)
+    {
+        return -1;
+    }
+
+    memset(snapshot, 0, sizeof(revocation_snapshot_t));
+
+    r = pthread_mutex_init(&snapshot->writer_mutex, NULL);
+    if (r != 0)
+    {
+        return -1;
+    }
+
+    snapshot->current = list;
+    snapshot->epoch = 1;
+
+    return 0;
+}
+
+/**
+ * Registers a reader (one per thread).
+ *
+ * @param snapshot the revocation list snapshot
+ * @param reader the slot of the reader
+ * @return 0 if success else -1 (too many readers)
+ */
+int rs_register_reader(revocation_snapshot_t *snapshot, size_t *reader)
+{
+    uint64_t expected;
+    size_t it;
+
+    if (snapshot == NULL || reader == NULL)
+    {
+        return -1;
+    }
+
+    for (it = 0; it < REVOCATION_SNAPSHOT_MAX_READERS; it++)
+    {
+        expected = 0;
+        if (__atomic_compare_exchange_n(&snapshot->readers[it].used, &expected, 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+        {
+            __atomic_store_n(&snapshot->readers[it].epoch, 0, __ATOMIC_RELEASE);
+            *reader = it;
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * Unregisters a reader, it must be outside of a read-side section.
+ *
+ * @param snapshot the revocation list snapshot
+ * @param reader the slot of the reader
+ */
+void rs_unregister_reader(revocation_snapshot_t *snapshot, size_t reader)
+{
+    if (snapshot == NULL || reader >= REVOCATION_SNAPSHOT_MAX_READERS)
+    {
+        return;
+    }
+
+    __atomic_store_n(&snapshot->readers[reader].epoch, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&snapshot->readers[reader].used, 0, __ATOMIC_RELEASE);
+}
+
+/**
+ * Enters a read-side section and gets the current list, which stays valid
+ * until rs_read_unlock. It never blocks.
+ *
+ * @param snapshot the revocation list snapshot
+ * @param reader the slot of the reader
+ * @return the current list or NULL
+ */
+const revocation_list_t *rs_read_lock(revocation_snapshot_t *snapshot, size_t reader)
+{
+    /*
+     * IMPORTANT!
+     *
+     * The announcement must be ordered before the load of the list (seq_cst):
+     * either the writer sees the announcement and waits for the reader, or the
+     * reader loads the list swapped in by the writer.
+     */
+    __atomic_store_n(&snapshot->readers[reader].epoch, __atomic_load_n(&snapshot->epoch, __ATOMIC_SEQ_CST), __ATOMIC_SEQ_CST);
+
+    return __atomic_load_n(&snapshot->current, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * Leaves a read-side section.
+ *
+ * @param snapshot the revocation list snapshot
+ * @param reader the slot of the reader
+ */
+void rs_read_unlock(revocation_snapshot_t *snapshot, size_t reader)
+{
+    __atomic_store_n(&snapshot->readers[reader].epoch, 0, __ATOMIC_RELEASE);
+}
+
+/**
+ * Publishes a new list and frees the previous one after the grace period
+ * (the readers of the previous list are waited for).
+ *
+ * @param snapshot the revocation list snapshot
+ * @param list the new list (allocated with malloc, owned by the snapshot) or NULL
+ * @return 0 if success else -1
+ */
+int rs_publish(revocation_snapshot_t *snapshot, revocation_list_t *list)
+{
+    revocation_list_t *previous;
+    uint64_t epoch, reader_epoch;
+
+    size_t it;
+
+    if (snapshot == NULL)
+    {
+        return -1;
+    }
+
+    pthread_mutex_lock(&snapshot->writer_mutex);
+
+    previous = __atomic_exchange_n(&snapshot->current, list, __ATOMIC_SEQ_CST);
+    epoch = __atomic_add_fetch(&snapshot->epoch, 1, __ATOMIC_SEQ_CST);
+
+    // grace period: the readers that announced an older epoch may still use the previous list
+    for (it = 0; it < REVOCATION_SNAPSHOT_MAX_READERS; it++)
+    {
+        for (;;)
+        {
+            reader_epoch = __atomic_load_n(&snapshot->readers[it].epoch, __ATOMIC_SEQ_CST);
+            if (reader_epoch == 0 || reader_epoch >= epoch)
+            {
+                break;
+            }
+            sched_yield();
+        }
+    }
+
+    pthread_mutex_unlock(&snapshot->writer_mutex);
+
+    rs_free_list(previous);
+
+    return 0;
+}
+
+/**
+ * Frees the current list, there must be no readers.
+ *
+ * @param snapshot the revocation list snapshot
+ */
+void rs_destroy(revocation_snapshot_t *snapshot)
+{
+    if (snapshot == NULL)
+    {
+        return;
+    }
+
+    rs_free_list(snapshot->current);
+    snapshot->current = NULL;
+
+    pthread_mutex_destroy(&snapshot->writer_mutex);
+}
@@ -0,0 +1,133 @@
+/**
+ *
+ *  Copyright (C) 2020  Raul Casanova Marques
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __RKVAC_PROTOCOL_REVOCATION_SNAPSHOT_H_
+#define __RKVAC_PROTOCOL_REVOCATION_SNAPSHOT_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "config/config.h"
+
+#include "revocation/list.h"
+
+typedef struct
+{
+    uint64_t epoch; // epoch observed by the reader (0 - outside of a read-side section)
+    uint64_t used; // 1 if the slot belongs to a reader
+    uint8_t padding[48]; // one cache line per reader
+} revocation_snapshot_reader_t;
+
+/*
+ * IMPORTANT!
+ *
+ * The revocation list snapshot is swapped with epoch-based reclamation. A reader
+ * announces the global epoch in its own slot and loads the current list with one
+ * atomic load, it never takes a lock. The writer builds the next list off to the
+ * side, swaps the pointer, advances the global epoch and frees the previous list
+ * once every reader has left the read-side sections of the older epochs. The
+ * published lists must not be modified.
+ */
+typedef struct
+{
+    revocation_list_t *current; // current list or NULL (no revocation check)
+    uint64_t epoch; // global epoch (starts at 1)
+
+    pthread_mutex_t writer_mutex; // serializes the writers only
+
+    revocation_snapshot_reader_t readers[REVOCATION_SNAPSHOT_MAX_READERS];
+} revocation_snapshot_t;
+
+/**
+ * Initializes the revocation list snapshot.
+ *
+ * @param snapshot the revocation list snapshot
+ * @param list the first list (allocated with malloc, owned by the snapshot) or NULL
+ * @return 0 if success else -1
+ */
+extern int rs_init(revocation_snapshot_t *snapshot, revocation_list_t *list);
+
+/**
+ * Registers a reader (one per thread).
+ *
+ * @param snapshot the revocation list snapshot
+ * @param reader the slot of the reader
+ * @return 0 if success else -1 (too many readers)
+ */
+extern int rs_register_reader(revocation_snapshot_t *snapshot, size_t *reader);
+
+/**
+ * Unregisters a reader, it must be outside of a read-side section.
+ *
+ * @param snapshot the revocation list snapshot
+ * @param reader the slot of the reader
+ */
+extern void rs_unregister_reader(revocation_snapshot_t *snapshot, size_t reader);
+
+/**
+ * Enters a read-side section and gets the current list, which stays valid
+ * until rs_read_unlock. It never blocks.
+ *
+ * @param snapshot the revocation list snapshot
+ * @param reader the slot of the reader
+ * @return the current list or NULL
+ */
+extern const revocation_list_t *rs_read_lock(revocation_snapshot_t *snapshot, size_t reader);
+
+/**
+ * Leaves a read-side section.
+ *
+ * @param snapshot the revocation list snapshot
+ * @param reader the slot of the reader
+ */
+extern void rs_read_unlock(revocation_snapshot_t *snapshot, size_t reader);
+
+/**
+ * Publishes a new list and frees the previous one after the grace period
+ * (the readers of the previous list are waited for).
+ *
+ * @param snapshot the revocation list snapshot
+ * @param list the new list (allocated with malloc, owned by the snapshot) or NULL
+ * @return 0 if success else -1
+ */
+extern int rs_publish(revocation_snapshot_t *snapshot, revocation_list_t *list);
+
+/**
+ * Frees the current list, there must be no readers.
+ *
+ * @param snapshot the revocation list snapshot
+ */
+extern void rs_destroy(revocation_snapshot_t *snapshot);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RKVAC_PROTOCOL_REVOCATION_SNAPSHOT_H_ */
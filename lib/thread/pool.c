@@ -0,0 +1,291 @@
+/**
+ *
+ *  Copyright (C) 2020  Raul Casanova Marques
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "pool.h"
+
+/**
+ * Gets the current time of the monotonic clock.
+ *
+ * @return the current time in seconds
+ */
+double thread_pool_get_time(void)
+{
+    struct timespec ts = {0, 0};
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (double) ts.tv_sec + 1.0e-9 * (double) ts.tv_nsec;
+}
+
+/**
+ * Gets the number of threads used to process a number of items.
+ *
+ * @param num_threads the number of threads (0 - one per core)
+ * @param num_items the number of items
+ * @return the number of threads (at least one, no more than items)
+ */
+size_t thread_pool_get_num_threads(size_t num_threads, size_t num_items)
+{
+    long num_cores;
+
+    // one thread per core by default, no more threads than items
+    if (num_threads == 0)
+    {
+        num_cores = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = num_cores > 0 ? (size_t) num_cores : 1;
+    }
+    if (num_threads > num_items)
+    {
+        num_threads = num_items;
+    }
+
+    return num_threads > 0 ? num_threads : 1;
+}
+
+/**
+ * Takes the tasks of the current job and executes them until there are no
+ * tasks left. The mutex of the pool must be locked by the caller.
+ *
+ * @param pool the pool
+ */
+static void thread_pool_execute(thread_pool_t *pool)
+{
+    thread_pool_task_t *task;
+    double start_time;
+
+    while (pool->next_task < pool->num_tasks)
+    {
+        task = &pool->tasks[pool->next_task++];
+        pthread_mutex_unlock(&pool->mutex);
+
+        start_time = thread_pool_get_time();
+        task->function(task->argument);
+        task->elapsed_time = thread_pool_get_time() - start_time;
+
+        pthread_mutex_lock(&pool->mutex);
+        pool->pending_tasks--;
+        if (pool->pending_tasks == 0)
+        {
+            pthread_cond_signal(&pool->done);
+        }
+    }
+}
+
+/**
+ * Thread of the pool.
+ *
+ * @param argument the pool
+ * @return NULL
+ */
+static void *thread_pool_worker(void *argument)
+{
+    thread_pool_t *pool = (thread_pool_t *) argument;
+
+    pthread_mutex_lock(&pool->mutex);
+    for (;;)
+    {
+        while (pool->running && pool->next_task >= pool->num_tasks)
+        {
+            pthread_cond_wait(&pool->work, &pool->mutex);
+        }
+        if (!pool->running)
+        {
+            break;
+        }
+
+        thread_pool_execute(pool);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    return NULL;
+}
+
+/**
+ * Initializes the pool and starts its threads.
+ *
+ * @param pool the pool
+ * @param num_threads the number of threads (the calling thread not included)
+ * @return 0 if success else -1
+ */
+int thread_pool_init(thread_pool_t *pool, size_t num_threads)
+{
+    size_t it;
+    int r;
+
+    if (pool == NULL)
+    {
+        return -1;
+    }
+
+    memset(pool, 0, sizeof(thread_pool_t));
+
+    pthread_mutex_init(&pool->run_mutex, NULL);
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->work, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    pool->running = 1;
+
+    if (num_threads == 0)
+    {
+        return 0;
+    }
+
+    pool->threads = malloc(num_threads * sizeof(pthread_t));
+    if (pool->threads == NULL)
+    {
+        thread_pool_destroy(pool);
+        return -1;
+    }
+
+    for (it = 0; it < num_threads; it++)
+    {
+        r = pthread_create(&pool->threads[it], NULL, thread_pool_worker, pool);
+        if (r != 0)
+        {
+            thread_pool_destroy(pool);
+            return -1;
+        }
+        pool->num_threads++;
+    }
+
+    return 0;
+}
+
+/**
+ * Executes the tasks using the threads of the pool and the calling thread,
+ * and waits until all of them have finished. If the pool is NULL, the tasks
+ * are executed one after another by the calling thread.
+ *
+ * @param pool the pool or NULL
+ * @param tasks the tasks
+ * @param num_tasks the number of tasks
+ * @return 0 if success else -1
+ */
+int thread_pool_run(thread_pool_t *pool, thread_pool_task_t *tasks, size_t num_tasks)
+{
+    double start_time;
+    size_t it;
+
+    if (tasks == NULL)
+    {
+        return -1;
+    }
+
+    if (pool == NULL)
+    {
+        for (it = 0; it < num_tasks; it++)
+        {
+            start_time = thread_pool_get_time();
+            tasks[it].function(tasks[it].argument);
+            tasks[it].elapsed_time = thread_pool_get_time() - start_time;
+        }
+
+        return 0;
+    }
+
+    if (num_tasks == 0)
+    {
+        return 0;
+    }
+
+    pthread_mutex_lock(&pool->run_mutex);
+    pthread_mutex_lock(&pool->mutex);
+
+    pool->tasks = tasks;
+    pool->num_tasks = num_tasks;
+    pool->next_task = 0;
+    pool->pending_tasks = num_tasks;
+    pthread_cond_broadcast(&pool->work);
+
+    // fork: the calling thread works too
+    thread_pool_execute(pool);
+
+    // join
+    while (pool->pending_tasks > 0)
+    {
+        pthread_cond_wait(&pool->done, &pool->mutex);
+    }
+
+    pool->tasks = NULL;
+    pool->num_tasks = 0;
+    pool->next_task = 0;
+
+    pthread_mutex_unlock(&pool->mutex);
+    pthread_mutex_unlock(&pool->run_mutex);
+
+    return 0;
+}
+
+/**
+ * Gets the longest elapsed time of the tasks, i.e. the critical path of
+ * the job when there are enough threads.
+ *
+ * @param tasks the tasks
+ * @param num_tasks the number of tasks
+ * @return the longest elapsed time in seconds
+ */
+double thread_pool_critical_path(const thread_pool_task_t *tasks, size_t num_tasks)
+{
+    double critical_path = 0.0;
+    size_t it;
+
+    for (it = 0; it < num_tasks; it++)
+    {
+        if (tasks[it].elapsed_time > critical_path)
+        {
+            critical_path = tasks[it].elapsed_time;
+        }
+    }
+
+    return critical_path;
+}
+
+/**
+ * Stops the threads and releases the resources allocated by the pool.
+ *
+ * @param pool the pool
+ */
+void thread_pool_destroy(thread_pool_t *pool)
+{
+    size_t it;
+
+    if (pool == NULL)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->running = 0;
+    pthread_cond_broadcast(&pool->work);
+    pthread_mutex_unlock(&pool->mutex);
+
+    for (it = 0; it < pool->num_threads; it++)
+    {
+        pthread_join(pool->threads[it], NULL);
+    }
+    free(pool->threads);
+    pool->threads = NULL;
+    pool->num_threads = 0;
+
+    pthread_cond_destroy(&pool->done);
+    pthread_cond_destroy(&pool->work);
+    pthread_mutex_destroy(&pool->mutex);
+    pthread_mutex_destroy(&pool->run_mutex);
+}
@@ -0,0 +1,131 @@
+/**
+ *
+ *  Copyright (C) 2020  Raul Casanova Marques
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __RKVAC_PROTOCOL_THREAD_POOL_H_
+#define __RKVAC_PROTOCOL_THREAD_POOL_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef void (*thread_pool_function_t)(void *argument);
+
+typedef struct
+{
+    thread_pool_function_t function;
+    void *argument;
+
+    double elapsed_time; // set by the pool, in seconds
+} thread_pool_task_t;
+
+/*
+ * IMPORTANT!
+ *
+ * Fork-join pool with a fixed set of threads, created once and reused by
+ * every call to thread_pool_run. The calling thread also executes tasks,
+ * so a pool with n threads runs up to n + 1 tasks at the same time. Only
+ * one job is executed at a time, concurrent callers are serialized.
+ */
+typedef struct
+{
+    pthread_t *threads;
+    size_t num_threads;
+
+    pthread_mutex_t run_mutex; // one job at a time
+    pthread_mutex_t mutex;
+    pthread_cond_t work;
+    pthread_cond_t done;
+
+    thread_pool_task_t *tasks;
+    size_t num_tasks;
+    size_t next_task;
+    size_t pending_tasks;
+
+    int running;
+} thread_pool_t;
+
+/**
+ * Gets the current time of the monotonic clock.
+ *
+ * @return the current time in seconds
+ */
+extern double thread_pool_get_time(void);
+
+/**
+ * Gets the number of threads used to process a number of items.
+ *
+ * @param num_threads the number of threads (0 - one per core)
+ * @param num_items the number of items
+ * @return the number of threads (at least one, no more than items)
+ */
+extern size_t thread_pool_get_num_threads(size_t num_threads, size_t num_items);
+
+/**
+ * Initializes the pool and starts its threads.
+ *
+ * @param pool the pool
+ * @param num_threads the number of threads (the calling thread not included)
+ * @return 0 if success else -1
+ */
+extern int thread_pool_init(thread_pool_t *pool, size_t num_threads);
+
+/**
+ * Executes the tasks using the threads of the pool and the calling thread,
+ * and waits until all of them have finished. If the pool is NULL, the tasks
+ * are executed one after another by the calling thread.
+ *
+ * @param pool the pool or NULL
+ * @param tasks the tasks
+ * @param num_tasks the number of tasks
+ * @return 0 if success else -1
+ */
+extern int thread_pool_run(thread_pool_t *pool, thread_pool_task_t *tasks, size_t num_tasks);
+
+/**
+ * Gets the longest elapsed time of the tasks, i.e. the critical path of
+ * the job when there are enough threads.
+ *
+ * @param tasks the tasks
+ * @param num_tasks the number of tasks
+ * @return the longest elapsed time in seconds
+ */
+extern double thread_pool_critical_path(const thread_pool_task_t *tasks, size_t num_tasks);
+
+/**
+ * Stops the threads and releases the resources allocated by the pool.
+ *
+ * @param pool the pool
+ */
+extern void thread_pool_destroy(thread_pool_t *pool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RKVAC_PROTOCOL_THREAD_POOL_H_ */
@@ -21,6 +21,8 @@
 #include <stdio.h>
 
 #include <getopt.h>
+#include <signal.h>
+#include <unistd.h>
 
 #include "system.h"
 #include "setup.h"
@@ -37,14 +39,39 @@
 #endif
 
 #include "controllers/verifier.h"
+#include "keystore/keystore.h"
+#include "services/verifier.h"
 
 static struct option long_options[] = {
         {"attributes",           required_argument, 0, 'a'},
         {"disclosed-attributes", required_argument, 0, 'd'},
+        {"multi-pairing",        no_argument,       0, 'm'},
+        {"designated-verifier",  no_argument,       0, 'v'},
+        {"parallel",             no_argument,       0, 'p'},
+        {"socket",               required_argument, 0, 's'},
+        {"revocation-database",  required_argument, 0, 'r'},
+        {"randomizers",          required_argument, 0, 'k'},
+        {"selected-randomizers", required_argument, 0, 'j'},
+        {"keystore",             required_argument, 0, 'K'},
+        {"parameters",           required_argument, 0, 'P'},
         {"help",                 no_argument,       0, 'h'},
         {0, 0, 0, 0}
 };
 
+static verifier_service_t *running_service = NULL;
+
+/**
+ * Stops the verifier service when SIGINT or SIGTERM is received.
+ *
+ * @param signum the number of the signal
+ */
+static void signal_handler(int signum)
+{
+    (void) signum;
+
+    ve_service_request_stop(running_service);
+}
+
 int main(int argc, char *argv[])
 {
     system_par_t sys_parameters = {0};
@@ -52,6 +79,13 @@ int main(int argc, char *argv[])
     revocation_authority_par_t ra_parameters = {0};
     revocation_authority_keys_t ra_keys = {0};
     revocation_authority_signature_t ra_signature = {0};
+    size_t ra_indices[REVOCATION_AUTHORITY_MAX_J] = {0}; // randomizers selected for the epoch
+    size_t num_randomizers = REVOCATION_AUTHORITY_VALUE_K;
+    size_t num_selected_randomizers = REVOCATION_AUTHORITY_VALUE_J;
+    revocation_database_t ra_database;
+    const char *database_path = NULL;
+    mclBnFr *revoked_mr = NULL;
+    size_t num_revoked = 0;
 
     issuer_par_t ie_parameters = {0};
     issuer_keys_t ie_keys = {0};
@@ -64,6 +98,21 @@ int main(int argc, char *argv[])
     user_credential_t ue_credential = {0};
     user_pi_t ue_pi = {0};
 
+    verifier_par_t ve_parameters = {0};
+    revocation_list_t ve_revocation_list = {0};
+    verifier_pairing_mode_t pairing_mode = VERIFIER_PAIRING_MODE_DEFAULT;
+    int designated_verifier = 0;
+    int parallel_verifier = 0;
+
+    verifier_service_t ve_service;
+    const char *socket_path = NULL;
+
+    keystore_t keystore;
+    const char *keystore_path = NULL;
+    int keystore_loaded = 0;
+
+    const char *parameters_path = NULL;
+
     uint8_t nonce[NONCE_LENGTH] = {0};
     uint8_t epoch[EPOCH_LENGTH] = {0};
 
@@ -82,7 +131,7 @@ int main(int argc, char *argv[])
     ue_attributes.num_attributes = USER_MAX_NUM_ATTRIBUTES;
     num_disclosed_attributes = 0;
 
-    while ((opt = getopt_long(argc, argv, "a:d:h", long_options, NULL)) != -1)
+    while ((opt = getopt_long(argc, argv, "a:d:mvps:r:k:j:K:P:h", long_options, NULL)) != -1)
     {
         switch (opt)
         {
@@ -98,9 +147,63 @@ int main(int argc, char *argv[])
 
                 break;
             }
+            case 'm':
+            {
+                pairing_mode = VERIFIER_PAIRING_MODE_MULTI_PAIRING;
+
+                break;
+            }
+            case 'v':
+            {
+                designated_verifier = 1;
+
+                break;
+            }
+            case 'p':
+            {
+                parallel_verifier = 1;
+
+                break;
+            }
+            case 's':
+            {
+                socket_path = optarg;
+
+                break;
+            }
+            case 'r':
+            {
+                database_path = optarg;
+
+                break;
+            }
+            case 'k':
+            {
+                num_randomizers = strtol(optarg, NULL, 10);
+
+                break;
+            }
+            case 'j':
+            {
+                num_selected_randomizers = strtol(optarg, NULL, 10);
+
+                break;
+            }
+            case 'K':
+            {
+                keystore_path = optarg;
+
+                break;
+            }
+            case 'P':
+            {
+                parameters_path = optarg;
+
+                break;
+            }
             case 'h':
             {
-                fprintf(stderr, "Usage: %s --attributes=<XX> --disclosed-attributes=<XX>\n", argv[0]);
+                fprintf(stderr, "Usage: %s --attributes=<XX> --disclosed-attributes=<XX> [--multi-pairing] [--designated-verifier] [--parallel] [--socket=<PATH>] [--revocation-database=<PATH>] [--randomizers=<K>] [--selected-randomizers=<J>] [--keystore=<PATH>] [--parameters=<PATH>]\n", argv[0]);
 
                 exit(0);
             }
@@ -123,6 +226,12 @@ int main(int argc, char *argv[])
         fprintf(stderr, "Error: the number of disclosed attributes is greater than the number of user attributes! (0-%lu)\n", ue_attributes.num_attributes);
         return 1;
     }
+    // check (k, j)
+    if (num_randomizers == 0 || num_selected_randomizers == 0 || num_selected_randomizers > REVOCATION_AUTHORITY_MAX_J)
+    {
+        fprintf(stderr, "Error: invalid number of randomizers! (k > 0, 1-%d)\n", REVOCATION_AUTHORITY_MAX_J);
+        return 1;
+    }
 
 #if defined (RKVAC_PROTOCOL_MULTOS)
     r = sc_get_card_connection(&reader);
@@ -147,13 +256,63 @@ int main(int argc, char *argv[])
 
     printf("[!] Disclosed attributes: %lu\n", num_disclosed_attributes);
     printf("[!] Number of user attributes: %lu\n", ue_attributes.num_attributes);
+    printf("[!] Number of randomizers (k, j): %lu, %lu\n", num_randomizers, num_selected_randomizers);
 
-    // system - setup
-    r = sys_setup(&sys_parameters);
-    if (r < 0)
+    // keystore - load the parameters and keys of a previous run
+    if (keystore_path != NULL && access(keystore_path, F_OK) == 0)
     {
-        fprintf(stderr, "Error: cannot initialize the system!\n");
-        return 1;
+        r = ks_open(&keystore, keystore_path);
+        if (r < 0)
+        {
+            fprintf(stderr, "Error: cannot open the keystore!\n");
+            return 1;
+        }
+
+        r = ks_load(&keystore, &sys_parameters, &ra_parameters, &ra_keys, &ie_parameters, &ie_keys);
+        if (r < 0)
+        {
+            fprintf(stderr, "Error: cannot load the keystore!\n");
+            return 1;
+        }
+        keystore_loaded = 1;
+
+        if (ie_parameters.num_attributes != ue_attributes.num_attributes)
+        {
+            fprintf(stderr, "Error: the keystore has been created for %lu user attributes!\n", ie_parameters.num_attributes);
+            return 1;
+        }
+
+        printf("[!] Keystore loaded (k, j): %lu, %lu\n", ra_parameters.k, ra_parameters.j);
+    }
+
+    // system - setup (from the system parameters blob of a previous run if available)
+    if (!keystore_loaded)
+    {
+        r = -1;
+        if (parameters_path != NULL)
+        {
+            r = sys_setup_from_file(&sys_parameters, parameters_path);
+        }
+        if (r < 0)
+        {
+            r = sys_setup(&sys_parameters);
+            if (r < 0)
+            {
+                fprintf(stderr, "Error: cannot initialize the system!\n");
+                return 1;
+            }
+
+            // system - store the parameters for the next runs
+            if (parameters_path != NULL)
+            {
+                r = sys_save(sys_parameters, parameters_path);
+                if (r < 0)
+                {
+                    fprintf(stderr, "Error: cannot save the system parameters!\n");
+                    return 1;
+                }
+            }
+        }
     }
 
     // user - get user identifier
@@ -164,16 +323,38 @@ int main(int argc, char *argv[])
         return 1;
     }
 
-    // revocation authority - setup
-    r = ra_setup(sys_parameters, &ra_parameters, &ra_keys);
-    if (r < 0)
+    if (!keystore_loaded)
     {
-        fprintf(stderr, "Error: cannot initialize the revocation authority!\n");
-        return 1;
+        // revocation authority - setup
+        r = ra_setup(sys_parameters, num_randomizers, num_selected_randomizers, 0, &ra_parameters, &ra_keys);
+        if (r < 0)
+        {
+            fprintf(stderr, "Error: cannot initialize the revocation authority!\n");
+            return 1;
+        }
+
+        // revocation authority - precompute the fixed-base tables
+        r = ra_precompute(&ra_parameters);
+        if (r < 0)
+        {
+            fprintf(stderr, "Error: cannot precompute the revocation authority tables!\n");
+            return 1;
+        }
+    }
+
+    // revocation authority - open the revocation database
+    if (database_path != NULL)
+    {
+        r = rd_open(&ra_database, database_path);
+        if (r < 0)
+        {
+            fprintf(stderr, "Error: cannot open the revocation database!\n");
+            return 1;
+        }
     }
 
     // revocation authority - mac
-    r = ra_mac(sys_parameters, ra_keys.private_key, ue_identifier, &ra_signature);
+    r = ra_mac(sys_parameters, ra_keys.private_key, database_path != NULL ? &ra_database : NULL, ue_identifier, &ra_signature);
     if (r < 0)
     {
         fprintf(stderr, "Error: cannot compute the revocation authority MAC!\n");
@@ -204,12 +385,34 @@ int main(int argc, char *argv[])
         return 1;
     }
 
-    // issuer - setup
-    ie_parameters.num_attributes = ue_attributes.num_attributes;
-    r = ie_setup(ie_parameters, &ie_keys);
+    if (!keystore_loaded)
+    {
+        // issuer - setup
+        ie_parameters.num_attributes = ue_attributes.num_attributes;
+        r = ie_setup(ie_parameters, &ie_keys);
+        if (r < 0)
+        {
+            fprintf(stderr, "Error: cannot initialize the issuer!\n");
+            return 1;
+        }
+
+        // keystore - store the parameters and keys for the next runs
+        if (keystore_path != NULL)
+        {
+            r = ks_save(keystore_path, sys_parameters, ra_parameters, ra_keys, ie_parameters, ie_keys);
+            if (r < 0)
+            {
+                fprintf(stderr, "Error: cannot save the keystore!\n");
+                return 1;
+            }
+        }
+    }
+
+    // issuer - precompute the G2 line coefficients
+    r = ie_precompute(sys_parameters, ra_keys.public_key, &ie_parameters);
     if (r < 0)
     {
-        fprintf(stderr, "Error: cannot initialize the issuer!\n");
+        fprintf(stderr, "Error: cannot precompute the issuer pairing data!\n");
         return 1;
     }
 
@@ -242,7 +445,7 @@ int main(int argc, char *argv[])
 #endif
 
     // user - compute proof of knowledge
-    r = ue_compute_proof_of_knowledge(reader, sys_parameters, ra_parameters, ra_signature, ie_signature, 0, 0, nonce, sizeof(nonce), epoch, sizeof(epoch), &ue_attributes, num_disclosed_attributes, &ue_credential, &ue_pi);
+    r = ue_compute_proof_of_knowledge(reader, sys_parameters, ra_parameters, ra_signature, ie_signature, ra_indices, nonce, sizeof(nonce), epoch, sizeof(epoch), &ue_attributes, num_disclosed_attributes, &ue_credential, &ue_pi);
     if (r < 0)
     {
         fprintf(stderr, "Error: cannot compute the user proof of knowledge!\n");
@@ -265,14 +468,107 @@ int main(int argc, char *argv[])
     fprintf(stdout, "[+] verifier - verify proof of knowledge\n");
 #endif
 
+    // verifier - setup
+    r = ve_setup(sys_parameters, ra_keys.public_key, &ve_parameters);
+    if (r < 0)
+    {
+        fprintf(stderr, "Error: cannot initialize the verifier!\n");
+        return 1;
+    }
+    ve_parameters.pairing_mode = pairing_mode;
+
+    // verifier - designated verifier (shares the revocation authority private key)
+    if (designated_verifier)
+    {
+        r = ve_set_designated_key(&ve_parameters, ra_keys.private_key);
+        if (r < 0)
+        {
+            fprintf(stderr, "Error: cannot set the designated verifier key!\n");
+            return 1;
+        }
+    }
+
+    // verifier - compute the independent parts of the verification in parallel
+    if (parallel_verifier)
+    {
+        r = ve_set_parallel(&ve_parameters, VERIFIER_NUM_THREADS);
+        if (r < 0)
+        {
+            fprintf(stderr, "Error: cannot start the verifier threads!\n");
+            return 1;
+        }
+    }
+
+    // revocation authority - revoked users of the revocation database
+    if (database_path != NULL)
+    {
+        r = rd_get_revoked(&ra_database, &revoked_mr, &num_revoked);
+        if (r < 0)
+        {
+            fprintf(stderr, "Error: cannot read the revocation database!\n");
+            return 1;
+        }
+    }
+
+    // revocation authority - revocation list of the epoch
+    r = ra_revoked_pseudonyms(sys_parameters, ra_parameters, ra_indices, revoked_mr, num_revoked, epoch, sizeof(epoch), 0, &ve_revocation_list);
+    free(revoked_mr);
+    if (r < 0)
+    {
+        fprintf(stderr, "Error: cannot create the revocation list!\n");
+        return 1;
+    }
+    ve_set_revocation_list(&ve_parameters, &ve_revocation_list);
+
     // verifier - verify proof of knowledge
-    r = ve_verify_proof_of_knowledge(sys_parameters, ra_parameters, ra_keys.public_key, ie_keys, nonce, sizeof(nonce), epoch, sizeof(epoch), ue_attributes, ue_credential, ue_pi);
+    r = ve_verify_proof_of_knowledge(sys_parameters, ve_parameters, ra_parameters, ra_keys.public_key, ie_keys, nonce, sizeof(nonce), epoch, sizeof(epoch), ue_attributes, ue_credential, ue_pi);
     if (r < 0)
     {
         fprintf(stderr, "Error: cannot verify the user proof of knowledge!\n");
         return 1;
     }
 
+    // verifier - serve the proofs of knowledge received through the socket
+    if (socket_path != NULL)
+    {
+        r = ve_service_start(&ve_service, sys_parameters, ve_parameters, ra_parameters, ra_keys.public_key, ie_keys, epoch, sizeof(epoch), socket_path, 0);
+        if (r < 0)
+        {
+            fprintf(stderr, "Error: cannot start the verifier service!\n");
+            return 1;
+        }
+
+        running_service = &ve_service;
+        signal(SIGINT, signal_handler);
+        signal(SIGTERM, signal_handler);
+
+        fprintf(stdout, "[!] Verifier service listening on %s\n", socket_path);
+
+        r = ve_service_run(&ve_service);
+        ve_service_stop(&ve_service);
+        running_service = NULL;
+        if (r < 0)
+        {
+            fprintf(stderr, "Error: cannot run the verifier service!\n");
+            return 1;
+        }
+    }
+
+    ie_cleanup(&ie_parameters);
+    ve_cleanup(&ve_parameters);
+    rl_destroy(&ve_revocation_list);
+    if (database_path != NULL)
+    {
+        rd_close(&ra_database);
+    }
+    if (keystore_loaded)
+    {
+        ks_release(&sys_parameters, &ra_parameters);
+        ks_close(&keystore);
+    }
+    ra_cleanup(&ra_parameters);
+    sys_cleanup(&sys_parameters);
+
 #if defined (RKVAC_PROTOCOL_MULTOS)
     sc_cleanup(reader);
 #endif
@@ -0,0 +1,154 @@
+/**
+ *
+ *  Copyright (C) 2020  Raul Casanova Marques
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <getopt.h>
+
+#include "system.h"
+#include "setup.h"
+
+static struct option long_options[] = {
+        {"output", required_argument, 0, 'o'},
+        {"source", no_argument,       0, 's'},
+        {"help",   no_argument,       0, 'h'},
+        {0, 0, 0, 0}
+};
+
+/**
+ * Writes the system parameters blob as a C source file defining
+ * sys_embedded_parameters and sys_embedded_parameters_length (see setup.h).
+ *
+ * @param path the path of the source file
+ * @param blob the blob
+ * @param blob_length the length of the blob
+ * @return 0 if success else -1
+ */
+static int parameters_write_source(const char *path, const unsigned char *blob, size_t blob_length)
+{
+    FILE *file;
+    size_t it;
+    int r;
+
+    file = fopen(path, "w");
+    if (file == NULL)
+    {
+        return -1;
+    }
+
+    fprintf(file, "/* Generated by rkvac-protocol-parameters, do not edit. */\n\n");
+    fprintf(file, "#include <stddef.h>\n\n");
+    fprintf(file, "const unsigned char sys_embedded_parameters[] = {");
+    for (it = 0; it < blob_length; it++)
+    {
+        fprintf(file, "%s0x%02x,", it % 16 == 0 ? "\n    " : " ", blob[it]);
+    }
+    fprintf(file, "\n};\n\n");
+    fprintf(file, "const size_t sys_embedded_parameters_length = %luu;\n", (unsigned long) blob_length);
+
+    r = ferror(file) ? -1 : 0;
+    if (fclose(file) != 0)
+    {
+        r = -1;
+    }
+
+    return r;
+}
+
+int main(int argc, char *argv[])
+{
+    system_par_t sys_parameters = {0};
+
+    const char *output_path = NULL;
+    int source = 0;
+
+    void *blob = NULL;
+    size_t blob_length;
+
+    int opt;
+    int r;
+
+    while ((opt = getopt_long(argc, argv, "o:sh", long_options, NULL)) != -1)
+    {
+        switch (opt)
+        {
+            case 'o':
+            {
+                output_path = optarg;
+
+                break;
+            }
+            case 's':
+            {
+                source = 1;
+
+                break;
+            }
+            case 'h':
+            {
+                fprintf(stderr, "Usage: %s --output=<PATH> [--source]\n", argv[0]);
+
+                exit(0);
+            }
+            default:
+            {
+                break;
+            }
+        }
+    }
+
+    if (output_path == NULL)
+    {
+        fprintf(stderr, "Error: the output path is required! (--output=<PATH>)\n");
+        return 1;
+    }
+
+    // system - compute the parameters and the precomputed tables
+    r = sys_compute(&sys_parameters);
+    if (r < 0)
+    {
+        fprintf(stderr, "Error: cannot initialize the system!\n");
+        return 1;
+    }
+
+    if (source)
+    {
+        r = sys_export(sys_parameters, &blob, &blob_length);
+        if (r == 0)
+        {
+            r = parameters_write_source(output_path, (const unsigned char *) blob, blob_length);
+        }
+        free(blob);
+    }
+    else
+    {
+        r = sys_save(sys_parameters, output_path);
+    }
+    sys_cleanup(&sys_parameters);
+
+    if (r < 0)
+    {
+        fprintf(stderr, "Error: cannot write the system parameters!\n");
+        return 1;
+    }
+
+    return 0;
+}
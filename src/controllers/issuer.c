@@ -68,30 +68,73 @@ int ie_setup(issuer_par_t parameters, issuer_keys_t *keys)
 }
 
 /**
- * Computes the signature of the user attributes using the private keys.
+ * Precomputes the line coefficients of the G2 points used by the
+ * issuer (G2 and the revocation authority public key), so that
+ * they are not recomputed for every pairing, and the pairing e(G1, G2).
  *
  * @param sys_parameters the system parameters
- * @param parameters the issuer parameters
- * @param keys the issuer keys
- * @param ue_identifier the user identifier
- * @param ue_attributes the user attributes
  * @param revocation_authority_public_key the revocation authority public key
- * @param revocation_authority_signature the revocation authority signature (mr, ra_sigma)
- * @param signature the signature of the user attributes
+ * @param parameters the issuer parameters
  * @return 0 if success else -1
  */
-int ie_issue(system_par_t sys_parameters, issuer_par_t parameters, issuer_keys_t keys, user_identifier_t ue_identifier, user_attributes_t ue_attributes,
-             revocation_authority_public_key_t revocation_authority_public_key, revocation_authority_signature_t revocation_authority_signature,
-             issuer_signature_t *signature)
+int ie_precompute(system_par_t sys_parameters, revocation_authority_public_key_t revocation_authority_public_key, issuer_par_t *parameters)
 {
-    mclBnGT el, er;
-    mclBnGT e1, e2, e3;
+    int r;
+
+    if (parameters == NULL)
+    {
+        return -1;
+    }
+
+    r = mcl_G2_precompute_copy(&parameters->G2_precomputed, &sys_parameters.G2, sys_parameters.G2_precomputed);
+    if (r < 0)
+    {
+        return -1;
+    }
 
-    mclBnFr number_one, attribute;
-    mclBnFr add_result, mul_result, div_result;
+    r = mcl_G2_precompute(&parameters->pk_precomputed, &revocation_authority_public_key.pk);
+    if (r < 0)
+    {
+        ie_cleanup(parameters);
+        return -1;
+    }
 
+    // e(G1, G2) does not change, it is the right side of every MAC equation
+    mcl_pairing(&parameters->G1_G2_pairing, &sys_parameters.G1, &sys_parameters.G2, parameters->G2_precomputed);
+
+    return 0;
+}
+
+/**
+ * Releases the resources allocated by the issuer precomputation.
+ *
+ * @param parameters the issuer parameters
+ */
+void ie_cleanup(issuer_par_t *parameters)
+{
+    if (parameters == NULL)
+    {
+        return;
+    }
+
+    free(parameters->G2_precomputed);
+    parameters->G2_precomputed = NULL;
+
+    free(parameters->pk_precomputed);
+    parameters->pk_precomputed = NULL;
+}
+
+/**
+ * Computes the hash H(mr || id) signed by the revocation authority.
+ *
+ * @param fr_hash the hash as Fr
+ * @param mr the revocation attribute mr
+ * @param ue_identifier the user identifier
+ * @return 0 if success else -1
+ */
+static int ie_compute_mac_hash(mclBnFr *fr_hash, mclBnFr mr, const user_identifier_t *ue_identifier)
+{
     unsigned char fr_data[EC_SIZE];
-    mclBnFr fr_hash;
 
     /*
      * IMPORTANT!
@@ -103,77 +146,73 @@ int ie_issue(system_par_t sys_parameters, issuer_par_t parameters, issuer_keys_t
     unsigned char hash[SHA_DIGEST_PADDING + SHA_DIGEST_LENGTH] = {0};
     SHA_CTX ctx;
 
-    size_t it;
     int r;
 
-    if (ue_attributes.num_attributes == 0 || ue_attributes.num_attributes > USER_MAX_NUM_ATTRIBUTES || signature == NULL)
-    {
-        return -1;
-    }
-
     // signature->mr to bytes
-    mcl_Fr_to_bytes(fr_data, EC_SIZE, revocation_authority_signature.mr);
+    mcl_Fr_to_bytes(fr_data, EC_SIZE, mr);
 
     // H(mr || id)
     SHA1_Init(&ctx);
     SHA1_Update(&ctx, fr_data, EC_SIZE);
-    SHA1_Update(&ctx, ue_identifier.buffer, ue_identifier.buffer_length);
+    SHA1_Update(&ctx, ue_identifier->buffer, ue_identifier->buffer_length);
     SHA1_Final(&hash[SHA_DIGEST_PADDING], &ctx);
 
-    /*
-     * IMPORTANT!
-     *
-     * We are using SHA1 on the Smart Card. However, because the length
-     * of the SHA1 hash is 20 and the size of Fr is 32, it is necessary
-     * to enlarge 12 characters and fill them with 0's.
-     */
-    mcl_bytes_to_Fr(&fr_hash, hash, EC_SIZE);
-    r = mclBnFr_isValid(&fr_hash);
+    mcl_bytes_to_Fr(fr_hash, hash, EC_SIZE);
+    r = mclBnFr_isValid(fr_hash);
     if (r != 1)
     {
         return -1;
     }
 
-    /// pairing
-    // e(ra_sigma, ra_pk)
-    mclBn_pairing(&e1, &revocation_authority_signature.sigma, &revocation_authority_public_key.pk);
-
-    // e(ra_sigma^hash, G2) == e(ra_sigma, G2)^hash
-    mclBn_pairing(&e2, &revocation_authority_signature.sigma, &sys_parameters.G2);
-    mclBnGT_pow(&e3, &e2, &fr_hash);
+    return 0;
+}
 
-    // e(ra_sigma, ra_pk) * e(ra_sigma^hash, G2)
-    mclBnGT_mul(&el, &e1, &e3);
+/**
+ * Computes the denominator of the signature, x(0) + m(1)·x(1) + ... + m(r)·x(r).
+ *
+ * @param denominator the denominator
+ * @param keys the issuer keys
+ * @param num_attributes the number of attributes
+ * @param ue_attributes the user attributes
+ * @param mr the revocation attribute mr
+ */
+static void ie_compute_denominator(mclBnFr *denominator, const issuer_keys_t *keys, size_t num_attributes, const user_attributes_t *ue_attributes, mclBnFr mr)
+{
+    mclBnFr attribute, mul_result;
 
-    // e(G1, G2)
-    mclBn_pairing(&er, &sys_parameters.G1, &sys_parameters.G2);
+    size_t it;
 
-    // e(ra_sigma, ra_pk) * e(ra_sigma^hash, G2) ?= e(G1, G2)
-    r = mclBnGT_isEqual(&el, &er);
-    if (r != 1)
+    // denominator = x(0)
+    memcpy(denominator, &keys->issuer_private_key.sk, sizeof(mclBnFr));
+    // denominator = denominator + m(it)·x(it)
+    for (it = 0; it < num_attributes; it++)
     {
-        return -1;
+        mcl_bytes_to_Fr(&attribute, ue_attributes->attributes[it].value, EC_SIZE);
+        mclBnFr_mul(&mul_result, &attribute, &keys->attribute_private_keys[it].sk);
+        mclBnFr_add(denominator, denominator, &mul_result);
     }
+    // denominator = denominator + m(r)·x(r)
+    mclBnFr_mul(&mul_result, &mr, &keys->revocation_private_key.sk);
+    mclBnFr_add(denominator, denominator, &mul_result);
+}
 
-    /// signature of the user attributes
-    // set 1 to Fr data type
-    mclBnFr_setInt32(&number_one, 1);
-
-    // add_result = x(0)
-    memcpy(&add_result, &keys.issuer_private_key.sk, sizeof(mclBnFr));
-    // add_result = add_result + m(it)·x(it)
-    for (it = 0; it < parameters.num_attributes; it++)
-    {
-        mcl_bytes_to_Fr(&attribute, ue_attributes.attributes[it].value, EC_SIZE);
-        mclBnFr_mul(&mul_result, &attribute, &keys.attribute_private_keys[it].sk);
-        mclBnFr_add(&add_result, &add_result, &mul_result);
-    }
-    // add_result = add_result + m(r)·x(r)
-    mclBnFr_mul(&mul_result, &revocation_authority_signature.mr, &keys.revocation_private_key.sk);
-    mclBnFr_add(&add_result, &add_result, &mul_result);
+/**
+ * Computes the signature from the inverse of its denominator,
+ * sigma = G1·inverse and the sigmas of the private keys.
+ *
+ * @param sys_parameters the system parameters
+ * @param keys the issuer keys
+ * @param num_attributes the number of attributes
+ * @param inverse the inverse of the denominator
+ * @param signature the signature of the user attributes
+ * @return 0 if success else -1
+ */
+static int ie_compute_signature(const system_par_t *sys_parameters, const issuer_keys_t *keys, size_t num_attributes, const mclBnFr *inverse, issuer_signature_t *signature)
+{
+    size_t it;
+    int r;
 
-    mclBnFr_div(&div_result, &number_one, &add_result); // div_result = 1 / add_result
-    mclBnG1_mul(&signature->sigma, &sys_parameters.G1, &div_result); // sigma = G1 * div_result
+    fixed_base_mul(&signature->sigma, &sys_parameters->G1, sys_parameters->G1_table, inverse); // sigma = G1 * inverse
     mclBnG1_normalize(&signature->sigma, &signature->sigma);
     r = mclBnG1_isValid(&signature->sigma);
     if (r != 1)
@@ -183,9 +222,9 @@ int ie_issue(system_par_t sys_parameters, issuer_par_t parameters, issuer_keys_t
 
     /// sigma attributes
     // sigma_x_it = sigma·x_it
-    for (it = 0; it < parameters.num_attributes; it++)
+    for (it = 0; it < num_attributes; it++)
     {
-        mclBnG1_mul(&signature->attribute_sigmas[it], &signature->sigma, &keys.attribute_private_keys[it].sk);
+        mclBnG1_mul(&signature->attribute_sigmas[it], &signature->sigma, &keys->attribute_private_keys[it].sk);
         mclBnG1_normalize(&signature->attribute_sigmas[it], &signature->attribute_sigmas[it]);
         r = mclBnG1_isValid(&signature->attribute_sigmas[it]);
         if (r != 1)
@@ -194,7 +233,7 @@ int ie_issue(system_par_t sys_parameters, issuer_par_t parameters, issuer_keys_t
         }
     }
 
-    mclBnG1_mul(&signature->revocation_sigma, &signature->sigma, &keys.revocation_private_key.sk);
+    mclBnG1_mul(&signature->revocation_sigma, &signature->sigma, &keys->revocation_private_key.sk);
     mclBnG1_normalize(&signature->revocation_sigma, &signature->revocation_sigma);
     r = mclBnG1_isValid(&signature->revocation_sigma);
     if (r != 1)
@@ -204,3 +243,592 @@ int ie_issue(system_par_t sys_parameters, issuer_par_t parameters, issuer_keys_t
 
     return 0;
 }
+
+/**
+ * Verifies the MAC of the revocation authority on the user identifier,
+ * e(ra_sigma, ra_pk) · e(ra_sigma, G2)^H(mr || id) == e(G1, G2). The left side is
+ * computed as e(ra_sigma, ra_pk) · e(H(mr || id)·ra_sigma, G2) with one precomputed
+ * Miller loop and compared with the cached e(G1, G2), or as the single pairing
+ * e(ra_sigma, ra_pk + H(mr || id)·G2) if the issuer has not been precomputed.
+ *
+ * @param sys_parameters the system parameters
+ * @param parameters the issuer parameters
+ * @param ue_identifier the user identifier
+ * @param revocation_authority_public_key the revocation authority public key
+ * @param revocation_authority_signature the revocation authority signature (mr, ra_sigma)
+ * @return 0 if success else -1
+ */
+int ie_verify_mac(system_par_t sys_parameters, issuer_par_t parameters, user_identifier_t ue_identifier, revocation_authority_public_key_t revocation_authority_public_key,
+                  revocation_authority_signature_t revocation_authority_signature)
+{
+    mclBnGT el, er;
+
+    mclBnG1 sigma_hash;
+    mclBnG2 pk_hash;
+
+    mclBnFr fr_hash;
+
+    int r;
+
+    // H(mr || id)
+    r = ie_compute_mac_hash(&fr_hash, revocation_authority_signature.mr, &ue_identifier);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    if (parameters.G2_precomputed != NULL && parameters.pk_precomputed != NULL)
+    {
+        // e(ra_sigma, ra_pk) · e(ra_sigma·hash, G2)
+        mclBnG1_mul(&sigma_hash, &revocation_authority_signature.sigma, &fr_hash);
+        mclBn_precomputedMillerLoop2(&el, &revocation_authority_signature.sigma, parameters.pk_precomputed, &sigma_hash, parameters.G2_precomputed);
+        mclBn_finalExp(&el, &el);
+
+        // e(G1, G2)
+        memcpy(&er, &parameters.G1_G2_pairing, sizeof(mclBnGT));
+    }
+    else
+    {
+        // e(ra_sigma, ra_pk + G2·hash)
+        mclBnG2_mul(&pk_hash, &sys_parameters.G2, &fr_hash);
+        mclBnG2_add(&pk_hash, &pk_hash, &revocation_authority_public_key.pk);
+        mclBn_pairing(&el, &revocation_authority_signature.sigma, &pk_hash);
+
+        // e(G1, G2)
+        mclBn_pairing(&er, &sys_parameters.G1, &sys_parameters.G2);
+    }
+
+    // e(ra_sigma, ra_pk) · e(ra_sigma, G2)^hash ?= e(G1, G2)
+    r = mclBnGT_isEqual(&el, &er);
+    if (r != 1)
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * Computes the signature of the user attributes using the private keys.
+ *
+ * @param sys_parameters the system parameters
+ * @param parameters the issuer parameters
+ * @param keys the issuer keys
+ * @param ue_identifier the user identifier
+ * @param ue_attributes the user attributes
+ * @param revocation_authority_public_key the revocation authority public key
+ * @param revocation_authority_signature the revocation authority signature (mr, ra_sigma)
+ * @param signature the signature of the user attributes
+ * @return 0 if success else -1
+ */
+int ie_issue(system_par_t sys_parameters, issuer_par_t parameters, issuer_keys_t keys, user_identifier_t ue_identifier, user_attributes_t ue_attributes,
+             revocation_authority_public_key_t revocation_authority_public_key, revocation_authority_signature_t revocation_authority_signature,
+             issuer_signature_t *signature)
+{
+    mclBnFr number_one;
+    mclBnFr denominator, div_result;
+
+    int r;
+
+    if (ue_attributes.num_attributes == 0 || ue_attributes.num_attributes > USER_MAX_NUM_ATTRIBUTES || signature == NULL)
+    {
+        return -1;
+    }
+
+    /// MAC of the revocation authority
+    r = ie_verify_mac(sys_parameters, parameters, ue_identifier, revocation_authority_public_key, revocation_authority_signature);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    /// signature of the user attributes
+    // set 1 to Fr data type
+    mclBnFr_setInt32(&number_one, 1);
+
+    ie_compute_denominator(&denominator, &keys, parameters.num_attributes, &ue_attributes, revocation_authority_signature.mr);
+    mclBnFr_div(&div_result, &number_one, &denominator); // div_result = 1 / denominator
+
+    return ie_compute_signature(&sys_parameters, &keys, parameters.num_attributes, &div_result, signature);
+}
+
+/**
+ * Aggregates the MAC equations of the credentials in the range [first, last)
+ * using the random weights and checks the resulting equation
+ * e(sum(w·ra_sigma), ra_pk) · e(sum(w·H(mr || id)·ra_sigma) - sum(w)·G1, G2) == 1.
+ *
+ * @param sys_parameters the system parameters
+ * @param parameters the issuer parameters
+ * @param revocation_authority_public_key the revocation authority public key
+ * @param sigmas the ra_sigma of each credential
+ * @param weights the random weight of each credential
+ * @param weighted_hashes the weight times H(mr || id) of each credential
+ * @param first the first credential of the range
+ * @param last the credential after the last credential of the range
+ * @return 0 if the aggregated equation holds else -1
+ */
+static int ie_verify_macs_range(const system_par_t *sys_parameters, const issuer_par_t *parameters, const revocation_authority_public_key_t *revocation_authority_public_key,
+                                mclBnG1 *sigmas, mclBnFr *weights, mclBnFr *weighted_hashes, size_t first, size_t last)
+{
+    mclBnG1 g1_points[2]; // sum(w·ra_sigma), sum(w·hash·ra_sigma) - sum(w)·G1
+    mclBnG2 g2_points[2]; // ra_pk, G2
+    mclBnGT el;
+
+    mclBnFr weights_sum;
+    mclBnG1 mul_result;
+
+    size_t it;
+
+    mclBnG1_mulVec(&g1_points[0], &sigmas[first], &weights[first], last - first);
+    mclBnG1_mulVec(&g1_points[1], &sigmas[first], &weighted_hashes[first], last - first);
+
+    // sum(w)·G1 (the right side of every equation is e(G1, G2))
+    mclBnFr_clear(&weights_sum);
+    for (it = first; it < last; it++)
+    {
+        mclBnFr_add(&weights_sum, &weights_sum, &weights[it]);
+    }
+    fixed_base_mul(&mul_result, &sys_parameters->G1, sys_parameters->G1_table, &weights_sum);
+    mclBnG1_sub(&g1_points[1], &g1_points[1], &mul_result);
+
+    // e(sum(w·ra_sigma), ra_pk) · e(sum(w·hash·ra_sigma) - sum(w)·G1, G2) ?= 1
+    if (parameters->pk_precomputed != NULL && parameters->G2_precomputed != NULL)
+    {
+        mclBn_precomputedMillerLoop2(&el, &g1_points[0], parameters->pk_precomputed, &g1_points[1], parameters->G2_precomputed);
+    }
+    else
+    {
+        memcpy(&g2_points[0], &revocation_authority_public_key->pk, sizeof(mclBnG2));
+        memcpy(&g2_points[1], &sys_parameters->G2, sizeof(mclBnG2));
+
+        mclBn_millerLoopVec(&el, g1_points, g2_points, 2);
+    }
+    mclBn_finalExp(&el, &el);
+
+    return mclBnGT_isOne(&el) == 1 ? 0 : -1;
+}
+
+/**
+ * Checks the MAC equations of the credentials in the range [first, last). If
+ * the aggregated equation does not hold, the range is bisected until the
+ * invalid MACs are found.
+ *
+ * @param sys_parameters the system parameters
+ * @param parameters the issuer parameters
+ * @param revocation_authority_public_key the revocation authority public key
+ * @param sigmas the ra_sigma of each credential
+ * @param weights the random weight of each credential
+ * @param weighted_hashes the weight times H(mr || id) of each credential
+ * @param first the first credential of the range
+ * @param last the credential after the last credential of the range
+ * @param results the result of each credential (0 if valid else -1)
+ * @return 0 if all the MACs of the range are valid else -1
+ */
+static int ie_verify_macs_bisect(const system_par_t *sys_parameters, const issuer_par_t *parameters, const revocation_authority_public_key_t *revocation_authority_public_key,
+                                 mclBnG1 *sigmas, mclBnFr *weights, mclBnFr *weighted_hashes, size_t first, size_t last, int *results)
+{
+    size_t middle;
+    int r1, r2;
+
+    r1 = ie_verify_macs_range(sys_parameters, parameters, revocation_authority_public_key, sigmas, weights, weighted_hashes, first, last);
+    if (r1 == 0)
+    {
+        return 0;
+    }
+
+    // a single MAC that does not hold
+    if (last - first == 1)
+    {
+        results[first] = -1;
+        return -1;
+    }
+
+    middle = first + (last - first) / 2;
+    r1 = ie_verify_macs_bisect(sys_parameters, parameters, revocation_authority_public_key, sigmas, weights, weighted_hashes, first, middle, results);
+    r2 = ie_verify_macs_bisect(sys_parameters, parameters, revocation_authority_public_key, sigmas, weights, weighted_hashes, middle, last, results);
+
+    return (r1 == 0 && r2 == 0) ? 0 : -1;
+}
+
+/**
+ * Signs a range of credentials. The denominators are inverted at once
+ * (Montgomery batch inversion): the prefix products are inverted with one
+ * division and the inverse of each denominator is obtained with two
+ * multiplications.
+ *
+ * @param argument the task
+ */
+static void ie_sign_task(void *argument)
+{
+    issuer_signatures_task_t *task = (issuer_signatures_task_t *) argument;
+    mclBnFr *products = task->products;
+
+    mclBnFr number_one;
+    mclBnFr inverse, div_result;
+
+    size_t num_credentials = task->last - task->first;
+    size_t it;
+    int r;
+
+    if (num_credentials == 0)
+    {
+        return;
+    }
+
+    // set 1 to Fr data type
+    mclBnFr_setInt32(&number_one, 1);
+
+    /// prefix products of the denominators
+    memcpy(&products[task->first], &task->denominators[task->first], sizeof(mclBnFr));
+    for (it = 1; it < num_credentials; it++)
+    {
+        mclBnFr_mul(&products[task->first + it], &products[task->first + it - 1], &task->denominators[task->first + it]); // products[it] = products[it - 1]·d(it)
+    }
+
+    /// one inversion for the whole range
+    mclBnFr_div(&inverse, &number_one, &products[task->last - 1]); // inverse = 1 / (d(0)·...·d(n - 1))
+
+    for (it = num_credentials; it-- > 0;)
+    {
+        if (it == 0)
+        {
+            memcpy(&div_result, &inverse, sizeof(mclBnFr)); // div_result = 1 / d(0)
+        }
+        else
+        {
+            mclBnFr_mul(&div_result, &inverse, &products[task->first + it - 1]); // div_result = 1 / d(it)
+            mclBnFr_mul(&inverse, &inverse, &task->denominators[task->first + it]); // inverse = 1 / (d(0)·...·d(it - 1))
+        }
+
+        if (task->results[task->first + it] != 0)
+        {
+            continue;
+        }
+
+        r = ie_compute_signature(task->sys_parameters, task->keys, task->num_attributes, &div_result, &task->signatures[task->first + it]);
+        if (r < 0)
+        {
+            task->results[task->first + it] = -1;
+        }
+    }
+}
+
+/**
+ * Writes the signature of a credential to the output as a fixed-size record.
+ *
+ * @param output the output stream
+ * @param index the index of the credential in the batch
+ * @param num_attributes the number of attributes
+ * @param signature the signature of the user attributes
+ * @return 0 if success else -1
+ */
+static int ie_write_signature(FILE *output, size_t index, size_t num_attributes, const issuer_signature_t *signature)
+{
+    issuer_signature_record_t record;
+
+    size_t it;
+    int r;
+
+    memset(&record, 0, sizeof(issuer_signature_record_t));
+    record.index = (uint64_t) index;
+
+    r = mcl_G1_to_bytes(&record.sigma, sizeof(elliptic_curve_point_t), signature->sigma);
+    if (r < 0)
+    {
+        return -1;
+    }
+    for (it = 0; it < num_attributes; it++)
+    {
+        r = mcl_G1_to_bytes(&record.attribute_sigmas[it], sizeof(elliptic_curve_point_t), signature->attribute_sigmas[it]);
+        if (r < 0)
+        {
+            return -1;
+        }
+    }
+    r = mcl_G1_to_bytes(&record.revocation_sigma, sizeof(elliptic_curve_point_t), signature->revocation_sigma);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    return fwrite(&record, sizeof(issuer_signature_record_t), 1, output) == 1 ? 0 : -1;
+}
+
+/**
+ * Reads the next signature written by the batch issuance.
+ *
+ * @param input the input stream
+ * @param num_attributes the number of attributes
+ * @param index the index of the credential in the batch
+ * @param signature the signature of the user attributes
+ * @return 0 if success else -1 (end of the stream included)
+ */
+int ie_read_signature(FILE *input, size_t num_attributes, size_t *index, issuer_signature_t *signature)
+{
+    issuer_signature_record_t record;
+
+    size_t it;
+    int r;
+
+    if (input == NULL || num_attributes == 0 || num_attributes > USER_MAX_NUM_ATTRIBUTES || index == NULL || signature == NULL)
+    {
+        return -1;
+    }
+
+    if (fread(&record, sizeof(issuer_signature_record_t), 1, input) != 1)
+    {
+        return -1;
+    }
+    *index = (size_t) record.index;
+
+    r = mcl_bytes_to_G1(&signature->sigma, &record.sigma, sizeof(elliptic_curve_point_t));
+    if (r < 0)
+    {
+        return -1;
+    }
+    for (it = 0; it < num_attributes; it++)
+    {
+        r = mcl_bytes_to_G1(&signature->attribute_sigmas[it], &record.attribute_sigmas[it], sizeof(elliptic_curve_point_t));
+        if (r < 0)
+        {
+            return -1;
+        }
+    }
+    r = mcl_bytes_to_G1(&signature->revocation_sigma, &record.revocation_sigma, sizeof(elliptic_curve_point_t));
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * Computes the signatures of a batch of credentials. The credentials are
+ * processed in chunks of ISSUER_BATCH_CHUNK_SIZE: the MACs of the revocation
+ * authority are checked with a single randomized multi-pairing (bisected if
+ * it fails), the denominators are inverted at once and the G1 multiplications
+ * are split among several threads. The signatures of each chunk are written
+ * to the output as soon as the chunk is signed.
+ *
+ * @param sys_parameters the system parameters
+ * @param parameters the issuer parameters
+ * @param keys the issuer keys
+ * @param ue_identifiers the identifier of each user
+ * @param ue_attributes the attributes of each user
+ * @param revocation_authority_public_key the revocation authority public key
+ * @param revocation_authority_signatures the revocation authority signature of each user (mr, ra_sigma)
+ * @param num_credentials the number of credentials
+ * @param num_threads the number of threads (0 - one per core)
+ * @param output the stream where the signatures are written or NULL
+ * @param signatures the signature of each credential or NULL
+ * @param results the result of each credential (0 if issued else -1)
+ * @return 0 if all the credentials are issued else -1
+ */
+int ie_issue_batch(system_par_t sys_parameters, issuer_par_t parameters, issuer_keys_t keys, const user_identifier_t *ue_identifiers, const user_attributes_t *ue_attributes,
+                   revocation_authority_public_key_t revocation_authority_public_key, const revocation_authority_signature_t *revocation_authority_signatures,
+                   size_t num_credentials, size_t num_threads, FILE *output, issuer_signature_t *signatures, int *results)
+{
+    issuer_signatures_task_t *contexts = NULL;
+    thread_pool_task_t *tasks = NULL;
+    thread_pool_t pool;
+
+    issuer_signature_t *chunk_signatures = NULL;
+    issuer_signature_t *current_signatures;
+
+    mclBnG1 *sigmas = NULL;
+    mclBnFr *weights = NULL, *weighted_hashes = NULL;
+    mclBnFr *denominators = NULL, *products = NULL;
+
+    size_t *valid_credentials = NULL; // credentials whose hash is valid
+    int *valid_results = NULL;
+    size_t num_valid_credentials;
+
+    mclBnFr fr_hash;
+
+    size_t chunk_size, num_chunk_credentials, range;
+    size_t first, it, jt;
+    int r;
+
+    if (ue_identifiers == NULL || ue_attributes == NULL || revocation_authority_signatures == NULL || num_credentials == 0 || results == NULL || (output == NULL && signatures == NULL))
+    {
+        return -1;
+    }
+
+    for (it = 0; it < num_credentials; it++)
+    {
+        results[it] = -1;
+    }
+
+    chunk_size = num_credentials < ISSUER_BATCH_CHUNK_SIZE ? num_credentials : ISSUER_BATCH_CHUNK_SIZE;
+    num_threads = thread_pool_get_num_threads(num_threads, chunk_size);
+
+    sigmas = malloc(chunk_size * sizeof(mclBnG1));
+    weights = malloc(chunk_size * sizeof(mclBnFr));
+    weighted_hashes = malloc(chunk_size * sizeof(mclBnFr));
+    denominators = malloc(chunk_size * sizeof(mclBnFr));
+    products = malloc(chunk_size * sizeof(mclBnFr));
+    valid_credentials = malloc(chunk_size * sizeof(size_t));
+    valid_results = malloc(chunk_size * sizeof(int));
+    contexts = malloc(num_threads * sizeof(issuer_signatures_task_t));
+    tasks = malloc(num_threads * sizeof(thread_pool_task_t));
+    if (sigmas == NULL || weights == NULL || weighted_hashes == NULL || denominators == NULL || products == NULL || valid_credentials == NULL || valid_results == NULL
+        || contexts == NULL || tasks == NULL)
+    {
+        r = -1;
+        goto cleanup;
+    }
+
+    // the signatures are kept only until they are written
+    if (signatures == NULL)
+    {
+        chunk_signatures = malloc(chunk_size * sizeof(issuer_signature_t));
+        if (chunk_signatures == NULL)
+        {
+            r = -1;
+            goto cleanup;
+        }
+    }
+
+    // the calling thread signs too
+    r = thread_pool_init(&pool, num_threads - 1);
+    if (r < 0)
+    {
+        goto cleanup;
+    }
+
+    for (first = 0; first < num_credentials; first += chunk_size)
+    {
+        num_chunk_credentials = num_credentials - first < chunk_size ? num_credentials - first : chunk_size;
+        current_signatures = signatures != NULL ? &signatures[first] : chunk_signatures;
+
+        /// random small-exponent weights (one per MAC equation)
+        r = mcl_generate_weights(weights, num_chunk_credentials, ISSUER_BATCH_WEIGHT_LENGTH);
+        if (r < 0)
+        {
+            break;
+        }
+
+        /// H(mr || id)
+        num_valid_credentials = 0;
+        for (it = 0; it < num_chunk_credentials; it++)
+        {
+            // the credentials not signed count as 1 in the batch inversion
+            mclBnFr_setInt32(&denominators[it], 1);
+
+            jt = first + it;
+            if (ue_attributes[jt].num_attributes == 0 || ue_attributes[jt].num_attributes > USER_MAX_NUM_ATTRIBUTES)
+            {
+                continue;
+            }
+
+            r = ie_compute_mac_hash(&fr_hash, revocation_authority_signatures[jt].mr, &ue_identifiers[jt]);
+            if (r < 0)
+            {
+                continue;
+            }
+
+            memcpy(&sigmas[num_valid_credentials], &revocation_authority_signatures[jt].sigma, sizeof(mclBnG1));
+            memcpy(&weights[num_valid_credentials], &weights[it], sizeof(mclBnFr));
+            mclBnFr_mul(&weighted_hashes[num_valid_credentials], &weights[num_valid_credentials], &fr_hash);
+            valid_results[num_valid_credentials] = 0;
+            valid_credentials[num_valid_credentials++] = it;
+        }
+
+        /// e(ra_sigma, ra_pk) · e(ra_sigma^hash, G2) ?= e(G1, G2) for the whole chunk
+        if (num_valid_credentials > 0)
+        {
+            ie_verify_macs_bisect(&sys_parameters, &parameters, &revocation_authority_public_key, sigmas, weights, weighted_hashes, 0, num_valid_credentials, valid_results);
+        }
+
+        /// denominators of the signatures
+        for (it = 0; it < num_valid_credentials; it++)
+        {
+            if (valid_results[it] != 0)
+            {
+                continue;
+            }
+
+            jt = valid_credentials[it];
+            ie_compute_denominator(&denominators[jt], &keys, parameters.num_attributes, &ue_attributes[first + jt], revocation_authority_signatures[first + jt].mr);
+            // the credential cannot be signed (zero denominator)
+            if (mclBnFr_isZero(&denominators[jt]) == 1)
+            {
+                mclBnFr_setInt32(&denominators[jt], 1);
+                continue;
+            }
+
+            results[first + jt] = 0;
+        }
+
+        /// signatures (batch inversion and G1 multiplications)
+        range = (num_chunk_credentials + num_threads - 1) / num_threads;
+        for (it = 0; it < num_threads; it++)
+        {
+            contexts[it].sys_parameters = &sys_parameters;
+            contexts[it].keys = &keys;
+            contexts[it].num_attributes = parameters.num_attributes;
+            contexts[it].denominators = denominators;
+            contexts[it].results = &results[first];
+            contexts[it].signatures = current_signatures;
+            contexts[it].first = it * range < num_chunk_credentials ? it * range : num_chunk_credentials;
+            contexts[it].last = (it + 1) * range < num_chunk_credentials ? (it + 1) * range : num_chunk_credentials;
+            contexts[it].products = products;
+
+            tasks[it].function = ie_sign_task;
+            tasks[it].argument = &contexts[it];
+        }
+
+        r = thread_pool_run(&pool, tasks, num_threads);
+        if (r < 0)
+        {
+            break;
+        }
+
+        /// output of the chunk
+        if (output != NULL)
+        {
+            for (it = 0; it < num_chunk_credentials && r == 0; it++)
+            {
+                if (results[first + it] == 0)
+                {
+                    r = ie_write_signature(output, first + it, parameters.num_attributes, &current_signatures[it]);
+                }
+            }
+            if (r < 0 || fflush(output) != 0)
+            {
+                r = -1;
+                break;
+            }
+        }
+    }
+
+    thread_pool_destroy(&pool);
+    if (r < 0)
+    {
+        goto cleanup;
+    }
+
+    for (it = 0; it < num_credentials; it++)
+    {
+        if (results[it] != 0)
+        {
+            r = -1;
+            break;
+        }
+    }
+
+cleanup:
+    free(sigmas);
+    free(weights);
+    free(weighted_hashes);
+    free(denominators);
+    free(products);
+    free(valid_credentials);
+    free(valid_results);
+    free(contexts);
+    free(tasks);
+    free(chunk_signatures);
+
+    return r;
+}
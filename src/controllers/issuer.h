@@ -27,6 +27,8 @@ extern "C"
 #endif
 
 #include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <assert.h>
 
@@ -40,7 +42,9 @@ extern "C"
 #include "models/user.h"
 #include "system.h"
 
+#include "helpers/fixed_base_helper.h"
 #include "helpers/mcl_helper.h"
+#include "thread/pool.h"
 
 /**
  * Outputs the issuer parameters, generates the private keys.
@@ -51,6 +55,42 @@ extern "C"
  */
 extern int ie_setup(issuer_par_t parameters, issuer_keys_t *keys);
 
+/**
+ * Precomputes the line coefficients of the G2 points used by the
+ * issuer (G2 and the revocation authority public key), so that
+ * they are not recomputed for every pairing, and the pairing e(G1, G2).
+ *
+ * @param sys_parameters the system parameters
+ * @param revocation_authority_public_key the revocation authority public key
+ * @param parameters the issuer parameters
+ * @return 0 if success else -1
+ */
+extern int ie_precompute(system_par_t sys_parameters, revocation_authority_public_key_t revocation_authority_public_key, issuer_par_t *parameters);
+
+/**
+ * Releases the resources allocated by the issuer precomputation.
+ *
+ * @param parameters the issuer parameters
+ */
+extern void ie_cleanup(issuer_par_t *parameters);
+
+/**
+ * Verifies the MAC of the revocation authority on the user identifier,
+ * e(ra_sigma, ra_pk) · e(ra_sigma, G2)^H(mr || id) == e(G1, G2). The left side is
+ * computed as e(ra_sigma, ra_pk) · e(H(mr || id)·ra_sigma, G2) with one precomputed
+ * Miller loop and compared with the cached e(G1, G2), or as the single pairing
+ * e(ra_sigma, ra_pk + H(mr || id)·G2) if the issuer has not been precomputed.
+ *
+ * @param sys_parameters the system parameters
+ * @param parameters the issuer parameters
+ * @param ue_identifier the user identifier
+ * @param revocation_authority_public_key the revocation authority public key
+ * @param revocation_authority_signature the revocation authority signature (mr, ra_sigma)
+ * @return 0 if success else -1
+ */
+extern int ie_verify_mac(system_par_t sys_parameters, issuer_par_t parameters, user_identifier_t ue_identifier, revocation_authority_public_key_t revocation_authority_public_key,
+                         revocation_authority_signature_t revocation_authority_signature);
+
 /**
  * Computes the signature of the user attributes using the private keys.
  *
@@ -68,6 +108,43 @@ extern int ie_issue(system_par_t sys_parameters, issuer_par_t parameters, issuer
                     revocation_authority_public_key_t revocation_authority_public_key, revocation_authority_signature_t revocation_authority_signature,
                     issuer_signature_t *signature);
 
+/**
+ * Computes the signatures of a batch of credentials. The credentials are
+ * processed in chunks of ISSUER_BATCH_CHUNK_SIZE: the MACs of the revocation
+ * authority are checked with a single randomized multi-pairing (bisected if
+ * it fails), the denominators are inverted at once and the G1 multiplications
+ * are split among several threads. The signatures of each chunk are written
+ * to the output as soon as the chunk is signed.
+ *
+ * @param sys_parameters the system parameters
+ * @param parameters the issuer parameters
+ * @param keys the issuer keys
+ * @param ue_identifiers the identifier of each user
+ * @param ue_attributes the attributes of each user
+ * @param revocation_authority_public_key the revocation authority public key
+ * @param revocation_authority_signatures the revocation authority signature of each user (mr, ra_sigma)
+ * @param num_credentials the number of credentials
+ * @param num_threads the number of threads (0 - one per core)
+ * @param output the stream where the signatures are written or NULL
+ * @param signatures the signature of each credential or NULL
+ * @param results the result of each credential (0 if issued else -1)
+ * @return 0 if all the credentials are issued else -1
+ */
+extern int ie_issue_batch(system_par_t sys_parameters, issuer_par_t parameters, issuer_keys_t keys, const user_identifier_t *ue_identifiers, const user_attributes_t *ue_attributes,
+                          revocation_authority_public_key_t revocation_authority_public_key, const revocation_authority_signature_t *revocation_authority_signatures,
+                          size_t num_credentials, size_t num_threads, FILE *output, issuer_signature_t *signatures, int *results);
+
+/**
+ * Reads the next signature written by the batch issuance.
+ *
+ * @param input the input stream
+ * @param num_attributes the number of attributes
+ * @param index the index of the credential in the batch
+ * @param signature the signature of the user attributes
+ * @return 0 if success else -1 (end of the stream included)
+ */
+extern int ie_read_signature(FILE *input, size_t num_attributes, size_t *index, issuer_signature_t *signature);
+
 #ifdef __cplusplus
 }
 #endif
@@ -87,6 +87,17 @@ int ue_set_revocation_authority_data(reader_t reader, revocation_authority_par_t
     size_t it;
     int r;
 
+    /*
+     * IMPORTANT!
+     *
+     * The Smart Card stores the default number of randomizers (k, j),
+     * the values chosen at runtime by ra_setup are not supported.
+     */
+    if (ra_parameters.k != REVOCATION_AUTHORITY_VALUE_K || ra_parameters.j != REVOCATION_AUTHORITY_VALUE_J)
+    {
+        return -1;
+    }
+
     data_length = 0;
 
     // ra_signature.mr
@@ -417,8 +428,7 @@ int ue_set_issuer_signatures(reader_t reader, issuer_par_t ie_parameters, issuer
  * @param ra_parameters the revocation authority parameters
  * @param ra_signature the signature of the user identifier
  * @param ie_signature the issuer signature
- * @param I the first pseudo-random value used to select the first randomizer
- * @param II the second pseudo-random value used to select the second randomizer
+ * @param indices the indices of the j randomizers (selected by the Smart Card, ignored)
  * @param nonce the nonce generated by the verifier
  * @param nonce_length the length of the nonce
  * @param epoch the epoch generated by the verifier
@@ -430,7 +440,7 @@ int ue_set_issuer_signatures(reader_t reader, issuer_par_t ie_parameters, issuer
  * @return 0 if success else -1
  */
 int ue_compute_proof_of_knowledge(reader_t reader, system_par_t sys_parameters, revocation_authority_par_t ra_parameters, revocation_authority_signature_t ra_signature,
-                                  issuer_signature_t ie_signature, uint8_t I, uint8_t II, const void *nonce, size_t nonce_length, const void *epoch, size_t epoch_length,
+                                  issuer_signature_t ie_signature, const size_t *indices, const void *nonce, size_t nonce_length, const void *epoch, size_t epoch_length,
                                   user_attributes_t *attributes, size_t num_disclosed_attributes, user_credential_t *credential, user_pi_t *pi)
 {
     uint8_t pbSendBuffer[MAX_APDU_LENGTH_T0] = {0};
@@ -485,6 +495,12 @@ int ue_compute_proof_of_knowledge(reader_t reader, system_par_t sys_parameters,
         return -1;
     }
 
+    // the Smart Card supports the default number of randomizers only
+    if (ra_parameters.j != REVOCATION_AUTHORITY_VALUE_J)
+    {
+        return -1;
+    }
+
     /// disclose attributes
     num_non_disclosed_attributes = attributes->num_attributes - num_disclosed_attributes;
 
@@ -643,8 +659,8 @@ int ue_compute_proof_of_knowledge(reader_t reader, system_par_t sys_parameters,
     data_length += sizeof(elliptic_curve_multiplier_t);
 
     // s_e1
-    multos_Fr_to_mcl_Fr(&pi->s_e1, &data[data_length], sizeof(elliptic_curve_fr_t));
-    r = mclBnFr_isValid(&pi->s_e1);
+    multos_Fr_to_mcl_Fr(&pi->s_e[0], &data[data_length], sizeof(elliptic_curve_fr_t));
+    r = mclBnFr_isValid(&pi->s_e[0]);
     if (r != 1)
     {
         return -1;
@@ -652,8 +668,8 @@ int ue_compute_proof_of_knowledge(reader_t reader, system_par_t sys_parameters,
     data_length += sizeof(elliptic_curve_fr_t);
 
     // s_e2
-    multos_Fr_to_mcl_Fr(&pi->s_e2, &data[data_length], sizeof(elliptic_curve_fr_t));
-    r = mclBnFr_isValid(&pi->s_e2);
+    multos_Fr_to_mcl_Fr(&pi->s_e[1], &data[data_length], sizeof(elliptic_curve_fr_t));
+    r = mclBnFr_isValid(&pi->s_e[1]);
     if (r != 1)
     {
         return -1;
@@ -685,6 +701,8 @@ int ue_compute_proof_of_knowledge(reader_t reader, system_par_t sys_parameters,
     }
 
     /// signatures
+    credential->num_randomizers = REVOCATION_AUTHORITY_VALUE_J;
+
     // sigma_hat
     multos_G1_to_mcl_G1(&credential->sigma_hat, &data[data_length], sizeof(elliptic_curve_point_t));
     r = mclBnG1_isValid(&credential->sigma_hat);
@@ -695,8 +713,8 @@ int ue_compute_proof_of_knowledge(reader_t reader, system_par_t sys_parameters,
     data_length += sizeof(elliptic_curve_point_t);
 
     // sigma_hat_e1
-    multos_G1_to_mcl_G1(&credential->sigma_hat_e1, &data[data_length], sizeof(elliptic_curve_point_t));
-    r = mclBnG1_isValid(&credential->sigma_hat_e1);
+    multos_G1_to_mcl_G1(&credential->sigma_hat_e[0], &data[data_length], sizeof(elliptic_curve_point_t));
+    r = mclBnG1_isValid(&credential->sigma_hat_e[0]);
     if (r != 1)
     {
         return -1;
@@ -704,8 +722,8 @@ int ue_compute_proof_of_knowledge(reader_t reader, system_par_t sys_parameters,
     data_length += sizeof(elliptic_curve_point_t);
 
     // sigma_hat_e2
-    multos_G1_to_mcl_G1(&credential->sigma_hat_e2, &data[data_length], sizeof(elliptic_curve_point_t));
-    r = mclBnG1_isValid(&credential->sigma_hat_e2);
+    multos_G1_to_mcl_G1(&credential->sigma_hat_e[1], &data[data_length], sizeof(elliptic_curve_point_t));
+    r = mclBnG1_isValid(&credential->sigma_hat_e[1]);
     if (r != 1)
     {
         return -1;
@@ -713,8 +731,8 @@ int ue_compute_proof_of_knowledge(reader_t reader, system_par_t sys_parameters,
     data_length += sizeof(elliptic_curve_point_t);
 
     // sigma_minus_e1
-    multos_G1_to_mcl_G1(&credential->sigma_minus_e1, &data[data_length], sizeof(elliptic_curve_point_t));
-    r = mclBnG1_isValid(&credential->sigma_minus_e1);
+    multos_G1_to_mcl_G1(&credential->sigma_minus_e[0], &data[data_length], sizeof(elliptic_curve_point_t));
+    r = mclBnG1_isValid(&credential->sigma_minus_e[0]);
     if (r != 1)
     {
         return -1;
@@ -722,8 +740,8 @@ int ue_compute_proof_of_knowledge(reader_t reader, system_par_t sys_parameters,
     data_length += sizeof(elliptic_curve_point_t);
 
     // sigma_minus_e2
-    multos_G1_to_mcl_G1(&credential->sigma_minus_e2, &data[data_length], sizeof(elliptic_curve_point_t));
-    r = mclBnG1_isValid(&credential->sigma_minus_e2);
+    multos_G1_to_mcl_G1(&credential->sigma_minus_e[1], &data[data_length], sizeof(elliptic_curve_point_t));
+    r = mclBnG1_isValid(&credential->sigma_minus_e[1]);
     if (r != 1)
     {
         return -1;
@@ -112,8 +112,7 @@ extern int ue_set_issuer_signatures(reader_t reader, issuer_par_t ie_parameters,
  * @param ra_parameters the revocation authority parameters
  * @param ra_signature the signature of the user identifier
  * @param ie_signature the issuer signature
- * @param I the first pseudo-random value used to select the first randomizer
- * @param II the second pseudo-random value used to select the second randomizer
+ * @param indices the indices of the j randomizers (selected by the Smart Card, ignored)
  * @param nonce the nonce generated by the verifier
  * @param nonce_length the length of the nonce
  * @param epoch the epoch generated by the verifier
@@ -125,7 +124,7 @@ extern int ue_set_issuer_signatures(reader_t reader, issuer_par_t ie_parameters,
  * @return 0 if success else -1
  */
 extern int ue_compute_proof_of_knowledge(reader_t reader, system_par_t sys_parameters, revocation_authority_par_t ra_parameters, revocation_authority_signature_t ra_signature,
-                                         issuer_signature_t ie_signature, uint8_t I, uint8_t II, const void *nonce, size_t nonce_length, const void *epoch, size_t epoch_length,
+                                         issuer_signature_t ie_signature, const size_t *indices, const void *nonce, size_t nonce_length, const void *epoch, size_t epoch_length,
                                          user_attributes_t *attributes, size_t num_disclosed_attributes, user_credential_t *credential, user_pi_t *pi);
 
 /**
@@ -20,20 +20,110 @@
 
 #include "revocation-authority.h"
 
+/**
+ * Signs a range of randomizers, sigma_e = (1 / (e + sk)) * G1. The denominators
+ * are inverted at once (Montgomery batch inversion): the prefix products are
+ * inverted with one division and the inverse of each denominator is obtained
+ * with two multiplications.
+ *
+ * @param argument the task
+ */
+static void ra_sign_randomizers_task(void *argument)
+{
+    revocation_authority_randomizers_task_t *task = (revocation_authority_randomizers_task_t *) argument;
+    mclBnFr *products = task->products;
+
+    mclBnFr number_one;
+    mclBnFr denominator, inverse, div_result;
+
+    mclBnG1 *sigma;
+
+    size_t num_randomizers = task->last - task->first;
+    size_t it;
+    int r;
+
+    task->result = 0;
+    if (num_randomizers == 0)
+    {
+        return;
+    }
+
+    // set 1 to Fr data type
+    mclBnFr_setInt32(&number_one, 1);
+
+    /// prefix products of the denominators (e + sk)
+    for (it = 0; it < num_randomizers; it++)
+    {
+        mclBnFr_add(&denominator, &task->randomizers[task->first + it], task->sk); // denominator = e + sk
+        // the randomizer cannot be signed (e = -sk)
+        if (mclBnFr_isZero(&denominator) == 1)
+        {
+            task->result = -1;
+            return;
+        }
+
+        if (it == 0)
+        {
+            memcpy(&products[task->first], &denominator, sizeof(mclBnFr));
+        }
+        else
+        {
+            mclBnFr_mul(&products[task->first + it], &products[task->first + it - 1], &denominator); // products[it] = products[it - 1]·denominator
+        }
+    }
+
+    /// one inversion for the whole range
+    mclBnFr_div(&inverse, &number_one, &products[task->last - 1]); // inverse = 1 / (d(0)·...·d(n - 1))
+
+    for (it = num_randomizers; it-- > 0;)
+    {
+        if (it == 0)
+        {
+            memcpy(&div_result, &inverse, sizeof(mclBnFr)); // div_result = 1 / d(0)
+        }
+        else
+        {
+            mclBnFr_add(&denominator, &task->randomizers[task->first + it], task->sk);
+            mclBnFr_mul(&div_result, &inverse, &products[task->first + it - 1]); // div_result = 1 / d(it)
+            mclBnFr_mul(&inverse, &inverse, &denominator); // inverse = 1 / (d(0)·...·d(it - 1))
+        }
+
+        // randomizers_sigma = (1 / (ez + sk)) * G1
+        sigma = &task->randomizers_sigma[task->first + it];
+        fixed_base_mul(sigma, &task->sys_parameters->G1, task->sys_parameters->G1_table, &div_result); // sigma = G1 * div_result
+        mclBnG1_normalize(sigma, sigma);
+        r = mclBnG1_isValid(sigma);
+        if (r != 1)
+        {
+            task->result = -1;
+            return;
+        }
+    }
+}
+
 /**
  * Outputs the revocation authority parameters, generates the
- * private key and computes the public key.
+ * private key and computes the public key. The k randomizers are
+ * signed by several threads, each of them inverts its denominators
+ * at once and multiplies using the fixed-base table of G1.
  *
  * @param sys_parameters the system parameters
+ * @param k the number of randomizers (0 - REVOCATION_AUTHORITY_VALUE_K)
+ * @param j the number of randomizers selected by the user (0 - REVOCATION_AUTHORITY_VALUE_J)
+ * @param num_threads the number of threads (0 - one per core)
  * @param parameters the revocation authority parameters
  * @param keys the revocation authority private and public keys
  * @return 0 if success else -1
  */
-int ra_setup(system_par_t sys_parameters, revocation_authority_par_t *parameters, revocation_authority_keys_t *keys)
+int ra_setup(system_par_t sys_parameters, size_t k, size_t j, size_t num_threads, revocation_authority_par_t *parameters, revocation_authority_keys_t *keys)
 {
-    mclBnFr number_one;
-    mclBnFr add_result, div_result;
+    revocation_authority_randomizers_task_t *contexts = NULL;
+    thread_pool_task_t *tasks = NULL;
+    thread_pool_t pool;
 
+    mclBnFr *products = NULL;
+
+    size_t chunk;
     size_t it;
     int r;
 
@@ -43,8 +133,16 @@ int ra_setup(system_par_t sys_parameters, revocation_authority_par_t *parameters
     }
 
     /// chooses integers (k, j)
-    parameters->k = REVOCATION_AUTHORITY_VALUE_K;
-    parameters->j = REVOCATION_AUTHORITY_VALUE_J;
+    k = k == 0 ? REVOCATION_AUTHORITY_VALUE_K : k;
+    j = j == 0 ? REVOCATION_AUTHORITY_VALUE_J : j;
+    if (j > REVOCATION_AUTHORITY_MAX_J)
+    {
+        return -1;
+    }
+
+    memset(parameters, 0, sizeof(revocation_authority_par_t));
+    parameters->k = k;
+    parameters->j = j;
 
     /// chooses random integers (alphas)
     for (it = 0; it < parameters->j; it++)
@@ -56,7 +154,7 @@ int ra_setup(system_par_t sys_parameters, revocation_authority_par_t *parameters
             return -1;
         }
 
-        mclBnG1_mul(&parameters->alphas_mul[it], &sys_parameters.G1, &parameters->alphas[it]);
+        fixed_base_mul(&parameters->alphas_mul[it], &sys_parameters.G1, sys_parameters.G1_table, &parameters->alphas[it]);
         mclBnG1_normalize(&parameters->alphas_mul[it], &parameters->alphas_mul[it]);
         r = mclBnG1_isValid(&parameters->alphas_mul[it]);
         if (r != 1)
@@ -84,37 +182,148 @@ int ra_setup(system_par_t sys_parameters, revocation_authority_par_t *parameters
     }
 
     /// chooses randomizers and signs each of them
-    // set 1 to Fr data type
-    mclBnFr_setInt32(&number_one, 1);
+    num_threads = thread_pool_get_num_threads(num_threads, parameters->k);
+
+    parameters->randomizers = malloc(parameters->k * sizeof(mclBnFr));
+    parameters->randomizers_sigma = malloc(parameters->k * sizeof(mclBnG1));
+    products = malloc(parameters->k * sizeof(mclBnFr));
+    contexts = malloc(num_threads * sizeof(revocation_authority_randomizers_task_t));
+    tasks = malloc(num_threads * sizeof(thread_pool_task_t));
+    if (parameters->randomizers == NULL || parameters->randomizers_sigma == NULL || products == NULL || contexts == NULL || tasks == NULL)
+    {
+        r = -1;
+        goto cleanup;
+    }
 
+    /*
+     * IMPORTANT!
+     *
+     * The randomizers are chosen by the calling thread, the CSPRNG
+     * of mcl is not meant to be shared by several threads.
+     */
     for (it = 0; it < parameters->k; it++)
     {
         mclBnFr_setByCSPRNG(&parameters->randomizers[it]);
         r = mclBnFr_isValid(&parameters->randomizers[it]);
         if (r != 1)
         {
-            return -1;
+            r = -1;
+            goto cleanup;
         }
+    }
 
-        // randomizers_sigma = (1 / (ez + sk)) * G1
-        mclBnFr_add(&add_result, &parameters->randomizers[it], &keys->private_key.sk); // add_result = ez + sk
-        mclBnFr_div(&div_result, &number_one, &add_result); // div_result = 1 / add_result
-        mclBnG1_mul(&parameters->randomizers_sigma[it], &sys_parameters.G1, &div_result); // sigma = G1 * div_result
-        mclBnG1_normalize(&parameters->randomizers_sigma[it], &parameters->randomizers_sigma[it]);
-        r = mclBnG1_isValid(&parameters->randomizers_sigma[it]);
-        if (r != 1)
+    // the calling thread signs too
+    r = thread_pool_init(&pool, num_threads - 1);
+    if (r < 0)
+    {
+        goto cleanup;
+    }
+
+    chunk = (parameters->k + num_threads - 1) / num_threads;
+    for (it = 0; it < num_threads; it++)
+    {
+        contexts[it].sys_parameters = &sys_parameters;
+        contexts[it].sk = &keys->private_key.sk;
+        contexts[it].randomizers = parameters->randomizers;
+        contexts[it].randomizers_sigma = parameters->randomizers_sigma;
+        contexts[it].first = it * chunk < parameters->k ? it * chunk : parameters->k;
+        contexts[it].last = (it + 1) * chunk < parameters->k ? (it + 1) * chunk : parameters->k;
+        contexts[it].products = products;
+
+        tasks[it].function = ra_sign_randomizers_task;
+        tasks[it].argument = &contexts[it];
+    }
+
+    r = thread_pool_run(&pool, tasks, num_threads);
+    thread_pool_destroy(&pool);
+    for (it = 0; it < num_threads && r == 0; it++)
+    {
+        r = contexts[it].result;
+    }
+
+    /// the revocation database RD with the revocation handlers RH is stored on the disk (see rd_open)
+    /// and the revocation list RL depends on the epoch (see rl_create)
+
+cleanup:
+    if (r < 0)
+    {
+        ra_cleanup(parameters);
+    }
+
+    free(products);
+    free(contexts);
+    free(tasks);
+
+    return r;
+}
+
+/**
+ * Releases the fixed-base tables of the revocation authority bases h_j.
+ *
+ * @param parameters the revocation authority parameters
+ */
+static void ra_cleanup_tables(revocation_authority_par_t *parameters)
+{
+    size_t it;
+
+    for (it = 0; it < REVOCATION_AUTHORITY_MAX_J; it++)
+    {
+        fixed_base_free(parameters->alphas_mul_tables[it]);
+        parameters->alphas_mul_tables[it] = NULL;
+    }
+}
+
+/**
+ * Precomputes the fixed-base tables of the revocation authority bases
+ * h_j, used by the user and the verifier to compute t_sig.
+ *
+ * @param parameters the revocation authority parameters
+ * @return 0 if success else -1
+ */
+int ra_precompute(revocation_authority_par_t *parameters)
+{
+    size_t it;
+    int r;
+
+    if (parameters == NULL)
+    {
+        return -1;
+    }
+
+    for (it = 0; it < parameters->j; it++)
+    {
+        r = fixed_base_precompute(&parameters->alphas_mul_tables[it], &parameters->alphas_mul[it]);
+        if (r < 0)
         {
+            ra_cleanup_tables(parameters);
             return -1;
         }
     }
 
-    /// generates revocation list RL, empty list of revocation handlers RH
-    /// and revocation database RD
-    // ???
-
     return 0;
 }
 
+/**
+ * Releases the resources allocated by the revocation authority setup
+ * and precomputation.
+ *
+ * @param parameters the revocation authority parameters
+ */
+void ra_cleanup(revocation_authority_par_t *parameters)
+{
+    if (parameters == NULL)
+    {
+        return;
+    }
+
+    ra_cleanup_tables(parameters);
+
+    free(parameters->randomizers);
+    parameters->randomizers = NULL;
+    free(parameters->randomizers_sigma);
+    parameters->randomizers_sigma = NULL;
+}
+
 /**
  * Computes the signature of the user identifier using the private key.
  *
@@ -124,7 +333,7 @@ int ra_setup(system_par_t sys_parameters, revocation_authority_par_t *parameters
  * @param signature the signature of the user identifier
  * @return 0 if success else -1
  */
-int ra_mac(system_par_t sys_parameters, revocation_authority_private_key_t private_key, user_identifier_t ue_identifier, revocation_authority_signature_t *signature)
+int ra_mac(system_par_t sys_parameters, revocation_authority_private_key_t private_key, revocation_database_t *database, user_identifier_t ue_identifier, revocation_authority_signature_t *signature)
 {
     mclBnFr number_one;
     mclBnFr add_result, div_result;
@@ -185,7 +394,7 @@ int ra_mac(system_par_t sys_parameters, revocation_authority_private_key_t priva
     // sigma = (1 / H(mr || id) + sk) * G1
     mclBnFr_add(&add_result, &fr_hash, &private_key.sk); // add_result = H(mr || id) + sk
     mclBnFr_div(&div_result, &number_one, &add_result); // div_result = 1 / add_result
-    mclBnG1_mul(&signature->sigma, &sys_parameters.G1, &div_result); // sigma = G1 * div_result
+    fixed_base_mul(&signature->sigma, &sys_parameters.G1, sys_parameters.G1_table, &div_result); // sigma = G1 * div_result
     mclBnG1_normalize(&signature->sigma, &signature->sigma);
     r = mclBnG1_isValid(&signature->sigma);
     if (r != 1)
@@ -193,5 +402,309 @@ int ra_mac(system_par_t sys_parameters, revocation_authority_private_key_t priva
         return -1;
     }
 
+    // stores (id, mr) to the revocation database
+    if (database != NULL)
+    {
+        r = rd_insert(database, ue_identifier, signature->mr);
+        if (r < 0)
+        {
+            return -1;
+        }
+    }
+
     return 0;
 }
+
+/**
+ * Computes the revoked pseudonyms C = (1 / i - mr + H(epoch)) * G1 of a range of
+ * revoked users. The denominators are inverted at once (Montgomery batch inversion):
+ * the prefix products are inverted with one division and the inverse of each
+ * denominator is obtained with two multiplications.
+ *
+ * @param argument the task
+ */
+static void ra_revoked_pseudonyms_task(void *argument)
+{
+    revocation_authority_pseudonyms_task_t *task = (revocation_authority_pseudonyms_task_t *) argument;
+    mclBnFr *products = task->products;
+
+    mclBnFr number_one;
+    mclBnFr denominator, inverse, div_result;
+
+    mclBnG1 pseudonym;
+    uint8_t *key;
+
+    size_t num_users = task->last - task->first;
+    size_t it;
+    int r;
+
+    task->result = 0;
+    if (num_users == 0)
+    {
+        return;
+    }
+
+    // set 1 to Fr data type
+    mclBnFr_setInt32(&number_one, 1);
+
+    /// prefix products of the denominators (i - mr + H(epoch))
+    for (it = 0; it < num_users; it++)
+    {
+        mclBnFr_sub(&denominator, &task->i_hash, &task->revoked_mr[task->first + it]); // denominator = i + H(epoch) - mr
+        // the user cannot compute this pseudonym either, skip it
+        if (mclBnFr_isZero(&denominator) == 1)
+        {
+            mclBnFr_setInt32(&denominator, 1);
+        }
+
+        if (it == 0)
+        {
+            memcpy(&products[task->first], &denominator, sizeof(mclBnFr));
+        }
+        else
+        {
+            mclBnFr_mul(&products[task->first + it], &products[task->first + it - 1], &denominator); // products[it] = products[it - 1]·denominator
+        }
+    }
+
+    /// one inversion for the whole range
+    mclBnFr_div(&inverse, &number_one, &products[task->last - 1]); // inverse = 1 / (d(0)·...·d(n - 1))
+
+    for (it = num_users; it-- > 0;)
+    {
+        key = &task->keys[(task->first + it) * REVOCATION_LIST_KEY_LENGTH];
+
+        mclBnFr_sub(&denominator, &task->i_hash, &task->revoked_mr[task->first + it]);
+        if (mclBnFr_isZero(&denominator) == 1)
+        {
+            memset(key, 0, REVOCATION_LIST_KEY_LENGTH); // unused key
+            continue;
+        }
+
+        if (it == 0)
+        {
+            memcpy(&div_result, &inverse, sizeof(mclBnFr)); // div_result = 1 / d(0)
+        }
+        else
+        {
+            mclBnFr_mul(&div_result, &inverse, &products[task->first + it - 1]); // div_result = 1 / d(it)
+            mclBnFr_mul(&inverse, &inverse, &denominator); // inverse = 1 / (d(0)·...·d(it - 1))
+        }
+
+        fixed_base_mul(&pseudonym, &task->sys_parameters->G1, task->sys_parameters->G1_table, &div_result); // pseudonym = G1 * div_result
+        r = rl_compute_key(key, pseudonym);
+        if (r < 0)
+        {
+            task->result = -1;
+            return;
+        }
+    }
+}
+
+/**
+ * Computes the revocation list of the epoch, i.e. the pseudonyms
+ * C = (1 / i - mr + H(epoch)) * G1 of all the revoked users, where i is the
+ * revocation handler of the j randomizers selected for the epoch.
+ * The revoked users are split among several threads, each of them inverts
+ * its denominators at once and multiplies using the fixed-base table of G1.
+ *
+ * @param sys_parameters the system parameters
+ * @param parameters the revocation authority parameters
+ * @param indices the indices of the j randomizers of the epoch
+ * @param revoked_mr the mr of the revoked users
+ * @param num_revoked the number of revoked users
+ * @param epoch the epoch
+ * @param epoch_length the length of the epoch
+ * @param num_threads the number of threads (0 - one per core)
+ * @param revocation_list the revocation list of the epoch
+ * @return 0 if success else -1
+ */
+int ra_revoked_pseudonyms(system_par_t sys_parameters, revocation_authority_par_t parameters, const size_t *indices, const mclBnFr *revoked_mr,
+                          size_t num_revoked, const void *epoch, size_t epoch_length, size_t num_threads, revocation_list_t *revocation_list)
+{
+    revocation_authority_pseudonyms_task_t *contexts = NULL;
+    thread_pool_task_t *tasks = NULL;
+    thread_pool_t pool;
+
+    mclBnFr *products = NULL;
+    uint8_t *keys = NULL;
+
+    mclBnFr i, mul_result;
+    mclBnFr fr_hash; // H(epoch)
+
+    /*
+     * IMPORTANT!
+     *
+     * We are using SHA1 on the Smart Card. However, because the length
+     * of the SHA1 hash is 20 and the size of Fr is 32, it is necessary
+     * to enlarge 12 characters and fill them with 0's.
+     */
+    unsigned char hash[SHA_DIGEST_PADDING + SHA_DIGEST_LENGTH] = {0};
+
+    size_t chunk;
+    size_t it;
+    int r;
+
+    if (indices == NULL || (revoked_mr == NULL && num_revoked > 0) || epoch == NULL || epoch_length != EPOCH_LENGTH || revocation_list == NULL)
+    {
+        return -1;
+    }
+
+    for (it = 0; it < parameters.j; it++)
+    {
+        if (indices[it] >= parameters.k)
+        {
+            return -1;
+        }
+    }
+
+    r = rl_create(revocation_list, num_revoked, epoch, epoch_length);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    if (num_revoked == 0)
+    {
+        return 0;
+    }
+
+    // H(epoch)
+    SHA1(epoch, epoch_length, &hash[SHA_DIGEST_PADDING]);
+    mcl_bytes_to_Fr(&fr_hash, hash, EC_SIZE);
+    r = mclBnFr_isValid(&fr_hash);
+    if (r != 1)
+    {
+        rl_destroy(revocation_list);
+        return -1;
+    }
+
+    /// i = alpha1·e1 + ... + alphaj·ej
+    mclBnFr_clear(&i);
+    for (it = 0; it < parameters.j; it++)
+    {
+        mclBnFr_mul(&mul_result, &parameters.alphas[it], &parameters.randomizers[indices[it]]); // mul_result = alpha(it)·e(it)
+        mclBnFr_add(&i, &i, &mul_result); // i = i + mul_result
+    }
+
+    num_threads = thread_pool_get_num_threads(num_threads, num_revoked);
+
+    products = malloc(num_revoked * sizeof(mclBnFr));
+    keys = malloc(num_revoked * REVOCATION_LIST_KEY_LENGTH);
+    contexts = malloc(num_threads * sizeof(revocation_authority_pseudonyms_task_t));
+    tasks = malloc(num_threads * sizeof(thread_pool_task_t));
+    if (products == NULL || keys == NULL || contexts == NULL || tasks == NULL)
+    {
+        r = -1;
+        goto cleanup;
+    }
+
+    /// pseudonyms (the calling thread computes too)
+    r = thread_pool_init(&pool, num_threads - 1);
+    if (r < 0)
+    {
+        goto cleanup;
+    }
+
+    chunk = (num_revoked + num_threads - 1) / num_threads;
+    for (it = 0; it < num_threads; it++)
+    {
+        contexts[it].sys_parameters = &sys_parameters;
+        contexts[it].revoked_mr = revoked_mr;
+        mclBnFr_add(&contexts[it].i_hash, &i, &fr_hash); // i_hash = i + H(epoch)
+        contexts[it].first = it * chunk < num_revoked ? it * chunk : num_revoked;
+        contexts[it].last = (it + 1) * chunk < num_revoked ? (it + 1) * chunk : num_revoked;
+        contexts[it].products = products;
+        contexts[it].keys = keys;
+
+        tasks[it].function = ra_revoked_pseudonyms_task;
+        tasks[it].argument = &contexts[it];
+    }
+
+    r = thread_pool_run(&pool, tasks, num_threads);
+    thread_pool_destroy(&pool);
+    for (it = 0; it < num_threads && r == 0; it++)
+    {
+        r = contexts[it].result;
+    }
+    if (r < 0)
+    {
+        goto cleanup;
+    }
+
+    /// revocation list RL of the epoch
+    for (it = 0; it < num_revoked; it++)
+    {
+        if ((keys[it * REVOCATION_LIST_KEY_LENGTH] & REVOCATION_LIST_KEY_USED) == 0)
+        {
+            continue;
+        }
+
+        r = rl_add_key(revocation_list, &keys[it * REVOCATION_LIST_KEY_LENGTH]);
+        if (r < 0)
+        {
+            goto cleanup;
+        }
+    }
+
+cleanup:
+    if (r < 0)
+    {
+        rl_destroy(revocation_list);
+    }
+
+    free(products);
+    free(keys);
+    free(contexts);
+    free(tasks);
+
+    return r;
+}
+
+/**
+ * Revokes a user: marks the user as revoked in the revocation database and
+ * appends the pseudonym of the user for the epoch to the delta log, so the
+ * verifiers add it to their revocation list without a full republish.
+ *
+ * @param sys_parameters the system parameters
+ * @param parameters the revocation authority parameters
+ * @param indices the indices of the j randomizers of the epoch
+ * @param database the revocation database
+ * @param ue_identifier the identifier of the revoked user
+ * @param epoch the epoch
+ * @param epoch_length the length of the epoch
+ * @param delta the delta log
+ * @return 0 if success else -1
+ */
+int ra_revoke(system_par_t sys_parameters, revocation_authority_par_t parameters, const size_t *indices, revocation_database_t *database,
+              user_identifier_t ue_identifier, const void *epoch, size_t epoch_length, revocation_delta_t *delta)
+{
+    revocation_list_t revocation_list;
+    mclBnFr mr;
+
+    int r;
+
+    if (database == NULL || delta == NULL)
+    {
+        return -1;
+    }
+
+    /// revocation database RD
+    r = rd_revoke(database, ue_identifier, &mr);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    /// pseudonym of the user for the epoch (a delta of one key)
+    r = ra_revoked_pseudonyms(sys_parameters, parameters, indices, &mr, 1, epoch, epoch_length, 1, &revocation_list);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    r = rl_delta_append(delta, &revocation_list, 0);
+    rl_destroy(&revocation_list);
+
+    return r;
+}
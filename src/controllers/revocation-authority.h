@@ -29,6 +29,8 @@ extern "C"
 #include <stddef.h>
 #include <assert.h>
 
+#include <unistd.h>
+
 #include <mcl/bn_c256.h>
 #include <openssl/sha.h>
 
@@ -38,29 +40,96 @@ extern "C"
 #include "models/user.h"
 #include "system.h"
 
+#include "helpers/fixed_base_helper.h"
 #include "helpers/mcl_helper.h"
+#include "revocation/database.h"
+#include "revocation/delta.h"
+#include "revocation/list.h"
+#include "thread/pool.h"
 
 /**
  * Outputs the revocation authority parameters, generates the
- * private key and computes the public key.
+ * private key and computes the public key. The k randomizers are
+ * signed by several threads, each of them inverts its denominators
+ * at once and multiplies using the fixed-base table of G1.
  *
  * @param sys_parameters the system parameters
+ * @param k the number of randomizers (0 - REVOCATION_AUTHORITY_VALUE_K)
+ * @param j the number of randomizers selected by the user (0 - REVOCATION_AUTHORITY_VALUE_J)
+ * @param num_threads the number of threads (0 - one per core)
  * @param parameters the revocation authority parameters
  * @param keys the revocation authority private and public keys
  * @return 0 if success else -1
  */
-extern int ra_setup(system_par_t sys_parameters, revocation_authority_par_t *parameters, revocation_authority_keys_t *keys);
+extern int ra_setup(system_par_t sys_parameters, size_t k, size_t j, size_t num_threads, revocation_authority_par_t *parameters, revocation_authority_keys_t *keys);
+
+/**
+ * Precomputes the fixed-base tables of the revocation authority bases
+ * h_j, used by the user and the verifier to compute t_sig.
+ *
+ * @param parameters the revocation authority parameters
+ * @return 0 if success else -1
+ */
+extern int ra_precompute(revocation_authority_par_t *parameters);
+
+/**
+ * Releases the resources allocated by the revocation authority setup
+ * and precomputation.
+ *
+ * @param parameters the revocation authority parameters
+ */
+extern void ra_cleanup(revocation_authority_par_t *parameters);
 
 /**
  * Computes the signature of the user identifier using the private key.
  *
  * @param sys_parameters the system parameters
  * @param private_key the revocation authority private key
+ * @param database the revocation database where the user is stored (can be NULL)
  * @param ue_identifier the user identifier
  * @param signature the signature of the user identifier
  * @return 0 if success else -1
  */
-extern int ra_mac(system_par_t sys_parameters, revocation_authority_private_key_t private_key, user_identifier_t ue_identifier, revocation_authority_signature_t *signature);
+extern int ra_mac(system_par_t sys_parameters, revocation_authority_private_key_t private_key, revocation_database_t *database, user_identifier_t ue_identifier, revocation_authority_signature_t *signature);
+
+/**
+ * Computes the revocation list of the epoch, i.e. the pseudonyms
+ * C = (1 / i - mr + H(epoch)) * G1 of all the revoked users, where i is the
+ * revocation handler of the j randomizers selected for the epoch.
+ * The revoked users are split among several threads, each of them inverts
+ * its denominators at once and multiplies using the fixed-base table of G1.
+ *
+ * @param sys_parameters the system parameters
+ * @param parameters the revocation authority parameters
+ * @param indices the indices of the j randomizers of the epoch
+ * @param revoked_mr the mr of the revoked users
+ * @param num_revoked the number of revoked users
+ * @param epoch the epoch
+ * @param epoch_length the length of the epoch
+ * @param num_threads the number of threads (0 - one per core)
+ * @param revocation_list the revocation list of the epoch
+ * @return 0 if success else -1
+ */
+extern int ra_revoked_pseudonyms(system_par_t sys_parameters, revocation_authority_par_t parameters, const size_t *indices, const mclBnFr *revoked_mr,
+                                 size_t num_revoked, const void *epoch, size_t epoch_length, size_t num_threads, revocation_list_t *revocation_list);
+
+/**
+ * Revokes a user: marks the user as revoked in the revocation database and
+ * appends the pseudonym of the user for the epoch to the delta log, so the
+ * verifiers add it to their revocation list without a full republish.
+ *
+ * @param sys_parameters the system parameters
+ * @param parameters the revocation authority parameters
+ * @param indices the indices of the j randomizers of the epoch
+ * @param database the revocation database
+ * @param ue_identifier the identifier of the revoked user
+ * @param epoch the epoch
+ * @param epoch_length the length of the epoch
+ * @param delta the delta log
+ * @return 0 if success else -1
+ */
+extern int ra_revoke(system_par_t sys_parameters, revocation_authority_par_t parameters, const size_t *indices, revocation_database_t *database,
+                     user_identifier_t ue_identifier, const void *epoch, size_t epoch_length, revocation_delta_t *delta);
 
 #ifdef __cplusplus
 }
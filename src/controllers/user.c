@@ -20,6 +20,10 @@
 
 #include "user.h"
 
+// pseudonyms of the current epoch, shared by all the proofs (and the token pool threads)
+static user_pseudonym_cache_t pseudonym_cache;
+static pthread_mutex_t pseudonym_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 /**
  * Gets the user identifier using the specified reader.
  *
@@ -105,66 +109,23 @@ int ue_set_issuer_signatures(reader_t reader, issuer_par_t ie_parameters, issuer
 }
 
 /**
- * Computes the proof of knowledge of the user attributes and discloses those requested
- * by the verifier.
+ * Gets the pseudonym C = (1 / i - mr + H(epoch)) * G1 from the pseudonym cache,
+ * computing it if it is not there. The cache is flushed when the epoch changes.
  *
- * @param reader the reader to be used
  * @param sys_parameters the system parameters
- * @param ra_parameters the revocation authority parameters
- * @param ra_signature the signature of the user identifier
- * @param ie_signature the issuer signature
- * @param I the first pseudo-random value used to select the first randomizer
- * @param II the second pseudo-random value used to select the second randomizer
- * @param nonce the nonce generated by the verifier
- * @param nonce_length the length of the nonce
+ * @param i the revocation handler i = alpha1·e1 + ... + alphaj·ej
+ * @param mr the revocation attribute of the user
  * @param epoch the epoch generated by the verifier
  * @param epoch_length the length of the epoch
- * @param attributes the user attributes
- * @param num_disclosed_attributes the number of attributes the verifier wants to disclose
- * @param credential the credential struct to be computed by the user
- * @param pi the pi struct to be computed by the user
+ * @param pseudonym the pseudonym
  * @return 0 if success else -1
  */
-int ue_compute_proof_of_knowledge(reader_t reader, system_par_t sys_parameters, revocation_authority_par_t ra_parameters, revocation_authority_signature_t ra_signature,
-                                  issuer_signature_t ie_signature, uint8_t I, uint8_t II, const void *nonce, size_t nonce_length, const void *epoch, size_t epoch_length,
-                                  user_attributes_t *attributes, size_t num_disclosed_attributes, user_credential_t *credential, user_pi_t *pi)
+static int ue_get_pseudonym(system_par_t sys_parameters, const mclBnFr *i, const mclBnFr *mr, const void *epoch, size_t epoch_length, mclBnG1 *pseudonym)
 {
-    mclBnFr number_one, attribute;
-
-    mclBnFr add_result, mul_result;
-    mclBnFr sub_result, div_result;
-    mclBnG1 add_result_g1, mul_result_g1;
-
-    mclBnFr i;
-
-    mclBnFr e1, e2; // e1, e2
-    mclBnFr neg_e1, neg_e2; // -e1, -e2
-    mclBnG1 sigma_e1, sigma_e2; // sigma_e1, sigma_e2
+    struct pseudonym_cache_entry_t *entry;
 
-    mclBnFr rho, rho_v, rho_i, rho_mr;
-    mclBnFr rho_e1, rho_e2;
-    mclBnFr rho_mz[USER_MAX_NUM_ATTRIBUTES]; // rho non-disclosed attributes
-
-    mclBnG1 t_verify, t_revoke;
-    mclBnG1 t_sig, t_sig1, t_sig2;
-
-    mclBnFr fr_hash;
-
-    /*
-     * IMPORTANT!
-     *
-     * The attributes are disclosed from the end to the beginning,
-     * i.e., if a user has 4 attributes and the verifier wants to
-     * disclose 2, the disclosed attributes will be the 3rd and 4th,
-     * keeping hidden the 1st and 2nd.
-     *
-     * +---+---+---+---+
-     * | 1 | 2 | 3 | 4 |
-     * +---+---+---+---+
-     * | H | H | D | D |
-     * +---+---+---+---+
-     */
-    size_t num_non_disclosed_attributes;
+    mclBnFr number_one;
+    mclBnFr add_result, sub_result, div_result;
 
     /*
      * IMPORTANT!
@@ -174,120 +135,215 @@ int ue_compute_proof_of_knowledge(reader_t reader, system_par_t sys_parameters,
      * to enlarge 12 characters and fill them with 0's.
      */
     unsigned char hash[SHA_DIGEST_PADDING + SHA_DIGEST_LENGTH] = {0};
-    SHA_CTX ctx;
 
     size_t it;
     int r;
 
-    if (nonce == NULL || nonce_length == 0 || epoch == NULL || epoch_length == 0 || attributes == NULL || pi == NULL || credential == NULL)
+    if (epoch_length != EPOCH_LENGTH)
     {
         return -1;
     }
 
-    if (attributes->num_attributes == 0 || attributes->num_attributes > USER_MAX_NUM_ATTRIBUTES || attributes->num_attributes < num_disclosed_attributes)
+    pthread_mutex_lock(&pseudonym_cache_mutex);
+
+    // new epoch, the cached pseudonyms are no longer valid
+    if (pseudonym_cache.valid == false || memcmp(pseudonym_cache.epoch, epoch, EPOCH_LENGTH) != 0)
+    {
+        memset(&pseudonym_cache, 0, sizeof(user_pseudonym_cache_t));
+
+        // H(epoch)
+        SHA1(epoch, epoch_length, &hash[SHA_DIGEST_PADDING]);
+
+        /*
+         * IMPORTANT!
+         *
+         * We are using SHA1 on the Smart Card. However, because the length
+         * of the SHA1 hash is 20 and the size of Fr is 32, it is necessary
+         * to enlarge 12 characters and fill them with 0's.
+         */
+        mcl_bytes_to_Fr(&pseudonym_cache.epoch_hash, hash, EC_SIZE);
+        r = mclBnFr_isValid(&pseudonym_cache.epoch_hash);
+        if (r != 1)
+        {
+            pthread_mutex_unlock(&pseudonym_cache_mutex);
+            return -1;
+        }
+
+        memcpy(pseudonym_cache.epoch, epoch, EPOCH_LENGTH);
+        pseudonym_cache.valid = true;
+    }
+
+    // credential (mr) and randomizer pair (i) already used in this epoch
+    for (it = 0; it < pseudonym_cache.num_entries; it++)
     {
+        entry = &pseudonym_cache.entries[it];
+        if (mclBnFr_isEqual(&entry->mr, mr) == 1 && mclBnFr_isEqual(&entry->i, i) == 1)
+        {
+            memcpy(pseudonym, &entry->pseudonym, sizeof(mclBnG1));
+            pthread_mutex_unlock(&pseudonym_cache_mutex);
+            return 0;
+        }
+    }
+
+    // set 1 to Fr data type
+    mclBnFr_setInt32(&number_one, 1);
+
+    /// C = (1 / i - mr + H(epoch)) * G1
+    mclBnFr_sub(&sub_result, i, mr); // sub_result = i - mr
+    mclBnFr_add(&add_result, &sub_result, &pseudonym_cache.epoch_hash); // add_result = sub_result + H(epoch)
+    mclBnFr_div(&div_result, &number_one, &add_result); // div_result = 1 / sub_result
+    fixed_base_mul(pseudonym, &sys_parameters.G1, sys_parameters.G1_table, &div_result); // pseudonym = G1 * div_result
+    mclBnG1_normalize(pseudonym, pseudonym);
+    r = mclBnG1_isValid(pseudonym);
+    if (r != 1)
+    {
+        pthread_mutex_unlock(&pseudonym_cache_mutex);
         return -1;
     }
 
-    // e1, e2
-    memcpy(&e1, &ra_parameters.randomizers[I], sizeof(mclBnFr));
-    memcpy(&e2, &ra_parameters.randomizers[II], sizeof(mclBnFr));
-    // sigma_e1, sigma_e2
-    memcpy(&sigma_e1, &ra_parameters.randomizers_sigma[I], sizeof(mclBnG1));
-    memcpy(&sigma_e2, &ra_parameters.randomizers_sigma[II], sizeof(mclBnG1));
+    // replace the oldest entry when the cache is full
+    entry = &pseudonym_cache.entries[pseudonym_cache.next_entry];
+    memcpy(&entry->mr, mr, sizeof(mclBnFr));
+    memcpy(&entry->i, i, sizeof(mclBnFr));
+    memcpy(&entry->pseudonym, pseudonym, sizeof(mclBnG1));
+    pseudonym_cache.next_entry = (pseudonym_cache.next_entry + 1) % USER_PSEUDONYM_CACHE_SIZE;
+    if (pseudonym_cache.num_entries < USER_PSEUDONYM_CACHE_SIZE)
+    {
+        pseudonym_cache.num_entries++;
+    }
 
-    /// disclose attributes
-    num_non_disclosed_attributes = attributes->num_attributes - num_disclosed_attributes;
+    pthread_mutex_unlock(&pseudonym_cache_mutex);
 
-    /*
-     * IMPORTANT!
-     *
-     * The attributes are disclosed from the end to the beginning,
-     * i.e., if a user has 4 attributes and the verifier wants to
-     * disclose 2, the disclosed attributes will be the 3rd and 4th,
-     * keeping hidden the 1st and 2nd.
-     *
-     * +---+---+---+---+
-     * | 1 | 2 | 3 | 4 |
-     * +---+---+---+---+
-     * | H | H | D | D |
-     * +---+---+---+---+
-     */
-    for (it = num_non_disclosed_attributes; it < attributes->num_attributes; it++)
+    return 0;
+}
+
+/**
+ * Flushes the pseudonym cache (e.g. when the credential is removed).
+ */
+void ue_flush_pseudonym_cache(void)
+{
+    pthread_mutex_lock(&pseudonym_cache_mutex);
+    memset(&pseudonym_cache, 0, sizeof(user_pseudonym_cache_t));
+    pthread_mutex_unlock(&pseudonym_cache_mutex);
+}
+
+/**
+ * Computes the part of the proof of knowledge that does not depend on the nonce
+ * (offline step): the pseudonym, the randomized signatures, the rho values and
+ * the t values. The disclosed attributes must already be marked.
+ *
+ * @param sys_parameters the system parameters
+ * @param ra_parameters the revocation authority parameters
+ * @param ra_signature the signature of the user identifier
+ * @param ie_signature the issuer signature
+ * @param indices the indices of the j randomizers selected by the user
+ * @param epoch the epoch generated by the verifier
+ * @param epoch_length the length of the epoch
+ * @param attributes the user attributes
+ * @param token the token to be computed
+ * @return 0 if success else -1
+ */
+static int ue_compute_token(system_par_t sys_parameters, revocation_authority_par_t ra_parameters, revocation_authority_signature_t ra_signature,
+                            issuer_signature_t ie_signature, const size_t *indices, const void *epoch, size_t epoch_length,
+                            const user_attributes_t *attributes, user_token_t *token)
+{
+    mclBnFr add_result, mul_result;
+
+    mclBnFr neg_e; // -e(it)
+
+    mclBnG1 g1_rho, g1_rho_v; // G1·rho, G1·rho_v (shared by several values)
+
+    // linear combination of t_verify (revocation_sigma and the non-disclosed attribute sigmas)
+    mclBnG1 t_verify_points[USER_MAX_NUM_ATTRIBUTES + 1];
+    mclBnFr t_verify_scalars[USER_MAX_NUM_ATTRIBUTES + 1];
+    size_t t_verify_length;
+
+    // multi-scalar multiplication of t_sig (G1 and the bases h1...hj)
+    mclBnG1 t_sig_points[REVOCATION_AUTHORITY_MAX_J + 1];
+    mclBnFr t_sig_scalars[REVOCATION_AUTHORITY_MAX_J + 1];
+    fixed_base_table_t *t_sig_tables[REVOCATION_AUTHORITY_MAX_J + 1];
+
+    size_t it;
+    int r;
+
+    if (indices == NULL || epoch == NULL || epoch_length != EPOCH_LENGTH || attributes == NULL || token == NULL)
     {
-        attributes->attributes[it].disclosed = true;
+        return -1;
     }
 
-    /// i = alpha1·e1 + alpha2·e2
-    mclBnFr_mul(&i, &ra_parameters.alphas[0], &e1); // i = alpha1·e1
-    mclBnFr_mul(&mul_result, &ra_parameters.alphas[1], &e2); // mul_result = alpha2·e2
-    mclBnFr_add(&i, &i, &mul_result); // i = i + mul_result
-    r = mclBnFr_isValid(&i);
-    if (r != 1)
+    if (ra_parameters.j == 0 || ra_parameters.j > REVOCATION_AUTHORITY_MAX_J || ra_parameters.randomizers == NULL || ra_parameters.randomizers_sigma == NULL)
     {
         return -1;
     }
 
-    // H(epoch)
-    SHA1(epoch, epoch_length, &hash[SHA_DIGEST_PADDING]);
+    for (it = 0; it < ra_parameters.j; it++)
+    {
+        if (indices[it] >= ra_parameters.k)
+        {
+            return -1;
+        }
+    }
 
-    /*
-     * IMPORTANT!
-     *
-     * We are using SHA1 on the Smart Card. However, because the length
-     * of the SHA1 hash is 20 and the size of Fr is 32, it is necessary
-     * to enlarge 12 characters and fill them with 0's.
-     */
-    mcl_bytes_to_Fr(&fr_hash, hash, EC_SIZE);
-    r = mclBnFr_isValid(&fr_hash);
+    // epoch the token is bound to (the pseudonym depends on it)
+    memcpy(token->epoch, epoch, EPOCH_LENGTH);
+
+    // e1...ej
+    for (it = 0; it < ra_parameters.j; it++)
+    {
+        memcpy(&token->randomizers[it], &ra_parameters.randomizers[indices[it]], sizeof(mclBnFr));
+    }
+    token->credential.num_randomizers = ra_parameters.j;
+    // mr
+    memcpy(&token->mr, &ra_signature.mr, sizeof(mclBnFr));
+
+    /// i = alpha1·e1 + ... + alphaj·ej
+    mclBnFr_clear(&token->i);
+    for (it = 0; it < ra_parameters.j; it++)
+    {
+        mclBnFr_mul(&mul_result, &ra_parameters.alphas[it], &token->randomizers[it]); // mul_result = alpha(it)·e(it)
+        mclBnFr_add(&token->i, &token->i, &mul_result); // i = i + mul_result
+    }
+    r = mclBnFr_isValid(&token->i);
     if (r != 1)
     {
         return -1;
     }
 
-    // set 1 to Fr data type
-    mclBnFr_setInt32(&number_one, 1);
-
     /// C = (1 / i - mr + H(epoch)) * G1
-    mclBnFr_sub(&sub_result, &i, &ra_signature.mr); // sub_result = i - mr
-    mclBnFr_add(&add_result, &sub_result, &fr_hash); // add_result = sub_result + H(epoch)
-    mclBnFr_div(&div_result, &number_one, &add_result); // div_result = 1 / sub_result
-    mclBnG1_mul(&credential->pseudonym, &sys_parameters.G1, &div_result); // pseudonym = G1 * div_result
-    mclBnG1_normalize(&credential->pseudonym, &credential->pseudonym);
-    r = mclBnG1_isValid(&credential->pseudonym);
-    if (r != 1)
+    r = ue_get_pseudonym(sys_parameters, &token->i, &ra_signature.mr, epoch, epoch_length, &token->credential.pseudonym);
+    if (r < 0)
     {
         return -1;
     }
 
     /// rho random numbers
     // rho
-    mclBnFr_setByCSPRNG(&rho);
-    r = mclBnFr_isValid(&rho);
+    mclBnFr_setByCSPRNG(&token->rho);
+    r = mclBnFr_isValid(&token->rho);
     if (r != 1)
     {
         return -1;
     }
 
     // rho_v
-    mclBnFr_setByCSPRNG(&rho_v);
-    r = mclBnFr_isValid(&rho_v);
+    mclBnFr_setByCSPRNG(&token->rho_v);
+    r = mclBnFr_isValid(&token->rho_v);
     if (r != 1)
     {
         return -1;
     }
 
     // rho_i
-    mclBnFr_setByCSPRNG(&rho_i);
-    r = mclBnFr_isValid(&rho_i);
+    mclBnFr_setByCSPRNG(&token->rho_i);
+    r = mclBnFr_isValid(&token->rho_i);
     if (r != 1)
     {
         return -1;
     }
 
     // rho_mr
-    mclBnFr_setByCSPRNG(&rho_mr);
-    r = mclBnFr_isValid(&rho_mr);
+    mclBnFr_setByCSPRNG(&token->rho_mr);
+    r = mclBnFr_isValid(&token->rho_mr);
     if (r != 1)
     {
         return -1;
@@ -298,8 +354,8 @@ int ue_compute_proof_of_knowledge(reader_t reader, system_par_t sys_parameters,
     {
         if (attributes->attributes[it].disclosed == false)
         {
-            mclBnFr_setByCSPRNG(&rho_mz[it]);
-            r = mclBnFr_isValid(&rho_mz[it]);
+            mclBnFr_setByCSPRNG(&token->rho_mz[it]);
+            r = mclBnFr_isValid(&token->rho_mz[it]);
             if (r != 1)
             {
                 return -1;
@@ -307,173 +363,201 @@ int ue_compute_proof_of_knowledge(reader_t reader, system_par_t sys_parameters,
         }
     }
 
-    // rho_e1
-    mclBnFr_setByCSPRNG(&rho_e1);
-    r = mclBnFr_isValid(&rho_e1);
-    if (r != 1)
-    {
-        return -1;
-    }
-
-    // rho_e2
-    mclBnFr_setByCSPRNG(&rho_e2);
-    r = mclBnFr_isValid(&rho_e2);
-    if (r != 1)
+    // rho_e1...rho_ej
+    for (it = 0; it < ra_parameters.j; it++)
     {
-        return -1;
+        mclBnFr_setByCSPRNG(&token->rho_e[it]);
+        r = mclBnFr_isValid(&token->rho_e[it]);
+        if (r != 1)
+        {
+            return -1;
+        }
     }
 
     /// signatures
     // sigma_hat
-    mclBnG1_mul(&credential->sigma_hat, &ie_signature.sigma, &rho);
-    mclBnG1_normalize(&credential->sigma_hat, &credential->sigma_hat);
-    r = mclBnG1_isValid(&credential->sigma_hat);
+    mclBnG1_mul(&token->credential.sigma_hat, &ie_signature.sigma, &token->rho);
+    mclBnG1_normalize(&token->credential.sigma_hat, &token->credential.sigma_hat);
+    r = mclBnG1_isValid(&token->credential.sigma_hat);
     if (r != 1)
     {
         return -1;
     }
 
-    // sigma_hat_e1
-    mclBnG1_mul(&credential->sigma_hat_e1, &sigma_e1, &rho);
-    mclBnG1_normalize(&credential->sigma_hat_e1, &credential->sigma_hat_e1);
-    r = mclBnG1_isValid(&credential->sigma_hat_e1);
-    if (r != 1)
-    {
-        return -1;
-    }
-
-    // sigma_hat_e2
-    mclBnG1_mul(&credential->sigma_hat_e2, &sigma_e2, &rho);
-    mclBnG1_normalize(&credential->sigma_hat_e2, &credential->sigma_hat_e2);
-    r = mclBnG1_isValid(&credential->sigma_hat_e2);
-    if (r != 1)
+    // sigma_hat_e1...sigma_hat_ej
+    for (it = 0; it < ra_parameters.j; it++)
     {
-        return -1;
+        mclBnG1_mul(&token->credential.sigma_hat_e[it], &ra_parameters.randomizers_sigma[indices[it]], &token->rho);
+        mclBnG1_normalize(&token->credential.sigma_hat_e[it], &token->credential.sigma_hat_e[it]);
+        r = mclBnG1_isValid(&token->credential.sigma_hat_e[it]);
+        if (r != 1)
+        {
+            return -1;
+        }
     }
 
-    // sigma_minus_e1
-    mclBnFr_neg(&neg_e1, &e1); // neg_e1 = -e1
-    mclBnG1_mul(&credential->sigma_minus_e1, &credential->sigma_hat_e1, &neg_e1); // sigma_minus_e1 = sigma_hat_e1·neg_e1
-    mclBnG1_mul(&mul_result_g1, &sys_parameters.G1, &rho); // mul_result_g1 = G1·rho
-    mclBnG1_add(&credential->sigma_minus_e1, &credential->sigma_minus_e1, &mul_result_g1);  // sigma_minus_e1 = sigma_minus_e1 + mul_result_g1
-    mclBnG1_normalize(&credential->sigma_minus_e1, &credential->sigma_minus_e1);
-    r = mclBnG1_isValid(&credential->sigma_minus_e1);
-    if (r != 1)
-    {
-        return -1;
-    }
+    /// shared products
+    fixed_base_mul(&g1_rho, &sys_parameters.G1, sys_parameters.G1_table, &token->rho); // g1_rho = G1·rho
+    fixed_base_mul(&g1_rho_v, &sys_parameters.G1, sys_parameters.G1_table, &token->rho_v); // g1_rho_v = G1·rho_v
 
-    // sigma_minus_e2
-    mclBnFr_neg(&neg_e2, &e2); // neg_e2 = -e2
-    mclBnG1_mul(&credential->sigma_minus_e2, &credential->sigma_hat_e2, &neg_e2); // sigma_minus_e2 = sigma_hat_e2·neg_e2
-    mclBnG1_mul(&mul_result_g1, &sys_parameters.G1, &rho); // mul_result_g1 = G1·rho
-    mclBnG1_add(&credential->sigma_minus_e2, &credential->sigma_minus_e2, &mul_result_g1);  // sigma_minus_e2 = sigma_minus_e2 + mul_result_g1
-    mclBnG1_normalize(&credential->sigma_minus_e2, &credential->sigma_minus_e2);
-    r = mclBnG1_isValid(&credential->sigma_minus_e2);
-    if (r != 1)
+    // sigma_minus_e1...sigma_minus_ej
+    for (it = 0; it < ra_parameters.j; it++)
     {
-        return -1;
+        mclBnFr_neg(&neg_e, &token->randomizers[it]); // neg_e = -e(it)
+        mclBnG1_mul(&token->credential.sigma_minus_e[it], &token->credential.sigma_hat_e[it], &neg_e); // sigma_minus_e(it) = sigma_hat_e(it)·neg_e
+        mclBnG1_add(&token->credential.sigma_minus_e[it], &token->credential.sigma_minus_e[it], &g1_rho);  // sigma_minus_e(it) = sigma_minus_e(it) + G1·rho
+        mclBnG1_normalize(&token->credential.sigma_minus_e[it], &token->credential.sigma_minus_e[it]);
+        r = mclBnG1_isValid(&token->credential.sigma_minus_e[it]);
+        if (r != 1)
+        {
+            return -1;
+        }
     }
 
     /// t values
-    // t_verify
-    mclBnG1_mul(&t_verify, &sys_parameters.G1, &rho_v); // t_verify = G1·rho_v
-    mclBnFr_mul(&mul_result, &rho_mr, &rho); // mul_result = rho_mr·rho
-    mclBnG1_mul(&mul_result_g1, &ie_signature.revocation_sigma, &mul_result); // mul_result_g1 = revocation_sigma·mul_result
-    mclBnG1_add(&t_verify, &t_verify, &mul_result_g1); // t_verify = t_verify + mul_result_g1
-
-    mclBnG1_clear(&add_result_g1); // add_result_g1 = 0
+    // t_verify = G1·rho_v + revocation_sigma·(rho_mr·rho) + sum(sigma_x(it)·(rho_mz(it)·rho))
+    memcpy(&t_verify_points[0], &ie_signature.revocation_sigma, sizeof(mclBnG1));
+    mclBnFr_mul(&t_verify_scalars[0], &token->rho_mr, &token->rho); // t_verify_scalars[0] = rho_mr·rho
+    t_verify_length = 1;
     for (it = 0; it < attributes->num_attributes; it++)
     {
         if (attributes->attributes[it].disclosed == false)
         {
-            mclBnG1_mul(&mul_result_g1, &ie_signature.attribute_sigmas[it], &rho_mz[it]); // mul_result_g1 = sigma_x(it)·rho_mz(it)
-            mclBnG1_add(&add_result_g1, &add_result_g1, &mul_result_g1); // add_result_g1 = add_result_g1 + mul_result_g1
+            memcpy(&t_verify_points[t_verify_length], &ie_signature.attribute_sigmas[it], sizeof(mclBnG1));
+            mclBnFr_mul(&t_verify_scalars[t_verify_length], &token->rho_mz[it], &token->rho); // t_verify_scalars[n] = rho_mz(it)·rho
+            t_verify_length++;
         }
     }
-    mclBnG1_mul(&mul_result_g1, &add_result_g1, &rho); // mul_result_g1 = add_result_g1·rho
-    mclBnG1_add(&t_verify, &t_verify, &mul_result_g1); // t_verify = t_verify + mul_result_g1
-
-    mclBnG1_normalize(&t_verify, &t_verify);
-    r = mclBnG1_isValid(&t_verify);
+    mclBnG1_mulVec(&token->t_verify, t_verify_points, t_verify_scalars, t_verify_length); // t_verify = sum(t_verify_points·t_verify_scalars)
+    mclBnG1_add(&token->t_verify, &token->t_verify, &g1_rho_v); // t_verify = t_verify + G1·rho_v
+    mclBnG1_normalize(&token->t_verify, &token->t_verify);
+    r = mclBnG1_isValid(&token->t_verify);
     if (r != 1)
     {
         return -1;
     }
 
     // t_revoke
-    mclBnG1_mul(&t_revoke, &credential->pseudonym, &rho_mr); // t_revoke = C·rho_mr
-    mclBnG1_mul(&mul_result_g1, &credential->pseudonym, &rho_i); // mul_result_g1 = C·rho_i
-    mclBnG1_add(&t_revoke, &t_revoke, &mul_result_g1); // t_revoke = t_revoke + mul_result_g1
-    mclBnG1_normalize(&t_revoke, &t_revoke);
-    r = mclBnG1_isValid(&t_revoke);
+    mclBnFr_add(&add_result, &token->rho_mr, &token->rho_i); // add_result = rho_mr + rho_i
+    mclBnG1_mul(&token->t_revoke, &token->credential.pseudonym, &add_result); // t_revoke = C·add_result (C·rho_mr + C·rho_i)
+    mclBnG1_normalize(&token->t_revoke, &token->t_revoke);
+    r = mclBnG1_isValid(&token->t_revoke);
     if (r != 1)
     {
         return -1;
     }
 
-    // t_sig
-    mclBnG1_mul(&t_sig, &sys_parameters.G1, &rho_i); // t_sig = G1·rho_i
-    mclBnG1_mul(&mul_result_g1, &ra_parameters.alphas_mul[0], &rho_e1); // mul_result_g1 = h1·rho_e1
-    mclBnG1_add(&t_sig, &t_sig, &mul_result_g1); // t_sig = t_sig + mul_result_g1 (G1·rho_i + h1·rho_e1)
-    mclBnG1_mul(&mul_result_g1, &ra_parameters.alphas_mul[1], &rho_e2); // mul_result_g1 = h2·rho_e2
-    mclBnG1_add(&t_sig, &t_sig, &mul_result_g1); // t_sig = t_sig + mul_result_g1 (G1·rho_i + h1·rho_e1 + h2·rho_e2)
-    mclBnG1_normalize(&t_sig, &t_sig);
-    r = mclBnG1_isValid(&t_sig);
-    if (r != 1)
+    // t_sig = G1·rho_i + h1·rho_e1 + ... + hj·rho_ej
+    memcpy(&t_sig_points[0], &sys_parameters.G1, sizeof(mclBnG1));
+    memcpy(&t_sig_scalars[0], &token->rho_i, sizeof(mclBnFr));
+    t_sig_tables[0] = sys_parameters.G1_table;
+    for (it = 0; it < ra_parameters.j; it++)
+    {
+        memcpy(&t_sig_points[it + 1], &ra_parameters.alphas_mul[it], sizeof(mclBnG1));
+        memcpy(&t_sig_scalars[it + 1], &token->rho_e[it], sizeof(mclBnFr));
+        t_sig_tables[it + 1] = ra_parameters.alphas_mul_tables[it];
+    }
+    r = fixed_base_mul_vec(&token->t_sig, t_sig_points, t_sig_tables, t_sig_scalars, ra_parameters.j + 1);
+    if (r < 0)
     {
         return -1;
     }
-
-    // t_sig1
-    mclBnG1_mul(&t_sig1, &sys_parameters.G1, &rho_v); // t_sig1 = G1·rho_v
-    mclBnG1_mul(&mul_result_g1, &credential->sigma_hat_e1, &rho_e1); // mul_result_g1 = sigma_hat_e1·rho_e1
-    mclBnG1_add(&t_sig1, &t_sig1, &mul_result_g1); // t_sig1 = t_sig1 + mul_result_g1
-    mclBnG1_normalize(&t_sig1, &t_sig1);
-    r = mclBnG1_isValid(&t_sig1);
+    mclBnG1_normalize(&token->t_sig, &token->t_sig);
+    r = mclBnG1_isValid(&token->t_sig);
     if (r != 1)
     {
         return -1;
     }
 
-    // t_sig2
-    mclBnG1_mul(&t_sig2, &sys_parameters.G1, &rho_v); // t_sig2 = G1·rho_v
-    mclBnG1_mul(&mul_result_g1, &credential->sigma_hat_e2, &rho_e2); // mul_result_g1 = sigma_hat_e2·rho_e2
-    mclBnG1_add(&t_sig2, &t_sig2, &mul_result_g1); // t_sig2 = t_sig2 + mul_result_g1
-    mclBnG1_normalize(&t_sig2, &t_sig2);
-    r = mclBnG1_isValid(&t_sig2);
-    if (r != 1)
+    // t_sig1...t_sigj
+    for (it = 0; it < ra_parameters.j; it++)
     {
-        return -1;
+        mclBnG1_mul(&token->t_sig_e[it], &token->credential.sigma_hat_e[it], &token->rho_e[it]); // t_sig(it) = sigma_hat_e(it)·rho_e(it)
+        mclBnG1_add(&token->t_sig_e[it], &token->t_sig_e[it], &g1_rho_v); // t_sig(it) = t_sig(it) + G1·rho_v
+        mclBnG1_normalize(&token->t_sig_e[it], &token->t_sig_e[it]);
+        r = mclBnG1_isValid(&token->t_sig_e[it]);
+        if (r != 1)
+        {
+            return -1;
+        }
     }
 
+    return 0;
+}
+
+/**
+ * Computes the part of the proof of knowledge that depends on the nonce
+ * (online step): the challenge e and the s values.
+ *
+ * @param token the token computed by the offline step
+ * @param nonce the nonce generated by the verifier
+ * @param nonce_length the length of the nonce
+ * @param attributes the user attributes
+ * @param credential the credential struct to be computed by the user
+ * @param pi the pi struct to be computed by the user
+ * @return 0 if success else -1
+ */
+static int ue_compute_responses(const user_token_t *token, const void *nonce, size_t nonce_length, const user_attributes_t *attributes,
+                                user_credential_t *credential, user_pi_t *pi)
+{
+    mclBnFr attribute;
+    mclBnFr mul_result;
+
+    /*
+     * IMPORTANT!
+     *
+     * We are using SHA1 on the Smart Card. However, because the length
+     * of the SHA1 hash is 20 and the size of Fr is 32, it is necessary
+     * to enlarge 12 characters and fill them with 0's.
+     */
+    unsigned char hash[SHA_DIGEST_PADDING + SHA_DIGEST_LENGTH] = {0};
+    SHA_CTX ctx;
+
+    size_t it;
+    int r;
+
+    memcpy(credential, &token->credential, sizeof(user_credential_t));
+
 #ifndef NDEBUG
-    mcl_display_G1("t_verify", t_verify);
-    mcl_display_G1("t_revoke", t_revoke);
-    mcl_display_G1("t_sig", t_sig);
-    mcl_display_G1("t_sig1", t_sig1);
-    mcl_display_G1("t_sig2", t_sig2);
+    mcl_display_G1("t_verify", token->t_verify);
+    mcl_display_G1("t_revoke", token->t_revoke);
+    mcl_display_G1("t_sig", token->t_sig);
+    for (it = 0; it < credential->num_randomizers; it++)
+    {
+        mcl_display_G1("t_sig_e", token->t_sig_e[it]);
+    }
     mcl_display_G1("sigma_hat", credential->sigma_hat);
-    mcl_display_G1("sigma_hat_e1", credential->sigma_hat_e1);
-    mcl_display_G1("sigma_hat_e2", credential->sigma_hat_e2);
-    mcl_display_G1("sigma_minus_e1", credential->sigma_minus_e1);
-    mcl_display_G1("sigma_minus_e2", credential->sigma_minus_e2);
+    for (it = 0; it < credential->num_randomizers; it++)
+    {
+        mcl_display_G1("sigma_hat_e", credential->sigma_hat_e[it]);
+        mcl_display_G1("sigma_minus_e", credential->sigma_minus_e[it]);
+    }
     mcl_display_G1("pseudonym", credential->pseudonym);
 #endif
 
     /// e <-- H(...)
     SHA1_Init(&ctx);
-    SHA1_Update(&ctx, &t_verify, sizeof(mclBnG1));
-    SHA1_Update(&ctx, &t_revoke, sizeof(mclBnG1));
-    SHA1_Update(&ctx, &t_sig, sizeof(mclBnG1));
-    SHA1_Update(&ctx, &t_sig1, sizeof(mclBnG1));
-    SHA1_Update(&ctx, &t_sig2, sizeof(mclBnG1));
-    SHA1_Update(&ctx, &credential->sigma_hat, sizeof(mclBnG1));
-    SHA1_Update(&ctx, &credential->sigma_hat_e1, sizeof(mclBnG1));
-    SHA1_Update(&ctx, &credential->sigma_hat_e2, sizeof(mclBnG1));
-    SHA1_Update(&ctx, &credential->sigma_minus_e1, sizeof(mclBnG1));
-    SHA1_Update(&ctx, &credential->sigma_minus_e2, sizeof(mclBnG1));
-    SHA1_Update(&ctx, &credential->pseudonym, sizeof(mclBnG1));
+    r = digest_update_point(&ctx, token->t_verify);
+    r |= digest_update_point(&ctx, token->t_revoke);
+    r |= digest_update_point(&ctx, token->t_sig);
+    for (it = 0; it < credential->num_randomizers; it++)
+    {
+        r |= digest_update_point(&ctx, token->t_sig_e[it]);
+    }
+    r |= digest_update_point(&ctx, credential->sigma_hat);
+    for (it = 0; it < credential->num_randomizers; it++)
+    {
+        r |= digest_update_point(&ctx, credential->sigma_hat_e[it]);
+    }
+    for (it = 0; it < credential->num_randomizers; it++)
+    {
+        r |= digest_update_point(&ctx, credential->sigma_minus_e[it]);
+    }
+    r |= digest_update_point(&ctx, credential->pseudonym);
+    if (r != 0)
+    {
+        return -1;
+    }
     SHA1_Update(&ctx, nonce, nonce_length);
     SHA1_Final(&hash[SHA_DIGEST_PADDING], &ctx);
 
@@ -503,7 +587,7 @@ int ue_compute_proof_of_knowledge(reader_t reader, system_par_t sys_parameters,
         {
             mcl_bytes_to_Fr(&attribute, attributes->attributes[it].value, EC_SIZE);
             mclBnFr_mul(&mul_result, &pi->e, &attribute); // mul_result = e·mz(it)
-            mclBnFr_sub(&pi->s_mz[it], &rho_mz[it], &mul_result); // s_mz[it] = rho_mz[it] - mul_result
+            mclBnFr_sub(&pi->s_mz[it], &token->rho_mz[it], &mul_result); // s_mz[it] = rho_mz[it] - mul_result
             r = mclBnFr_isValid(&pi->s_mz[it]);
             if (r != 1)
             {
@@ -513,8 +597,8 @@ int ue_compute_proof_of_knowledge(reader_t reader, system_par_t sys_parameters,
     }
 
     // s_v
-    mclBnFr_mul(&mul_result, &pi->e, &rho); // mul_result = e·rho
-    mclBnFr_add(&pi->s_v, &rho_v, &mul_result); // s_v = rho_v + mul_result
+    mclBnFr_mul(&mul_result, &pi->e, &token->rho); // mul_result = e·rho
+    mclBnFr_add(&pi->s_v, &token->rho_v, &mul_result); // s_v = rho_v + mul_result
     r = mclBnFr_isValid(&pi->s_v);
     if (r != 1)
     {
@@ -522,8 +606,8 @@ int ue_compute_proof_of_knowledge(reader_t reader, system_par_t sys_parameters,
     }
 
     // s_mr
-    mclBnFr_mul(&mul_result, &pi->e, &ra_signature.mr); // mul_result = e·mr
-    mclBnFr_sub(&pi->s_mr, &rho_mr, &mul_result); // s_mr = rho_mr + mul_result
+    mclBnFr_mul(&mul_result, &pi->e, &token->mr); // mul_result = e·mr
+    mclBnFr_sub(&pi->s_mr, &token->rho_mr, &mul_result); // s_mr = rho_mr + mul_result
     r = mclBnFr_isValid(&pi->s_mr);
     if (r != 1)
     {
@@ -531,35 +615,339 @@ int ue_compute_proof_of_knowledge(reader_t reader, system_par_t sys_parameters,
     }
 
     // s_i
-    mclBnFr_mul(&mul_result, &pi->e, &i); // mul_result = e·i
-    mclBnFr_add(&pi->s_i, &rho_i, &mul_result); // s_i = rho_i + mul_result
+    mclBnFr_mul(&mul_result, &pi->e, &token->i); // mul_result = e·i
+    mclBnFr_add(&pi->s_i, &token->rho_i, &mul_result); // s_i = rho_i + mul_result
     r = mclBnFr_isValid(&pi->s_i);
     if (r != 1)
     {
         return -1;
     }
 
-    // s_e1
-    mclBnFr_mul(&mul_result, &pi->e, &e1); // mul_result = e·e1
-    mclBnFr_sub(&pi->s_e1, &rho_e1, &mul_result); // s_e1 = rho_e1 + mul_result
-    r = mclBnFr_isValid(&pi->s_e1);
-    if (r != 1)
+    // s_e1...s_ej
+    for (it = 0; it < credential->num_randomizers; it++)
+    {
+        mclBnFr_mul(&mul_result, &pi->e, &token->randomizers[it]); // mul_result = e·e(it)
+        mclBnFr_sub(&pi->s_e[it], &token->rho_e[it], &mul_result); // s_e(it) = rho_e(it) + mul_result
+        r = mclBnFr_isValid(&pi->s_e[it]);
+        if (r != 1)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Marks the attributes the verifier wants to disclose.
+ *
+ * @param attributes the user attributes
+ * @param num_disclosed_attributes the number of attributes the verifier wants to disclose
+ */
+static void ue_disclose_attributes(user_attributes_t *attributes, size_t num_disclosed_attributes)
+{
+    size_t num_non_disclosed_attributes;
+    size_t it;
+
+    num_non_disclosed_attributes = attributes->num_attributes - num_disclosed_attributes;
+
+    /*
+     * IMPORTANT!
+     *
+     * The attributes are disclosed from the end to the beginning,
+     * i.e., if a user has 4 attributes and the verifier wants to
+     * disclose 2, the disclosed attributes will be the 3rd and 4th,
+     * keeping hidden the 1st and 2nd.
+     *
+     * +---+---+---+---+
+     * | 1 | 2 | 3 | 4 |
+     * +---+---+---+---+
+     * | H | H | D | D |
+     * +---+---+---+---+
+     */
+    for (it = num_non_disclosed_attributes; it < attributes->num_attributes; it++)
+    {
+        attributes->attributes[it].disclosed = true;
+    }
+}
+
+/**
+ * Computes the proof of knowledge of the user attributes and discloses those requested
+ * by the verifier.
+ *
+ * @param reader the reader to be used
+ * @param sys_parameters the system parameters
+ * @param ra_parameters the revocation authority parameters
+ * @param ra_signature the signature of the user identifier
+ * @param ie_signature the issuer signature
+ * @param indices the indices of the j randomizers selected by the user
+ * @param nonce the nonce generated by the verifier
+ * @param nonce_length the length of the nonce
+ * @param epoch the epoch generated by the verifier
+ * @param epoch_length the length of the epoch
+ * @param attributes the user attributes
+ * @param num_disclosed_attributes the number of attributes the verifier wants to disclose
+ * @param credential the credential struct to be computed by the user
+ * @param pi the pi struct to be computed by the user
+ * @return 0 if success else -1
+ */
+int ue_compute_proof_of_knowledge(reader_t reader, system_par_t sys_parameters, revocation_authority_par_t ra_parameters, revocation_authority_signature_t ra_signature,
+                                  issuer_signature_t ie_signature, const size_t *indices, const void *nonce, size_t nonce_length, const void *epoch, size_t epoch_length,
+                                  user_attributes_t *attributes, size_t num_disclosed_attributes, user_credential_t *credential, user_pi_t *pi)
+{
+    user_token_t token;
+
+    int r;
+
+    if (nonce == NULL || nonce_length == 0 || epoch == NULL || epoch_length == 0 || attributes == NULL || pi == NULL || credential == NULL)
     {
         return -1;
     }
 
-    // s_e2
-    mclBnFr_mul(&mul_result, &pi->e, &e2); // mul_result = e·e2
-    mclBnFr_sub(&pi->s_e2, &rho_e2, &mul_result); // s_e2 = rho_e2 + mul_result
-    r = mclBnFr_isValid(&pi->s_e2);
-    if (r != 1)
+    if (attributes->num_attributes == 0 || attributes->num_attributes > USER_MAX_NUM_ATTRIBUTES || attributes->num_attributes < num_disclosed_attributes)
+    {
+        return -1;
+    }
+
+    /// disclose attributes
+    ue_disclose_attributes(attributes, num_disclosed_attributes);
+
+    /// nonce-independent values
+    r = ue_compute_token(sys_parameters, ra_parameters, ra_signature, ie_signature, indices, epoch, epoch_length, attributes, &token);
+    if (r == 0)
+    {
+        /// nonce-dependent values
+        r = ue_compute_responses(&token, nonce, nonce_length, attributes, credential, pi);
+    }
+
+    // the rho values must never be reused
+    memset(&token, 0, sizeof(user_token_t));
+
+    return r;
+}
+
+/**
+ * Background thread of the token pool, keeps the pool full of tokens.
+ *
+ * @param argument the token pool
+ * @return NULL
+ */
+static void *ue_token_pool_worker(void *argument)
+{
+    user_token_pool_t *pool = (user_token_pool_t *) argument;
+    user_token_t token;
+
+    size_t tail;
+    int r;
+
+    pthread_mutex_lock(&pool->mutex);
+    while (pool->running == true)
     {
+        if (pool->num_tokens == USER_TOKEN_POOL_SIZE)
+        {
+            pthread_cond_wait(&pool->not_full, &pool->mutex);
+            continue;
+        }
+        pthread_mutex_unlock(&pool->mutex);
+
+        // the parameters of the pool do not change while the thread is running
+        r = ue_compute_token(pool->sys_parameters, pool->ra_parameters, pool->ra_signature, pool->ie_signature, pool->indices,
+                             pool->epoch, sizeof(pool->epoch), &pool->attributes, &token);
+
+        pthread_mutex_lock(&pool->mutex);
+        if (r < 0)
+        {
+            pool->error = -1;
+            pool->running = false;
+            pthread_cond_broadcast(&pool->not_empty);
+            break;
+        }
+
+        tail = (pool->head + pool->num_tokens) % USER_TOKEN_POOL_SIZE;
+        memcpy(&pool->tokens[tail], &token, sizeof(user_token_t));
+        pool->num_tokens++;
+        pthread_cond_signal(&pool->not_empty);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    memset(&token, 0, sizeof(user_token_t));
+
+    return NULL;
+}
+
+/**
+ * Starts the token pool. A background thread precomputes the nonce-independent
+ * part of the proof of knowledge (presentation tokens) for the given epoch,
+ * randomizers and disclosed attributes.
+ *
+ * @param pool the token pool
+ * @param sys_parameters the system parameters
+ * @param ra_parameters the revocation authority parameters
+ * @param ra_signature the signature of the user identifier
+ * @param ie_signature the issuer signature
+ * @param indices the indices of the j randomizers selected by the user
+ * @param epoch the epoch the tokens are bound to
+ * @param epoch_length the length of the epoch
+ * @param attributes the user attributes
+ * @param num_disclosed_attributes the number of attributes the verifier wants to disclose
+ * @return 0 if success else -1
+ */
+int ue_token_pool_start(user_token_pool_t *pool, system_par_t sys_parameters, revocation_authority_par_t ra_parameters, revocation_authority_signature_t ra_signature,
+                        issuer_signature_t ie_signature, const size_t *indices, const void *epoch, size_t epoch_length,
+                        const user_attributes_t *attributes, size_t num_disclosed_attributes)
+{
+    int r;
+
+    if (pool == NULL || indices == NULL || ra_parameters.j > REVOCATION_AUTHORITY_MAX_J || epoch == NULL || epoch_length != EPOCH_LENGTH || attributes == NULL)
+    {
+        return -1;
+    }
+
+    if (attributes->num_attributes == 0 || attributes->num_attributes > USER_MAX_NUM_ATTRIBUTES || attributes->num_attributes < num_disclosed_attributes)
+    {
+        return -1;
+    }
+
+    memset(pool, 0, sizeof(user_token_pool_t));
+
+    memcpy(&pool->sys_parameters, &sys_parameters, sizeof(system_par_t));
+    memcpy(&pool->ra_parameters, &ra_parameters, sizeof(revocation_authority_par_t));
+    memcpy(&pool->ra_signature, &ra_signature, sizeof(revocation_authority_signature_t));
+    memcpy(&pool->ie_signature, &ie_signature, sizeof(issuer_signature_t));
+    memcpy(pool->epoch, epoch, EPOCH_LENGTH);
+    memcpy(pool->indices, indices, ra_parameters.j * sizeof(size_t));
+
+    memcpy(&pool->attributes, attributes, sizeof(user_attributes_t));
+    ue_disclose_attributes(&pool->attributes, num_disclosed_attributes);
+
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->not_empty, NULL);
+    pthread_cond_init(&pool->not_full, NULL);
+
+    pool->running = true;
+    r = pthread_create(&pool->thread, NULL, ue_token_pool_worker, pool);
+    if (r != 0)
+    {
+        pthread_cond_destroy(&pool->not_full);
+        pthread_cond_destroy(&pool->not_empty);
+        pthread_mutex_destroy(&pool->mutex);
+        memset(pool, 0, sizeof(user_token_pool_t));
         return -1;
     }
 
     return 0;
 }
 
+/**
+ * Gets the number of tokens available in the token pool.
+ *
+ * @param pool the token pool
+ * @return the number of tokens
+ */
+size_t ue_token_pool_available(user_token_pool_t *pool)
+{
+    size_t num_tokens;
+
+    if (pool == NULL)
+    {
+        return 0;
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+    num_tokens = pool->num_tokens;
+    pthread_mutex_unlock(&pool->mutex);
+
+    return num_tokens;
+}
+
+/**
+ * Computes the proof of knowledge of the user attributes consuming a token of the
+ * pool, only the challenge and the s values are computed (online step). Each token
+ * is used once. If the pool is empty, waits until a token is available.
+ *
+ * @param pool the token pool
+ * @param nonce the nonce generated by the verifier
+ * @param nonce_length the length of the nonce
+ * @param epoch the epoch generated by the verifier (must be the epoch of the pool)
+ * @param epoch_length the length of the epoch
+ * @param attributes the user attributes with the disclosed attributes marked
+ * @param credential the credential struct to be computed by the user
+ * @param pi the pi struct to be computed by the user
+ * @return 0 if success else -1
+ */
+int ue_token_pool_compute_proof_of_knowledge(user_token_pool_t *pool, const void *nonce, size_t nonce_length, const void *epoch, size_t epoch_length,
+                                             user_attributes_t *attributes, user_credential_t *credential, user_pi_t *pi)
+{
+    user_token_t token;
+
+    int r;
+
+    if (pool == NULL || nonce == NULL || nonce_length == 0 || epoch == NULL || epoch_length != EPOCH_LENGTH || attributes == NULL || credential == NULL || pi == NULL)
+    {
+        return -1;
+    }
+
+    // the tokens are bound to the epoch of the pool
+    if (memcmp(pool->epoch, epoch, EPOCH_LENGTH) != 0)
+    {
+        return -1;
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+    while (pool->num_tokens == 0 && pool->running == true)
+    {
+        pthread_cond_wait(&pool->not_empty, &pool->mutex);
+    }
+    if (pool->num_tokens == 0)
+    {
+        pthread_mutex_unlock(&pool->mutex);
+        return -1;
+    }
+
+    memcpy(&token, &pool->tokens[pool->head], sizeof(user_token_t));
+    memset(&pool->tokens[pool->head], 0, sizeof(user_token_t));
+    pool->head = (pool->head + 1) % USER_TOKEN_POOL_SIZE;
+    pool->num_tokens--;
+    pthread_cond_signal(&pool->not_full);
+    pthread_mutex_unlock(&pool->mutex);
+
+    memcpy(attributes, &pool->attributes, sizeof(user_attributes_t));
+
+    r = ue_compute_responses(&token, nonce, nonce_length, attributes, credential, pi);
+
+    // the rho values must never be reused
+    memset(&token, 0, sizeof(user_token_t));
+
+    return r;
+}
+
+/**
+ * Stops the token pool and discards the remaining tokens.
+ *
+ * @param pool the token pool
+ */
+void ue_token_pool_stop(user_token_pool_t *pool)
+{
+    if (pool == NULL)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->running = false;
+    pthread_cond_broadcast(&pool->not_full);
+    pthread_cond_broadcast(&pool->not_empty);
+    pthread_mutex_unlock(&pool->mutex);
+
+    pthread_join(pool->thread, NULL);
+
+    pthread_cond_destroy(&pool->not_full);
+    pthread_cond_destroy(&pool->not_empty);
+    pthread_mutex_destroy(&pool->mutex);
+
+    memset(pool, 0, sizeof(user_token_pool_t));
+}
+
 /**
  * Gets and displays the proof of knowledge of the user attributes.
  *
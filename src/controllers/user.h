@@ -31,6 +31,8 @@ extern "C"
 #include <stdint.h>
 #include <string.h>
 
+#include <pthread.h>
+
 #include <mcl/bn_c256.h>
 #include <openssl/sha.h>
 
@@ -41,6 +43,8 @@ extern "C"
 #include "models/user.h"
 #include "system.h"
 
+#include "helpers/fixed_base_helper.h"
+#include "helpers/hash_helper.h"
 #include "helpers/mcl_helper.h"
 
 #include "attributes.h"
@@ -105,8 +109,7 @@ extern int ue_set_issuer_signatures(reader_t reader, issuer_par_t ie_parameters,
  * @param ra_parameters the revocation authority parameters
  * @param ra_signature the signature of the user identifier
  * @param ie_signature the issuer signature
- * @param I the first pseudo-random value used to select the first randomizer
- * @param II the second pseudo-random value used to select the second randomizer
+ * @param indices the indices of the j randomizers selected by the user
  * @param nonce the nonce generated by the verifier
  * @param nonce_length the length of the nonce
  * @param epoch the epoch generated by the verifier
@@ -118,9 +121,68 @@ extern int ue_set_issuer_signatures(reader_t reader, issuer_par_t ie_parameters,
  * @return 0 if success else -1
  */
 extern int ue_compute_proof_of_knowledge(reader_t reader, system_par_t sys_parameters, revocation_authority_par_t ra_parameters, revocation_authority_signature_t ra_signature,
-                                         issuer_signature_t ie_signature, uint8_t I, uint8_t II, const void *nonce, size_t nonce_length, const void *epoch, size_t epoch_length,
+                                         issuer_signature_t ie_signature, const size_t *indices, const void *nonce, size_t nonce_length, const void *epoch, size_t epoch_length,
                                          user_attributes_t *attributes, size_t num_disclosed_attributes, user_credential_t *credential, user_pi_t *pi);
 
+/**
+ * Flushes the pseudonym cache (e.g. when the credential is removed).
+ */
+extern void ue_flush_pseudonym_cache(void);
+
+/**
+ * Starts the token pool. A background thread precomputes the nonce-independent
+ * part of the proof of knowledge (presentation tokens) for the given epoch,
+ * randomizers and disclosed attributes.
+ *
+ * @param pool the token pool
+ * @param sys_parameters the system parameters
+ * @param ra_parameters the revocation authority parameters
+ * @param ra_signature the signature of the user identifier
+ * @param ie_signature the issuer signature
+ * @param indices the indices of the j randomizers selected by the user
+ * @param epoch the epoch the tokens are bound to
+ * @param epoch_length the length of the epoch
+ * @param attributes the user attributes
+ * @param num_disclosed_attributes the number of attributes the verifier wants to disclose
+ * @return 0 if success else -1
+ */
+extern int ue_token_pool_start(user_token_pool_t *pool, system_par_t sys_parameters, revocation_authority_par_t ra_parameters, revocation_authority_signature_t ra_signature,
+                               issuer_signature_t ie_signature, const size_t *indices, const void *epoch, size_t epoch_length,
+                               const user_attributes_t *attributes, size_t num_disclosed_attributes);
+
+/**
+ * Gets the number of tokens available in the token pool.
+ *
+ * @param pool the token pool
+ * @return the number of tokens
+ */
+extern size_t ue_token_pool_available(user_token_pool_t *pool);
+
+/**
+ * Computes the proof of knowledge of the user attributes consuming a token of the
+ * pool, only the challenge and the s values are computed (online step). Each token
+ * is used once. If the pool is empty, waits until a token is available.
+ *
+ * @param pool the token pool
+ * @param nonce the nonce generated by the verifier
+ * @param nonce_length the length of the nonce
+ * @param epoch the epoch generated by the verifier (must be the epoch of the pool)
+ * @param epoch_length the length of the epoch
+ * @param attributes the user attributes with the disclosed attributes marked
+ * @param credential the credential struct to be computed by the user
+ * @param pi the pi struct to be computed by the user
+ * @return 0 if success else -1
+ */
+extern int ue_token_pool_compute_proof_of_knowledge(user_token_pool_t *pool, const void *nonce, size_t nonce_length, const void *epoch, size_t epoch_length,
+                                                    user_attributes_t *attributes, user_credential_t *credential, user_pi_t *pi);
+
+/**
+ * Stops the token pool and discards the remaining tokens.
+ *
+ * @param pool the token pool
+ */
+extern void ue_token_pool_stop(user_token_pool_t *pool);
+
 /**
  * Gets and displays the proof of knowledge of the user attributes.
  *
@@ -20,6 +20,222 @@
 
 #include "verifier.h"
 
+/**
+ * Precomputes the line coefficients of the G2 points used by the
+ * verifier (G2 and the revocation authority public key), so that
+ * they are not recomputed for every pairing. The other parameters are
+ * reset to their defaults (they are set after the setup).
+ *
+ * @param sys_parameters the system parameters
+ * @param ra_public_key the revocation authority public key
+ * @param parameters the verifier parameters
+ * @return 0 if success else -1
+ */
+int ve_setup(system_par_t sys_parameters, revocation_authority_public_key_t ra_public_key, verifier_par_t *parameters)
+{
+    int r;
+
+    if (parameters == NULL)
+    {
+        return -1;
+    }
+
+    memset(parameters, 0, sizeof(verifier_par_t));
+
+    r = mcl_G2_precompute_copy(&parameters->G2_precomputed, &sys_parameters.G2, sys_parameters.G2_precomputed);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    r = mcl_G2_precompute(&parameters->pk_precomputed, &ra_public_key.pk);
+    if (r < 0)
+    {
+        ve_cleanup(parameters);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * Releases the resources allocated by the verifier setup.
+ *
+ * @param parameters the verifier parameters
+ */
+void ve_cleanup(verifier_par_t *parameters)
+{
+    if (parameters == NULL)
+    {
+        return;
+    }
+
+    free(parameters->G2_precomputed);
+    parameters->G2_precomputed = NULL;
+
+    free(parameters->pk_precomputed);
+    parameters->pk_precomputed = NULL;
+
+    memset(&parameters->ra_private_key, 0, sizeof(revocation_authority_private_key_t));
+
+    if (parameters->thread_pool != NULL)
+    {
+        thread_pool_destroy(parameters->thread_pool);
+        free(parameters->thread_pool);
+        parameters->thread_pool = NULL;
+    }
+
+    if (parameters->revocation_snapshot != NULL)
+    {
+        rs_unregister_reader(parameters->revocation_snapshot, parameters->revocation_reader);
+        parameters->revocation_snapshot = NULL;
+    }
+}
+
+/**
+ * Sets the revocation authority private key and enables the designated verifier
+ * mode, in which the pairing equations are checked without pairings. It must only
+ * be used when the verifier and the revocation authority share the trust domain.
+ *
+ * @param parameters the verifier parameters
+ * @param ra_private_key the revocation authority private key
+ * @return 0 if success else -1
+ */
+int ve_set_designated_key(verifier_par_t *parameters, revocation_authority_private_key_t ra_private_key)
+{
+    int r;
+
+    if (parameters == NULL)
+    {
+        return -1;
+    }
+
+    r = mclBnFr_isValid(&ra_private_key.sk);
+    if (r != 1 || mclBnFr_isZero(&ra_private_key.sk) == 1)
+    {
+        return -1;
+    }
+
+    memcpy(&parameters->ra_private_key, &ra_private_key, sizeof(revocation_authority_private_key_t));
+    parameters->pairing_mode = VERIFIER_PAIRING_MODE_DESIGNATED;
+
+    return 0;
+}
+
+/**
+ * Starts the thread pool used to compute the independent parts of a single
+ * proof verification (the t values and the pairings) at the same time. The
+ * calling thread also computes, so num_threads + 1 tasks run in parallel.
+ *
+ * @param parameters the verifier parameters
+ * @param num_threads the number of threads of the pool
+ * @return 0 if success else -1
+ */
+int ve_set_parallel(verifier_par_t *parameters, size_t num_threads)
+{
+    int r;
+
+    if (parameters == NULL || parameters->thread_pool != NULL || num_threads == 0)
+    {
+        return -1;
+    }
+
+    parameters->thread_pool = malloc(sizeof(thread_pool_t));
+    if (parameters->thread_pool == NULL)
+    {
+        return -1;
+    }
+
+    r = thread_pool_init(parameters->thread_pool, num_threads);
+    if (r < 0)
+    {
+        free(parameters->thread_pool);
+        parameters->thread_pool = NULL;
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * Sets the revocation list checked by the verifier. The list is not copied, it
+ * must stay valid while it is used and its epoch must be the verified epoch.
+ *
+ * @param parameters the verifier parameters
+ * @param revocation_list the revocation list or NULL (no revocation check)
+ * @return 0 if success else -1
+ */
+int ve_set_revocation_list(verifier_par_t *parameters, const revocation_list_t *revocation_list)
+{
+    if (parameters == NULL)
+    {
+        return -1;
+    }
+
+    parameters->revocation_list = revocation_list;
+
+    return 0;
+}
+
+/**
+ * Sets the revocation list snapshot read by the verifier, the revocation authority
+ * can publish new lists (rs_publish) while the verifier is running. A reader slot
+ * is registered for the parameters, each thread must use its own parameters.
+ *
+ * @param parameters the verifier parameters
+ * @param revocation_snapshot the revocation list snapshot or NULL (no snapshot)
+ * @return 0 if success else -1
+ */
+int ve_set_revocation_snapshot(verifier_par_t *parameters, revocation_snapshot_t *revocation_snapshot)
+{
+    size_t reader;
+    int r;
+
+    if (parameters == NULL)
+    {
+        return -1;
+    }
+
+    if (revocation_snapshot != NULL)
+    {
+        r = rs_register_reader(revocation_snapshot, &reader);
+        if (r < 0)
+        {
+            return -1;
+        }
+    }
+
+    if (parameters->revocation_snapshot != NULL)
+    {
+        rs_unregister_reader(parameters->revocation_snapshot, parameters->revocation_reader);
+    }
+
+    parameters->revocation_snapshot = revocation_snapshot;
+    parameters->revocation_reader = revocation_snapshot != NULL ? reader : 0;
+
+    return 0;
+}
+
+/**
+ * Sets the revocation list shared by the verifier processes of the host
+ * (mapped read-only, see rl_shared_open).
+ *
+ * @param parameters the verifier parameters
+ * @param revocation_shared the shared revocation list or NULL (no shared list)
+ * @return 0 if success else -1
+ */
+int ve_set_revocation_shared(verifier_par_t *parameters, const revocation_shared_t *revocation_shared)
+{
+    if (parameters == NULL)
+    {
+        return -1;
+    }
+
+    parameters->revocation_shared = revocation_shared;
+
+    return 0;
+}
+
 /**
  * Generates a nonce and an epoch to be used in the proof of knowledge.
  *
@@ -60,70 +276,40 @@ int ve_generate_nonce_epoch(void *nonce, size_t nonce_length, void *epoch, size_
 }
 
 /**
- * Verifies the proof of knowledge of the user attributes.
+ * Computes the t values of the proof of knowledge term by term, as
+ * they are defined by the protocol (reference kernel).
  *
  * @param sys_parameters the system parameters
  * @param ra_parameters the revocation authority parameters
- * @param ra_public_key the revocation authority public key
  * @param ie_keys the issuer keys
- * @param nonce the nonce generated by the verifier
- * @param nonce_length the length of the nonce
- * @param epoch the epoch generated by the verifier
- * @param epoch_length the length of the epoch
+ * @param fr_hash the hash of the epoch H(epoch)
  * @param attributes the attributes disclosed by the user
  * @param ue_credential the credential struct computed by the user
  * @param ue_pi the pi struct computed by the user
- * @return 0 if success else -1
+ * @param t_values the t values
  */
-int ve_verify_proof_of_knowledge(system_par_t sys_parameters, revocation_authority_par_t ra_parameters, revocation_authority_public_key_t ra_public_key,
-                                 issuer_keys_t ie_keys, const void *nonce, size_t nonce_length, const void *epoch, size_t epoch_length,
-                                 user_attributes_t attributes, user_credential_t ue_credential, user_pi_t ue_pi)
+static void ve_compute_t_values_reference(system_par_t sys_parameters, revocation_authority_par_t ra_parameters, issuer_keys_t ie_keys, mclBnFr fr_hash,
+                                          user_attributes_t attributes, user_credential_t ue_credential, user_pi_t ue_pi, verifier_t_values_t *t_values)
 {
     mclBnFr attribute;
-    mclBnGT el, er;
 
     mclBnFr mul_result;
     mclBnG1 mul_result_g1;
 
-    mclBnFr e;
     mclBnFr neg_e;
-
-    mclBnG1 t_verify, t_revoke;
-    mclBnG1 t_sig, t_sig1, t_sig2;
-
-    mclBnFr fr_hash, fr_hash_neg; // H(epoch), -H(epoch)
-
-    // used to obtain the point data independently of the platform
-    char digest_platform_point[192] = {0};
-
-    /*
-     * IMPORTANT!
-     *
-     * We are using SHA1 on the Smart Card. However, because the length
-     * of the SHA1 hash is 20 and the size of Fr is 32, it is necessary
-     * to enlarge 12 characters and fill them with 0's.
-     */
-    unsigned char hash[SHA_DIGEST_PADDING + SHA_DIGEST_LENGTH] = {0};
-    SHA_CTX ctx;
+    mclBnFr fr_hash_neg; // -H(epoch)
 
     size_t it;
-    int r;
-
-    if (nonce == NULL || nonce_length == 0 || epoch == NULL || epoch_length == 0)
-    {
-        return -1;
-    }
 
-    /// t values
     // t_verify
     mclBnFr_neg(&neg_e, &ue_pi.e); // neg_e = -e
     mclBnFr_mul(&mul_result, &neg_e, &ie_keys.issuer_private_key.sk); // mul_result = -e·x(0)
-    mclBnG1_mul(&t_verify, &ue_credential.sigma_hat, &mul_result); // t_verify = sigma_hat·mul_result
-    mclBnG1_mul(&mul_result_g1, &sys_parameters.G1, &ue_pi.s_v); // mul_result_g1 = G1·s_v
-    mclBnG1_add(&t_verify, &t_verify, &mul_result_g1); // t_verify = t_verify + mul_result_g1
+    mclBnG1_mul(&t_values->t_verify, &ue_credential.sigma_hat, &mul_result); // t_verify = sigma_hat·mul_result
+    fixed_base_mul(&mul_result_g1, &sys_parameters.G1, sys_parameters.G1_table, &ue_pi.s_v); // mul_result_g1 = G1·s_v
+    mclBnG1_add(&t_values->t_verify, &t_values->t_verify, &mul_result_g1); // t_verify = t_verify + mul_result_g1
     mclBnFr_mul(&mul_result, &ie_keys.revocation_private_key.sk, &ue_pi.s_mr); // mul_result = x(r)·s_mr
     mclBnG1_mul(&mul_result_g1, &ue_credential.sigma_hat, &mul_result); // mul_result_g1 = sigma_hat·mul_result
-    mclBnG1_add(&t_verify, &t_verify, &mul_result_g1); // t_verify = t_verify + mul_result_g1
+    mclBnG1_add(&t_values->t_verify, &t_values->t_verify, &mul_result_g1); // t_verify = t_verify + mul_result_g1
     // product of non-disclosed attributes
     for (it = 0; it < attributes.num_attributes; it++)
     {
@@ -131,7 +317,7 @@ int ve_verify_proof_of_knowledge(system_par_t sys_parameters, revocation_authori
         {
             mclBnFr_mul(&mul_result, &ie_keys.attribute_private_keys[it].sk, &ue_pi.s_mz[it]); // mul_result = x(it)·s_mz(it)
             mclBnG1_mul(&mul_result_g1, &ue_credential.sigma_hat, &mul_result); // mul_result_g1 = sigma_hat·mul_result
-            mclBnG1_add(&t_verify, &t_verify, &mul_result_g1); // t_verify = t_verify + mul_result_g1
+            mclBnG1_add(&t_values->t_verify, &t_values->t_verify, &mul_result_g1); // t_verify = t_verify + mul_result_g1
         }
     }
     // product of disclosed attributes
@@ -143,168 +329,924 @@ int ve_verify_proof_of_knowledge(system_par_t sys_parameters, revocation_authori
             mclBnFr_mul(&mul_result, &neg_e, &ie_keys.attribute_private_keys[it].sk); // mul_result = -e·x(it)
             mclBnFr_mul(&mul_result, &mul_result, &attribute); // mul_result = mul_result·mz
             mclBnG1_mul(&mul_result_g1, &ue_credential.sigma_hat, &mul_result); // mul_result_g1 = sigma_hat·mul_result
-            mclBnG1_add(&t_verify, &t_verify, &mul_result_g1); // t_verify = t_verify + mul_result_g1
+            mclBnG1_add(&t_values->t_verify, &t_values->t_verify, &mul_result_g1); // t_verify = t_verify + mul_result_g1
         }
     }
-    mclBnG1_normalize(&t_verify, &t_verify);
-    r = mclBnG1_isValid(&t_verify);
-    if (r != 1)
-    {
-        return -1;
-    }
-
-    // H(epoch)
-    SHA1(epoch, epoch_length, &hash[SHA_DIGEST_PADDING]);
 
-    /*
-     * IMPORTANT!
-     *
-     * We are using SHA1 on the Smart Card. However, because the length
-     * of the SHA1 hash is 20 and the size of Fr is 32, it is necessary
-     * to enlarge 12 characters and fill them with 0's.
-     */
-    mcl_bytes_to_Fr(&fr_hash, hash, EC_SIZE);
-    r = mclBnFr_isValid(&fr_hash);
-    if (r != 1)
-    {
-        return -1;
-    }
     // -H(epoch)
     mclBnFr_neg(&fr_hash_neg, &fr_hash);
 
     // t_revoke
-    mclBnG1_mul(&t_revoke, &ue_credential.pseudonym, &fr_hash_neg); // t_revoke = C·(-H(epoch))
-    mclBnG1_add(&t_revoke, &sys_parameters.G1, &t_revoke); // t_revoke = G1 + t_revoke
-    mclBnG1_mul(&t_revoke, &t_revoke, &neg_e); // t_revoke = t_revoke·(-e)
+    mclBnG1_mul(&t_values->t_revoke, &ue_credential.pseudonym, &fr_hash_neg); // t_revoke = C·(-H(epoch))
+    mclBnG1_add(&t_values->t_revoke, &sys_parameters.G1, &t_values->t_revoke); // t_revoke = G1 + t_revoke
+    mclBnG1_mul(&t_values->t_revoke, &t_values->t_revoke, &neg_e); // t_revoke = t_revoke·(-e)
     mclBnG1_mul(&mul_result_g1, &ue_credential.pseudonym, &ue_pi.s_mr); // mul_result_g1 = C·s_mr
-    mclBnG1_add(&t_revoke, &t_revoke, &mul_result_g1); // t_revoke = t_revoke + mul_result_g1
+    mclBnG1_add(&t_values->t_revoke, &t_values->t_revoke, &mul_result_g1); // t_revoke = t_revoke + mul_result_g1
     mclBnG1_mul(&mul_result_g1, &ue_credential.pseudonym, &ue_pi.s_i); // mul_result_g1 = C·s_i
-    mclBnG1_add(&t_revoke, &t_revoke, &mul_result_g1); // t_revoke = t_revoke + mul_result_g1
-    mclBnG1_normalize(&t_revoke, &t_revoke);
-    r = mclBnG1_isValid(&t_revoke);
-    if (r != 1)
-    {
-        return -1;
-    }
+    mclBnG1_add(&t_values->t_revoke, &t_values->t_revoke, &mul_result_g1); // t_revoke = t_revoke + mul_result_g1
 
     // t_sig
-    mclBnG1_mul(&t_sig, &sys_parameters.G1, &ue_pi.s_i); // t_sig = G1·s_i
-    mclBnG1_mul(&mul_result_g1, &ra_parameters.alphas_mul[0], &ue_pi.s_e1); // mul_result_g1 = h1·s_e1
-    mclBnG1_add(&t_sig, &t_sig, &mul_result_g1); // t_sig = t_sig + mul_result_g1 (G1·s_i + h1·s_e1)
-    mclBnG1_mul(&mul_result_g1, &ra_parameters.alphas_mul[1], &ue_pi.s_e2); // mul_result_g1 = h2·s_e2
-    mclBnG1_add(&t_sig, &t_sig, &mul_result_g1); // t_sig = t_sig + mul_result_g1 (G1·s_i + h1·s_e1 + h2·s_e2)
-    mclBnG1_normalize(&t_sig, &t_sig);
-    r = mclBnG1_isValid(&t_sig);
-    if (r != 1)
+    fixed_base_mul(&t_values->t_sig, &sys_parameters.G1, sys_parameters.G1_table, &ue_pi.s_i); // t_sig = G1·s_i
+    for (it = 0; it < ra_parameters.j; it++)
     {
-        return -1;
+        fixed_base_mul(&mul_result_g1, &ra_parameters.alphas_mul[it], ra_parameters.alphas_mul_tables[it], &ue_pi.s_e[it]); // mul_result_g1 = h(it)·s_e(it)
+        mclBnG1_add(&t_values->t_sig, &t_values->t_sig, &mul_result_g1); // t_sig = t_sig + mul_result_g1
     }
 
-    // t_sig1
-    mclBnG1_mul(&t_sig1, &ue_credential.sigma_minus_e1, &neg_e); // t_sig1 = sigma_minus_e1·(-e)
-    mclBnG1_mul(&mul_result_g1, &ue_credential.sigma_hat_e1, &ue_pi.s_e1); // mul_result_g1 = sigma_hat_e1·s_e1
-    mclBnG1_add(&t_sig1, &t_sig1, &mul_result_g1); // t_sig2 = t_sig2 + mul_result_g1
-    mclBnG1_mul(&mul_result_g1, &sys_parameters.G1, &ue_pi.s_v); // mul_result_g1 = G1·s_v
-    mclBnG1_add(&t_sig1, &t_sig1, &mul_result_g1); // t_sig2 = t_sig2 + mul_result_g1
-    mclBnG1_normalize(&t_sig1, &t_sig1);
-    r = mclBnG1_isValid(&t_sig1);
-    if (r != 1)
+    // t_sig1...t_sigj
+    for (it = 0; it < ra_parameters.j; it++)
     {
-        return -1;
+        mclBnG1_mul(&t_values->t_sig_e[it], &ue_credential.sigma_minus_e[it], &neg_e); // t_sig(it) = sigma_minus_e(it)·(-e)
+        mclBnG1_mul(&mul_result_g1, &ue_credential.sigma_hat_e[it], &ue_pi.s_e[it]); // mul_result_g1 = sigma_hat_e(it)·s_e(it)
+        mclBnG1_add(&t_values->t_sig_e[it], &t_values->t_sig_e[it], &mul_result_g1); // t_sig(it) = t_sig(it) + mul_result_g1
+        fixed_base_mul(&mul_result_g1, &sys_parameters.G1, sys_parameters.G1_table, &ue_pi.s_v); // mul_result_g1 = G1·s_v
+        mclBnG1_add(&t_values->t_sig_e[it], &t_values->t_sig_e[it], &mul_result_g1); // t_sig(it) = t_sig(it) + mul_result_g1
     }
+}
 
-    // t_sig2
-    mclBnG1_mul(&t_sig2, &ue_credential.sigma_minus_e2, &neg_e); // t_sig2 = sigma_minus_e2·(-e)
-    mclBnG1_mul(&mul_result_g1, &ue_credential.sigma_hat_e2, &ue_pi.s_e2); // mul_result_g1 = sigma_hat_e2·s_e2
-    mclBnG1_add(&t_sig2, &t_sig2, &mul_result_g1); // t_sig2 = t_sig2 + mul_result_g1
-    mclBnG1_mul(&mul_result_g1, &sys_parameters.G1, &ue_pi.s_v); // mul_result_g1 = G1·s_v
-    mclBnG1_add(&t_sig2, &t_sig2, &mul_result_g1); // t_sig2 = t_sig2 + mul_result_g1
-    mclBnG1_normalize(&t_sig2, &t_sig2);
-    r = mclBnG1_isValid(&t_sig2);
-    if (r != 1)
-    {
-        return -1;
-    }
+/**
+ * Computes t_verify accumulating the scalars in Fr first. Every term except
+ * G1·s_v is a multiple of sigma_hat, so it costs one multiplication
+ * regardless of the number of attributes:
+ *
+ * t_verify = G1·s_v + sigma_hat·(-e·x(0) + x(r)·s_mr + sum(x(i)·s_mz(i)) + sum(-e·x(i)·mz(i)))
+ *
+ * @param argument the kernel context
+ */
+static void ve_compute_t_verify(void *argument)
+{
+    verifier_kernel_context_t *context = (verifier_kernel_context_t *) argument;
+    const user_attributes_t *attributes = context->attributes;
 
-#ifndef NDEBUG
-    mcl_display_G1("t_verify", t_verify);
-    mcl_display_G1("t_revoke", t_revoke);
-    mcl_display_G1("t_sig", t_sig);
-    mcl_display_G1("t_sig1", t_sig1);
-    mcl_display_G1("t_sig2", t_sig2);
-    mcl_display_G1("sigma_hat", ue_credential.sigma_hat);
-    mcl_display_G1("sigma_hat_e1", ue_credential.sigma_hat_e1);
-    mcl_display_G1("sigma_hat_e2", ue_credential.sigma_hat_e2);
-    mcl_display_G1("sigma_minus_e1", ue_credential.sigma_minus_e1);
-    mcl_display_G1("sigma_minus_e2", ue_credential.sigma_minus_e2);
-    mcl_display_G1("pseudonym", ue_credential.pseudonym);
-#endif
+    mclBnFr attribute;
 
-    /// e <-- H(...)
-    SHA1_Init(&ctx);
-    SHA1_Update(&ctx, digest_get_platform_point_data(digest_platform_point, t_verify), digest_get_platform_point_size());
-    SHA1_Update(&ctx, digest_get_platform_point_data(digest_platform_point, t_revoke), digest_get_platform_point_size());
-    SHA1_Update(&ctx, digest_get_platform_point_data(digest_platform_point, t_sig), digest_get_platform_point_size());
-    SHA1_Update(&ctx, digest_get_platform_point_data(digest_platform_point, t_sig1), digest_get_platform_point_size());
-    SHA1_Update(&ctx, digest_get_platform_point_data(digest_platform_point, t_sig2), digest_get_platform_point_size());
-    SHA1_Update(&ctx, digest_get_platform_point_data(digest_platform_point, ue_credential.sigma_hat), digest_get_platform_point_size());
-    SHA1_Update(&ctx, digest_get_platform_point_data(digest_platform_point, ue_credential.sigma_hat_e1), digest_get_platform_point_size());
-    SHA1_Update(&ctx, digest_get_platform_point_data(digest_platform_point, ue_credential.sigma_hat_e2), digest_get_platform_point_size());
-    SHA1_Update(&ctx, digest_get_platform_point_data(digest_platform_point, ue_credential.sigma_minus_e1), digest_get_platform_point_size());
-    SHA1_Update(&ctx, digest_get_platform_point_data(digest_platform_point, ue_credential.sigma_minus_e2), digest_get_platform_point_size());
-    SHA1_Update(&ctx, digest_get_platform_point_data(digest_platform_point, ue_credential.pseudonym), digest_get_platform_point_size());
-    SHA1_Update(&ctx, nonce, nonce_length);
-    SHA1_Final(&hash[SHA_DIGEST_PADDING], &ctx);
+    mclBnFr mul_result;
+    mclBnFr scalar;
 
-    /*
-     * IMPORTANT!
-     *
-     * We are using SHA1 on the Smart Card. However, because the length
-     * of the SHA1 hash is 20 and the size of Fr is 32, it is necessary
-     * to enlarge 12 characters and fill them with 0's.
-     */
-    mcl_bytes_to_Fr(&e, hash, EC_SIZE);
-    r = mclBnFr_isValid(&e);
-    if (r != 1)
+    mclBnFr disclosed_sum; // sum(x(i)·mz(i)) of the disclosed attributes
+
+    size_t it;
+
+    mclBnFr_mul(&scalar, &context->ie_keys->revocation_private_key.sk, &context->ue_pi->s_mr); // scalar = x(r)·s_mr
+    mclBnFr_clear(&disclosed_sum);
+    for (it = 0; it < attributes->num_attributes; it++)
     {
-        return -1;
+        if (attributes->attributes[it].disclosed == false)
+        {
+            mclBnFr_mul(&mul_result, &context->ie_keys->attribute_private_keys[it].sk, &context->ue_pi->s_mz[it]); // mul_result = x(it)·s_mz(it)
+            mclBnFr_add(&scalar, &scalar, &mul_result); // scalar = scalar + mul_result
+        }
+        else
+        {
+            mcl_bytes_to_Fr(&attribute, attributes->attributes[it].value, EC_SIZE);
+            mclBnFr_mul(&mul_result, &context->ie_keys->attribute_private_keys[it].sk, &attribute); // mul_result = x(it)·mz
+            mclBnFr_add(&disclosed_sum, &disclosed_sum, &mul_result); // disclosed_sum = disclosed_sum + mul_result
+        }
     }
+    mclBnFr_add(&disclosed_sum, &disclosed_sum, &context->ie_keys->issuer_private_key.sk); // disclosed_sum = x(0) + disclosed_sum
+    mclBnFr_mul(&mul_result, &context->neg_e, &disclosed_sum); // mul_result = -e·(x(0) + disclosed_sum)
+    mclBnFr_add(&scalar, &scalar, &mul_result); // scalar = scalar + mul_result
+    mclBnG1_mul(&context->t_values->t_verify, &context->ue_credential->sigma_hat, &scalar); // t_verify = sigma_hat·scalar
+    mclBnG1_add(&context->t_values->t_verify, &context->t_values->t_verify, &context->g1_s_v); // t_verify = t_verify + G1·s_v
+}
 
-#ifndef NDEBUG
-    mcl_display_Fr("e", e);
-#endif
+/**
+ * Computes t_revoke accumulating the scalars in Fr first. Every term except
+ * G1·(-e) is a multiple of C:
+ *
+ * t_revoke = G1·(-e) + C·(e·H(epoch) + s_mr + s_i)
+ *
+ * @param argument the kernel context
+ */
+static void ve_compute_t_revoke(void *argument)
+{
+    verifier_kernel_context_t *context = (verifier_kernel_context_t *) argument;
 
-    r = mclBnFr_isEqual(&ue_pi.e, &e);
-    if (r != 1)
+    mclBnFr scalar;
+    mclBnG1 mul_result_g1;
+
+    mclBnFr_mul(&scalar, &context->ue_pi->e, &context->fr_hash); // scalar = e·H(epoch)
+    mclBnFr_add(&scalar, &scalar, &context->ue_pi->s_mr); // scalar = scalar + s_mr
+    mclBnFr_add(&scalar, &scalar, &context->ue_pi->s_i); // scalar = scalar + s_i
+    mclBnG1_mul(&context->t_values->t_revoke, &context->ue_credential->pseudonym, &scalar); // t_revoke = C·scalar
+    fixed_base_mul(&mul_result_g1, &context->sys_parameters->G1, context->sys_parameters->G1_table, &context->neg_e); // mul_result_g1 = G1·(-e)
+    mclBnG1_add(&context->t_values->t_revoke, &context->t_values->t_revoke, &mul_result_g1); // t_revoke = t_revoke + mul_result_g1
+}
+
+/**
+ * Computes t_sig = G1·s_i + h1·s_e1 + ... + hj·s_ej as a multi-scalar
+ * multiplication over the fixed-base tables.
+ *
+ * @param argument the kernel context
+ */
+static void ve_compute_t_sig(void *argument)
+{
+    verifier_kernel_context_t *context = (verifier_kernel_context_t *) argument;
+    const revocation_authority_par_t *ra_parameters = context->ra_parameters;
+
+    mclBnG1 points[REVOCATION_AUTHORITY_MAX_J + 1];
+    mclBnFr scalars[REVOCATION_AUTHORITY_MAX_J + 1];
+    fixed_base_table_t *tables[REVOCATION_AUTHORITY_MAX_J + 1];
+
+    size_t it;
+    int r;
+
+    memcpy(&points[0], &context->sys_parameters->G1, sizeof(mclBnG1));
+    memcpy(&scalars[0], &context->ue_pi->s_i, sizeof(mclBnFr));
+    tables[0] = context->sys_parameters->G1_table;
+    for (it = 0; it < ra_parameters->j; it++)
     {
-        return -1;
+        memcpy(&points[it + 1], &ra_parameters->alphas_mul[it], sizeof(mclBnG1));
+        memcpy(&scalars[it + 1], &context->ue_pi->s_e[it], sizeof(mclBnFr));
+        tables[it + 1] = ra_parameters->alphas_mul_tables[it];
     }
 
-    /// pairing
-    // e(sigma_minus_e1, G2)
-    mclBn_pairing(&el, &ue_credential.sigma_minus_e1, &sys_parameters.G2);
-    // e(sigma_hat_e1, G2)
-    mclBn_pairing(&er, &ue_credential.sigma_hat_e1, &ra_public_key.pk);
-    // e(sigma_minus_e1, G2) ?= e(sigma_hat_e1, G2)
-    r = mclBnGT_isEqual(&el, &er);
-    if (r != 1)
+    r = fixed_base_mul_vec(&context->t_values->t_sig, points, tables, scalars, ra_parameters->j + 1);
+    if (r < 0)
     {
-        return -1;
+        // invalid point, the challenge will not match
+        mclBnG1_clear(&context->t_values->t_sig);
     }
+}
 
-    // e(sigma_minus_e2, G2)
-    mclBn_pairing(&el, &ue_credential.sigma_minus_e2, &sys_parameters.G2);
-    // e(sigma_hat_e2, G2)
-    mclBn_pairing(&er, &ue_credential.sigma_hat_e2, &ra_public_key.pk);
-    // e(sigma_minus_e2, G2) ?= e(sigma_hat_e2, G2)
-    r = mclBnGT_isEqual(&el, &er);
+/**
+ * Computes t_sig(it) = sigma_minus_e(it)·(-e) + sigma_hat_e(it)·s_e(it) + G1·s_v.
+ *
+ * @param argument the kernel randomizer
+ */
+static void ve_compute_t_sig_e(void *argument)
+{
+    verifier_kernel_randomizer_t *randomizer = (verifier_kernel_randomizer_t *) argument;
+    const verifier_kernel_context_t *context = randomizer->context;
+    size_t it = randomizer->index;
+
+    mclBnG1 points[2];
+    mclBnFr scalars[2];
+
+    memcpy(&points[0], &context->ue_credential->sigma_minus_e[it], sizeof(mclBnG1));
+    memcpy(&points[1], &context->ue_credential->sigma_hat_e[it], sizeof(mclBnG1));
+    memcpy(&scalars[0], &context->neg_e, sizeof(mclBnFr));
+    memcpy(&scalars[1], &context->ue_pi->s_e[it], sizeof(mclBnFr));
+    mclBnG1_mulVec(&context->t_values->t_sig_e[it], points, scalars, 2); // t_sig(it) = sigma_minus_e(it)·(-e) + sigma_hat_e(it)·s_e(it)
+    mclBnG1_add(&context->t_values->t_sig_e[it], &context->t_values->t_sig_e[it], &context->g1_s_v); // t_sig(it) = t_sig(it) + G1·s_v
+}
+
+/**
+ * Computes the t values of the proof of knowledge accumulating the scalars
+ * in Fr first (folded kernel), so that t_verify and t_revoke cost two
+ * multiplications regardless of the number of attributes. The t values are
+ * independent of each other, so they are computed as the tasks of a
+ * fork-join job (in the calling thread if there is no thread pool).
+ *
+ * @param sys_parameters the system parameters
+ * @param parameters the verifier parameters
+ * @param ra_parameters the revocation authority parameters
+ * @param ie_keys the issuer keys
+ * @param fr_hash the hash of the epoch H(epoch)
+ * @param attributes the attributes disclosed by the user
+ * @param ue_credential the credential struct computed by the user
+ * @param ue_pi the pi struct computed by the user
+ * @param t_values the t values
+ */
+static void ve_compute_t_values_folded(system_par_t sys_parameters, verifier_par_t parameters, revocation_authority_par_t ra_parameters, issuer_keys_t ie_keys,
+                                       mclBnFr fr_hash, user_attributes_t attributes, user_credential_t ue_credential, user_pi_t ue_pi, verifier_t_values_t *t_values)
+{
+    static const thread_pool_function_t functions[] = {ve_compute_t_verify, ve_compute_t_revoke, ve_compute_t_sig};
+
+    verifier_kernel_context_t context;
+    verifier_kernel_randomizer_t randomizers[REVOCATION_AUTHORITY_MAX_J];
+    thread_pool_task_t tasks[sizeof(functions) / sizeof(functions[0]) + REVOCATION_AUTHORITY_MAX_J];
+    size_t num_tasks;
+
+    size_t it;
+
+    context.sys_parameters = &sys_parameters;
+    context.ra_parameters = &ra_parameters;
+    context.ie_keys = &ie_keys;
+    context.attributes = &attributes;
+    context.ue_credential = &ue_credential;
+    context.ue_pi = &ue_pi;
+    context.t_values = t_values;
+    memcpy(&context.fr_hash, &fr_hash, sizeof(mclBnFr));
+
+    mclBnFr_neg(&context.neg_e, &ue_pi.e); // neg_e = -e
+    fixed_base_mul(&context.g1_s_v, &sys_parameters.G1, sys_parameters.G1_table, &ue_pi.s_v); // g1_s_v = G1·s_v
+
+    num_tasks = 0;
+    for (it = 0; it < sizeof(functions) / sizeof(functions[0]); it++)
+    {
+        tasks[num_tasks].function = functions[it];
+        tasks[num_tasks].argument = &context;
+        num_tasks++;
+    }
+    // one t_sig value per randomizer
+    for (it = 0; it < ra_parameters.j; it++)
+    {
+        randomizers[it].context = &context;
+        randomizers[it].index = it;
+        tasks[num_tasks].function = ve_compute_t_sig_e;
+        tasks[num_tasks].argument = &randomizers[it];
+        num_tasks++;
+    }
+
+    thread_pool_run(parameters.thread_pool, tasks, num_tasks);
+
+    if (parameters.profile != NULL)
+    {
+        parameters.profile->t_values_critical_path = thread_pool_critical_path(tasks, num_tasks);
+    }
+}
+
+/**
+ * Recomputes the t values of the proof of knowledge using the verification
+ * kernel selected in the verifier parameters.
+ *
+ * @param sys_parameters the system parameters
+ * @param parameters the verifier parameters
+ * @param ra_parameters the revocation authority parameters
+ * @param ie_keys the issuer keys
+ * @param epoch the epoch generated by the verifier
+ * @param epoch_length the length of the epoch
+ * @param attributes the attributes disclosed by the user
+ * @param ue_credential the credential struct computed by the user
+ * @param ue_pi the pi struct computed by the user
+ * @param t_values the t values
+ * @return 0 if success else -1
+ */
+int ve_compute_t_values(system_par_t sys_parameters, verifier_par_t parameters, revocation_authority_par_t ra_parameters, issuer_keys_t ie_keys,
+                        const void *epoch, size_t epoch_length, user_attributes_t attributes, user_credential_t ue_credential, user_pi_t ue_pi, verifier_t_values_t *t_values)
+{
+    mclBnFr fr_hash; // H(epoch)
+
+    /*
+     * IMPORTANT!
+     *
+     * We are using SHA1 on the Smart Card. However, because the length
+     * of the SHA1 hash is 20 and the size of Fr is 32, it is necessary
+     * to enlarge 12 characters and fill them with 0's.
+     */
+    unsigned char hash[SHA_DIGEST_PADDING + SHA_DIGEST_LENGTH] = {0};
+
+    double start_time;
+
+    size_t it;
+    int r;
+
+    if (epoch == NULL || epoch_length == 0 || t_values == NULL)
+    {
+        return -1;
+    }
+
+    // the credential must contain the j randomizers of the revocation authority
+    if (ra_parameters.j == 0 || ra_parameters.j > REVOCATION_AUTHORITY_MAX_J || ue_credential.num_randomizers != ra_parameters.j)
+    {
+        return -1;
+    }
+
+    start_time = thread_pool_get_time();
+
+    // H(epoch)
+    SHA1(epoch, epoch_length, &hash[SHA_DIGEST_PADDING]);
+    mcl_bytes_to_Fr(&fr_hash, hash, EC_SIZE);
+    r = mclBnFr_isValid(&fr_hash);
+    if (r != 1)
+    {
+        return -1;
+    }
+
+    if (parameters.kernel == VERIFIER_KERNEL_REFERENCE)
+    {
+        ve_compute_t_values_reference(sys_parameters, ra_parameters, ie_keys, fr_hash, attributes, ue_credential, ue_pi, t_values);
+    }
+    else
+    {
+        ve_compute_t_values_folded(sys_parameters, parameters, ra_parameters, ie_keys, fr_hash, attributes, ue_credential, ue_pi, t_values);
+    }
+
+    mclBnG1_normalize(&t_values->t_verify, &t_values->t_verify);
+    r = mclBnG1_isValid(&t_values->t_verify);
+    if (r != 1)
+    {
+        return -1;
+    }
+
+    mclBnG1_normalize(&t_values->t_revoke, &t_values->t_revoke);
+    r = mclBnG1_isValid(&t_values->t_revoke);
+    if (r != 1)
+    {
+        return -1;
+    }
+
+    mclBnG1_normalize(&t_values->t_sig, &t_values->t_sig);
+    r = mclBnG1_isValid(&t_values->t_sig);
     if (r != 1)
     {
         return -1;
     }
 
-    /// pseudonym C not in revocation list RL
-    // ???
+    for (it = 0; it < ra_parameters.j; it++)
+    {
+        mclBnG1_normalize(&t_values->t_sig_e[it], &t_values->t_sig_e[it]);
+        r = mclBnG1_isValid(&t_values->t_sig_e[it]);
+        if (r != 1)
+        {
+            return -1;
+        }
+    }
+
+    if (parameters.profile != NULL)
+    {
+        parameters.profile->t_values = thread_pool_get_time() - start_time;
+        // the reference kernel is not split into tasks
+        if (parameters.kernel == VERIFIER_KERNEL_REFERENCE)
+        {
+            parameters.profile->t_values_critical_path = parameters.profile->t_values;
+        }
+    }
 
     return 0;
 }
+
+/**
+ * Recomputes the t values of the proof of knowledge and checks that
+ * they hash, together with the nonce, to the challenge sent by the user.
+ *
+ * @param sys_parameters the system parameters
+ * @param parameters the verifier parameters
+ * @param ra_parameters the revocation authority parameters
+ * @param ie_keys the issuer keys
+ * @param nonce the nonce generated by the verifier
+ * @param nonce_length the length of the nonce
+ * @param epoch the epoch generated by the verifier
+ * @param epoch_length the length of the epoch
+ * @param attributes the attributes disclosed by the user
+ * @param ue_credential the credential struct computed by the user
+ * @param ue_pi the pi struct computed by the user
+ * @return 0 if success else -1
+ */
+static int ve_verify_challenge(system_par_t sys_parameters, verifier_par_t parameters, revocation_authority_par_t ra_parameters, issuer_keys_t ie_keys,
+                               const void *nonce, size_t nonce_length, const void *epoch, size_t epoch_length,
+                               user_attributes_t attributes, user_credential_t ue_credential, user_pi_t ue_pi)
+{
+    verifier_t_values_t t_values;
+
+    mclBnFr e;
+
+    /*
+     * IMPORTANT!
+     *
+     * We are using SHA1 on the Smart Card. However, because the length
+     * of the SHA1 hash is 20 and the size of Fr is 32, it is necessary
+     * to enlarge 12 characters and fill them with 0's.
+     */
+    unsigned char hash[SHA_DIGEST_PADDING + SHA_DIGEST_LENGTH] = {0};
+    SHA_CTX ctx;
+
+    double start_time;
+
+    size_t it;
+    int r;
+
+    if (nonce == NULL || nonce_length == 0 || epoch == NULL || epoch_length == 0)
+    {
+        return -1;
+    }
+
+    /// t values
+    r = ve_compute_t_values(sys_parameters, parameters, ra_parameters, ie_keys, epoch, epoch_length, attributes, ue_credential, ue_pi, &t_values);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+#ifndef NDEBUG
+    mcl_display_G1("t_verify", t_values.t_verify);
+    mcl_display_G1("t_revoke", t_values.t_revoke);
+    mcl_display_G1("t_sig", t_values.t_sig);
+    for (it = 0; it < ra_parameters.j; it++)
+    {
+        mcl_display_G1("t_sig_e", t_values.t_sig_e[it]);
+    }
+    mcl_display_G1("sigma_hat", ue_credential.sigma_hat);
+    for (it = 0; it < ra_parameters.j; it++)
+    {
+        mcl_display_G1("sigma_hat_e", ue_credential.sigma_hat_e[it]);
+        mcl_display_G1("sigma_minus_e", ue_credential.sigma_minus_e[it]);
+    }
+    mcl_display_G1("pseudonym", ue_credential.pseudonym);
+#endif
+
+    /// e <-- H(...)
+    start_time = thread_pool_get_time();
+    SHA1_Init(&ctx);
+    r = digest_update_point(&ctx, t_values.t_verify);
+    r |= digest_update_point(&ctx, t_values.t_revoke);
+    r |= digest_update_point(&ctx, t_values.t_sig);
+    for (it = 0; it < ra_parameters.j; it++)
+    {
+        r |= digest_update_point(&ctx, t_values.t_sig_e[it]);
+    }
+    r |= digest_update_point(&ctx, ue_credential.sigma_hat);
+    for (it = 0; it < ra_parameters.j; it++)
+    {
+        r |= digest_update_point(&ctx, ue_credential.sigma_hat_e[it]);
+    }
+    for (it = 0; it < ra_parameters.j; it++)
+    {
+        r |= digest_update_point(&ctx, ue_credential.sigma_minus_e[it]);
+    }
+    r |= digest_update_point(&ctx, ue_credential.pseudonym);
+    if (r != 0)
+    {
+        return -1;
+    }
+    SHA1_Update(&ctx, nonce, nonce_length);
+    SHA1_Final(&hash[SHA_DIGEST_PADDING], &ctx);
+
+    if (parameters.profile != NULL)
+    {
+        parameters.profile->challenge = thread_pool_get_time() - start_time;
+    }
+
+    /*
+     * IMPORTANT!
+     *
+     * We are using SHA1 on the Smart Card. However, because the length
+     * of the SHA1 hash is 20 and the size of Fr is 32, it is necessary
+     * to enlarge 12 characters and fill them with 0's.
+     */
+    mcl_bytes_to_Fr(&e, hash, EC_SIZE);
+    r = mclBnFr_isValid(&e);
+    if (r != 1)
+    {
+        return -1;
+    }
+
+#ifndef NDEBUG
+    mcl_display_Fr("e", e);
+#endif
+
+    r = mclBnFr_isEqual(&ue_pi.e, &e);
+    if (r != 1)
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * Checks that the pseudonym is not in the revocation list.
+ *
+ * @param revocation_list the revocation list or NULL (no revocation check)
+ * @param epoch the epoch generated by the verifier
+ * @param epoch_length the length of the epoch
+ * @param pseudonym the pseudonym C computed by the user
+ * @return 0 if the pseudonym is not revoked else -1
+ */
+static int ve_verify_pseudonym_list(const revocation_list_t *revocation_list, const void *epoch, size_t epoch_length, mclBnG1 pseudonym)
+{
+    int r;
+
+    // no revocation list
+    if (revocation_list == NULL)
+    {
+        return 0;
+    }
+
+    // the pseudonyms of another epoch cannot be compared
+    if (epoch_length != EPOCH_LENGTH || memcmp(revocation_list->header->epoch, epoch, EPOCH_LENGTH) != 0)
+    {
+        return -1;
+    }
+
+    r = rl_is_revoked(revocation_list, pseudonym);
+    if (r != 0)
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * Checks that the pseudonym is not in the revocation list of the epoch (the
+ * shared list or the current list of the snapshot if they are set).
+ *
+ * @param parameters the verifier parameters
+ * @param epoch the epoch generated by the verifier
+ * @param epoch_length the length of the epoch
+ * @param pseudonym the pseudonym C computed by the user
+ * @return 0 if the pseudonym is not revoked else -1
+ */
+static int ve_verify_pseudonym(verifier_par_t parameters, const void *epoch, size_t epoch_length, mclBnG1 pseudonym)
+{
+    int r;
+
+    if (parameters.revocation_shared != NULL)
+    {
+        // the pseudonyms of another epoch cannot be compared
+        if (epoch_length != EPOCH_LENGTH)
+        {
+            return -1;
+        }
+
+        r = rl_shared_is_revoked(parameters.revocation_shared, epoch, pseudonym);
+        return r == 0 ? 0 : -1;
+    }
+
+    if (parameters.revocation_snapshot == NULL)
+    {
+        return ve_verify_pseudonym_list(parameters.revocation_list, epoch, epoch_length, pseudonym);
+    }
+
+    r = ve_verify_pseudonym_list(rs_read_lock(parameters.revocation_snapshot, parameters.revocation_reader), epoch, epoch_length, pseudonym);
+    rs_read_unlock(parameters.revocation_snapshot, parameters.revocation_reader);
+
+    return r;
+}
+
+/**
+ * Aggregates the pairing equations of the proofs in the range [first, last)
+ * using the random weights and checks the resulting equation
+ * e(sum(w·sigma_minus), G2) · e(-sum(w·sigma_hat), pk) == 1, or
+ * sum(w·sigma_minus) == sk·sum(w·sigma_hat) in the designated verifier mode.
+ *
+ * @param sys_parameters the system parameters
+ * @param parameters the verifier parameters
+ * @param ra_public_key the revocation authority public key
+ * @param sigmas_minus the sigma_minus_e1...sigma_minus_ej points of each proof
+ * @param sigmas_hat the sigma_hat_e1...sigma_hat_ej points of each proof
+ * @param weights the random weights of each pairing equation
+ * @param num_randomizers the number of pairing equations of each proof (j)
+ * @param first the first proof of the range
+ * @param last the proof after the last proof of the range
+ * @return 0 if success else -1
+ */
+static int ve_verify_pairings_range(system_par_t sys_parameters, verifier_par_t parameters, revocation_authority_public_key_t ra_public_key,
+                                    mclBnG1 *sigmas_minus, mclBnG1 *sigmas_hat, const mclBnFr *weights, size_t num_randomizers, size_t first, size_t last)
+{
+    mclBnG1 g1_points[2]; // sum(w·sigma_minus), -sum(w·sigma_hat)
+    mclBnG2 g2_points[2]; // G2, pk
+    mclBnGT el;
+
+    // each proof contributes with j pairing equations (e1...ej)
+    mclBnG1_mulVec(&g1_points[0], &sigmas_minus[num_randomizers * first], &weights[num_randomizers * first], num_randomizers * (last - first));
+    mclBnG1_mulVec(&g1_points[1], &sigmas_hat[num_randomizers * first], &weights[num_randomizers * first], num_randomizers * (last - first));
+
+    // pk = G2·sk, so e(A, G2) == e(B, pk) if and only if A == B·sk
+    if (parameters.pairing_mode == VERIFIER_PAIRING_MODE_DESIGNATED)
+    {
+        mclBnG1_mul(&g1_points[1], &g1_points[1], &parameters.ra_private_key.sk);
+        return mclBnG1_isEqual(&g1_points[0], &g1_points[1]) == 1 ? 0 : -1;
+    }
+
+    mclBnG1_neg(&g1_points[1], &g1_points[1]);
+
+    // e(sum(w·sigma_minus), G2) · e(-sum(w·sigma_hat), pk) ?= 1
+    if (parameters.G2_precomputed != NULL && parameters.pk_precomputed != NULL)
+    {
+        mclBn_precomputedMillerLoop2(&el, &g1_points[0], parameters.G2_precomputed, &g1_points[1], parameters.pk_precomputed);
+    }
+    else
+    {
+        memcpy(&g2_points[0], &sys_parameters.G2, sizeof(mclBnG2));
+        memcpy(&g2_points[1], &ra_public_key.pk, sizeof(mclBnG2));
+
+        mclBn_millerLoopVec(&el, g1_points, g2_points, 2);
+    }
+    mclBn_finalExp(&el, &el);
+
+    return mclBnGT_isOne(&el) == 1 ? 0 : -1;
+}
+
+/**
+ * Checks the pairing equations of the proofs in the range [first, last). If the
+ * aggregated equation does not hold, the range is bisected until the invalid
+ * proofs are found.
+ *
+ * @param sys_parameters the system parameters
+ * @param parameters the verifier parameters
+ * @param ra_public_key the revocation authority public key
+ * @param sigmas_minus the sigma_minus_e1...sigma_minus_ej points of each proof
+ * @param sigmas_hat the sigma_hat_e1...sigma_hat_ej points of each proof
+ * @param weights the random weights of each pairing equation
+ * @param num_randomizers the number of pairing equations of each proof (j)
+ * @param first the first proof of the range
+ * @param last the proof after the last proof of the range
+ * @param results the result of each proof (0 if valid else -1)
+ * @return 0 if all the proofs of the range are valid else -1
+ */
+static int ve_verify_pairings_bisect(system_par_t sys_parameters, verifier_par_t parameters, revocation_authority_public_key_t ra_public_key,
+                                     mclBnG1 *sigmas_minus, mclBnG1 *sigmas_hat, const mclBnFr *weights, size_t num_randomizers, size_t first, size_t last, int *results)
+{
+    size_t middle;
+    int r1, r2;
+
+    r1 = ve_verify_pairings_range(sys_parameters, parameters, ra_public_key, sigmas_minus, sigmas_hat, weights, num_randomizers, first, last);
+    if (r1 == 0)
+    {
+        return 0;
+    }
+
+    // a single proof whose equations do not hold
+    if (last - first == 1)
+    {
+        results[first] = -1;
+        return -1;
+    }
+
+    middle = first + (last - first) / 2;
+    r1 = ve_verify_pairings_bisect(sys_parameters, parameters, ra_public_key, sigmas_minus, sigmas_hat, weights, num_randomizers, first, middle, results);
+    r2 = ve_verify_pairings_bisect(sys_parameters, parameters, ra_public_key, sigmas_minus, sigmas_hat, weights, num_randomizers, middle, last, results);
+
+    return (r1 == 0 && r2 == 0) ? 0 : -1;
+}
+
+/**
+ * Computes one pairing of the pairings stage.
+ *
+ * @param argument the pairing
+ */
+static void ve_compute_pairing(void *argument)
+{
+    verifier_pairing_t *pairing = (verifier_pairing_t *) argument;
+
+    mcl_pairing(&pairing->result, pairing->x, pairing->y, pairing->y_precomputed);
+}
+
+/**
+ * Computes one multiplication of the pairing-free stage (designated verifier).
+ *
+ * @param argument the multiplication
+ */
+static void ve_compute_multiplication(void *argument)
+{
+    verifier_multiplication_t *multiplication = (verifier_multiplication_t *) argument;
+
+    mclBnG1_mul(&multiplication->result, multiplication->x, multiplication->y);
+}
+
+/**
+ * Verifies the proof of knowledge of the user attributes.
+ *
+ * @param sys_parameters the system parameters
+ * @param parameters the verifier parameters
+ * @param ra_parameters the revocation authority parameters
+ * @param ra_public_key the revocation authority public key
+ * @param ie_keys the issuer keys
+ * @param nonce the nonce generated by the verifier
+ * @param nonce_length the length of the nonce
+ * @param epoch the epoch generated by the verifier
+ * @param epoch_length the length of the epoch
+ * @param attributes the attributes disclosed by the user
+ * @param ue_credential the credential struct computed by the user
+ * @param ue_pi the pi struct computed by the user
+ * @return 0 if success else -1
+ */
+int ve_verify_proof_of_knowledge(system_par_t sys_parameters, verifier_par_t parameters, revocation_authority_par_t ra_parameters,
+                                 revocation_authority_public_key_t ra_public_key, issuer_keys_t ie_keys, const void *nonce, size_t nonce_length, const void *epoch, size_t epoch_length,
+                                 user_attributes_t attributes, user_credential_t ue_credential, user_pi_t ue_pi)
+{
+    mclBnFr weights[REVOCATION_AUTHORITY_MAX_J];
+
+    verifier_pairing_t pairings[2 * REVOCATION_AUTHORITY_MAX_J];
+    verifier_multiplication_t multiplications[REVOCATION_AUTHORITY_MAX_J];
+    thread_pool_task_t tasks[2 * REVOCATION_AUTHORITY_MAX_J];
+
+    double start_time;
+
+    size_t it;
+    int r;
+
+    r = ve_verify_challenge(sys_parameters, parameters, ra_parameters, ie_keys, nonce, nonce_length, epoch, epoch_length, attributes, ue_credential, ue_pi);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    /// pseudonym C not in revocation list RL (cheaper than the pairings)
+    r = ve_verify_pseudonym(parameters, epoch, epoch_length, ue_credential.pseudonym);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    start_time = thread_pool_get_time();
+
+    if (parameters.pairing_mode == VERIFIER_PAIRING_MODE_MULTI_PAIRING)
+    {
+        /*
+         * IMPORTANT!
+         *
+         * The equations after the first one are weighted by random
+         * values, otherwise an error in one equation could be cancelled
+         * out by an error in another one and the product would still be 1.
+         */
+        mclBnFr_setInt32(&weights[0], 1);
+        r = mcl_generate_weights(&weights[1], ra_parameters.j - 1, VERIFIER_BATCH_WEIGHT_LENGTH);
+        if (r < 0)
+        {
+            return -1;
+        }
+
+        /// pairing
+        // e(sum(w·sigma_minus_e), G2) · e(-sum(w·sigma_hat_e), pk) ?= 1
+        // (a single multi-Miller loop, it is not split into tasks)
+        r = ve_verify_pairings_range(sys_parameters, parameters, ra_public_key, ue_credential.sigma_minus_e, ue_credential.sigma_hat_e, weights, ra_parameters.j, 0, 1);
+
+        if (parameters.profile != NULL)
+        {
+            parameters.profile->pairings = thread_pool_get_time() - start_time;
+            parameters.profile->pairings_critical_path = parameters.profile->pairings;
+        }
+
+        if (r < 0)
+        {
+            return -1;
+        }
+
+        return 0;
+    }
+
+    if (parameters.pairing_mode == VERIFIER_PAIRING_MODE_DESIGNATED)
+    {
+        /// pairing-free check (pk = G2·sk)
+        // sigma_hat_e1·sk...sigma_hat_ej·sk
+        for (it = 0; it < ra_parameters.j; it++)
+        {
+            multiplications[it].x = &ue_credential.sigma_hat_e[it];
+            multiplications[it].y = &parameters.ra_private_key.sk;
+            tasks[it].function = ve_compute_multiplication;
+            tasks[it].argument = &multiplications[it];
+        }
+        thread_pool_run(parameters.thread_pool, tasks, ra_parameters.j);
+
+        if (parameters.profile != NULL)
+        {
+            parameters.profile->pairings = thread_pool_get_time() - start_time;
+            parameters.profile->pairings_critical_path = thread_pool_critical_path(tasks, ra_parameters.j);
+        }
+
+        // sigma_minus_e(it) ?= sigma_hat_e(it)·sk
+        for (it = 0; it < ra_parameters.j; it++)
+        {
+            r = mclBnG1_isEqual(&ue_credential.sigma_minus_e[it], &multiplications[it].result);
+            if (r != 1)
+            {
+                return -1;
+            }
+        }
+
+        return 0;
+    }
+
+    /// pairing
+    // e(sigma_minus_e(it), G2), e(sigma_hat_e(it), pk)
+    for (it = 0; it < ra_parameters.j; it++)
+    {
+        pairings[2 * it].x = &ue_credential.sigma_minus_e[it];
+        pairings[2 * it].y = &sys_parameters.G2;
+        pairings[2 * it].y_precomputed = parameters.G2_precomputed;
+        pairings[2 * it + 1].x = &ue_credential.sigma_hat_e[it];
+        pairings[2 * it + 1].y = &ra_public_key.pk;
+        pairings[2 * it + 1].y_precomputed = parameters.pk_precomputed;
+    }
+    for (it = 0; it < 2 * ra_parameters.j; it++)
+    {
+        tasks[it].function = ve_compute_pairing;
+        tasks[it].argument = &pairings[it];
+    }
+    thread_pool_run(parameters.thread_pool, tasks, 2 * ra_parameters.j);
+
+    if (parameters.profile != NULL)
+    {
+        parameters.profile->pairings = thread_pool_get_time() - start_time;
+        parameters.profile->pairings_critical_path = thread_pool_critical_path(tasks, 2 * ra_parameters.j);
+    }
+
+    // e(sigma_minus_e(it), G2) ?= e(sigma_hat_e(it), pk)
+    for (it = 0; it < ra_parameters.j; it++)
+    {
+        r = mclBnGT_isEqual(&pairings[2 * it].result, &pairings[2 * it + 1].result);
+        if (r != 1)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Verifies a batch of proofs of knowledge of the user attributes. The pairing
+ * equations of all the proofs are combined using random weights, so the whole
+ * batch costs one multi-Miller loop and one final exponentiation. If the batch
+ * fails, it is bisected to find out which proofs are invalid.
+ *
+ * @param sys_parameters the system parameters
+ * @param parameters the verifier parameters
+ * @param ra_parameters the revocation authority parameters
+ * @param ra_public_key the revocation authority public key
+ * @param ie_keys the issuer keys
+ * @param epoch the epoch generated by the verifier
+ * @param epoch_length the length of the epoch
+ * @param proofs the proofs computed by the users
+ * @param num_proofs the number of proofs
+ * @param results the result of each proof (0 if valid else -1)
+ * @return 0 if all the proofs are valid else -1
+ */
+int ve_verify_proof_of_knowledge_batch(system_par_t sys_parameters, verifier_par_t parameters, revocation_authority_par_t ra_parameters,
+                                       revocation_authority_public_key_t ra_public_key, issuer_keys_t ie_keys, const void *epoch, size_t epoch_length, const verifier_proof_t *proofs, size_t num_proofs, int *results)
+{
+    mclBnG1 *sigmas_minus = NULL, *sigmas_hat = NULL;
+    mclBnFr *weights = NULL;
+
+    size_t *valid_proofs = NULL; // proofs whose challenge is valid
+    int *valid_results = NULL;
+    size_t num_valid_proofs;
+
+    size_t num_randomizers = ra_parameters.j;
+
+    size_t it;
+    int r, valid;
+
+    // a proof is only valid once its pairing equations have been checked
+    for (it = 0; results != NULL && it < num_proofs; it++)
+    {
+        results[it] = -1;
+    }
+
+    if (epoch == NULL || epoch_length == 0 || proofs == NULL || num_proofs == 0 || results == NULL)
+    {
+        return -1;
+    }
+
+    sigmas_minus = malloc(num_randomizers * num_proofs * sizeof(mclBnG1));
+    sigmas_hat = malloc(num_randomizers * num_proofs * sizeof(mclBnG1));
+    weights = malloc(num_randomizers * num_proofs * sizeof(mclBnFr));
+    valid_proofs = malloc(num_proofs * sizeof(size_t));
+    valid_results = malloc(num_proofs * sizeof(int));
+    if (sigmas_minus == NULL || sigmas_hat == NULL || weights == NULL || valid_proofs == NULL || valid_results == NULL)
+    {
+        r = -1;
+        goto cleanup;
+    }
+
+    /// challenges (must be checked independently for each proof)
+    num_valid_proofs = 0;
+    for (it = 0; it < num_proofs; it++)
+    {
+        valid = ve_verify_challenge(sys_parameters, parameters, ra_parameters, ie_keys, proofs[it].nonce, proofs[it].nonce_length, epoch, epoch_length,
+                                    proofs[it].attributes, proofs[it].ue_credential, proofs[it].ue_pi);
+        if (valid == 0)
+        {
+            // pseudonym C not in revocation list RL
+            valid = ve_verify_pseudonym(parameters, epoch, epoch_length, proofs[it].ue_credential.pseudonym);
+        }
+        if (valid == 0)
+        {
+            // the challenge checks that the credential contains j randomizers
+            memcpy(&sigmas_minus[num_randomizers * num_valid_proofs], proofs[it].ue_credential.sigma_minus_e, num_randomizers * sizeof(mclBnG1));
+            memcpy(&sigmas_hat[num_randomizers * num_valid_proofs], proofs[it].ue_credential.sigma_hat_e, num_randomizers * sizeof(mclBnG1));
+
+            valid_proofs[num_valid_proofs++] = it;
+        }
+    }
+
+    if (num_valid_proofs == 0)
+    {
+        r = -1;
+        goto cleanup;
+    }
+
+    /// random small-exponent weights (one per pairing equation)
+    r = mcl_generate_weights(weights, num_randomizers * num_valid_proofs, VERIFIER_BATCH_WEIGHT_LENGTH);
+    if (r < 0)
+    {
+        goto cleanup;
+    }
+
+    /// pairing
+    for (it = 0; it < num_valid_proofs; it++)
+    {
+        valid_results[it] = 0;
+    }
+
+    r = ve_verify_pairings_bisect(sys_parameters, parameters, ra_public_key, sigmas_minus, sigmas_hat, weights, num_randomizers, 0, num_valid_proofs, valid_results);
+    for (it = 0; it < num_valid_proofs; it++)
+    {
+        results[valid_proofs[it]] = valid_results[it];
+    }
+
+    r = (r == 0 && num_valid_proofs == num_proofs) ? 0 : -1;
+
+cleanup:
+    free(sigmas_minus);
+    free(sigmas_hat);
+    free(weights);
+    free(valid_proofs);
+    free(valid_results);
+
+    return r;
+}
@@ -27,6 +27,7 @@ extern "C"
 #endif
 
 #include <stddef.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <time.h>
@@ -40,10 +41,87 @@ extern "C"
 #include "models/issuer.h"
 #include "models/revocation-authority.h"
 #include "models/user.h"
+#include "models/verifier.h"
 #include "system.h"
 
+#include "helpers/fixed_base_helper.h"
 #include "helpers/hash_helper.h"
 #include "helpers/mcl_helper.h"
+#include "revocation/list.h"
+#include "thread/pool.h"
+
+/**
+ * Precomputes the line coefficients of the G2 points used by the
+ * verifier (G2 and the revocation authority public key), so that
+ * they are not recomputed for every pairing. The other parameters are
+ * reset to their defaults (they are set after the setup).
+ *
+ * @param sys_parameters the system parameters
+ * @param ra_public_key the revocation authority public key
+ * @param parameters the verifier parameters
+ * @return 0 if success else -1
+ */
+extern int ve_setup(system_par_t sys_parameters, revocation_authority_public_key_t ra_public_key, verifier_par_t *parameters);
+
+/**
+ * Releases the resources allocated by the verifier setup.
+ *
+ * @param parameters the verifier parameters
+ */
+extern void ve_cleanup(verifier_par_t *parameters);
+
+/**
+ * Sets the revocation authority private key and enables the designated verifier
+ * mode, in which the pairing equations are checked without pairings. It must only
+ * be used when the verifier and the revocation authority share the trust domain.
+ *
+ * @param parameters the verifier parameters
+ * @param ra_private_key the revocation authority private key
+ * @return 0 if success else -1
+ */
+extern int ve_set_designated_key(verifier_par_t *parameters, revocation_authority_private_key_t ra_private_key);
+
+/**
+ * Starts the thread pool used to compute the independent parts of a single
+ * proof verification (the t values and the pairings) at the same time. The
+ * calling thread also computes, so num_threads + 1 tasks run in parallel.
+ *
+ * @param parameters the verifier parameters
+ * @param num_threads the number of threads of the pool
+ * @return 0 if success else -1
+ */
+extern int ve_set_parallel(verifier_par_t *parameters, size_t num_threads);
+
+/**
+ * Sets the revocation list checked by the verifier. The list is not copied, it
+ * must stay valid while it is used and its epoch must be the verified epoch.
+ *
+ * @param parameters the verifier parameters
+ * @param revocation_list the revocation list or NULL (no revocation check)
+ * @return 0 if success else -1
+ */
+extern int ve_set_revocation_list(verifier_par_t *parameters, const revocation_list_t *revocation_list);
+
+/**
+ * Sets the revocation list snapshot read by the verifier, the revocation authority
+ * can publish new lists (rs_publish) while the verifier is running. A reader slot
+ * is registered for the parameters, each thread must use its own parameters.
+ *
+ * @param parameters the verifier parameters
+ * @param revocation_snapshot the revocation list snapshot or NULL (no snapshot)
+ * @return 0 if success else -1
+ */
+extern int ve_set_revocation_snapshot(verifier_par_t *parameters, revocation_snapshot_t *revocation_snapshot);
+
+/**
+ * Sets the revocation list shared by the verifier processes of the host
+ * (mapped read-only, see rl_shared_open).
+ *
+ * @param parameters the verifier parameters
+ * @param revocation_shared the shared revocation list or NULL (no shared list)
+ * @return 0 if success else -1
+ */
+extern int ve_set_revocation_shared(verifier_par_t *parameters, const revocation_shared_t *revocation_shared);
 
 /**
  * Generates a nonce and an epoch to be used in the proof of knowledge.
@@ -56,10 +134,30 @@ extern "C"
  */
 extern int ve_generate_nonce_epoch(void *nonce, size_t nonce_length, void *epoch, size_t epoch_length);
 
+/**
+ * Recomputes the t values of the proof of knowledge using the verification
+ * kernel selected in the verifier parameters.
+ *
+ * @param sys_parameters the system parameters
+ * @param parameters the verifier parameters
+ * @param ra_parameters the revocation authority parameters
+ * @param ie_keys the issuer keys
+ * @param epoch the epoch generated by the verifier
+ * @param epoch_length the length of the epoch
+ * @param attributes the attributes disclosed by the user
+ * @param ue_credential the credential struct computed by the user
+ * @param ue_pi the pi struct computed by the user
+ * @param t_values the t values
+ * @return 0 if success else -1
+ */
+extern int ve_compute_t_values(system_par_t sys_parameters, verifier_par_t parameters, revocation_authority_par_t ra_parameters, issuer_keys_t ie_keys,
+                               const void *epoch, size_t epoch_length, user_attributes_t attributes, user_credential_t ue_credential, user_pi_t ue_pi, verifier_t_values_t *t_values);
+
 /**
  * Verifies the proof of knowledge of the user attributes.
  *
  * @param sys_parameters the system parameters
+ * @param parameters the verifier parameters
  * @param ra_parameters the revocation authority parameters
  * @param ra_public_key the revocation authority public key
  * @param ie_keys the issuer keys
@@ -72,10 +170,31 @@ extern int ve_generate_nonce_epoch(void *nonce, size_t nonce_length, void *epoch
  * @param ue_pi the pi struct computed by the user
  * @return 0 if success else -1
  */
-extern int ve_verify_proof_of_knowledge(system_par_t sys_parameters, revocation_authority_par_t ra_parameters, revocation_authority_public_key_t ra_public_key,
-                                        issuer_keys_t ie_keys, const void *nonce, size_t nonce_length, const void *epoch, size_t epoch_length,
+extern int ve_verify_proof_of_knowledge(system_par_t sys_parameters, verifier_par_t parameters, revocation_authority_par_t ra_parameters,
+                                        revocation_authority_public_key_t ra_public_key, issuer_keys_t ie_keys, const void *nonce, size_t nonce_length, const void *epoch, size_t epoch_length,
                                         user_attributes_t attributes, user_credential_t ue_credential, user_pi_t ue_pi);
 
+/**
+ * Verifies a batch of proofs of knowledge of the user attributes. The pairing
+ * equations of all the proofs are combined using random weights, so the whole
+ * batch costs one multi-Miller loop and one final exponentiation. If the batch
+ * fails, it is bisected to find out which proofs are invalid.
+ *
+ * @param sys_parameters the system parameters
+ * @param parameters the verifier parameters
+ * @param ra_parameters the revocation authority parameters
+ * @param ra_public_key the revocation authority public key
+ * @param ie_keys the issuer keys
+ * @param epoch the epoch generated by the verifier
+ * @param epoch_length the length of the epoch
+ * @param proofs the proofs computed by the users
+ * @param num_proofs the number of proofs
+ * @param results the result of each proof (0 if valid else -1)
+ * @return 0 if all the proofs are valid else -1
+ */
+extern int ve_verify_proof_of_knowledge_batch(system_par_t sys_parameters, verifier_par_t parameters, revocation_authority_par_t ra_parameters,
+                                              revocation_authority_public_key_t ra_public_key, issuer_keys_t ie_keys, const void *epoch, size_t epoch_length, const verifier_proof_t *proofs, size_t num_proofs, int *results);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,764 @@
+/**
+ *
+ *  Copyright (C) 2020  Raul Casanova Marques
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "rkvac.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <pthread.h>
+
+#include <mcl/bn_c256.h>
+
+#include "config/config.h"
+
+#include "models/issuer.h"
+#include "models/revocation-authority.h"
+#include "models/user.h"
+#include "models/verifier.h"
+#include "revocation/list.h"
+#include "system.h"
+
+#include "setup.h"
+
+#include "controllers/issuer.h"
+#include "controllers/revocation-authority.h"
+#include "controllers/user.h"
+#include "controllers/verifier.h"
+#include "services/verifier.h"
+
+/*
+ * The public lengths must match the configuration of the build
+ */
+typedef char rkvac_check_nonce_length[(RKVAC_NONCE_LENGTH == NONCE_LENGTH) ? 1 : -1];
+typedef char rkvac_check_epoch_length[(RKVAC_EPOCH_LENGTH == EPOCH_LENGTH) ? 1 : -1];
+typedef char rkvac_check_identifier_length[(RKVAC_IDENTIFIER_LENGTH == USER_MAX_ID_LENGTH) ? 1 : -1];
+typedef char rkvac_check_attribute_length[(RKVAC_ATTRIBUTE_LENGTH == EC_SIZE) ? 1 : -1];
+
+struct rkvac_revocation_authority
+{
+    revocation_authority_par_t parameters;
+    revocation_authority_keys_t keys;
+    size_t indices[REVOCATION_AUTHORITY_MAX_J]; // randomizers selected for the epochs
+
+    mclBnFr *revoked_mr; // mr of the revoked users
+    size_t num_revoked;
+};
+
+struct rkvac_issuer
+{
+    const rkvac_revocation_authority_t *ra;
+    issuer_par_t parameters;
+    issuer_keys_t keys;
+};
+
+struct rkvac_user
+{
+    user_identifier_t identifier;
+    user_attributes_t attributes;
+    revocation_authority_signature_t ra_signature; // valid if has_mac
+    issuer_signature_t ie_signature; // valid if has_credential
+    bool has_mac;
+    bool has_credential;
+};
+
+struct rkvac_verifier
+{
+    const rkvac_revocation_authority_t *ra;
+    const rkvac_issuer_t *ie;
+    verifier_par_t parameters;
+
+    uint8_t epoch[EPOCH_LENGTH];
+    revocation_list_t revocation_list; // revoked pseudonyms of the epoch, valid if has_epoch
+    bool has_epoch;
+};
+
+static system_par_t rkvac_sys_parameters;
+static size_t rkvac_references = 0;
+static pthread_mutex_t rkvac_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Initializes mcl and the system parameters shared by all the entities.
+ * The parameters are loaded from the blob if it is valid, otherwise they are
+ * computed (and stored in the blob for the next processes if it can be written).
+ *
+ * @param parameters_path the path of the system parameters blob or NULL
+ * @return 0 if success else -1
+ */
+int rkvac_init(const char *parameters_path)
+{
+    int r = 0;
+
+    pthread_mutex_lock(&rkvac_mutex);
+
+    if (rkvac_references == 0)
+    {
+        r = -1;
+        if (parameters_path != NULL)
+        {
+            r = sys_setup_from_file(&rkvac_sys_parameters, parameters_path);
+        }
+        if (r < 0)
+        {
+            r = sys_setup(&rkvac_sys_parameters);
+            if (r == 0 && parameters_path != NULL)
+            {
+                // the blob is only a cache, the computed parameters are used even if it cannot be written (e.g. read-only path)
+                sys_save(rkvac_sys_parameters, parameters_path);
+            }
+        }
+    }
+    if (r == 0)
+    {
+        rkvac_references++;
+    }
+
+    pthread_mutex_unlock(&rkvac_mutex);
+
+    return r;
+}
+
+/**
+ * Releases the system parameters and the user pseudonym cache when the
+ * last initialization is released.
+ */
+void rkvac_teardown(void)
+{
+    pthread_mutex_lock(&rkvac_mutex);
+
+    if (rkvac_references > 0)
+    {
+        rkvac_references--;
+        if (rkvac_references == 0)
+        {
+            ue_flush_pseudonym_cache();
+            sys_cleanup(&rkvac_sys_parameters);
+        }
+    }
+
+    pthread_mutex_unlock(&rkvac_mutex);
+}
+
+/**
+ * Gets the system parameters shared by all the entities.
+ *
+ * @return the system parameters or NULL if the library is not initialized
+ */
+static const system_par_t *rkvac_get_system_parameters(void)
+{
+    const system_par_t *sys_parameters;
+
+    pthread_mutex_lock(&rkvac_mutex);
+    sys_parameters = rkvac_references > 0 ? &rkvac_sys_parameters : NULL;
+    pthread_mutex_unlock(&rkvac_mutex);
+
+    return sys_parameters;
+}
+
+/**
+ * Gets the length of an encoded proof of knowledge.
+ *
+ * @return the length of the proof
+ */
+size_t rkvac_proof_length(void)
+{
+    return VERIFIER_SERVICE_REQUEST_LENGTH;
+}
+
+/**
+ * Creates a revocation authority: generates its keys and k randomizers
+ * and precomputes its fixed-base tables.
+ *
+ * @param k the number of randomizers (0 - default)
+ * @param j the number of randomizers selected by the user (0 - default)
+ * @return the revocation authority or NULL if error
+ */
+rkvac_revocation_authority_t *rkvac_ra_create(size_t k, size_t j)
+{
+    const system_par_t *sys_parameters = rkvac_get_system_parameters();
+    rkvac_revocation_authority_t *ra;
+    int r;
+
+    if (sys_parameters == NULL)
+    {
+        return NULL;
+    }
+
+    ra = (rkvac_revocation_authority_t *) calloc(1, sizeof(rkvac_revocation_authority_t));
+    if (ra == NULL)
+    {
+        return NULL;
+    }
+
+    r = ra_setup(*sys_parameters, k, j, 0, &ra->parameters, &ra->keys);
+    if (r < 0)
+    {
+        free(ra);
+        return NULL;
+    }
+
+    r = ra_precompute(&ra->parameters);
+    if (r < 0)
+    {
+        ra_cleanup(&ra->parameters);
+        free(ra);
+        return NULL;
+    }
+
+    return ra;
+}
+
+/**
+ * Destroys a revocation authority.
+ *
+ * @param ra the revocation authority
+ */
+void rkvac_ra_destroy(rkvac_revocation_authority_t *ra)
+{
+    if (ra == NULL)
+    {
+        return;
+    }
+
+    ra_cleanup(&ra->parameters);
+    free(ra->revoked_mr);
+
+    // the private key must not stay in the released memory
+    memset(ra, 0, sizeof(rkvac_revocation_authority_t));
+    free(ra);
+}
+
+/**
+ * Computes the MAC of the identifier of the user, which gets its revocation attribute.
+ *
+ * @param ra the revocation authority
+ * @param user the user
+ * @return 0 if success else -1
+ */
+int rkvac_ra_mac(const rkvac_revocation_authority_t *ra, rkvac_user_t *user)
+{
+    const system_par_t *sys_parameters = rkvac_get_system_parameters();
+    int r;
+
+    if (sys_parameters == NULL || ra == NULL || user == NULL)
+    {
+        return -1;
+    }
+
+    r = ra_mac(*sys_parameters, ra->keys.private_key, NULL, user->identifier, &user->ra_signature);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    // the previous credential was issued for another revocation attribute
+    user->has_mac = true;
+    user->has_credential = false;
+
+    return 0;
+}
+
+/**
+ * Revokes a user, its pseudonyms are in the revocation lists of the next
+ * epochs (see rkvac_ve_set_epoch).
+ *
+ * @param ra the revocation authority
+ * @param user the user (with the MAC of the revocation authority)
+ * @return 0 if success else -1
+ */
+int rkvac_ra_revoke(rkvac_revocation_authority_t *ra, const rkvac_user_t *user)
+{
+    mclBnFr *revoked_mr;
+
+    if (rkvac_get_system_parameters() == NULL || ra == NULL || user == NULL || !user->has_mac)
+    {
+        return -1;
+    }
+
+    revoked_mr = (mclBnFr *) realloc(ra->revoked_mr, (ra->num_revoked + 1) * sizeof(mclBnFr));
+    if (revoked_mr == NULL)
+    {
+        return -1;
+    }
+
+    revoked_mr[ra->num_revoked++] = user->ra_signature.mr;
+    ra->revoked_mr = revoked_mr;
+
+    return 0;
+}
+
+/**
+ * Creates an issuer of credentials with num_attributes attributes
+ * accepting the users of the revocation authority.
+ *
+ * @param ra the revocation authority
+ * @param num_attributes the number of user attributes
+ * @return the issuer or NULL if error
+ */
+rkvac_issuer_t *rkvac_ie_create(const rkvac_revocation_authority_t *ra, size_t num_attributes)
+{
+    const system_par_t *sys_parameters = rkvac_get_system_parameters();
+    rkvac_issuer_t *ie;
+    int r;
+
+    if (sys_parameters == NULL || ra == NULL || num_attributes == 0 || num_attributes > USER_MAX_NUM_ATTRIBUTES)
+    {
+        return NULL;
+    }
+
+    ie = (rkvac_issuer_t *) calloc(1, sizeof(rkvac_issuer_t));
+    if (ie == NULL)
+    {
+        return NULL;
+    }
+
+    ie->ra = ra;
+    ie->parameters.num_attributes = num_attributes;
+
+    r = ie_setup(ie->parameters, &ie->keys);
+    if (r == 0)
+    {
+        r = ie_precompute(*sys_parameters, ra->keys.public_key, &ie->parameters);
+    }
+    if (r < 0)
+    {
+        ie_cleanup(&ie->parameters);
+        free(ie);
+        return NULL;
+    }
+
+    return ie;
+}
+
+/**
+ * Destroys an issuer.
+ *
+ * @param ie the issuer
+ */
+void rkvac_ie_destroy(rkvac_issuer_t *ie)
+{
+    if (ie == NULL)
+    {
+        return;
+    }
+
+    ie_cleanup(&ie->parameters);
+
+    // the private keys must not stay in the released memory
+    memset(ie, 0, sizeof(rkvac_issuer_t));
+    free(ie);
+}
+
+/**
+ * Verifies the MAC of the revocation authority on the user identifier and
+ * signs the attributes of the user.
+ *
+ * @param ie the issuer
+ * @param user the user
+ * @return 0 if success else -1
+ */
+int rkvac_ie_issue(const rkvac_issuer_t *ie, rkvac_user_t *user)
+{
+    const system_par_t *sys_parameters = rkvac_get_system_parameters();
+    int r;
+
+    if (sys_parameters == NULL || ie == NULL || user == NULL || !user->has_mac || user->attributes.num_attributes != ie->parameters.num_attributes)
+    {
+        return -1;
+    }
+
+    r = ie_issue(*sys_parameters, ie->parameters, ie->keys, user->identifier, user->attributes, ie->ra->keys.public_key, user->ra_signature, &user->ie_signature);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    user->has_credential = true;
+
+    return 0;
+}
+
+/**
+ * Creates a user.
+ *
+ * @param identifier the identifier of the user (RKVAC_IDENTIFIER_LENGTH) or NULL (identifier of the device)
+ * @param identifier_length the length of the identifier
+ * @param num_attributes the number of attributes (the values of the device by default)
+ * @return the user or NULL if error
+ */
+rkvac_user_t *rkvac_ue_create(const void *identifier, size_t identifier_length, size_t num_attributes)
+{
+    rkvac_user_t *user;
+    int r;
+
+    if (rkvac_get_system_parameters() == NULL || num_attributes == 0 || num_attributes > USER_MAX_NUM_ATTRIBUTES)
+    {
+        return NULL;
+    }
+
+    if (identifier != NULL && (identifier_length == 0 || identifier_length > USER_MAX_ID_LENGTH))
+    {
+        return NULL;
+    }
+
+    user = (rkvac_user_t *) calloc(1, sizeof(rkvac_user_t));
+    if (user == NULL)
+    {
+        return NULL;
+    }
+
+    if (identifier != NULL)
+    {
+        memcpy(user->identifier.buffer, identifier, identifier_length);
+        user->identifier.buffer_length = identifier_length;
+        r = 0;
+    }
+    else
+    {
+        r = ue_get_user_identifier(NULL, &user->identifier);
+    }
+    if (r == 0)
+    {
+        user->attributes.num_attributes = num_attributes;
+        r = ue_get_user_attributes_identifier(NULL, &user->attributes, &user->identifier, &user->ra_signature);
+    }
+    if (r < 0)
+    {
+        free(user);
+        return NULL;
+    }
+
+    return user;
+}
+
+/**
+ * Destroys a user.
+ *
+ * @param user the user
+ */
+void rkvac_ue_destroy(rkvac_user_t *user)
+{
+    if (user == NULL)
+    {
+        return;
+    }
+
+    // the credential must not stay in the released memory
+    memset(user, 0, sizeof(rkvac_user_t));
+    free(user);
+}
+
+/**
+ * Sets the value of an attribute of the user (before the credential is issued).
+ *
+ * @param user the user
+ * @param index the index of the attribute
+ * @param value the value of the attribute (big-endian, lower than the order of the group)
+ * @param value_length the length of the value (RKVAC_ATTRIBUTE_LENGTH)
+ * @return 0 if success else -1
+ */
+int rkvac_ue_set_attribute(rkvac_user_t *user, size_t index, const void *value, size_t value_length)
+{
+    if (user == NULL || user->has_credential || index >= user->attributes.num_attributes || value == NULL || value_length != EC_SIZE)
+    {
+        return -1;
+    }
+
+    memcpy(user->attributes.attributes[index].value, value, EC_SIZE);
+
+    return 0;
+}
+
+/**
+ * Computes the proof of knowledge of the credential of the user disclosing
+ * its last num_disclosed_attributes attributes.
+ *
+ * @param user the user (with its credential)
+ * @param ra the revocation authority
+ * @param nonce the nonce generated by the verifier
+ * @param nonce_length the length of the nonce (RKVAC_NONCE_LENGTH)
+ * @param epoch the epoch generated by the verifier
+ * @param epoch_length the length of the epoch (RKVAC_EPOCH_LENGTH)
+ * @param num_disclosed_attributes the number of disclosed attributes
+ * @param proof the buffer where the encoded proof will be stored
+ * @param proof_length the length of the buffer (rkvac_proof_length)
+ * @return 0 if success else -1
+ */
+int rkvac_ue_compute_proof(const rkvac_user_t *user, const rkvac_revocation_authority_t *ra, const void *nonce, size_t nonce_length,
+                           const void *epoch, size_t epoch_length, size_t num_disclosed_attributes, void *proof, size_t proof_length)
+{
+    const system_par_t *sys_parameters = rkvac_get_system_parameters();
+
+    user_attributes_t attributes;
+    user_credential_t credential;
+    user_pi_t pi;
+
+    int r;
+
+    if (sys_parameters == NULL || user == NULL || ra == NULL || !user->has_credential || nonce_length != NONCE_LENGTH || epoch_length != EPOCH_LENGTH)
+    {
+        return -1;
+    }
+
+    // the disclosed flags are set on a copy, the user is only read
+    attributes = user->attributes;
+
+    r = ue_compute_proof_of_knowledge(NULL, *sys_parameters, ra->parameters, user->ra_signature, user->ie_signature, ra->indices, nonce, nonce_length,
+                                      epoch, epoch_length, &attributes, num_disclosed_attributes, &credential, &pi);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    return ve_service_encode_request(proof, proof_length, nonce, nonce_length, attributes, credential, pi);
+}
+
+/**
+ * Creates a verifier of the credentials of the issuer.
+ *
+ * @param ra the revocation authority
+ * @param ie the issuer
+ * @return the verifier or NULL if error
+ */
+rkvac_verifier_t *rkvac_ve_create(const rkvac_revocation_authority_t *ra, const rkvac_issuer_t *ie)
+{
+    const system_par_t *sys_parameters = rkvac_get_system_parameters();
+    rkvac_verifier_t *ve;
+    int r;
+
+    if (sys_parameters == NULL || ra == NULL || ie == NULL || ie->ra != ra)
+    {
+        return NULL;
+    }
+
+    ve = (rkvac_verifier_t *) calloc(1, sizeof(rkvac_verifier_t));
+    if (ve == NULL)
+    {
+        return NULL;
+    }
+
+    ve->ra = ra;
+    ve->ie = ie;
+
+    r = ve_setup(*sys_parameters, ra->keys.public_key, &ve->parameters);
+    if (r < 0)
+    {
+        free(ve);
+        return NULL;
+    }
+
+    return ve;
+}
+
+/**
+ * Destroys a verifier.
+ *
+ * @param ve the verifier
+ */
+void rkvac_ve_destroy(rkvac_verifier_t *ve)
+{
+    if (ve == NULL)
+    {
+        return;
+    }
+
+    ve_cleanup(&ve->parameters);
+    if (ve->has_epoch)
+    {
+        rl_destroy(&ve->revocation_list);
+    }
+
+    free(ve);
+}
+
+/**
+ * Generates a nonce and an epoch to be used in the proof of knowledge.
+ *
+ * @param nonce the nonce
+ * @param nonce_length the length of the nonce (RKVAC_NONCE_LENGTH)
+ * @param epoch the epoch
+ * @param epoch_length the length of the epoch (RKVAC_EPOCH_LENGTH)
+ * @return 0 if success else -1
+ */
+int rkvac_ve_generate_nonce_epoch(void *nonce, size_t nonce_length, void *epoch, size_t epoch_length)
+{
+    return ve_generate_nonce_epoch(nonce, nonce_length, epoch, epoch_length);
+}
+
+/**
+ * Sets the epoch of the verifier and computes its revocation list from the
+ * users revoked by the revocation authority.
+ *
+ * @param ve the verifier
+ * @param epoch the epoch
+ * @param epoch_length the length of the epoch (RKVAC_EPOCH_LENGTH)
+ * @return 0 if success else -1
+ */
+int rkvac_ve_set_epoch(rkvac_verifier_t *ve, const void *epoch, size_t epoch_length)
+{
+    const system_par_t *sys_parameters = rkvac_get_system_parameters();
+    revocation_list_t revocation_list;
+    int r;
+
+    if (sys_parameters == NULL || ve == NULL || epoch == NULL || epoch_length != EPOCH_LENGTH)
+    {
+        return -1;
+    }
+
+    r = ra_revoked_pseudonyms(*sys_parameters, ve->ra->parameters, ve->ra->indices, ve->ra->revoked_mr, ve->ra->num_revoked, epoch, epoch_length, 0,
+                              &revocation_list);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    // the list of the previous epoch is kept until the new one is computed
+    if (ve->has_epoch)
+    {
+        rl_destroy(&ve->revocation_list);
+    }
+    ve->revocation_list = revocation_list;
+    ve->has_epoch = true;
+    memcpy(ve->epoch, epoch, EPOCH_LENGTH);
+
+    return ve_set_revocation_list(&ve->parameters, &ve->revocation_list);
+}
+
+/**
+ * Verifies an encoded proof of knowledge computed for the nonce and the
+ * epoch of the verifier.
+ *
+ * @param ve the verifier
+ * @param nonce the nonce
+ * @param nonce_length the length of the nonce (RKVAC_NONCE_LENGTH)
+ * @param proof the encoded proof
+ * @param proof_length the length of the proof (rkvac_proof_length)
+ * @return 0 if valid else -1
+ */
+int rkvac_ve_verify(const rkvac_verifier_t *ve, const void *nonce, size_t nonce_length, const void *proof, size_t proof_length)
+{
+    const system_par_t *sys_parameters = rkvac_get_system_parameters();
+    verifier_service_request_t *request;
+    int r;
+
+    if (sys_parameters == NULL || ve == NULL || !ve->has_epoch || nonce == NULL || nonce_length != NONCE_LENGTH || proof == NULL)
+    {
+        return -1;
+    }
+
+    request = (verifier_service_request_t *) malloc(sizeof(verifier_service_request_t));
+    if (request == NULL)
+    {
+        return -1;
+    }
+
+    r = ve_service_decode_request(proof, proof_length, request);
+    if (r == 0)
+    {
+        // the proof must have been computed for this nonce
+        r = memcmp(request->nonce, nonce, NONCE_LENGTH) == 0 ? 0 : -1;
+    }
+    if (r == 0)
+    {
+        r = ve_verify_proof_of_knowledge(*sys_parameters, ve->parameters, ve->ra->parameters, ve->ra->keys.public_key, ve->ie->keys, request->nonce,
+                                         NONCE_LENGTH, ve->epoch, EPOCH_LENGTH, request->proof.attributes, request->proof.ue_credential,
+                                         request->proof.ue_pi);
+    }
+
+    free(request);
+
+    return r;
+}
+
+/**
+ * Verifies several encoded proofs of knowledge of the epoch of the verifier at
+ * once (each proof carries its own nonce, it must be checked by the caller).
+ *
+ * @param ve the verifier
+ * @param proofs the encoded proofs, one after the other
+ * @param num_proofs the number of proofs
+ * @param results the result of each proof (0 if valid else -1)
+ * @return 0 if all the proofs are valid else -1
+ */
+int rkvac_ve_verify_batch(const rkvac_verifier_t *ve, const void *proofs, size_t num_proofs, int *results)
+{
+    const system_par_t *sys_parameters = rkvac_get_system_parameters();
+    const uint8_t *data = (const uint8_t *) proofs;
+
+    verifier_service_request_t *requests = NULL;
+    verifier_proof_t *decoded = NULL;
+    int *decoded_results = NULL;
+    size_t *decoded_indices = NULL;
+    size_t num_decoded;
+
+    size_t it;
+    int r;
+
+    if (sys_parameters == NULL || ve == NULL || !ve->has_epoch || proofs == NULL || num_proofs == 0 || results == NULL)
+    {
+        return -1;
+    }
+
+    requests = (verifier_service_request_t *) malloc(num_proofs * sizeof(verifier_service_request_t));
+    decoded = (verifier_proof_t *) malloc(num_proofs * sizeof(verifier_proof_t));
+    decoded_results = (int *) malloc(num_proofs * sizeof(int));
+    decoded_indices = (size_t *) malloc(num_proofs * sizeof(size_t));
+    if (requests == NULL || decoded == NULL || decoded_results == NULL || decoded_indices == NULL)
+    {
+        r = -1;
+        goto cleanup;
+    }
+
+    // the malformed proofs are invalid, the others are verified at once
+    for (it = 0, num_decoded = 0; it < num_proofs; it++)
+    {
+        results[it] = -1;
+        r = ve_service_decode_request(&data[it * VERIFIER_SERVICE_REQUEST_LENGTH], VERIFIER_SERVICE_REQUEST_LENGTH, &requests[it]);
+        if (r == 0)
+        {
+            decoded[num_decoded] = requests[it].proof;
+            decoded_indices[num_decoded++] = it;
+        }
+    }
+
+    r = num_decoded == num_proofs ? 0 : -1;
+    if (num_decoded > 0)
+    {
+        if (ve_verify_proof_of_knowledge_batch(*sys_parameters, ve->parameters, ve->ra->parameters, ve->ra->keys.public_key, ve->ie->keys, ve->epoch,
+                                               EPOCH_LENGTH, decoded, num_decoded, decoded_results) < 0)
+        {
+            r = -1;
+        }
+        for (it = 0; it < num_decoded; it++)
+        {
+            results[decoded_indices[it]] = decoded_results[it];
+        }
+    }
+
+cleanup:
+    free(decoded_indices);
+    free(decoded_results);
+    free(decoded);
+    free(requests);
+
+    return r;
+}
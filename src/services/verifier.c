@@ -0,0 +1,852 @@
+/**
+ *
+ *  Copyright (C) 2020  Raul Casanova Marques
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "verifier.h"
+
+#ifndef MSG_NOSIGNAL
+# define MSG_NOSIGNAL 0
+#endif
+
+/**
+ * Encodes a proof of knowledge as a request of the verifier service.
+ *
+ * @param buffer the buffer where the request will be stored
+ * @param buffer_length the length of the buffer (VERIFIER_SERVICE_REQUEST_LENGTH)
+ * @param nonce the nonce generated by the verifier
+ * @param nonce_length the length of the nonce
+ * @param attributes the attributes disclosed by the user
+ * @param ue_credential the credential struct computed by the user
+ * @param ue_pi the pi struct computed by the user
+ * @return 0 if success else -1
+ */
+int ve_service_encode_request(void *buffer, size_t buffer_length, const void *nonce, size_t nonce_length,
+                              user_attributes_t attributes, user_credential_t ue_credential, user_pi_t ue_pi)
+{
+    const mclBnG1 *points[] = {&ue_credential.pseudonym, &ue_credential.sigma_hat};
+    const mclBnFr *values[] = {&ue_pi.e, &ue_pi.s_v, &ue_pi.s_mr, &ue_pi.s_i};
+
+    uint8_t *data = (uint8_t *) buffer;
+
+    size_t it;
+    int r;
+
+    if (buffer == NULL || buffer_length != VERIFIER_SERVICE_REQUEST_LENGTH || nonce == NULL || nonce_length != NONCE_LENGTH)
+    {
+        return -1;
+    }
+
+    if (attributes.num_attributes == 0 || attributes.num_attributes > USER_MAX_NUM_ATTRIBUTES)
+    {
+        return -1;
+    }
+
+    if (ue_credential.num_randomizers == 0 || ue_credential.num_randomizers > REVOCATION_AUTHORITY_MAX_J)
+    {
+        return -1;
+    }
+
+    memset(buffer, 0, buffer_length);
+
+    // nonce
+    memcpy(data, nonce, NONCE_LENGTH);
+    data += NONCE_LENGTH;
+
+    // attributes (only the values of the disclosed attributes)
+    *data++ = attributes.num_attributes;
+    for (it = 0; it < attributes.num_attributes; it++)
+    {
+        data[0] = attributes.attributes[it].disclosed == true ? 1 : 0;
+        if (attributes.attributes[it].disclosed == true)
+        {
+            memcpy(&data[1], attributes.attributes[it].value, EC_SIZE);
+        }
+        data += 1 + EC_SIZE;
+    }
+    data += (USER_MAX_NUM_ATTRIBUTES - attributes.num_attributes) * (1 + EC_SIZE);
+
+    // credential (only the points of the j randomizers)
+    for (it = 0; it < sizeof(points) / sizeof(points[0]); it++)
+    {
+        r = mcl_G1_to_bytes(data, ECP_SIZE, *points[it]);
+        if (r < 0)
+        {
+            return -1;
+        }
+        data += ECP_SIZE;
+    }
+    *data++ = ue_credential.num_randomizers;
+    for (it = 0; it < ue_credential.num_randomizers; it++)
+    {
+        r = mcl_G1_to_bytes(data, ECP_SIZE, ue_credential.sigma_hat_e[it]);
+        r |= mcl_G1_to_bytes(data + ECP_SIZE, ECP_SIZE, ue_credential.sigma_minus_e[it]);
+        if (r < 0)
+        {
+            return -1;
+        }
+        data += 2 * ECP_SIZE;
+    }
+    data += (REVOCATION_AUTHORITY_MAX_J - ue_credential.num_randomizers) * 2 * ECP_SIZE;
+
+    // pi
+    for (it = 0; it < sizeof(values) / sizeof(values[0]); it++)
+    {
+        r = mcl_Fr_to_bytes(data, EC_SIZE, *values[it]);
+        if (r < 0)
+        {
+            return -1;
+        }
+        data += EC_SIZE;
+    }
+    for (it = 0; it < ue_credential.num_randomizers; it++)
+    {
+        r = mcl_Fr_to_bytes(data, EC_SIZE, ue_pi.s_e[it]);
+        if (r < 0)
+        {
+            return -1;
+        }
+        data += EC_SIZE;
+    }
+    data += (REVOCATION_AUTHORITY_MAX_J - ue_credential.num_randomizers) * EC_SIZE;
+    for (it = 0; it < attributes.num_attributes; it++)
+    {
+        if (attributes.attributes[it].disclosed == false)
+        {
+            r = mcl_Fr_to_bytes(data, EC_SIZE, ue_pi.s_mz[it]);
+            if (r < 0)
+            {
+                return -1;
+            }
+        }
+        data += EC_SIZE;
+    }
+
+    return 0;
+}
+
+/**
+ * Decodes a request of the verifier service (the proof of knowledge points to
+ * the nonce of the request).
+ *
+ * @param buffer the buffer containing the request
+ * @param buffer_length the length of the buffer (VERIFIER_SERVICE_REQUEST_LENGTH)
+ * @param request the request
+ * @return 0 if success else -1
+ */
+int ve_service_decode_request(const void *buffer, size_t buffer_length, verifier_service_request_t *request)
+{
+    mclBnG1 *points[2];
+    mclBnFr *values[4];
+
+    const uint8_t *data = (const uint8_t *) buffer;
+    user_attributes_t *attributes = &request->proof.attributes;
+    user_credential_t *credential = &request->proof.ue_credential;
+
+    size_t it;
+    int r;
+
+    if (buffer_length != VERIFIER_SERVICE_REQUEST_LENGTH)
+    {
+        return -1;
+    }
+
+    points[0] = &credential->pseudonym;
+    points[1] = &credential->sigma_hat;
+
+    values[0] = &request->proof.ue_pi.e;
+    values[1] = &request->proof.ue_pi.s_v;
+    values[2] = &request->proof.ue_pi.s_mr;
+    values[3] = &request->proof.ue_pi.s_i;
+
+    // nonce
+    memcpy(request->nonce, data, NONCE_LENGTH);
+    request->proof.nonce = request->nonce;
+    request->proof.nonce_length = NONCE_LENGTH;
+    data += NONCE_LENGTH;
+
+    // attributes
+    attributes->num_attributes = *data++;
+    if (attributes->num_attributes == 0 || attributes->num_attributes > USER_MAX_NUM_ATTRIBUTES)
+    {
+        return -1;
+    }
+    for (it = 0; it < attributes->num_attributes; it++)
+    {
+        attributes->attributes[it].disclosed = data[0] == 1 ? true : false;
+        memcpy(attributes->attributes[it].value, &data[1], EC_SIZE);
+        data += 1 + EC_SIZE;
+    }
+    data += (USER_MAX_NUM_ATTRIBUTES - attributes->num_attributes) * (1 + EC_SIZE);
+
+    // credential
+    for (it = 0; it < sizeof(points) / sizeof(points[0]); it++)
+    {
+        r = mcl_bytes_to_G1(points[it], data, ECP_SIZE);
+        if (r < 0)
+        {
+            return -1;
+        }
+        data += ECP_SIZE;
+    }
+    credential->num_randomizers = *data++;
+    if (credential->num_randomizers == 0 || credential->num_randomizers > REVOCATION_AUTHORITY_MAX_J)
+    {
+        return -1;
+    }
+    for (it = 0; it < credential->num_randomizers; it++)
+    {
+        r = mcl_bytes_to_G1(&credential->sigma_hat_e[it], data, ECP_SIZE);
+        r |= mcl_bytes_to_G1(&credential->sigma_minus_e[it], data + ECP_SIZE, ECP_SIZE);
+        if (r < 0)
+        {
+            return -1;
+        }
+        data += 2 * ECP_SIZE;
+    }
+    data += (REVOCATION_AUTHORITY_MAX_J - credential->num_randomizers) * 2 * ECP_SIZE;
+
+    // pi
+    for (it = 0; it < sizeof(values) / sizeof(values[0]); it++)
+    {
+        r = mcl_bytes_to_Fr(values[it], data, EC_SIZE);
+        if (r < 0)
+        {
+            return -1;
+        }
+        data += EC_SIZE;
+    }
+    for (it = 0; it < credential->num_randomizers; it++)
+    {
+        r = mcl_bytes_to_Fr(&request->proof.ue_pi.s_e[it], data, EC_SIZE);
+        if (r < 0)
+        {
+            return -1;
+        }
+        data += EC_SIZE;
+    }
+    data += (REVOCATION_AUTHORITY_MAX_J - credential->num_randomizers) * EC_SIZE;
+    for (it = 0; it < attributes->num_attributes; it++)
+    {
+        if (attributes->attributes[it].disclosed == false)
+        {
+            r = mcl_bytes_to_Fr(&request->proof.ue_pi.s_mz[it], data, EC_SIZE);
+            if (r < 0)
+            {
+                return -1;
+            }
+        }
+        data += EC_SIZE;
+    }
+
+    return 0;
+}
+
+/**
+ * Sends the response to the client and releases the request.
+ *
+ * @param request the request
+ * @param response the response
+ */
+static void ve_service_respond(verifier_service_request_t *request, uint8_t response)
+{
+    ssize_t length;
+
+    length = send(request->fd, &response, sizeof(response), MSG_NOSIGNAL);
+    (void) length; // the client may have gone away
+
+    close(request->fd);
+    free(request);
+}
+
+/**
+ * Worker thread of the verifier service. Takes the requests of the queue in
+ * batches (as many as available, up to VERIFIER_SERVICE_BATCH_SIZE) so that the
+ * batch verification is used under load.
+ *
+ * @param argument the worker
+ * @return NULL
+ */
+static void *ve_service_worker(void *argument)
+{
+    verifier_service_worker_t *worker = (verifier_service_worker_t *) argument;
+    verifier_service_t *service = worker->service;
+
+    uint8_t epoch[EPOCH_LENGTH];
+
+    size_t num_requests, num_decoded;
+    size_t it;
+    int r;
+
+    for (;;)
+    {
+        // wait for the first request
+        r = sem_wait(&service->num_requests);
+        if (r < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+
+        // ve_service_run is the only producer and posts after each push, so the request is visible
+        r = mpmc_queue_pop(&service->queue, (void **) &worker->requests[0]);
+        if (r < 0)
+        {
+            // woken up to stop
+            if (__atomic_load_n(&service->running, __ATOMIC_ACQUIRE) == 0)
+            {
+                break;
+            }
+            continue;
+        }
+        num_requests = 1;
+
+        // take the requests already queued
+        while (num_requests < VERIFIER_SERVICE_BATCH_SIZE && sem_trywait(&service->num_requests) == 0)
+        {
+            r = mpmc_queue_pop(&service->queue, (void **) &worker->requests[num_requests]);
+            if (r < 0)
+            {
+                // stop token, give it back to the other workers
+                sem_post(&service->num_requests);
+                break;
+            }
+            num_requests++;
+        }
+
+        // the requests are decoded by the workers, the accept loop only receives them
+        for (it = 0, num_decoded = 0; it < num_requests; it++)
+        {
+            r = ve_service_decode_request(worker->requests[it]->buffer, sizeof(worker->requests[it]->buffer), worker->requests[it]);
+            if (r < 0)
+            {
+                ve_service_respond(worker->requests[it], VERIFIER_SERVICE_RESPONSE_MALFORMED);
+                continue;
+            }
+            worker->requests[num_decoded++] = worker->requests[it];
+        }
+        num_requests = num_decoded;
+        if (num_requests == 0)
+        {
+            continue;
+        }
+
+        pthread_mutex_lock(&service->epoch_mutex);
+        memcpy(epoch, service->epoch, EPOCH_LENGTH);
+        pthread_mutex_unlock(&service->epoch_mutex);
+
+        if (num_requests == 1)
+        {
+            worker->results[0] = ve_verify_proof_of_knowledge(service->sys_parameters, worker->parameters, service->ra_parameters, service->ra_public_key,
+                                                              service->ie_keys, worker->requests[0]->nonce, NONCE_LENGTH, epoch, EPOCH_LENGTH,
+                                                              worker->requests[0]->proof.attributes, worker->requests[0]->proof.ue_credential,
+                                                              worker->requests[0]->proof.ue_pi);
+        }
+        else
+        {
+            for (it = 0; it < num_requests; it++)
+            {
+                memcpy(&worker->proofs[it], &worker->requests[it]->proof, sizeof(verifier_proof_t));
+            }
+
+            ve_verify_proof_of_knowledge_batch(service->sys_parameters, worker->parameters, service->ra_parameters, service->ra_public_key,
+                                               service->ie_keys, epoch, EPOCH_LENGTH, worker->proofs, num_requests, worker->results);
+        }
+
+        for (it = 0; it < num_requests; it++)
+        {
+            ve_service_respond(worker->requests[it], worker->results[it] == 0 ? VERIFIER_SERVICE_RESPONSE_VALID : VERIFIER_SERVICE_RESPONSE_INVALID);
+            worker->requests[it] = NULL;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Starts the verifier service: binds the Unix domain socket and starts the worker
+ * threads. The system must be initialized (mclBn_init) before starting the service,
+ * the mcl state is only read by the workers.
+ *
+ * @param service the verifier service
+ * @param sys_parameters the system parameters
+ * @param parameters the verifier parameters
+ * @param ra_parameters the revocation authority parameters
+ * @param ra_public_key the revocation authority public key
+ * @param ie_keys the issuer keys
+ * @param epoch the current epoch
+ * @param epoch_length the length of the epoch
+ * @param socket_path the path of the Unix domain socket
+ * @param num_workers the number of worker threads (0 - one per core)
+ * @return 0 if success else -1
+ */
+int ve_service_start(verifier_service_t *service, system_par_t sys_parameters, verifier_par_t parameters, revocation_authority_par_t ra_parameters,
+                     revocation_authority_public_key_t ra_public_key, issuer_keys_t ie_keys, const void *epoch, size_t epoch_length,
+                     const char *socket_path, size_t num_workers)
+{
+    struct sockaddr_un address;
+    long num_cores;
+
+    size_t it;
+    int r;
+
+    if (service == NULL || epoch == NULL || epoch_length != EPOCH_LENGTH || socket_path == NULL || strlen(socket_path) >= sizeof(address.sun_path))
+    {
+        return -1;
+    }
+
+    memset(service, 0, sizeof(verifier_service_t));
+    service->socket_fd = -1;
+
+    memcpy(&service->sys_parameters, &sys_parameters, sizeof(system_par_t));
+    memcpy(&service->parameters, &parameters, sizeof(verifier_par_t));
+    // the workers verify different proofs at the same time, a shared pool would serialize them
+    service->parameters.thread_pool = NULL;
+    service->parameters.profile = NULL;
+    // the reader slot of the snapshot belongs to the caller, each worker registers its own
+    service->parameters.revocation_reader = 0;
+    memcpy(&service->ra_parameters, &ra_parameters, sizeof(revocation_authority_par_t));
+    memcpy(&service->ra_public_key, &ra_public_key, sizeof(revocation_authority_public_key_t));
+    memcpy(&service->ie_keys, &ie_keys, sizeof(issuer_keys_t));
+    memcpy(service->epoch, epoch, EPOCH_LENGTH);
+    strcpy(service->socket_path, socket_path);
+
+    // one worker per core by default
+    if (num_workers == 0)
+    {
+        num_cores = sysconf(_SC_NPROCESSORS_ONLN);
+        num_workers = num_cores > 0 ? (size_t) num_cores : 1;
+    }
+
+    r = mpmc_queue_init(&service->queue, VERIFIER_SERVICE_QUEUE_SIZE);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    r = sem_init(&service->num_requests, 0, 0);
+    if (r < 0)
+    {
+        mpmc_queue_destroy(&service->queue);
+        return -1;
+    }
+    pthread_mutex_init(&service->epoch_mutex, NULL);
+
+    /// socket
+    service->socket_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (service->socket_fd < 0)
+    {
+        ve_service_stop(service);
+        return -1;
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, socket_path);
+
+    unlink(socket_path);
+    r = bind(service->socket_fd, (struct sockaddr *) &address, sizeof(address));
+    if (r < 0)
+    {
+        ve_service_stop(service);
+        return -1;
+    }
+
+    r = listen(service->socket_fd, SOMAXCONN);
+    if (r < 0)
+    {
+        ve_service_stop(service);
+        return -1;
+    }
+
+    // the accept loop never blocks on a single connection
+    r = fcntl(service->socket_fd, F_SETFL, fcntl(service->socket_fd, F_GETFL) | O_NONBLOCK);
+    if (r < 0)
+    {
+        ve_service_stop(service);
+        return -1;
+    }
+
+    /// workers
+    service->workers = calloc(num_workers, sizeof(verifier_service_worker_t));
+    if (service->workers == NULL)
+    {
+        ve_service_stop(service);
+        return -1;
+    }
+
+    __atomic_store_n(&service->running, 1, __ATOMIC_RELEASE);
+    for (it = 0; it < num_workers; it++)
+    {
+        service->workers[it].service = service;
+        memcpy(&service->workers[it].parameters, &service->parameters, sizeof(verifier_par_t));
+        if (service->parameters.revocation_snapshot != NULL)
+        {
+            r = rs_register_reader(service->parameters.revocation_snapshot, &service->workers[it].parameters.revocation_reader);
+            if (r < 0)
+            {
+                ve_service_stop(service);
+                return -1;
+            }
+        }
+
+        r = pthread_create(&service->workers[it].thread, NULL, ve_service_worker, &service->workers[it]);
+        if (r != 0)
+        {
+            if (service->parameters.revocation_snapshot != NULL)
+            {
+                rs_unregister_reader(service->parameters.revocation_snapshot, service->workers[it].parameters.revocation_reader);
+            }
+            ve_service_stop(service);
+            return -1;
+        }
+        service->num_workers++;
+    }
+
+    return 0;
+}
+
+/**
+ * Sets the epoch used to verify the next requests. When the service reads a
+ * revocation list snapshot, the list of the new epoch is published (rs_publish)
+ * just before, the workers do not stop meanwhile.
+ *
+ * @param service the verifier service
+ * @param epoch the current epoch
+ * @param epoch_length the length of the epoch
+ * @return 0 if success else -1
+ */
+int ve_service_set_epoch(verifier_service_t *service, const void *epoch, size_t epoch_length)
+{
+    if (service == NULL || epoch == NULL || epoch_length != EPOCH_LENGTH)
+    {
+        return -1;
+    }
+
+    pthread_mutex_lock(&service->epoch_mutex);
+    memcpy(service->epoch, epoch, EPOCH_LENGTH);
+    pthread_mutex_unlock(&service->epoch_mutex);
+
+    return 0;
+}
+
+/**
+ * Sets the delta log tailed by the service, the deltas are applied to the
+ * revocation list snapshot of the verifier parameters between the requests.
+ * When a rebuild of the next epoch is applied, the service moves to that epoch.
+ *
+ * @param service the verifier service
+ * @param delta the delta log or NULL
+ * @return 0 if success else -1
+ */
+int ve_service_set_revocation_delta(verifier_service_t *service, revocation_delta_t *delta)
+{
+    if (service == NULL || (delta != NULL && service->parameters.revocation_snapshot == NULL))
+    {
+        return -1;
+    }
+
+    service->revocation_delta = delta;
+
+    return 0;
+}
+
+/**
+ * Applies the new deltas of the tailed delta log (the service is the only
+ * writer of the revocation list snapshot).
+ *
+ * @param service the verifier service
+ */
+static void ve_service_apply_delta(verifier_service_t *service)
+{
+    const revocation_list_t *list;
+    size_t num_applied;
+    int r;
+
+    if (service->revocation_delta == NULL)
+    {
+        return;
+    }
+
+    r = rl_delta_apply(service->revocation_delta, service->parameters.revocation_snapshot, &num_applied);
+    if (r < 0 || num_applied == 0)
+    {
+        return;
+    }
+
+    list = service->parameters.revocation_snapshot->current;
+    if (list != NULL && memcmp(list->header->epoch, service->epoch, EPOCH_LENGTH) != 0)
+    {
+        ve_service_set_epoch(service, list->header->epoch, EPOCH_LENGTH);
+    }
+}
+
+/**
+ * Gets the time of the monotonic clock.
+ *
+ * @return the time in milliseconds
+ */
+static uint64_t ve_service_get_time(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t) now.tv_sec * 1000 + (uint64_t) now.tv_nsec / 1000000;
+}
+
+/**
+ * Reads the available part of the request of the client (the connection is
+ * non-blocking).
+ *
+ * @param request the request
+ * @return 1 if the whole request has been received, 0 if more data is expected, -1 if error
+ */
+static int ve_service_receive(verifier_service_request_t *request)
+{
+    ssize_t length;
+
+    while (request->received < sizeof(request->buffer))
+    {
+        length = recv(request->fd, &request->buffer[request->received], sizeof(request->buffer) - request->received, 0);
+        if (length < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (length < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            return 0;
+        }
+        if (length <= 0)
+        {
+            return -1;
+        }
+        request->received += (size_t) length;
+    }
+
+    return 1;
+}
+
+/**
+ * Accepts the pending connections of the listening socket while there is room
+ * for them among the connections being received.
+ *
+ * @param service the verifier service
+ * @param connections the connections being received
+ * @param num_connections the number of connections being received
+ * @param now the current time (milliseconds)
+ */
+static void ve_service_accept(verifier_service_t *service, verifier_service_request_t **connections, size_t *num_connections, uint64_t now)
+{
+    verifier_service_request_t *request;
+    int fd;
+
+    while (*num_connections < VERIFIER_SERVICE_MAX_CONNECTIONS)
+    {
+        fd = accept(service->socket_fd, NULL, NULL);
+        if (fd < 0)
+        {
+            // EAGAIN - no more pending connections
+            return;
+        }
+
+        if (fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) < 0)
+        {
+            close(fd);
+            continue;
+        }
+
+        request = malloc(sizeof(verifier_service_request_t));
+        if (request == NULL)
+        {
+            close(fd);
+            continue;
+        }
+        request->fd = fd;
+        request->deadline = now + VERIFIER_SERVICE_RECEIVE_TIMEOUT;
+        request->received = 0;
+
+        connections[(*num_connections)++] = request;
+    }
+}
+
+/**
+ * Accepts the requests of the clients and queues them for the workers until
+ * the service is requested to stop. The connections are read without blocking,
+ * a client has VERIFIER_SERVICE_RECEIVE_TIMEOUT ms to send its whole request.
+ *
+ * @param service the verifier service
+ * @return 0 if success else -1
+ */
+int ve_service_run(verifier_service_t *service)
+{
+    verifier_service_request_t *connections[VERIFIER_SERVICE_MAX_CONNECTIONS];
+    struct pollfd pfds[1 + VERIFIER_SERVICE_MAX_CONNECTIONS];
+
+    size_t num_connections = 0;
+    size_t it;
+
+    uint64_t now;
+    int r;
+
+    if (service == NULL || service->socket_fd < 0)
+    {
+        return -1;
+    }
+
+    while (__atomic_load_n(&service->running, __ATOMIC_ACQUIRE) == 1)
+    {
+        ve_service_apply_delta(service);
+
+        // the listening socket is not polled while all the connection slots are in use
+        pfds[0].fd = num_connections < VERIFIER_SERVICE_MAX_CONNECTIONS ? service->socket_fd : -1;
+        pfds[0].events = POLLIN;
+        pfds[0].revents = 0;
+        for (it = 0; it < num_connections; it++)
+        {
+            pfds[1 + it].fd = connections[it]->fd;
+            pfds[1 + it].events = POLLIN;
+            pfds[1 + it].revents = 0;
+        }
+
+        // wake up periodically to check whether the service must stop (and to tail the delta log)
+        r = poll(pfds, 1 + num_connections, 100);
+        if (r < 0)
+        {
+            continue;
+        }
+        now = ve_service_get_time();
+
+        /// connections being received (backwards, a finished connection is replaced by the last one)
+        for (it = num_connections; it-- > 0;)
+        {
+            r = 0;
+            if (pfds[1 + it].revents != 0)
+            {
+                r = ve_service_receive(connections[it]);
+            }
+            if (r == 0 && now < connections[it]->deadline)
+            {
+                continue;
+            }
+
+            if (r <= 0)
+            {
+                // error, closed or too slow
+                ve_service_respond(connections[it], VERIFIER_SERVICE_RESPONSE_MALFORMED);
+            }
+            else if (mpmc_queue_push(&service->queue, connections[it]) < 0)
+            {
+                ve_service_respond(connections[it], VERIFIER_SERVICE_RESPONSE_BUSY);
+            }
+            else
+            {
+                sem_post(&service->num_requests);
+            }
+
+            connections[it] = connections[--num_connections];
+        }
+
+        /// new connections
+        if (pfds[0].revents & POLLIN)
+        {
+            ve_service_accept(service, connections, &num_connections, now);
+        }
+    }
+
+    // connections not received yet
+    for (it = 0; it < num_connections; it++)
+    {
+        ve_service_respond(connections[it], VERIFIER_SERVICE_RESPONSE_BUSY);
+    }
+
+    return 0;
+}
+
+/**
+ * Requests the service to stop (it can be called from a signal handler).
+ *
+ * @param service the verifier service
+ */
+void ve_service_request_stop(verifier_service_t *service)
+{
+    if (service == NULL)
+    {
+        return;
+    }
+
+    __atomic_store_n(&service->running, 0, __ATOMIC_RELEASE);
+}
+
+/**
+ * Stops the worker threads and releases the resources of the service.
+ *
+ * @param service the verifier service
+ */
+void ve_service_stop(verifier_service_t *service)
+{
+    verifier_service_request_t *request;
+    size_t it;
+
+    if (service == NULL)
+    {
+        return;
+    }
+
+    __atomic_store_n(&service->running, 0, __ATOMIC_RELEASE);
+
+    // the workers finish the queued requests, then an empty pop stops them
+    for (it = 0; it < service->num_workers; it++)
+    {
+        sem_post(&service->num_requests);
+    }
+    for (it = 0; it < service->num_workers; it++)
+    {
+        pthread_join(service->workers[it].thread, NULL);
+        if (service->workers[it].parameters.revocation_snapshot != NULL)
+        {
+            rs_unregister_reader(service->workers[it].parameters.revocation_snapshot, service->workers[it].parameters.revocation_reader);
+        }
+    }
+    free(service->workers);
+    service->workers = NULL;
+    service->num_workers = 0;
+
+    // requests queued after the workers stopped
+    if (service->queue.cells != NULL)
+    {
+        while (mpmc_queue_pop(&service->queue, (void **) &request) == 0)
+        {
+            ve_service_respond(request, VERIFIER_SERVICE_RESPONSE_BUSY);
+        }
+    }
+
+    if (service->socket_fd >= 0)
+    {
+        close(service->socket_fd);
+        unlink(service->socket_path);
+        service->socket_fd = -1;
+    }
+
+    mpmc_queue_destroy(&service->queue);
+    sem_destroy(&service->num_requests);
+    pthread_mutex_destroy(&service->epoch_mutex);
+}
@@ -0,0 +1,231 @@
+/**
+ *
+ *  Copyright (C) 2020  Raul Casanova Marques
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __RKVAC_PROTOCOL_SERVICE_VERIFIER_H_
+#define __RKVAC_PROTOCOL_SERVICE_VERIFIER_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#include <mcl/bn_c256.h>
+
+#include "config/config.h"
+
+#include "models/issuer.h"
+#include "models/revocation-authority.h"
+#include "models/user.h"
+#include "models/verifier.h"
+#include "system.h"
+
+#include "controllers/verifier.h"
+
+#include "helpers/mcl_helper.h"
+#include "queue/mpmc_queue.h"
+#include "revocation/delta.h"
+
+/*
+ * Request sent by the client (all the values are big-endian):
+ *
+ * +-------+----------------+---------------------------------------+--------------------------------------------------+------------------------------------+
+ * | nonce | num_attributes | attributes (disclosed flag, value)    | credential (C, sigma_hat, j, sigma_e pairs)      | pi (e, s_v, s_mr, s_i, s_e, s_mz)  |
+ * | 32B   | 1B             | USER_MAX_NUM_ATTRIBUTES · (1B + 32B)  | 2 · 65B + 1B + REVOCATION_AUTHORITY_MAX_J · 130B | (4 + max j + max attr) · 32B       |
+ * +-------+----------------+---------------------------------------+--------------------------------------------------+------------------------------------+
+ *
+ * The values of the non-disclosed attributes, the s_mz values of the
+ * disclosed attributes and the values of the unused randomizers (after
+ * the first j) are sent as zeros. The response is a single byte.
+ */
+#define VERIFIER_SERVICE_REQUEST_LENGTH (NONCE_LENGTH + 1 + USER_MAX_NUM_ATTRIBUTES * (1 + EC_SIZE) + \
+                                         2 * ECP_SIZE + 1 + REVOCATION_AUTHORITY_MAX_J * 2 * ECP_SIZE + \
+                                         (4 + REVOCATION_AUTHORITY_MAX_J + USER_MAX_NUM_ATTRIBUTES) * EC_SIZE)
+
+#define VERIFIER_SERVICE_RESPONSE_VALID 0x00
+#define VERIFIER_SERVICE_RESPONSE_INVALID 0x01
+#define VERIFIER_SERVICE_RESPONSE_MALFORMED 0x02
+#define VERIFIER_SERVICE_RESPONSE_BUSY 0x03
+
+typedef struct
+{
+    int fd; // connection of the client (non-blocking)
+    uint64_t deadline; // the whole request must be received before (milliseconds, monotonic clock)
+    size_t received;
+    uint8_t buffer[VERIFIER_SERVICE_REQUEST_LENGTH]; // encoded request, decoded by the worker
+
+    uint8_t nonce[NONCE_LENGTH];
+    verifier_proof_t proof;
+} verifier_service_request_t;
+
+struct verifier_service_t;
+
+typedef struct
+{
+    pthread_t thread;
+    struct verifier_service_t *service;
+    verifier_par_t parameters; // own reader slot of the revocation list snapshot
+
+    // scratch state of the worker (one batch of requests)
+    verifier_service_request_t *requests[VERIFIER_SERVICE_BATCH_SIZE];
+    verifier_proof_t proofs[VERIFIER_SERVICE_BATCH_SIZE];
+    int results[VERIFIER_SERVICE_BATCH_SIZE];
+} verifier_service_worker_t;
+
+typedef struct verifier_service_t
+{
+    // parameters used to verify the proofs (read-only while running)
+    system_par_t sys_parameters;
+    verifier_par_t parameters;
+    revocation_authority_par_t ra_parameters;
+    revocation_authority_public_key_t ra_public_key;
+    issuer_keys_t ie_keys;
+
+    uint8_t epoch[EPOCH_LENGTH];
+    pthread_mutex_t epoch_mutex;
+
+    revocation_delta_t *revocation_delta; // tailed delta log or NULL
+
+    char socket_path[sizeof(((struct sockaddr_un *) 0)->sun_path)];
+    int socket_fd;
+
+    mpmc_queue_t queue;
+    sem_t num_requests; // number of requests in the queue
+    int running;
+
+    verifier_service_worker_t *workers;
+    size_t num_workers;
+} verifier_service_t;
+
+/**
+ * Starts the verifier service: binds the Unix domain socket and starts the worker
+ * threads. The system must be initialized (mclBn_init) before starting the service,
+ * the mcl state is only read by the workers.
+ *
+ * @param service the verifier service
+ * @param sys_parameters the system parameters
+ * @param parameters the verifier parameters
+ * @param ra_parameters the revocation authority parameters
+ * @param ra_public_key the revocation authority public key
+ * @param ie_keys the issuer keys
+ * @param epoch the current epoch
+ * @param epoch_length the length of the epoch
+ * @param socket_path the path of the Unix domain socket
+ * @param num_workers the number of worker threads (0 - one per core)
+ * @return 0 if success else -1
+ */
+extern int ve_service_start(verifier_service_t *service, system_par_t sys_parameters, verifier_par_t parameters, revocation_authority_par_t ra_parameters,
+                            revocation_authority_public_key_t ra_public_key, issuer_keys_t ie_keys, const void *epoch, size_t epoch_length,
+                            const char *socket_path, size_t num_workers);
+
+/**
+ * Sets the epoch used to verify the next requests. When the service reads a
+ * revocation list snapshot, the list of the new epoch is published (rs_publish)
+ * just before, the workers do not stop meanwhile.
+ *
+ * @param service the verifier service
+ * @param epoch the current epoch
+ * @param epoch_length the length of the epoch
+ * @return 0 if success else -1
+ */
+extern int ve_service_set_epoch(verifier_service_t *service, const void *epoch, size_t epoch_length);
+
+/**
+ * Sets the delta log tailed by the service, the deltas are applied to the
+ * revocation list snapshot of the verifier parameters between the requests.
+ * When a rebuild of the next epoch is applied, the service moves to that epoch.
+ *
+ * @param service the verifier service
+ * @param delta the delta log or NULL
+ * @return 0 if success else -1
+ */
+extern int ve_service_set_revocation_delta(verifier_service_t *service, revocation_delta_t *delta);
+
+/**
+ * Accepts the requests of the clients and queues them for the workers until
+ * the service is requested to stop. The connections are read without blocking,
+ * a client has VERIFIER_SERVICE_RECEIVE_TIMEOUT ms to send its whole request.
+ *
+ * @param service the verifier service
+ * @return 0 if success else -1
+ */
+extern int ve_service_run(verifier_service_t *service);
+
+/**
+ * Requests the service to stop (it can be called from a signal handler).
+ *
+ * @param service the verifier service
+ */
+extern void ve_service_request_stop(verifier_service_t *service);
+
+/**
+ * Stops the worker threads and releases the resources of the service.
+ *
+ * @param service the verifier service
+ */
+extern void ve_service_stop(verifier_service_t *service);
+
+/**
+ * Encodes a proof of knowledge as a request of the verifier service.
+ *
+ * @param buffer the buffer where the request will be stored
+ * @param buffer_length the length of the buffer (VERIFIER_SERVICE_REQUEST_LENGTH)
+ * @param nonce the nonce generated by the verifier
+ * @param nonce_length the length of the nonce
+ * @param attributes the attributes disclosed by the user
+ * @param ue_credential the credential struct computed by the user
+ * @param ue_pi the pi struct computed by the user
+ * @return 0 if success else -1
+ */
+extern int ve_service_encode_request(void *buffer, size_t buffer_length, const void *nonce, size_t nonce_length,
+                                     user_attributes_t attributes, user_credential_t ue_credential, user_pi_t ue_pi);
+
+/**
+ * Decodes a request of the verifier service (the proof of knowledge points to
+ * the nonce of the request).
+ *
+ * @param buffer the buffer containing the request
+ * @param buffer_length the length of the buffer (VERIFIER_SERVICE_REQUEST_LENGTH)
+ * @param request the request
+ * @return 0 if success else -1
+ */
+extern int ve_service_decode_request(const void *buffer, size_t buffer_length, verifier_service_request_t *request);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RKVAC_PROTOCOL_SERVICE_VERIFIER_H_ */
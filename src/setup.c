@@ -20,13 +20,68 @@
 
 #include "setup.h"
 
+/*
+ * Alignment of the values stored in the system parameters blob
+ */
+#define SYSTEM_BLOB_ALIGNMENT 64
+
+#define SYSTEM_BLOB_ALIGN(x) (((x) + (SYSTEM_BLOB_ALIGNMENT - 1)) & ~((uint64_t) SYSTEM_BLOB_ALIGNMENT - 1))
+
+/**
+ * Sets the representation and the offsets of the system parameters blob
+ * expected by this build.
+ *
+ * @param header the header of the blob
+ * @param curve the curve of the system parameters
+ */
+static void sys_set_layout(system_blob_header_t *header, int curve)
+{
+    header->curve = (uint32_t) curve;
+    header->mcl_version = (uint32_t) mclBn_getVersion();
+    header->g1_size = (uint32_t) sizeof(mclBnG1);
+    header->g2_size = (uint32_t) sizeof(mclBnG2);
+    header->table_size = (uint32_t) sizeof(fixed_base_table_t);
+    header->num_precomputed = (uint32_t) mclBn_getUint64NumToPrecompute();
+
+    header->G1_offset = SYSTEM_BLOB_ALIGN(sizeof(system_blob_header_t));
+    header->G2_offset = SYSTEM_BLOB_ALIGN(header->G1_offset + header->g1_size);
+    header->G1_table_offset = SYSTEM_BLOB_ALIGN(header->G2_offset + header->g2_size);
+    header->G2_precomputed_offset = SYSTEM_BLOB_ALIGN(header->G1_table_offset + header->table_size);
+    header->blob_length = header->G2_precomputed_offset + header->num_precomputed * sizeof(uint64_t);
+}
+
 /**
- * Outputs the system parameters.
+ * Outputs the system parameters. The embedded blob is used if the executable
+ * has been built with it, otherwise the parameters are computed.
  *
  * @param parameters the system parameters
  * @return 0 if success else -1
  */
 int sys_setup(system_par_t *parameters)
+{
+#if defined (RKVAC_PROTOCOL_EMBEDDED_PARAMETERS)
+    int r;
+
+    // a blob written by another build of mcl is rejected, compute the parameters instead
+    r = sys_setup_from_blob(parameters, sys_embedded_parameters, sys_embedded_parameters_length);
+    if (r == 0)
+    {
+        return 0;
+    }
+#endif
+
+    return sys_compute(parameters);
+}
+
+/**
+ * Computes the system parameters: initializes the curve, parses the
+ * generators and precomputes the fixed-base table of G1 and the line
+ * coefficients of G2.
+ *
+ * @param parameters the system parameters
+ * @return 0 if success else -1
+ */
+int sys_compute(system_par_t *parameters)
 {
     char G1_buffer[] = "1 " // affine coordinate
                        "-1 " // x
@@ -45,6 +100,9 @@ int sys_setup(system_par_t *parameters)
         return -1;
     }
 
+    parameters->G1_table = NULL;
+    parameters->G2_precomputed = NULL;
+
     parameters->curve = MCL_BN254;
     r = mclBn_init(parameters->curve, MCLBN_COMPILED_TIME_VAR);
     if (r != 0)
@@ -68,5 +126,291 @@ int sys_setup(system_par_t *parameters)
         return -1;
     }
 
+    // fixed-base table of G1 (shared by all the controllers)
+    r = fixed_base_precompute(&parameters->G1_table, &parameters->G1);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    // line coefficients of G2 (copied by the issuer and the verifier)
+    r = mcl_G2_precompute(&parameters->G2_precomputed, &parameters->G2);
+    if (r < 0)
+    {
+        sys_cleanup(parameters);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * Outputs the system parameters stored in a blob (see sys_export).
+ *
+ * @param parameters the system parameters
+ * @param blob the blob
+ * @param blob_length the length of the blob
+ * @return 0 if success else -1
+ */
+int sys_setup_from_blob(system_par_t *parameters, const void *blob, size_t blob_length)
+{
+    system_blob_header_t header, expected;
+    const uint8_t *data = (const uint8_t *) blob;
+
+    int r;
+
+    if (parameters == NULL || blob == NULL || blob_length < sizeof(system_blob_header_t))
+    {
+        return -1;
+    }
+
+    parameters->G1_table = NULL;
+    parameters->G2_precomputed = NULL;
+
+    // the blob may not be aligned (e.g. embedded into the executable)
+    memcpy(&header, blob, sizeof(system_blob_header_t));
+
+    /// header (layout computed by this build)
+    memset(&expected, 0, sizeof(system_blob_header_t));
+    sys_set_layout(&expected, MCL_BN254);
+
+    if (header.magic != SYSTEM_BLOB_MAGIC || header.version != SYSTEM_BLOB_VERSION
+        || header.curve != expected.curve || header.mcl_version != expected.mcl_version
+        || header.g1_size != expected.g1_size || header.g2_size != expected.g2_size
+        || header.table_size != expected.table_size || header.num_precomputed != expected.num_precomputed
+        || header.G1_offset != expected.G1_offset || header.G2_offset != expected.G2_offset
+        || header.G1_table_offset != expected.G1_table_offset || header.G2_precomputed_offset != expected.G2_precomputed_offset
+        || header.blob_length != expected.blob_length || header.blob_length != blob_length)
+    {
+        return -1;
+    }
+
+    /// checksum of the whole blob
+    if (header.checksum != checksum_fnv1a(&data[sizeof(system_blob_header_t)], blob_length - sizeof(system_blob_header_t)))
+    {
+        return -1;
+    }
+
+    parameters->curve = (int) header.curve;
+    r = mclBn_init(parameters->curve, MCLBN_COMPILED_TIME_VAR);
+    if (r != 0)
+    {
+        return -1;
+    }
+
+    memcpy(&parameters->G1, &data[header.G1_offset], sizeof(mclBnG1));
+    r = mclBnG1_isValid(&parameters->G1);
+    if (r != 1)
+    {
+        return -1;
+    }
+
+    memcpy(&parameters->G2, &data[header.G2_offset], sizeof(mclBnG2));
+    r = mclBnG2_isValid(&parameters->G2);
+    if (r != 1)
+    {
+        return -1;
+    }
+
+    parameters->G1_table = malloc(sizeof(fixed_base_table_t));
+    parameters->G2_precomputed = malloc(header.num_precomputed * sizeof(uint64_t));
+    if (parameters->G1_table == NULL || parameters->G2_precomputed == NULL)
+    {
+        sys_cleanup(parameters);
+        return -1;
+    }
+
+    memcpy(parameters->G1_table, &data[header.G1_table_offset], sizeof(fixed_base_table_t));
+    memcpy(parameters->G2_precomputed, &data[header.G2_precomputed_offset], header.num_precomputed * sizeof(uint64_t));
+
     return 0;
 }
+
+/**
+ * Outputs the system parameters stored in a blob file (see sys_save).
+ *
+ * @param parameters the system parameters
+ * @param path the path of the blob
+ * @return 0 if success else -1
+ */
+int sys_setup_from_file(system_par_t *parameters, const char *path)
+{
+    struct stat blob_stat;
+    void *blob;
+
+    int fd;
+    int r;
+
+    if (parameters == NULL || path == NULL)
+    {
+        return -1;
+    }
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    r = fstat(fd, &blob_stat);
+    if (r < 0 || (size_t) blob_stat.st_size < sizeof(system_blob_header_t))
+    {
+        close(fd);
+        return -1;
+    }
+
+    blob = mmap(NULL, (size_t) blob_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (blob == MAP_FAILED)
+    {
+        return -1;
+    }
+
+    r = sys_setup_from_blob(parameters, blob, (size_t) blob_stat.st_size);
+    munmap(blob, (size_t) blob_stat.st_size);
+
+    return r;
+}
+
+/**
+ * Stores the system parameters in a blob. The blob must be released using free().
+ *
+ * @param parameters the system parameters (with the precomputed tables)
+ * @param blob the blob
+ * @param blob_length the length of the blob
+ * @return 0 if success else -1
+ */
+int sys_export(system_par_t parameters, void **blob, size_t *blob_length)
+{
+    system_blob_header_t header;
+    uint8_t *data;
+
+    if (blob == NULL || blob_length == NULL || parameters.G1_table == NULL || parameters.G2_precomputed == NULL)
+    {
+        return -1;
+    }
+
+    memset(&header, 0, sizeof(system_blob_header_t));
+    sys_set_layout(&header, parameters.curve);
+
+    data = calloc(1, (size_t) header.blob_length);
+    if (data == NULL)
+    {
+        return -1;
+    }
+
+    memcpy(&data[header.G1_offset], &parameters.G1, sizeof(mclBnG1));
+    memcpy(&data[header.G2_offset], &parameters.G2, sizeof(mclBnG2));
+    memcpy(&data[header.G1_table_offset], parameters.G1_table, sizeof(fixed_base_table_t));
+    memcpy(&data[header.G2_precomputed_offset], parameters.G2_precomputed, header.num_precomputed * sizeof(uint64_t));
+
+    header.checksum = checksum_fnv1a(&data[sizeof(system_blob_header_t)], (size_t) header.blob_length - sizeof(system_blob_header_t));
+    header.version = SYSTEM_BLOB_VERSION;
+    header.magic = SYSTEM_BLOB_MAGIC;
+    memcpy(data, &header, sizeof(system_blob_header_t));
+
+    *blob = data;
+    *blob_length = (size_t) header.blob_length;
+
+    return 0;
+}
+
+/**
+ * Stores the system parameters in a blob file (the file is replaced atomically).
+ *
+ * @param parameters the system parameters (with the precomputed tables)
+ * @param path the path of the blob
+ * @return 0 if success else -1
+ */
+int sys_save(system_par_t parameters, const char *path)
+{
+    char tmp_path[FILENAME_MAX];
+    uint8_t *blob = NULL;
+
+    size_t it, blob_length;
+    ssize_t written;
+    int fd = -1;
+    int r;
+
+    if (path == NULL)
+    {
+        return -1;
+    }
+
+    r = snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    if (r < 0 || (size_t) r >= sizeof(tmp_path))
+    {
+        return -1;
+    }
+
+    r = sys_export(parameters, (void **) &blob, &blob_length);
+    if (r < 0)
+    {
+        return -1;
+    }
+
+    /// temporary file, renamed once it is durable
+    fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        r = -1;
+        goto cleanup;
+    }
+
+    for (it = 0; it < blob_length; it += (size_t) written)
+    {
+        written = write(fd, &blob[it], blob_length - it);
+        if (written <= 0)
+        {
+            r = -1;
+            goto cleanup;
+        }
+    }
+
+    r = fsync(fd);
+    if (r < 0)
+    {
+        goto cleanup;
+    }
+
+    r = close(fd);
+    fd = -1;
+    if (r < 0)
+    {
+        goto cleanup;
+    }
+
+    r = rename(tmp_path, path);
+
+cleanup:
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+    if (r < 0)
+    {
+        unlink(tmp_path);
+    }
+    free(blob);
+
+    return r < 0 ? -1 : 0;
+}
+
+/**
+ * Releases the resources allocated by the system setup.
+ *
+ * @param parameters the system parameters
+ */
+void sys_cleanup(system_par_t *parameters)
+{
+    if (parameters == NULL)
+    {
+        return;
+    }
+
+    fixed_base_free(parameters->G1_table);
+    parameters->G1_table = NULL;
+
+    free(parameters->G2_precomputed);
+    parameters->G2_precomputed = NULL;
+}
@@ -27,19 +27,136 @@ extern "C"
 #endif
 
 #include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include <mcl/bn_c256.h>
 
 #include "system.h"
 
+#include "helpers/fixed_base_helper.h"
+#include "helpers/hash_helper.h"
+#include "helpers/mcl_helper.h"
+
+/*
+ * Magic number of the system parameters blob ("RKVACSYS")
+ */
+#define SYSTEM_BLOB_MAGIC 0x5359534341564B52ULL
+
+/*
+ * Version of the layout of the system parameters blob
+ */
+#define SYSTEM_BLOB_VERSION 1
+
+typedef struct
+{
+    uint64_t magic;
+    uint64_t version; // version of the layout
+    uint64_t blob_length;
+    uint64_t checksum; // FNV-1a (64-bit words) of the blob after the header
+
+    // representation of the stored values (native mcl types)
+    uint32_t curve;
+    uint32_t mcl_version;
+    uint32_t g1_size;
+    uint32_t g2_size;
+    uint32_t table_size;
+    uint32_t num_precomputed; // 64-bit words of the line coefficients of G2
+
+    uint64_t G1_offset;
+    uint64_t G2_offset;
+    uint64_t G1_table_offset; // fixed-base table of G1
+    uint64_t G2_precomputed_offset; // line coefficients of G2
+} system_blob_header_t;
+
+/*
+ * IMPORTANT!
+ *
+ * The system parameters blob holds the generators, the fixed-base table of
+ * G1 and the line coefficients of G2 in the native representation of mcl,
+ * so a process starts without parsing the generators or precomputing the
+ * tables. The blob is only valid for the build of mcl that wrote it (the
+ * header records the curve, the version of mcl and the size of the types).
+ * It is written by sys_save, or by rkvac-protocol-parameters at build time
+ * and embedded into the executables (RKVAC_PROTOCOL_EMBEDDED_PARAMETERS).
+ */
+#if defined (RKVAC_PROTOCOL_EMBEDDED_PARAMETERS)
+extern const unsigned char sys_embedded_parameters[];
+extern const size_t sys_embedded_parameters_length;
+#endif
+
 /**
- * Outputs the system parameters.
+ * Outputs the system parameters. The embedded blob is used if the executable
+ * has been built with it, otherwise the parameters are computed.
  *
  * @param parameters the system parameters
  * @return 0 if success else -1
  */
 extern int sys_setup(system_par_t *parameters);
 
+/**
+ * Computes the system parameters: initializes the curve, parses the
+ * generators and precomputes the fixed-base table of G1 and the line
+ * coefficients of G2.
+ *
+ * @param parameters the system parameters
+ * @return 0 if success else -1
+ */
+extern int sys_compute(system_par_t *parameters);
+
+/**
+ * Outputs the system parameters stored in a blob (see sys_export).
+ *
+ * @param parameters the system parameters
+ * @param blob the blob
+ * @param blob_length the length of the blob
+ * @return 0 if success else -1
+ */
+extern int sys_setup_from_blob(system_par_t *parameters, const void *blob, size_t blob_length);
+
+/**
+ * Outputs the system parameters stored in a blob file (see sys_save).
+ *
+ * @param parameters the system parameters
+ * @param path the path of the blob
+ * @return 0 if success else -1
+ */
+extern int sys_setup_from_file(system_par_t *parameters, const char *path);
+
+/**
+ * Stores the system parameters in a blob. The blob must be released using free().
+ *
+ * @param parameters the system parameters (with the precomputed tables)
+ * @param blob the blob
+ * @param blob_length the length of the blob
+ * @return 0 if success else -1
+ */
+extern int sys_export(system_par_t parameters, void **blob, size_t *blob_length);
+
+/**
+ * Stores the system parameters in a blob file (the file is replaced atomically).
+ *
+ * @param parameters the system parameters (with the precomputed tables)
+ * @param path the path of the blob
+ * @return 0 if success else -1
+ */
+extern int sys_save(system_par_t parameters, const char *path);
+
+/**
+ * Releases the resources allocated by the system setup.
+ *
+ * @param parameters the system parameters
+ */
+extern void sys_cleanup(system_par_t *parameters);
+
 #ifdef __cplusplus
 }
 #endif